@@ -27,6 +27,8 @@
 #include <MicroOcpp/Core/OperationRegistry.h>
 #include <MicroOcpp/Core/FilesystemAdapter.h>
 #include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Core/FilesystemSnapshot.h>
+#include <MicroOcpp/Core/Trace.h>
 #include <MicroOcpp/Core/Ftp.h>
 #include <MicroOcpp/Core/FtpMbedTLS.h>
 
@@ -48,6 +50,15 @@ Connection *connection {nullptr};
 Context *context {nullptr};
 std::shared_ptr<FilesystemAdapter> filesystem;
 
+#if MO_ENABLE_SNAPSHOT
+std::shared_ptr<FilesystemSnapshot> fsSnapshot;
+#endif
+
+#if MO_ENABLE_TRACE
+std::unique_ptr<TraceConnection> traceConnection;
+std::unique_ptr<TraceRecorder> traceRecorder;
+#endif
+
 #ifndef MO_NUMCONNECTORS
 #define MO_NUMCONNECTORS 2
 #endif
@@ -246,6 +257,24 @@ ChargerCredentials ChargerCredentials::v201(const char *cpModel, const char *cpV
     return res;
 }
 
+#if MO_ENABLE_SNAPSHOT
+//no transaction is active, so the stored state won't change soon
+bool isSnapshotCleanState() {
+    unsigned int numConnectors = context->getModel().getNumConnectors();
+#if MO_ENABLE_V201
+    if (context->getVersion().major == 2) {
+        numConnectors = MO_NUM_EVSEID;
+    }
+#endif
+    for (unsigned int connectorId = 1; connectorId < numConnectors; connectorId++) {
+        if (isTransactionActive(connectorId)) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif //MO_ENABLE_SNAPSHOT
+
 void mocpp_initialize(Connection& connection, const char *bootNotificationCredentials, std::shared_ptr<FilesystemAdapter> fs, bool autoRecover, MicroOcpp::ProtocolVersion version) {
     if (context) {
         MO_DBG_WARN("already initialized. To reinit, call mocpp_deinitialize() before");
@@ -254,9 +283,20 @@ void mocpp_initialize(Connection& connection, const char *bootNotificationCreden
 
     MO_DBG_DEBUG("initialize OCPP");
 
+    MO_MEM_BOOT_ARENA_OPEN(); //the long-lived objects created below are placed contiguously
+
     filesystem = fs;
     MO_DBG_DEBUG("filesystem %s", filesystem ? "loaded" : "deactivated");
 
+#if MO_ENABLE_SNAPSHOT
+    if (filesystem) {
+        fsSnapshot = decorateSnapshot(filesystem); //warm boot: the loaders below read from the snapshot if available
+        if (fsSnapshot) {
+            filesystem = fsSnapshot;
+        }
+    }
+#endif
+
     BootStats bootstats;
     BootService::loadBootStats(filesystem, bootstats);
 
@@ -272,7 +312,12 @@ void mocpp_initialize(Connection& connection, const char *bootNotificationCreden
 
     configuration_init(filesystem); //call before each other library call
 
+#if MO_ENABLE_TRACE
+    traceConnection.reset(new TraceConnection(connection));
+    context = new Context(*traceConnection, filesystem, bootstats.bootNr, version);
+#else
     context = new Context(connection, filesystem, bootstats.bootNr, version);
+#endif
 
 #if MO_ENABLE_MBEDTLS
     context->setFtpClient(makeFtpClientMbedTLS());
@@ -297,7 +342,7 @@ void mocpp_initialize(Connection& connection, const char *bootNotificationCreden
 #endif
     {
         model.setTransactionStore(std::unique_ptr<TransactionStore>(
-            new TransactionStore(MO_NUMCONNECTORS, filesystem)));
+            new ("v16.Transactions.TransactionStore") TransactionStore(MO_NUMCONNECTORS, filesystem)));
         model.setConnectorsCommon(std::unique_ptr<ConnectorsCommon>(
             new ConnectorsCommon(*context, MO_NUMCONNECTORS, filesystem)));
         auto connectors = makeVector<std::unique_ptr<Connector>>("v16.ConnectorBase.Connector");
@@ -374,8 +419,21 @@ void mocpp_initialize(Connection& connection, const char *bootNotificationCreden
     }
     credsJson.reset();
 
+#if MO_ENABLE_TRACE
+    auto traceCaptureBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "TraceCapture", false, CONFIGURATION_FN, false, true);
+#endif
+
     configuration_load();
 
+#if MO_ENABLE_TRACE
+    if (traceCaptureBool && traceCaptureBool->getBool()) {
+        traceRecorder = makeTraceRecorder(fs, bootstats.bootNr, version); //bypass the snapshot decorator
+        traceConnection->setRecorder(traceRecorder.get());
+    }
+#endif
+
+    MO_MEM_BOOT_ARENA_FREEZE();
+
     MO_DBG_INFO("initialized MicroOcpp v" MO_VERSION " running OCPP %i.%i.%i", version.major, version.minor, version.patch);
 }
 
@@ -390,11 +448,22 @@ void mocpp_deinitialize() {
             bootstats.lastBootSuccess = bootstats.bootNr;
             BootService::storeBootStats(filesystem, bootstats);
         }
+
+#if MO_ENABLE_SNAPSHOT
+        if (fsSnapshot && !fsSnapshot->isSnapshotValid() && isSnapshotCleanState()) {
+            fsSnapshot->storeSnapshot();
+        }
+#endif
     }
     
     delete context;
     context = nullptr;
 
+#if MO_ENABLE_TRACE
+    traceRecorder.reset(); //after the Inputs which refer to it
+    traceConnection.reset();
+#endif
+
 #ifndef MO_CUSTOM_WS
     delete connection;
     connection = nullptr;
@@ -403,9 +472,14 @@ void mocpp_deinitialize() {
 #endif
 
     filesystem.reset();
+#if MO_ENABLE_SNAPSHOT
+    fsSnapshot.reset();
+#endif
 
     configuration_deinit();
 
+    MO_MEM_BOOT_ARENA_RELEASE();
+
 #if !MO_HEAP_PROFILER_EXTERNAL_CONTROL
     MO_MEM_DEINIT();
 #endif
@@ -419,7 +493,26 @@ void mocpp_loop() {
         return;
     }
 
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        traceRecorder->onLoop(mocpp_tick_ms());
+    }
+#endif
+
     context->loop();
+
+#if MO_ENABLE_SNAPSHOT
+    if (fsSnapshot) {
+        fsSnapshot->releaseImage(); //boot-time loading completed
+        if (fsSnapshot->isStoreDue() && isSnapshotCleanState() && fsSnapshot->beginStore()) {
+            //copy one file per step, so that the store doesn't exceed the loop budget
+            auto snapshot = fsSnapshot;
+            context->getTaskQueue().addTask(makeTask([snapshot] () {
+                return snapshot->storeStep();
+            }));
+        }
+    }
+#endif
 }
 
 std::shared_ptr<Transaction> beginTransaction(const char *idTag, unsigned int connectorId) {
@@ -437,6 +530,12 @@ std::shared_ptr<Transaction> beginTransaction(const char *idTag, unsigned int co
         return nullptr;
     }
 
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        traceRecorder->onCall("beginTransaction", connectorId, idTag);
+    }
+#endif
+
     return connector->beginTransaction(idTag);
 }
 
@@ -456,19 +555,48 @@ std::shared_ptr<Transaction> beginTransaction_authorized(const char *idTag, cons
         return nullptr;
     }
     
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        traceRecorder->onCall("beginTransaction_authorized", connectorId, idTag, parentIdTag);
+    }
+#endif
+
     return connector->beginTransaction_authorized(idTag, parentIdTag);
 }
 
+namespace MicroOcpp {
+namespace Facade {
+
+//shared by endTransaction and endTransaction_authorized without recording a trace call. Internal to this file
+static bool endTransactionAuthorized(const char *idTag, const char *reason, unsigned int connectorId) {
+    auto connector = context->getModel().getConnector(connectorId);
+    if (!connector) {
+        MO_DBG_ERR("could not find connector");
+        return false;
+    }
+    auto res = isTransactionActive(connectorId);
+    connector->endTransaction(idTag, reason);
+    return res;
+}
+
+} //end namespace MicroOcpp::Facade
+} //end namespace MicroOcpp
+
 bool endTransaction(const char *idTag, const char *reason, unsigned int connectorId) {
     if (!context) {
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return false;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        traceRecorder->onCall("endTransaction", connectorId, idTag, reason);
+    }
+#endif
     bool res = false;
     if (isTransactionActive(connectorId) && getTransactionIdTag(connectorId)) {
         //end transaction now if either idTag is nullptr (i.e. force stop) or the idTag matches beginTransaction
         if (!idTag || !strcmp(idTag, getTransactionIdTag(connectorId))) {
-            res = endTransaction_authorized(idTag, reason, connectorId);
+            res = endTransactionAuthorized(idTag, reason, connectorId);
         } else {
             auto tx = getTransaction(connectorId);
             const char *parentIdTag = tx->getParentIdTag();
@@ -492,7 +620,7 @@ bool endTransaction(const char *idTag, const char *reason, unsigned int connecto
                     }
                     if (idTagInfo.containsKey("parentIdTag") && !strcmp(idTagInfo["parenIdTag"], tx->getParentIdTag()))
                     {
-                        endTransaction_authorized(idTag_capture.c_str(), reason_capture.empty() ? (const char*)nullptr : reason_capture.c_str(), connectorId);
+                        endTransactionAuthorized(idTag_capture.c_str(), reason_capture.empty() ? (const char*)nullptr : reason_capture.c_str(), connectorId);
                     }
                 });
 
@@ -524,14 +652,12 @@ bool endTransaction_authorized(const char *idTag, const char *reason, unsigned i
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return false;
     }
-    auto connector = context->getModel().getConnector(connectorId);
-    if (!connector) {
-        MO_DBG_ERR("could not find connector");
-        return false;
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        traceRecorder->onCall("endTransaction_authorized", connectorId, idTag, reason);
     }
-    auto res = isTransactionActive(connectorId);
-    connector->endTransaction(idTag, reason);
-    return res;
+#endif
+    return endTransactionAuthorized(idTag, reason, connectorId);
 }
 
 bool isTransactionActive(unsigned int connectorId) {
@@ -689,6 +815,11 @@ void setConnectorPluggedInput(std::function<bool()> pluggedInput, unsigned int c
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        pluggedInput = traceRecorder->traceBoolInput(pluggedInput, "ConnectorPlugged", connectorId);
+    }
+#endif
 #if MO_ENABLE_V201
     if (context->getVersion().major == 2) {
         if (auto availabilityService = context->getModel().getAvailabilityService()) {
@@ -725,6 +856,12 @@ void setEnergyMeterInput(std::function<int()> energyInput, unsigned int connecto
     }
     #endif
 
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        energyInput = traceRecorder->traceIntInput(energyInput, "EnergyMeter", connectorId);
+    }
+#endif
+
     SampledValueProperties meterProperties;
     meterProperties.setMeasurand("Energy.Active.Import.Register");
     meterProperties.setUnit("Wh");
@@ -749,6 +886,12 @@ void setPowerMeterInput(std::function<float()> powerInput, unsigned int connecto
     }
     #endif
 
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        powerInput = traceRecorder->traceFloatInput(powerInput, "PowerMeter", connectorId);
+    }
+#endif
+
     SampledValueProperties meterProperties;
     meterProperties.setMeasurand("Power.Active.Import");
     meterProperties.setUnit("W");
@@ -827,7 +970,7 @@ void setSmartChargingOutput(std::function<void(float,float,int)> chargingLimitOu
     auto& model = context->getModel();
     if (!model.getSmartChargingService() && chargingLimitOutput) {
         model.setSmartChargingService(std::unique_ptr<SmartChargingService>(
-            new SmartChargingService(*context, filesystem, MO_NUMCONNECTORS)));
+            new ("v16.SmartCharging.SmartChargingService") SmartChargingService(*context, filesystem, MO_NUMCONNECTORS)));
     }
 
     if (auto scService = context->getModel().getSmartChargingService()) {
@@ -845,6 +988,11 @@ void setEvReadyInput(std::function<bool()> evReadyInput, unsigned int connectorI
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        evReadyInput = traceRecorder->traceBoolInput(evReadyInput, "EvReady", connectorId);
+    }
+#endif
 #if MO_ENABLE_V201
     if (context->getVersion().major == 2) {
         if (auto txService = context->getModel().getTransactionService()) {
@@ -867,6 +1015,11 @@ void setEvseReadyInput(std::function<bool()> evseReadyInput, unsigned int connec
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        evseReadyInput = traceRecorder->traceBoolInput(evseReadyInput, "EvseReady", connectorId);
+    }
+#endif
 #if MO_ENABLE_V201
     if (context->getVersion().major == 2) {
         if (auto txService = context->getModel().getTransactionService()) {
@@ -890,6 +1043,11 @@ void addErrorCodeInput(std::function<const char*()> errorCodeInput, unsigned int
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        errorCodeInput = traceRecorder->traceStringInput(errorCodeInput, "ErrorCode", connectorId);
+    }
+#endif
     auto connector = context->getModel().getConnector(connectorId);
     if (!connector) {
         MO_DBG_ERR("could not find connector");
@@ -927,6 +1085,12 @@ void addMeterValueInput(std::function<float ()> valueInput, const char *measuran
         MO_DBG_WARN("measurand unspecified; assume %s", measurand);
     }
 
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        valueInput = traceRecorder->traceFloatInput(valueInput, "MeterValue", connectorId, measurand, unit, location, phase);
+    }
+#endif
+
     #if MO_ENABLE_V201
     if (context->getVersion().major == 2) {
         auto& model = context->getModel();
@@ -995,6 +1159,11 @@ void setOccupiedInput(std::function<bool()> occupied, unsigned int connectorId)
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        occupied = traceRecorder->traceBoolInput(occupied, "Occupied", connectorId);
+    }
+#endif
 #if MO_ENABLE_V201
     if (context->getVersion().major == 2) {
         if (auto availabilityService = context->getModel().getAvailabilityService()) {
@@ -1017,6 +1186,11 @@ void setStartTxReadyInput(std::function<bool()> startTxReady, unsigned int conne
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        startTxReady = traceRecorder->traceBoolInput(startTxReady, "StartTxReady", connectorId);
+    }
+#endif
     auto connector = context->getModel().getConnector(connectorId);
     if (!connector) {
         MO_DBG_ERR("could not find connector");
@@ -1030,6 +1204,11 @@ void setStopTxReadyInput(std::function<bool()> stopTxReady, unsigned int connect
         MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
         return;
     }
+#if MO_ENABLE_TRACE
+    if (traceRecorder) {
+        stopTxReady = traceRecorder->traceBoolInput(stopTxReady, "StopTxReady", connectorId);
+    }
+#endif
     auto connector = context->getModel().getConnector(connectorId);
     if (!connector) {
         MO_DBG_ERR("could not find connector");
@@ -1158,7 +1337,7 @@ DiagnosticsService *getDiagnosticsService() {
     auto& model = context->getModel();
     if (!model.getDiagnosticsService()) {
         model.setDiagnosticsService(std::unique_ptr<DiagnosticsService>(
-            new DiagnosticsService(*context)));
+            new ("v16.Diagnostics.DiagnosticsService") DiagnosticsService(*context)));
     }
 
     return model.getDiagnosticsService();
@@ -4,6 +4,7 @@
 
 #include <MicroOcpp/Core/ConfigurationKeyValue.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/EnumTable.h>
 #include <MicroOcpp/Debug.h>
 
 #include <string.h>
@@ -251,32 +252,24 @@ std::unique_ptr<Configuration> makeConfiguration(TConfig type, const char *key)
     return res;
 }
 
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<3,4> tConfigTable {
+    {"int", "bool", "string"},
+    {0, 1, 0xFF, 2},
+    0U};
+static_assert(tConfigTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
 bool deserializeTConfig(const char *serialized, TConfig& out) {
-    if (!strcmp(serialized, "int")) {
-        out = TConfig::Int;
-        return true;
-    } else if (!strcmp(serialized, "bool")) {
-        out = TConfig::Bool;
-        return true;
-    } else if (!strcmp(serialized, "string")) {
-        out = TConfig::String;
-        return true;
-    } else {
+    if (!tConfigTable.decode(serialized, out)) {
         MO_DBG_WARN("config type error");
         return false;
     }
+    return true;
 }
 
 const char *serializeTConfig(TConfig type) {
-    switch (type) {
-        case TConfig::Int:
-            return "int";
-        case TConfig::Bool:
-            return "bool";
-        case TConfig::String:
-            return "string";
-    }
-    return "_Undefined";
+    const char *name = tConfigTable.encode((size_t)type);
+    return name ? name : "_Undefined";
 }
 
 } //end namespace MicroOcpp
@@ -7,14 +7,36 @@
 
 using namespace MicroOcpp;
 
-LoopbackConnection::LoopbackConnection() : MemoryManaged("WebSocketLoopback") { }
-
-void LoopbackConnection::loop() { }
+LoopbackConnection::LoopbackConnection() : MemoryManaged("WebSocketLoopback"), delayed(makeVector<DelayedMessage>(getMemoryTag())) { }
+
+void LoopbackConnection::loop() {
+    //deliver in order. The receiveTXT callback may send further messages, so don't hold iterators
+    while (!delayed.empty() && mocpp_tick_ms() - delayed.front().t_sent >= latency) {
+        auto msg = std::move(delayed.front().msg);
+        delayed.erase(delayed.begin());
+        if (receiveTXT) {
+            lastRecv = mocpp_tick_ms();
+            receiveTXT(msg.c_str(), msg.length());
+        }
+    }
+}
 
 bool LoopbackConnection::sendTXT(const char *msg, size_t length) {
     if (!connected || !online) {
         return false;
     }
+    if (lossPercent > 0) {
+        lossRand = lossRand * 1103515245U + 12345U;
+        if ((lossRand >> 16) % 100 < lossPercent) {
+            return true; //lost on the way
+        }
+    }
+    if (latency > 0) {
+        auto delayedMsg = makeString(getMemoryTag());
+        delayedMsg.assign(msg, length);
+        delayed.push_back(DelayedMessage {std::move(delayedMsg), mocpp_tick_ms()});
+        return true;
+    }
     if (receiveTXT) {
         lastRecv = mocpp_tick_ms();
         return receiveTXT(msg, length);
@@ -49,6 +71,14 @@ void LoopbackConnection::setConnected(bool connected) {
     this->connected = connected;
 }
 
+void LoopbackConnection::setLatency(unsigned long latency) {
+    this->latency = latency;
+}
+
+void LoopbackConnection::setLoss(unsigned int lossPercent) {
+    this->lossPercent = lossPercent;
+}
+
 #ifndef MO_CUSTOM_WS
 
 using namespace MicroOcpp::EspWiFi;
@@ -81,6 +81,16 @@ private:
     bool connected = true;
     unsigned long lastRecv = 0;
     unsigned long lastConn = 0;
+
+    //for simulating weak connections
+    unsigned long latency = 0;
+    unsigned int lossPercent = 0;
+    uint32_t lossRand = 1;
+    struct DelayedMessage {
+        String msg;
+        unsigned long t_sent;
+    };
+    Vector<DelayedMessage> delayed;
 public:
     LoopbackConnection();
 
@@ -94,6 +104,9 @@ public:
     bool isOnline() {return online;}
     void setConnected(bool connected); //"connected": connection has been established, but messages may not go through (e.g. weak connection)
     bool isConnected() override {return connected;}
+
+    void setLatency(unsigned long latency); //one-way delay in ms. Delayed messages are delivered in loop()
+    void setLoss(unsigned int lossPercent); //drop this share of the sent messages. Deterministic sequence
 };
 
 } //end namespace MicroOcpp
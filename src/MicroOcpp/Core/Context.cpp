@@ -6,6 +6,7 @@
 #include <MicroOcpp/Core/Request.h>
 #include <MicroOcpp/Core/Connection.h>
 #include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Platform.h>
 
 #include <MicroOcpp/Debug.h>
 
@@ -17,13 +18,24 @@ Context::Context(Connection& connection, std::shared_ptr<FilesystemAdapter> file
 }
 
 Context::~Context() {
-
+    taskQueue.flush(); //complete pending work like flash writes before the services are destroyed
 }
 
 void Context::loop() {
+    auto t_start = mocpp_tick_ms();
+
     connection.loop();
     reqQueue.loop();
     model.loop();
+    taskQueue.loop(t_start, MO_LOOP_BUDGET_MS);
+
+    auto loopTime = mocpp_tick_ms() - t_start;
+    if (loopTime > maxLoopTime) {
+        maxLoopTime = loopTime;
+        if (loopTime > MO_LOOP_BUDGET_MS) {
+            MO_DBG_DEBUG("new worst-case loop time: %lu ms (budget %lu ms)", loopTime, (unsigned long)MO_LOOP_BUDGET_MS);
+        }
+    }
 }
 
 void Context::initiateRequest(std::unique_ptr<Request> op) {
@@ -54,6 +66,10 @@ RequestQueue& Context::getRequestQueue() {
     return reqQueue;
 }
 
+TaskQueue& Context::getTaskQueue() {
+    return taskQueue;
+}
+
 void Context::setFtpClient(std::unique_ptr<FtpClient> ftpClient) {
     this->ftpClient = std::move(ftpClient);
 }
@@ -9,6 +9,7 @@
 
 #include <MicroOcpp/Core/OperationRegistry.h>
 #include <MicroOcpp/Core/RequestQueue.h>
+#include <MicroOcpp/Core/TaskQueue.h>
 #include <MicroOcpp/Core/Memory.h>
 #include <MicroOcpp/Core/Ftp.h>
 #include <MicroOcpp/Model/Model.h>
@@ -25,9 +26,12 @@ private:
     OperationRegistry operationRegistry;
     Model model;
     RequestQueue reqQueue;
+    TaskQueue taskQueue;
 
     std::unique_ptr<FtpClient> ftpClient;
 
+    unsigned long maxLoopTime = 0; //worst-case duration of loop() in ms
+
 public:
     Context(Connection& connection, std::shared_ptr<FilesystemAdapter> filesystem, uint16_t bootNr, ProtocolVersion version);
     ~Context();
@@ -46,6 +50,11 @@ public:
 
     RequestQueue& getRequestQueue();
 
+    TaskQueue& getTaskQueue();
+
+    unsigned long getMaxLoopTime() {return maxLoopTime;}
+    void resetMaxLoopTime() {maxLoopTime = 0;}
+
     void setFtpClient(std::unique_ptr<FtpClient> ftpClient);
     FtpClient *getFtpClient();
 };
@@ -0,0 +1,84 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_ENUMTABLE_H
+#define MO_ENUMTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+namespace MicroOcpp {
+
+/*
+ * Seeded FNV-1a hash with the high bits folded into the low bits. Same result in the constexpr and the
+ * runtime version
+ */
+constexpr uint32_t enumHashStep(const char *s, uint32_t h) {
+    return *s ? enumHashStep(s + 1, (uint32_t)((h ^ (uint32_t)(unsigned char)*s) * 16777619UL)) : h;
+}
+
+constexpr uint32_t enumHash(const char *s, uint32_t seed) {
+    return enumHashStep(s, seed) ^ (enumHashStep(s, seed) >> 16);
+}
+
+inline uint32_t enumHashRuntime(const char *s, uint32_t seed) {
+    uint32_t h = seed;
+    for (; *s; s++) {
+        h = (uint32_t)((h ^ (uint32_t)(unsigned char)*s) * 16777619UL);
+    }
+    return h ^ (h >> 16);
+}
+
+/*
+ * String table of an OCPP enum. Encoding is an array lookup by enum value. Decoding hashes the input into
+ * the slot table which is collision-free for the names of the enum (perfect hash), so it takes one hash
+ * pass and one strcmp, regardless of the number of enum values.
+ *
+ * The tables are generated with tests/benchmarks/scripts/gen_enum_tables.py. Check them with
+ * static_assert(table.isPerfect()), so a table which doesn't match the names fails to compile
+ */
+template<size_t N, size_t M>
+struct EnumTable {
+    const char *names [N]; //index is the enum value; nullptr if the value has no string representation
+    uint8_t slots [M]; //enum value at hash & (M - 1) or 0xFF if empty. M is a power of 2
+    uint32_t seed;
+
+    //returns the name of the enum value or nullptr if undefined
+    const char *encode(size_t value) const {
+        return value < N ? names[value] : nullptr;
+    }
+
+    //returns the enum value or N if s is not a name of this enum
+    size_t lookup(const char *s) const {
+        if (!s) {
+            return N;
+        }
+        size_t value = slots[enumHashRuntime(s, seed) & (M - 1)];
+        if (value < N && names[value] && !strcmp(names[value], s)) {
+            return value;
+        }
+        return N;
+    }
+
+    //writes the enum value into out. Returns false and leaves out unchanged if s is not a name of this enum
+    template<class T>
+    bool decode(const char *s, T& out) const {
+        size_t value = lookup(s);
+        if (value >= N) {
+            return false;
+        }
+        out = (T)value;
+        return true;
+    }
+
+    constexpr bool isPerfect(size_t i = 0) const {
+        return (M & (M - 1)) == 0 &&
+                (i >= N || ((!names[i] || slots[enumHash(names[i], seed) & (M - 1)] == i) && isPerfect(i + 1)));
+    }
+};
+
+} //end namespace MicroOcpp
+
+#endif
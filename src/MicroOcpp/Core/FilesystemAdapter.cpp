@@ -15,6 +15,7 @@
  *     - Arduino SPIFFS
  *     - ESP-IDF SPIFFS
  *     - POSIX-like API (tested on Ubuntu 20.04)
+ *     - In-memory filesystem for host tests
  * Plus a filesystem index decorator working with any of the above
  * 
  * You can add support for other file systems by passing a custom adapter to mocpp_initialize(...)
@@ -28,7 +29,7 @@ namespace MicroOcpp {
 
 class FilesystemAdapterIndex;
 
-class IndexedFileAdapter : public FileAdapter, public MemoryManaged {
+class IndexedFileAdapter : public FileAdapter, public TransientMemoryManaged {
 private:
     FilesystemAdapterIndex& index;
     char fn [MO_MAX_PATH_SIZE];
@@ -36,8 +37,8 @@ private:
 
     size_t written = 0;
 public:
-    IndexedFileAdapter(FilesystemAdapterIndex& index, const char *fn, std::unique_ptr<FileAdapter> file)
-            : MemoryManaged("FilesystemIndex"), index(index), file(std::move(file)) {
+    IndexedFileAdapter(FilesystemAdapterIndex& index, const char *fn, std::unique_ptr<FileAdapter> file, size_t written = 0)
+            : TransientMemoryManaged("FilesystemIndex"), index(index), file(std::move(file)), written(written) {
         snprintf(this->fn, sizeof(this->fn), "%s", fn);
     }
 
@@ -122,7 +123,7 @@ public:
     std::unique_ptr<FileAdapter> open(const char *path, const char *mode) {
         if (!strcmp(mode, "r")) {
             return filesystem->open(path, "r");
-        } else if (!strcmp(mode, "w")) {
+        } else if (!strcmp(mode, "w") || !strcmp(mode, "a")) {
 
             if (strlen(path) < sizeof(MO_FILENAME_PREFIX) - 1) {
                 MO_DBG_ERR("invalid fn");
@@ -131,7 +132,7 @@ public:
 
             const char *fn = path + sizeof(MO_FILENAME_PREFIX) - 1;
 
-            auto file = filesystem->open(path, "w");
+            auto file = filesystem->open(path, mode);
             if (!file) {
                 return nullptr;
             }
@@ -147,11 +148,13 @@ public:
                 return nullptr;
             }
 
-            entry->size = 0; //write always empties the file
+            if (*mode == 'w') {
+                entry->size = 0; //write always empties the file
+            }
 
-            return std::unique_ptr<IndexedFileAdapter>(new IndexedFileAdapter(*this, entry->fname.c_str(), std::move(file)));
+            return std::unique_ptr<IndexedFileAdapter>(new IndexedFileAdapter(*this, entry->fname.c_str(), std::move(file), entry->size));
         } else {
-            MO_DBG_ERR("only support r or w");
+            MO_DBG_ERR("only support r, w or a");
             return nullptr;
         }
     }
@@ -265,10 +268,10 @@ std::shared_ptr<FilesystemAdapter> decorateIndex(std::shared_ptr<FilesystemAdapt
 
 namespace MicroOcpp {
 
-class ArduinoFileAdapter : public FileAdapter, public MemoryManaged {
+class ArduinoFileAdapter : public FileAdapter, public TransientMemoryManaged {
     File file;
 public:
-    ArduinoFileAdapter(File&& file) : MemoryManaged("Filesystem"), file(file) {}
+    ArduinoFileAdapter(File&& file) : TransientMemoryManaged("Filesystem"), file(file) {}
 
     ~ArduinoFileAdapter() {
         if (file) {
@@ -483,10 +486,10 @@ std::shared_ptr<FilesystemAdapter> makeDefaultFilesystemAdapter(FilesystemOpt co
 
 namespace MicroOcpp {
 
-class EspIdfFileAdapter : public FileAdapter, public MemoryManaged {
+class EspIdfFileAdapter : public FileAdapter, public TransientMemoryManaged {
     FILE *file {nullptr};
 public:
-    EspIdfFileAdapter(FILE *file) : MemoryManaged("Filesystem"), file(file) {}
+    EspIdfFileAdapter(FILE *file) : TransientMemoryManaged("Filesystem"), file(file) {}
 
     ~EspIdfFileAdapter() {
         fclose(file);
@@ -668,10 +671,10 @@ std::shared_ptr<FilesystemAdapter> makeDefaultFilesystemAdapter(FilesystemOpt co
 
 namespace MicroOcpp {
 
-class PosixFileAdapter : public FileAdapter, public MemoryManaged {
+class PosixFileAdapter : public FileAdapter, public TransientMemoryManaged {
     FILE *file {nullptr};
 public:
-    PosixFileAdapter(FILE *file) : MemoryManaged("Filesystem"), file(file) {}
+    PosixFileAdapter(FILE *file) : TransientMemoryManaged("Filesystem"), file(file) {}
 
     ~PosixFileAdapter() {
         fclose(file);
@@ -787,6 +790,46 @@ std::shared_ptr<FilesystemAdapter> makeDefaultFilesystemAdapter(FilesystemOpt co
 
 } //end namespace MicroOcpp
 
+#elif MO_USE_FILEAPI == MEMORY_FILEAPI
+
+#include <MicroOcpp/Core/FilesystemMemory.h>
+
+namespace MicroOcpp {
+
+#if MO_ENABLE_FILE_INDEX
+std::weak_ptr<FilesystemAdapter> filesystemCache;
+
+void resetFilesystemCache(void*) {
+    filesystemCache.reset();
+}
+#endif // MO_ENABLE_FILE_INDEX
+
+std::shared_ptr<FilesystemAdapter> makeDefaultFilesystemAdapter(FilesystemOpt config) {
+
+    if (!config.accessAllowed()) {
+        MO_DBG_DEBUG("Access to FS not allowed by config");
+        return nullptr;
+    }
+
+    //the flash content survives mocpp_deinitialize() like on a real device
+    static std::shared_ptr<MemoryFilesystemAdapter> flash = makeMemoryFilesystemAdapter();
+
+#if MO_ENABLE_FILE_INDEX
+    if (auto cached = filesystemCache.lock()) {
+        return cached;
+    }
+
+    auto fs = decorateIndex(flash, resetFilesystemCache);
+
+    filesystemCache = fs;
+    return fs;
+#else
+    return flash;
+#endif // MO_ENABLE_FILE_INDEX
+}
+
+} //end namespace MicroOcpp
+
 #else //filesystem disabled
 
 namespace MicroOcpp {
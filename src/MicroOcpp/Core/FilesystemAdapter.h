@@ -16,6 +16,7 @@
 #define ARDUINO_SPIFFS   2
 #define ESPIDF_SPIFFS    3
 #define POSIX_FILEAPI    4
+#define MEMORY_FILEAPI   5 //in-memory with a flash cost model, see FilesystemMemory.h
 
 // choose FileAPI if not given by build flag; assume usage with Arduino if no build flags are present
 #ifndef MO_USE_FILEAPI
@@ -44,7 +45,7 @@
 
 // set default max path size parameters
 #ifndef MO_MAX_PATH_SIZE
-#if MO_USE_FILEAPI == POSIX_FILEAPI
+#if MO_USE_FILEAPI == POSIX_FILEAPI || MO_USE_FILEAPI == MEMORY_FILEAPI
 #define MO_MAX_PATH_SIZE 128
 #else
 #define MO_MAX_PATH_SIZE 30
@@ -82,6 +83,7 @@ public:
  *     - Arduino SPIFFS
  *     - ESP-IDF SPIFFS
  *     - POSIX-like API (tested on Ubuntu 20.04)
+ *     - In-memory filesystem for host tests. The content persists until the end of the process
  * 
  * You can add support for other file systems by passing a custom adapter to mocpp_initialize(...)
  * 
@@ -0,0 +1,329 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+
+namespace MicroOcpp {
+
+FlashModel FlashModel::littlefs() {
+    return FlashModel();
+}
+
+FlashModel FlashModel::spiffs() {
+    FlashModel model;
+    model.progSize = 256; //SPIFFS programs whole logical pages
+    model.commitSize = 256; //object index header page, written again with each change of the file
+    model.fileMetadataSize = 0;
+    model.inlineMax = 0;
+    model.copyOnWrite = false;
+    return model;
+}
+
+void FlashStats::add(const FlashStats& other) {
+    bytesWritten += other.bytesWritten;
+    bytesProgrammed += other.bytesProgrammed;
+    bytesRead += other.bytesRead;
+    pagesProgrammed += other.pagesProgrammed;
+    blocksErased += other.blocksErased;
+    fileWrites += other.fileWrites;
+    fileReads += other.fileReads;
+    simulatedUs += other.simulatedUs;
+}
+
+class MemoryFileAdapter : public FileAdapter, public TransientMemoryManaged {
+private:
+    MemoryFilesystemAdapter& filesystem;
+    std::string path;
+    std::shared_ptr<std::vector<char>> content;
+
+    size_t pos = 0;
+    size_t sizeBefore;
+    bool writing, append;
+    size_t written = 0;
+    size_t nRead = 0;
+public:
+    MemoryFileAdapter(MemoryFilesystemAdapter& filesystem, const char *path, std::shared_ptr<std::vector<char>> content, size_t sizeBefore, bool writing, bool append)
+            : TransientMemoryManaged("Filesystem"), filesystem(filesystem), path(path), content(std::move(content)), sizeBefore(sizeBefore), writing(writing), append(append) {
+        if (append) {
+            pos = this->content->size();
+        }
+    }
+
+    ~MemoryFileAdapter() {
+        filesystem.onClose(path.c_str(), content, sizeBefore, writing, append, written, nRead);
+    }
+
+    size_t read(char *buf, size_t len) override {
+        if (pos >= content->size()) {
+            return 0;
+        }
+        if (len > content->size() - pos) {
+            len = content->size() - pos;
+        }
+        memcpy(buf, content->data() + pos, len);
+        pos += len;
+        nRead += len;
+        return len;
+    }
+
+    size_t write(const char *buf, size_t len) override {
+        if (!writing) {
+            return 0;
+        }
+        if (append) {
+            pos = content->size();
+        }
+        if (pos + len > content->size()) {
+            if (!filesystem.reserve(path.c_str(), content, content->size(), pos + len)) {
+                MO_DBG_DEBUG("flash full");
+                return 0;
+            }
+            content->resize(pos + len);
+        }
+        memcpy(content->data() + pos, buf, len);
+        pos += len;
+        written += len;
+        return len;
+    }
+
+    size_t seek(size_t offset) override {
+        pos = offset;
+        return 0;
+    }
+
+    int read() override {
+        if (pos >= content->size()) {
+            return -1;
+        }
+        nRead++;
+        return (unsigned char) (*content)[pos++];
+    }
+};
+
+MemoryFilesystemAdapter::MemoryFilesystemAdapter(const FlashModel& model) : TransientMemoryManaged("Filesystem"), model(model) {
+
+}
+
+size_t MemoryFilesystemAdapter::getFootprint(size_t fileSize) {
+    if (model.copyOnWrite) {
+        if (fileSize <= model.inlineMax) {
+            return 0; //stored in the metadata block
+        }
+        return (fileSize + model.blockSize - 1) / model.blockSize * model.blockSize;
+    } else {
+        return (fileSize + model.pageSize - 1) / model.pageSize * model.pageSize + model.pageSize; //plus the index header page
+    }
+}
+
+void MemoryFilesystemAdapter::program(FlashStats& delta, size_t len) {
+    if (len == 0) {
+        return;
+    }
+    size_t bytes = (len + model.progSize - 1) / model.progSize * model.progSize;
+    size_t pages = (bytes + model.pageSize - 1) / model.pageSize;
+    delta.bytesProgrammed += bytes;
+    delta.pagesProgrammed += pages;
+    delta.simulatedUs += (unsigned long long) pages * model.pageProgramUs;
+
+    if (!model.copyOnWrite) {
+        //garbage collection: each programmed page is erased again eventually
+        gcPages += pages;
+        size_t pagesPerBlock = model.blockSize / model.pageSize;
+        while (gcPages >= pagesPerBlock) {
+            erase(delta, 1);
+            gcPages -= pagesPerBlock;
+        }
+    }
+}
+
+void MemoryFilesystemAdapter::erase(FlashStats& delta, size_t nBlocks) {
+    delta.blocksErased += nBlocks;
+    delta.simulatedUs += (unsigned long long) nBlocks * model.blockEraseUs;
+}
+
+void MemoryFilesystemAdapter::commitMetadata(FlashStats& delta, size_t len) {
+    delta.fileWrites++;
+
+    if (model.copyOnWrite) {
+        size_t bytes = (len + model.progSize - 1) / model.progSize * model.progSize;
+        if (metadataLog + bytes > model.blockSize) {
+            //compaction: erase the other block of the metadata pair and write the live metadata into it
+            size_t live = files.size() * model.fileMetadataSize;
+            for (auto& file : files) {
+                if (file.second->size() <= model.inlineMax) {
+                    live += file.second->size();
+                }
+            }
+            erase(delta, 1);
+            program(delta, live);
+            metadataLog = (live + model.progSize - 1) / model.progSize * model.progSize;
+        }
+        metadataLog += bytes;
+    }
+
+    program(delta, len);
+}
+
+bool MemoryFilesystemAdapter::isCurrent(const char *path, const std::shared_ptr<std::vector<char>>& content) {
+    auto file = files.find(path);
+    return file != files.end() && file->second == content;
+}
+
+bool MemoryFilesystemAdapter::reserve(const char *path, const std::shared_ptr<std::vector<char>>& content, size_t sizeBefore, size_t sizeAfter) {
+    if (!isCurrent(path, content)) {
+        return true; //file has been removed or replaced in the meantime. Its content is discarded on close
+    }
+
+    size_t footprintBefore = getFootprint(sizeBefore);
+    size_t footprintAfter = getFootprint(sizeAfter);
+    if (footprintAfter > footprintBefore && used + (footprintAfter - footprintBefore) > model.capacity) {
+        return false;
+    }
+    used = used - footprintBefore + footprintAfter;
+    return true;
+}
+
+void MemoryFilesystemAdapter::onClose(const char *path, const std::shared_ptr<std::vector<char>>& content, size_t sizeBefore, bool writing, bool append, size_t written, size_t nRead) {
+    FlashStats delta;
+
+    if (nRead > 0) {
+        delta.bytesRead = nRead;
+        delta.fileReads = 1;
+        delta.simulatedUs += (unsigned long long) ((nRead + model.pageSize - 1) / model.pageSize) * model.pageReadUs;
+    }
+
+    if (writing && isCurrent(path, content)) {
+        delta.bytesWritten = written;
+
+        size_t sizeAfter = content->size();
+
+        if (model.copyOnWrite && sizeAfter <= model.inlineMax) {
+            //inline file: the content is part of the metadata commit
+            commitMetadata(delta, model.commitSize + sizeAfter);
+        } else if (model.copyOnWrite) {
+            size_t data = sizeAfter;
+            if (append && sizeBefore > model.inlineMax) {
+                data = (sizeBefore % model.blockSize) + (sizeAfter - sizeBefore); //copy the partially filled last block
+            }
+            erase(delta, (data + model.blockSize - 1) / model.blockSize);
+            program(delta, data);
+            commitMetadata(delta, model.commitSize);
+        } else {
+            size_t data = sizeAfter;
+            if (append) {
+                data = (sizeBefore % model.pageSize) + (sizeAfter - sizeBefore); //rewrite the partially filled last page
+            }
+            program(delta, data);
+            commitMetadata(delta, model.commitSize);
+        }
+    }
+
+    stats.add(delta);
+    getFileStats(path).add(delta);
+}
+
+FlashStats& MemoryFilesystemAdapter::getFileStats(const char *path) {
+    const char *fname = path;
+    if (!strncmp(path, MO_FILENAME_PREFIX, sizeof(MO_FILENAME_PREFIX) - 1)) {
+        fname += sizeof(MO_FILENAME_PREFIX) - 1;
+    }
+    return fileStats[fname];
+}
+
+int MemoryFilesystemAdapter::stat(const char *path, size_t *size) {
+    auto file = files.find(path);
+    if (file == files.end()) {
+        return -1;
+    }
+    *size = file->second->size();
+    return 0;
+}
+
+std::unique_ptr<FileAdapter> MemoryFilesystemAdapter::open(const char *path, const char *mode) {
+    bool writing = strchr(mode, 'w') || strchr(mode, 'a') || strchr(mode, '+');
+    bool append = strchr(mode, 'a');
+
+    auto file = files.find(path);
+
+    if (*mode == 'r') {
+        if (file == files.end()) {
+            MO_DBG_DEBUG("Failed to open file path %s", path);
+            return nullptr;
+        }
+        return std::unique_ptr<FileAdapter>(new MemoryFileAdapter(*this, path, file->second, file->second->size(), writing, false));
+    }
+
+    size_t sizeBefore = 0;
+    if (file != files.end()) {
+        sizeBefore = file->second->size();
+        if (*mode == 'w') {
+            //truncate. Open readers keep the previous content
+            used -= getFootprint(sizeBefore);
+            file->second = std::make_shared<std::vector<char>>();
+            used += getFootprint(0);
+        }
+    } else {
+        if (used + getFootprint(0) > model.capacity) {
+            MO_DBG_DEBUG("flash full: %s", path);
+            return nullptr;
+        }
+        file = files.emplace(path, std::make_shared<std::vector<char>>()).first;
+        used += getFootprint(0);
+    }
+
+    return std::unique_ptr<FileAdapter>(new MemoryFileAdapter(*this, path, file->second, sizeBefore, writing, append));
+}
+
+bool MemoryFilesystemAdapter::remove(const char *path) {
+    auto file = files.find(path);
+    if (file == files.end()) {
+        return false;
+    }
+    used -= getFootprint(file->second->size());
+    files.erase(file);
+
+    FlashStats delta;
+    commitMetadata(delta, model.commitSize);
+    stats.add(delta);
+    getFileStats(path).add(delta);
+    return true;
+}
+
+int MemoryFilesystemAdapter::ftw_root(std::function<int(const char *fpath)> fn) {
+    //collect the names first, the callback may remove files
+    std::vector<std::string> fnames;
+    for (auto& file : files) {
+        const char *path = file.first.c_str();
+        if (strncmp(path, MO_FILENAME_PREFIX, sizeof(MO_FILENAME_PREFIX) - 1)) {
+            continue;
+        }
+        const char *fname = path + sizeof(MO_FILENAME_PREFIX) - 1;
+        if (*fname == '\0' || strchr(fname, '/')) {
+            continue; //not in the root folder
+        }
+        fnames.emplace_back(fname);
+    }
+
+    for (auto& fname : fnames) {
+        auto err = fn(fname.c_str());
+        if (err) {
+            return err;
+        }
+    }
+    return 0;
+}
+
+void MemoryFilesystemAdapter::resetStats() {
+    stats = FlashStats();
+    fileStats.clear();
+}
+
+std::shared_ptr<MemoryFilesystemAdapter> makeMemoryFilesystemAdapter(const FlashModel& model) {
+    return std::shared_ptr<MemoryFilesystemAdapter>(new MemoryFilesystemAdapter(model), std::default_delete<MemoryFilesystemAdapter>(), makeAllocator<MemoryFilesystemAdapter>("Filesystem"));
+}
+
+} //namespace MicroOcpp
@@ -0,0 +1,124 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_FILESYSTEMMEMORY_H
+#define MO_FILESYSTEMMEMORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <MicroOcpp/Core/Memory.h>
+
+/*
+ * In-memory filesystem with a cost model of a flash filesystem on NOR flash. It counts the bytes which
+ * the filesystem would program including its metadata, the erased blocks and the resulting flash time.
+ * This makes the write pattern of MO measurable on the host: the unit tests run on it (MO_USE_FILEAPI =
+ * MEMORY_FILEAPI) and benchmarks can compare the flash wear and latency of storage-related changes.
+ *
+ * The model is a first-order approximation of LittleFS and SPIFFS, not a simulation of their on-disk
+ * structures. The absolute figures depend on the filesystem configuration of the target, but the
+ * relations between two write patterns hold.
+ */
+
+namespace MicroOcpp {
+
+struct FlashModel {
+    size_t capacity = 0x100000; //bytes available for files
+    size_t blockSize = 4096; //erase block
+    size_t pageSize = 256; //program page of the NOR flash; each page program operation takes pageProgramUs
+    size_t progSize = 16; //smallest unit which the filesystem programs; writes are padded to it
+
+    unsigned long pageProgramUs = 400; //typical values of a SPI NOR flash like on the ESP32 modules
+    unsigned long blockEraseUs = 45000;
+    unsigned long pageReadUs = 25;
+
+    size_t commitSize = 64; //metadata which is programmed when a file is created, rewritten or removed
+    size_t fileMetadataSize = 48; //live metadata per file, programmed again when the metadata log is compacted
+    size_t inlineMax = 512; //files up to this size are stored in the metadata instead of own blocks. 0 = no inline files
+
+    /*
+     * true: copy-on-write like LittleFS. Each written data block is erased before programming and the
+     * metadata is appended to a log of one block which is compacted (erased and rewritten) when full.
+     * false: log-structured like SPIFFS. Data and metadata are appended in pages and the garbage
+     * collection erases one block for every blockSize / pageSize programmed pages
+     */
+    bool copyOnWrite = true;
+
+    static FlashModel littlefs(); //LittleFS on 4 KB blocks as configured by the ESP32 Arduino core
+    static FlashModel spiffs(); //SPIFFS with 256 B logical pages on 4 KB blocks
+};
+
+struct FlashStats {
+    size_t bytesWritten = 0; //passed to FileAdapter::write()
+    size_t bytesProgrammed = 0; //data and metadata which the filesystem programs into the flash
+    size_t bytesRead = 0;
+    size_t pagesProgrammed = 0; //page program operations
+    size_t blocksErased = 0;
+    size_t fileWrites = 0; //closed files which have been written, including removals
+    size_t fileReads = 0; //closed files which have been read
+    unsigned long long simulatedUs = 0; //flash time of the operations above
+
+    double getWriteAmplification() const {return bytesWritten ? (double)bytesProgrammed / (double)bytesWritten : 0.;}
+    double getSimulatedMs() const {return (double)simulatedUs / 1000.;}
+
+    void add(const FlashStats& other);
+};
+
+class MemoryFileAdapter;
+
+/*
+ * The file content is kept in plain std containers outside of the MO heap, so that the heap profiler
+ * only sees the memory of MO itself. Rewriting a file replaces its content, i.e. files which are still
+ * open for reading keep the previous version, like on a copy-on-write filesystem. The open files must be
+ * closed before the filesystem is destroyed
+ */
+class MemoryFilesystemAdapter : public FilesystemAdapter, public TransientMemoryManaged {
+private:
+    FlashModel model;
+
+    std::map<std::string, std::shared_ptr<std::vector<char>>> files; //key: path including MO_FILENAME_PREFIX
+
+    size_t used = 0; //occupied flash of all files
+    size_t metadataLog = 0; //fill level of the metadata block (copyOnWrite)
+    size_t gcPages = 0; //programmed pages which the garbage collection hasn't erased yet (log-structured)
+
+    FlashStats stats;
+    std::map<std::string, FlashStats> fileStats; //key: file name without MO_FILENAME_PREFIX
+
+    size_t getFootprint(size_t fileSize);
+    void program(FlashStats& delta, size_t len);
+    void erase(FlashStats& delta, size_t nBlocks);
+    void commitMetadata(FlashStats& delta, size_t len);
+    FlashStats& getFileStats(const char *path);
+    bool isCurrent(const char *path, const std::shared_ptr<std::vector<char>>& content); //false if the file has been removed or replaced
+
+    friend class MemoryFileAdapter;
+    bool reserve(const char *path, const std::shared_ptr<std::vector<char>>& content, size_t sizeBefore, size_t sizeAfter); //account the growth of a file. Returns false if the flash is full
+    void onClose(const char *path, const std::shared_ptr<std::vector<char>>& content, size_t sizeBefore, bool writing, bool append, size_t written, size_t nRead); //charge the costs of one open-close cycle
+public:
+    MemoryFilesystemAdapter(const FlashModel& model);
+
+    int stat(const char *path, size_t *size) override;
+    std::unique_ptr<FileAdapter> open(const char *path, const char *mode) override;
+    bool remove(const char *path) override;
+    int ftw_root(std::function<int(const char *fpath)> fn) override;
+
+    const FlashModel& getModel() {return model;}
+    const FlashStats& getStats() {return stats;}
+    const std::map<std::string, FlashStats>& getFileStats() {return fileStats;}
+    size_t getUsed() {return used;}
+
+    void resetStats(); //counters only; keeps the files
+};
+
+std::shared_ptr<MemoryFilesystemAdapter> makeMemoryFilesystemAdapter(const FlashModel& model = FlashModel::littlefs());
+
+} //namespace MicroOcpp
+
+#endif
@@ -0,0 +1,624 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/FilesystemSnapshot.h>
+#include <MicroOcpp/Core/Trace.h>
+#include <MicroOcpp/Platform.h>
+#include <MicroOcpp/Version.h>
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+#include <algorithm>
+
+/*
+ * Snapshot file format (all numbers are 32 bit little endian):
+ *
+ *     magic "MOSS" | format version | MO version hash | number of files
+ *     for each file: filename incl. terminating zero (max MO_MAX_PATH_SIZE) | size | content
+ *     CRC-32 of all preceding bytes
+ */
+
+#define SNAPSHOT_FORMAT 2
+#define SNAPSHOT_HEADER_SIZE 16
+#define SNAPSHOT_TRAILER_SIZE 4
+
+using namespace MicroOcpp;
+
+namespace MicroOcpp {
+
+class SnapshotImage : public MemoryManaged {
+public:
+    char *buf = nullptr;
+    size_t size = 0;
+
+    SnapshotImage() : MemoryManaged("FilesystemSnapshot") { }
+
+    ~SnapshotImage() {
+        MO_FREE(buf);
+    }
+};
+
+} //namespace MicroOcpp
+
+namespace {
+
+//CRC-32 (IEEE 802.3) with a nibble table
+const uint32_t crc32_table [16] = {
+    0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+    0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+};
+
+uint32_t crc32_update(uint32_t crc, const char *buf, size_t len) {
+    crc = ~crc;
+    for (size_t i = 0; i < len; i++) {
+        crc ^= (unsigned char)buf[i];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0F];
+        crc = (crc >> 4) ^ crc32_table[crc & 0x0F];
+    }
+    return ~crc;
+}
+
+uint32_t versionHash() {
+    //FNV-1a
+    const char *version = MO_VERSION;
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; version[i]; i++) {
+        h ^= (unsigned char)version[i];
+        h *= 16777619U;
+    }
+    return h;
+}
+
+void putU32(char *buf, uint32_t val) {
+    buf[0] = (char)(val & 0xFF);
+    buf[1] = (char)((val >> 8) & 0xFF);
+    buf[2] = (char)((val >> 16) & 0xFF);
+    buf[3] = (char)((val >> 24) & 0xFF);
+}
+
+uint32_t getU32(const char *buf) {
+    return (uint32_t)(unsigned char)buf[0] |
+           ((uint32_t)(unsigned char)buf[1] << 8) |
+           ((uint32_t)(unsigned char)buf[2] << 16) |
+           ((uint32_t)(unsigned char)buf[3] << 24);
+}
+
+const char *stripPrefix(const char *path) {
+    if (strlen(path) < sizeof(MO_FILENAME_PREFIX) - 1) {
+        MO_DBG_ERR("invalid fn");
+        return nullptr;
+    }
+    return path + sizeof(MO_FILENAME_PREFIX) - 1;
+}
+
+//the bootstats are rewritten at every boot. They're kept out of the snapshot and accessed directly, so that they don't invalidate it
+#define SNAPSHOT_DIRECT_FN "bootstats.jsn"
+
+bool isDirectFile(const char *path) {
+    return !strcmp(path, MO_FILENAME_PREFIX SNAPSHOT_DIRECT_FN);
+}
+
+//read-only file which is backed by the snapshot image
+class SnapshotFileAdapter : public FileAdapter, public TransientMemoryManaged {
+private:
+    std::shared_ptr<SnapshotImage> image; //keep image alive while file is open
+    const char *data;
+    size_t size;
+    size_t pos = 0;
+public:
+    SnapshotFileAdapter(std::shared_ptr<SnapshotImage> image, const char *data, size_t size)
+            : TransientMemoryManaged("FilesystemSnapshot"), image(std::move(image)), data(data), size(size) { }
+
+    size_t read(char *buf, size_t len) override {
+        if (len > size - pos) {
+            len = size - pos;
+        }
+        memcpy(buf, data + pos, len);
+        pos += len;
+        return len;
+    }
+
+    size_t write(const char *buf, size_t len) override {
+        MO_DBG_ERR("file opened in read mode");
+        return 0;
+    }
+
+    size_t seek(size_t offset) override {
+        pos = offset <= size ? offset : size;
+        return pos;
+    }
+
+    int read() override {
+        if (pos >= size) {
+            return -1;
+        }
+        return (unsigned char)data[pos++];
+    }
+};
+
+} //namespace
+
+FilesystemSnapshot::FilesystemSnapshot(std::shared_ptr<FilesystemAdapter> filesystem)
+        : MemoryManaged("FilesystemSnapshot"), filesystem(std::move(filesystem)), entries(makeVector<Entry>(getMemoryTag())), storeFnames(makeVector<String>(getMemoryTag())) {
+
+    auto ret = snprintf(snapshotPath, sizeof(snapshotPath), MO_FILENAME_PREFIX MO_SNAPSHOT_FN);
+    if (ret < 0 || (size_t)ret >= sizeof(snapshotPath)) {
+        MO_DBG_ERR("fn error: %i", ret);
+        snapshotPath[0] = '\0';
+    }
+}
+
+FilesystemSnapshot::Entry *FilesystemSnapshot::getEntry(const char *path) {
+    const char *fn = stripPrefix(path);
+    if (!fn) {
+        return nullptr;
+    }
+    for (auto& entry : entries) {
+        if (!entry.fname.compare(fn)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+bool FilesystemSnapshot::loadSnapshot() {
+    if (!*snapshotPath) {
+        return false;
+    }
+
+    size_t size = 0;
+    if (filesystem->stat(snapshotPath, &size) != 0) {
+        MO_DBG_DEBUG("no snapshot");
+        return false;
+    }
+
+    if (size < SNAPSHOT_HEADER_SIZE + SNAPSHOT_TRAILER_SIZE || size > MO_SNAPSHOT_MAXSIZE) {
+        MO_DBG_WARN("discard snapshot: invalid size %zu", size);
+        filesystem->remove(snapshotPath);
+        return false;
+    }
+
+    auto file = filesystem->open(snapshotPath, "r");
+    if (!file) {
+        MO_DBG_ERR("could not open snapshot");
+        return false;
+    }
+
+    auto loaded = std::allocate_shared<SnapshotImage>(makeAllocator<SnapshotImage>(getMemoryTag()));
+    loaded->buf = static_cast<char*>(MO_MALLOC(getMemoryTag(), size));
+    if (!loaded->buf) {
+        MO_DBG_ERR("OOM");
+        return false;
+    }
+    loaded->size = size;
+
+    size_t read = 0;
+    while (read < size) {
+        auto ret = file->read(loaded->buf + read, size - read);
+        if (ret == 0) {
+            break;
+        }
+        read += ret;
+    }
+    file.reset();
+
+    const char *buf = loaded->buf;
+    const char *end = buf + size - SNAPSHOT_TRAILER_SIZE;
+
+    bool valid = read == size &&
+            !memcmp(buf, "MOSS", 4) &&
+            getU32(buf + 4) == SNAPSHOT_FORMAT &&
+            getU32(buf + 8) == versionHash() &&
+            getU32(end) == crc32_update(0, buf, size - SNAPSHOT_TRAILER_SIZE);
+
+    size_t nfiles = valid ? getU32(buf + 12) : 0;
+    const char *p = buf + SNAPSHOT_HEADER_SIZE;
+
+    entries.clear();
+    entries.reserve(std::min(nfiles, size / 6)); //each entry takes at least 6 bytes
+    for (size_t i = 0; valid && i < nfiles; i++) {
+        size_t fnLen = strnlen(p, std::min((size_t)(end - p), (size_t)MO_MAX_PATH_SIZE));
+        if (fnLen == 0 || fnLen >= MO_MAX_PATH_SIZE || (size_t)(end - p) < fnLen + 1 + 4) {
+            valid = false;
+            break;
+        }
+        const char *fname = p;
+        p += fnLen + 1;
+        size_t fsize = getU32(p);
+        p += 4;
+        if ((size_t)(end - p) < fsize) {
+            valid = false;
+            break;
+        }
+        entries.emplace_back(fname, p, fsize);
+        p += fsize;
+    }
+
+    if (!valid || p != end) {
+        MO_DBG_WARN("discard snapshot: stale or corrupt. Load files individually");
+        entries.clear();
+        filesystem->remove(snapshotPath);
+        return false;
+    }
+
+    image = std::move(loaded);
+    snapshotValid = true;
+
+    MO_DBG_DEBUG("loaded snapshot: %zu files, %zuB", entries.size(), size);
+    return true;
+}
+
+bool FilesystemSnapshot::storeSnapshot() {
+    if (snapshotValid) {
+        return true;
+    }
+
+    if (!storeFile && !beginStore()) {
+        return false;
+    }
+
+    while (storeStep() == TaskStatus::Pending);
+
+    return snapshotValid;
+}
+
+bool FilesystemSnapshot::beginStore() {
+    if (snapshotValid || storeFile) {
+        return true;
+    }
+    if (!*snapshotPath) {
+        return false;
+    }
+
+    storeFailed = true; //reset on success or the next file modification
+
+    storeFnames.clear();
+    storeTotal = SNAPSHOT_HEADER_SIZE + SNAPSHOT_TRAILER_SIZE;
+
+    auto ret = filesystem->ftw_root([this] (const char *fname) -> int {
+        if (!strcmp(fname, MO_SNAPSHOT_FN)) {
+            return 0; //skip snapshot itself
+        }
+        if (!strncmp(fname, MO_TRACE_FN_PREFIX, sizeof(MO_TRACE_FN_PREFIX) - 1)) {
+            return 0; //skip traces, they are written continuously and aren't loaded at boot
+        }
+        if (!strcmp(fname, SNAPSHOT_DIRECT_FN)) {
+            return 0;
+        }
+        char path [MO_MAX_PATH_SIZE];
+        auto ret = snprintf(path, sizeof(path), MO_FILENAME_PREFIX "%s", fname);
+        if (ret < 0 || (size_t)ret >= sizeof(path)) {
+            MO_DBG_ERR("fn error: %i", ret);
+            return -1;
+        }
+        size_t size;
+        if (filesystem->stat(path, &size) != 0) {
+            MO_DBG_ERR("unexpected entry: %s", fname);
+            return -1;
+        }
+        storeTotal += strlen(fname) + 1 + 4 + size;
+        storeFnames.emplace_back(makeString(getMemoryTag(), fname));
+        return 0;
+    });
+
+    if (ret != 0) {
+        MO_DBG_ERR("ftw_root: %i", ret);
+        storeFnames.clear();
+        return false;
+    }
+
+    if (storeTotal > MO_SNAPSHOT_MAXSIZE) {
+        MO_DBG_WARN("files exceed MO_SNAPSHOT_MAXSIZE (%zuB), skip snapshot", storeTotal);
+        storeFnames.clear();
+        return false;
+    }
+
+    storeFile = filesystem->open(snapshotPath, "w");
+    if (!storeFile) {
+        MO_DBG_ERR("could not open snapshot");
+        storeFnames.clear();
+        return false;
+    }
+
+    storeCrc = 0;
+    storeIndex = 0;
+
+    char header [SNAPSHOT_HEADER_SIZE];
+    memcpy(header, "MOSS", 4);
+    putU32(header + 4, SNAPSHOT_FORMAT);
+    putU32(header + 8, versionHash());
+    putU32(header + 12, (uint32_t)storeFnames.size());
+    if (!writeStoreChunk(header, SNAPSHOT_HEADER_SIZE)) {
+        MO_DBG_ERR("could not store snapshot");
+        abortStore();
+        return false;
+    }
+
+    return true;
+}
+
+TaskStatus FilesystemSnapshot::storeStep() {
+    if (!storeFile) {
+        return TaskStatus::Done; //completed or aborted
+    }
+
+    if (storeIndex < storeFnames.size()) {
+        if (!copyStoreFile(storeFnames[storeIndex].c_str())) {
+            MO_DBG_ERR("could not store snapshot");
+            abortStore();
+            return TaskStatus::Done;
+        }
+        storeIndex++;
+        return TaskStatus::Pending;
+    }
+
+    char trailer [SNAPSHOT_TRAILER_SIZE];
+    putU32(trailer, storeCrc);
+    bool success = storeFile->write(trailer, SNAPSHOT_TRAILER_SIZE) == SNAPSHOT_TRAILER_SIZE;
+
+    if (!success) {
+        MO_DBG_ERR("could not store snapshot");
+        abortStore();
+        return TaskStatus::Done;
+    }
+
+    storeFile.reset();
+    snapshotValid = true;
+    storeFailed = false;
+
+    MO_DBG_DEBUG("stored snapshot: %zu files, %zuB", storeFnames.size(), storeTotal);
+
+    storeFnames.clear();
+    storeFnames.shrink_to_fit();
+    return TaskStatus::Done;
+}
+
+bool FilesystemSnapshot::writeStoreChunk(const char *buf, size_t len) {
+    if (storeFile->write(buf, len) != len) {
+        return false;
+    }
+    storeCrc = crc32_update(storeCrc, buf, len);
+    return true;
+}
+
+bool FilesystemSnapshot::copyStoreFile(const char *fname) {
+    char path [MO_MAX_PATH_SIZE];
+    auto ret = snprintf(path, sizeof(path), MO_FILENAME_PREFIX "%s", fname);
+    if (ret < 0 || (size_t)ret >= sizeof(path)) {
+        MO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+
+    size_t size;
+    std::unique_ptr<FileAdapter> src;
+    if (filesystem->stat(path, &size) == 0) {
+        src = filesystem->open(path, "r");
+    }
+    if (!src) {
+        MO_DBG_ERR("could not open %s", path);
+        return false;
+    }
+
+    char buf [64];
+    putU32(buf, (uint32_t)size);
+    if (!writeStoreChunk(fname, strlen(fname) + 1) ||
+            !writeStoreChunk(buf, 4)) {
+        return false;
+    }
+
+    size_t copied = 0;
+    while (copied < size) {
+        auto len = src->read(buf, std::min(sizeof(buf), size - copied));
+        if (len == 0 || !writeStoreChunk(buf, len)) {
+            break;
+        }
+        copied += len;
+    }
+
+    if (copied != size) {
+        MO_DBG_ERR("read error %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+void FilesystemSnapshot::abortStore() {
+    if (!storeFile) {
+        return;
+    }
+    storeFile.reset();
+    storeFnames.clear();
+    storeFnames.shrink_to_fit();
+    discardSnapshotFile(); //incomplete
+}
+
+void FilesystemSnapshot::releaseImage() {
+    if (image) {
+        image.reset();
+        entries.clear();
+        entries.shrink_to_fit();
+    }
+}
+
+bool FilesystemSnapshot::isStoreDue() {
+    return !snapshotValid && !storeFailed && !storeFile && mocpp_tick_ms() - lastWrite >= MO_SNAPSHOT_DELAY * 1000UL;
+}
+
+bool FilesystemSnapshot::invalidate() {
+    if (snapshotValid) {
+        //remove the snapshot before the file changes. If the write is interrupted, the next boot loads the files individually
+        MO_DBG_DEBUG("invalidate snapshot");
+        if (!discardSnapshotFile()) {
+            //the snapshot would roll back the modification at the next boot
+            return false;
+        }
+        snapshotValid = false;
+    }
+
+    abortStore(); //the copied files are outdated
+
+    lastWrite = mocpp_tick_ms();
+    storeFailed = false;
+    return true;
+}
+
+bool FilesystemSnapshot::discardSnapshotFile() {
+    if (filesystem->remove(snapshotPath)) {
+        return true;
+    }
+
+    size_t size;
+    if (filesystem->stat(snapshotPath, &size) != 0) {
+        return true; //doesn't exist
+    }
+
+    //overwrite it with an empty file. The loader discards snapshots which are smaller than the header
+    MO_DBG_WARN("could not remove snapshot. Truncate it");
+    auto file = filesystem->open(snapshotPath, "w");
+    if (!file) {
+        MO_DBG_ERR("could not invalidate snapshot");
+        return false;
+    }
+    return true;
+}
+
+int FilesystemSnapshot::stat(const char *path, size_t *size) {
+    if (image && strcmp(path, snapshotPath) && !isDirectFile(path)) {
+        auto entry = getEntry(path);
+        if (!entry) {
+            return -1; //image lists all files
+        }
+        if (entry->data) {
+            *size = entry->size;
+            return 0;
+        }
+    }
+    return filesystem->stat(path, size);
+}
+
+std::unique_ptr<FileAdapter> FilesystemSnapshot::open(const char *path, const char *mode) {
+    if (!strcmp(path, snapshotPath)) {
+        if (strcmp(mode, "r")) {
+            abortStore();
+            snapshotValid = false;
+        }
+        return filesystem->open(path, mode);
+    }
+
+    if (isDirectFile(path)) {
+        return filesystem->open(path, mode);
+    }
+
+    if (!strcmp(mode, "r")) {
+        if (image) {
+            auto entry = getEntry(path);
+            if (!entry) {
+                return nullptr;
+            }
+            if (entry->data) {
+                return std::unique_ptr<FileAdapter>(new SnapshotFileAdapter(image, entry->data, entry->size));
+            }
+        }
+        return filesystem->open(path, "r");
+    }
+
+    if (!invalidate()) {
+        MO_DBG_ERR("refuse write: %s", path);
+        return nullptr;
+    }
+
+    auto file = filesystem->open(path, mode);
+    if (file && image) {
+        if (auto entry = getEntry(path)) {
+            entry->data = nullptr; //content in image outdated
+        } else if (auto fn = stripPrefix(path)) {
+            entries.emplace_back(fn, nullptr, 0);
+        }
+    }
+    return file;
+}
+
+bool FilesystemSnapshot::remove(const char *path) {
+    if (!strcmp(path, snapshotPath)) {
+        abortStore();
+        snapshotValid = false;
+        return filesystem->remove(path);
+    }
+
+    if (isDirectFile(path)) {
+        return filesystem->remove(path);
+    }
+
+    if (!invalidate()) {
+        MO_DBG_ERR("refuse remove: %s", path);
+        return false;
+    }
+
+    auto ret = filesystem->remove(path);
+    if (image) {
+        if (auto entry = getEntry(path)) {
+            if (ret) {
+                entries.erase(entries.begin() + (entry - entries.data()));
+            } else {
+                entry->data = nullptr;
+            }
+        }
+    }
+    return ret;
+}
+
+int FilesystemSnapshot::ftw_root(std::function<int(const char *fpath)> fn) {
+    if (!image) {
+        return filesystem->ftw_root([&fn] (const char *fname) -> int {
+            if (!strcmp(fname, MO_SNAPSHOT_FN)) {
+                return 0; //hide snapshot
+            }
+            return fn(fname);
+        });
+    }
+
+    // allow fn to remove elements
+    for (size_t it = 0; it < entries.size();) {
+        auto size_before = entries.size();
+        auto err = fn(entries[it].fname.c_str());
+        if (err) {
+            return err;
+        }
+        if (entries.size() + 1 == size_before) {
+            // element removed
+            continue;
+        }
+        // normal execution
+        it++;
+    }
+
+    //not in the image
+    size_t size;
+    if (filesystem->stat(MO_FILENAME_PREFIX SNAPSHOT_DIRECT_FN, &size) == 0) {
+        return fn(SNAPSHOT_DIRECT_FN);
+    }
+
+    return 0;
+}
+
+namespace MicroOcpp {
+
+std::shared_ptr<FilesystemSnapshot> decorateSnapshot(std::shared_ptr<FilesystemAdapter> filesystem) {
+    if (!filesystem) {
+        return nullptr;
+    }
+
+    auto fsSnapshot = std::allocate_shared<FilesystemSnapshot>(makeAllocator<FilesystemSnapshot>("FilesystemSnapshot"), std::move(filesystem));
+    if (!fsSnapshot) {
+        MO_DBG_ERR("OOM");
+        return nullptr;
+    }
+
+    fsSnapshot->loadSnapshot();
+
+    return fsSnapshot;
+}
+
+} //namespace MicroOcpp
@@ -0,0 +1,116 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_FILESYSTEMSNAPSHOT_H
+#define MO_FILESYSTEMSNAPSHOT_H
+
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <MicroOcpp/Core/TaskQueue.h>
+#include <MicroOcpp/Core/Memory.h>
+
+/*
+ * Warm boot: mocpp_initialize wraps the filesystem into a FilesystemSnapshot which restores the stored
+ * state (configurations, local auth list, charging profiles, transactions and meter data) from one
+ * snapshot file. Requires that the files in the MO root folder are only modified through the filesystem
+ * adapter of MicroOcpp
+ */
+#ifndef MO_ENABLE_SNAPSHOT
+#define MO_ENABLE_SNAPSHOT 0
+#endif
+
+#ifndef MO_SNAPSHOT_FN
+#define MO_SNAPSHOT_FN "snapshot.bin"
+#endif
+
+#ifndef MO_SNAPSHOT_MAXSIZE
+#define MO_SNAPSHOT_MAXSIZE 16384 //bytes; if the files in the root folder exceed this size, no snapshot is taken
+#endif
+
+#ifndef MO_SNAPSHOT_DELAY
+#define MO_SNAPSHOT_DELAY 60 //in s; renew the snapshot only after the files haven't been modified for this period
+#endif
+
+namespace MicroOcpp {
+
+class SnapshotImage;
+
+/*
+ * Decorator which bundles all files of the root folder into one snapshot file. At boot, loadSnapshot()
+ * reads the snapshot with one sequential read and verifies it. While the image is loaded, the reads
+ * of the boot-time loaders are served from memory, including stat() and ftw_root(), i.e. lookups of
+ * files which don't exist don't access the filesystem either.
+ *
+ * Any write or remove invalidates the snapshot file before the access is passed through to the
+ * filesystem, so a snapshot is never older than the files. If the snapshot file can't be removed, it's
+ * truncated instead. If that fails too, the write or remove is refused. If the snapshot is missing, corrupt
+ * or from another MO version, the loaders fall back to the individual files. The bootstats are not part of
+ * the snapshot, because every boot updates them. They're always accessed on the filesystem and writing
+ * them keeps the snapshot valid.
+ *
+ * The store runs stepwise: beginStore() lists the files and each storeStep() copies one file into the
+ * snapshot, so that it can run as a Task within the loop budget. A modification in between aborts it.
+ */
+class FilesystemSnapshot : public FilesystemAdapter, public MemoryManaged {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+
+    std::shared_ptr<SnapshotImage> image;
+
+    struct Entry {
+        String fname;
+        const char *data; //content in the image or nullptr if the file has been modified after loading the snapshot
+        size_t size;
+
+        Entry(const char *fname, const char *data, size_t size) : fname(makeString("FilesystemSnapshot", fname)), data(data), size(size) { }
+    };
+    Vector<Entry> entries; //complete listing of the root folder while the image is loaded
+
+    char snapshotPath [MO_MAX_PATH_SIZE] = {'\0'};
+
+    bool snapshotValid = false; //the snapshot file reflects the current state of the files
+    bool storeFailed = false; //don't retry until the files change
+    unsigned long lastWrite = 0;
+
+    //progress of the stepwise store
+    std::unique_ptr<FileAdapter> storeFile; //snapshot file while the store is in progress
+    Vector<String> storeFnames;
+    size_t storeIndex = 0; //next file to copy
+    size_t storeTotal = 0;
+    uint32_t storeCrc = 0;
+
+    Entry *getEntry(const char *path);
+    bool invalidate(); //called before each modification. Returns false if the snapshot file can't be invalidated
+    bool discardSnapshotFile(); //remove or truncate the snapshot file
+    bool writeStoreChunk(const char *buf, size_t len);
+    bool copyStoreFile(const char *fname);
+    void abortStore();
+public:
+    FilesystemSnapshot(std::shared_ptr<FilesystemAdapter> filesystem);
+
+    bool loadSnapshot(); //read the snapshot file into memory. Returns false if there is no valid snapshot
+    bool storeSnapshot(); //bundle all files of the root folder into the snapshot file. Completes a pending stepwise store
+    void releaseImage(); //free the image; further reads access the filesystem
+
+    bool beginStore(); //list the files and write the snapshot header. Returns false if no snapshot can be taken
+    TaskStatus storeStep(); //copy the next file into the snapshot. Done when the snapshot is complete, has failed or has been aborted
+    bool isStorePending() {return storeFile != nullptr;}
+
+    bool isImageLoaded() {return image != nullptr;}
+    bool isSnapshotValid() {return snapshotValid;}
+    bool isStoreDue(); //snapshot outdated, no store pending and no file modifications during the last MO_SNAPSHOT_DELAY
+
+    int stat(const char *path, size_t *size) override;
+    std::unique_ptr<FileAdapter> open(const char *path, const char *mode) override;
+    bool remove(const char *path) override;
+    int ftw_root(std::function<int(const char *fpath)> fn) override;
+};
+
+/*
+ * Wraps filesystem into a FilesystemSnapshot and loads the snapshot if available
+ */
+std::shared_ptr<FilesystemSnapshot> decorateSnapshot(std::shared_ptr<FilesystemAdapter> filesystem);
+
+} //namespace MicroOcpp
+
+#endif
@@ -0,0 +1,110 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/JsonPool.h>
+#include <MicroOcpp/Debug.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace MicroOcpp;
+
+JsonPool::JsonPool() : MemoryManaged("JsonPool"), operationStats(makeVector<OperationStats>(getMemoryTag())) {
+
+}
+
+JsonPool::OperationStats *JsonPool::getOperationStats(const char *operationType) {
+    if (!operationType) {
+        return nullptr;
+    }
+    for (auto& entry : operationStats) {
+        if (!strncmp(entry.operationType.c_str(), operationType, MO_JSON_POOL_OPTYPE_LEN_MAX)) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void JsonPool::setBudget(size_t budget) {
+    this->budget = budget;
+}
+
+size_t JsonPool::getBudget() {
+    return budget;
+}
+
+size_t JsonPool::getEstimate(const char *operationType) {
+    auto stats = getOperationStats(operationType);
+    if (!stats) {
+        return MO_JSON_POOL_INITIAL_ESTIMATE;
+    }
+    return stats->peak;
+}
+
+bool JsonPool::reserve(size_t size) {
+    if (budget && usage > 0 && usage + size > budget) {
+        MO_DBG_DEBUG("JSON budget exhausted: %zu B in use, %zu B requested, %zu B budget", usage, size, budget);
+        return false;
+    }
+    reserveForced(size);
+    return true;
+}
+
+void JsonPool::reserveForced(size_t size) {
+    usage += size;
+    if (usage > maxUsage) {
+        maxUsage = usage;
+    }
+}
+
+void JsonPool::release(size_t size) {
+    if (size > usage) {
+        MO_DBG_ERR("released more than reserved");
+        size = usage;
+    }
+    usage -= size;
+}
+
+void JsonPool::updatePeak(const char *operationType, size_t size) {
+    if (!operationType) {
+        return;
+    }
+
+    auto stats = getOperationStats(operationType);
+    if (!stats) {
+        if (operationStats.size() >= MO_JSON_POOL_OPTYPES_MAX) {
+            MO_DBG_DEBUG("exceeded number of operation types with statistics");
+            return;
+        }
+        OperationStats entry;
+        entry.operationType.set(operationType); //longer operation types are truncated
+        operationStats.push_back(entry);
+        stats = &operationStats.back();
+    }
+
+    if (size > stats->peak) {
+        stats->peak = size;
+    }
+
+    #if MO_OVERRIDE_ALLOCATION && MO_ENABLE_HEAP_PROFILER
+    {
+        char tag [64];
+        snprintf(tag, sizeof(tag), "JsonPool.%s", operationType);
+        MO_MEM_TRACK_PEAK(tag, size);
+    }
+    #endif
+}
+
+size_t JsonPool::getUsage() {
+    return usage;
+}
+
+size_t JsonPool::getMaxUsage() {
+    return maxUsage;
+}
+
+size_t JsonPool::getPeak(const char *operationType) {
+    auto stats = getOperationStats(operationType);
+    return stats ? stats->peak : 0;
+}
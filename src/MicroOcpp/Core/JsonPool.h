@@ -0,0 +1,84 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_JSONPOOL_H
+#define MO_JSONPOOL_H
+
+#include <stddef.h>
+
+#include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
+
+#ifndef MO_JSON_POOL_BUDGET
+#define MO_JSON_POOL_BUDGET 0 //total budget in Bytes for all OCPP messages in flight (JSON docs and serialized messages). 0 = unlimited
+#endif
+
+#ifndef MO_JSON_POOL_INITIAL_ESTIMATE
+#define MO_JSON_POOL_INITIAL_ESTIMATE 512 //reservation for operation types which haven't been measured yet
+#endif
+
+#ifndef MO_JSON_POOL_OPTYPES_MAX
+#define MO_JSON_POOL_OPTYPES_MAX 32 //number of operation types with individual usage statistics
+#endif
+
+#define MO_JSON_POOL_OPTYPE_LEN_MAX 32
+
+namespace MicroOcpp {
+
+/*
+ * Accounts the memory of all OCPP messages which are processed at the same time. Before an outgoing
+ * message is created, the RequestQueue reserves the expected size from the pool. The expected size
+ * is the peak usage which has been observed for the same operation type before (payload doc, RPC
+ * envelope doc and serialized message). A request holds its reservation until it has been answered,
+ * has timed out or has been aborted, a conf until it has been sent. If the budget is exhausted, the
+ * message is deferred and created in a later loop call after the other messages have been released.
+ *
+ * Incoming messages can't be deferred. They are accounted, but always granted.
+ */
+class JsonPool : public MemoryManaged {
+private:
+    size_t budget = MO_JSON_POOL_BUDGET;
+    size_t usage = 0;
+    size_t maxUsage = 0;
+
+    struct OperationStats {
+        StaticString<MO_JSON_POOL_OPTYPE_LEN_MAX> operationType;
+        size_t peak = 0;
+    };
+    Vector<OperationStats> operationStats;
+
+    OperationStats *getOperationStats(const char *operationType);
+public:
+    JsonPool();
+
+    void setBudget(size_t budget); //0 = unlimited
+    size_t getBudget();
+
+    /*
+     * Expected memory usage for a message of this operation type. Returns the observed peak or
+     * MO_JSON_POOL_INITIAL_ESTIMATE if no message of this type has been measured yet
+     */
+    size_t getEstimate(const char *operationType);
+
+    /*
+     * Reserve size Bytes. Returns false if the budget is exhausted. If nothing else is reserved, the
+     * reservation is always granted, so that messages larger than the budget are still sent eventually
+     */
+    bool reserve(size_t size);
+    void reserveForced(size_t size); //account memory which must be granted, e.g. for incoming messages
+    void release(size_t size);
+
+    /*
+     * Record the actual memory usage of a message after it has been processed
+     */
+    void updatePeak(const char *operationType, size_t size);
+
+    size_t getUsage();
+    size_t getMaxUsage();
+    size_t getPeak(const char *operationType); //returns 0 if not measured yet
+};
+
+} //namespace MicroOcpp
+
+#endif
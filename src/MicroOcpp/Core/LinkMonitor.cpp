@@ -0,0 +1,119 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/LinkMonitor.h>
+#include <MicroOcpp/Debug.h>
+
+#include <algorithm>
+
+using namespace MicroOcpp;
+
+void LinkMonitor::onRequestSent(unsigned long t_now) {
+    outstanding = true;
+    t_sent = t_now;
+    overdueCounted = false;
+}
+
+void LinkMonitor::onResponse(unsigned long t_now) {
+    if (!outstanding) {
+        return;
+    }
+    outstanding = false;
+    offline = false;
+    trafficValid = true;
+    t_lastTraffic = t_now;
+
+    unsigned long rtt = t_now - t_sent;
+
+    //integer EWMA like the TCP retransmission timer: SRTT += (RTT - SRTT) / 8, RTTVAR += (|RTT - SRTT| - RTTVAR) / 4
+    if (stats.samples == 0) {
+        srtt8 = rtt << 3;
+        rttvar4 = rtt << 1; //RTTVAR = RTT / 2
+    } else {
+        long err = (long)rtt - (long)(srtt8 >> 3);
+        srtt8 = (unsigned long)((long)srtt8 + err);
+        if (err < 0) {
+            err = -err;
+        }
+        rttvar4 = (unsigned long)((long)rttvar4 + err - (long)(rttvar4 >> 2));
+    }
+
+    stats.samples++;
+    stats.lastRtt = rtt;
+    stats.maxRtt = std::max(stats.maxRtt, rtt);
+    if (stats.consecutiveLosses > 0) {
+        MO_DBG_DEBUG("link recovered after %u losses", stats.consecutiveLosses);
+    }
+    stats.consecutiveLosses = 0;
+    updateRto();
+}
+
+void LinkMonitor::onTimeout(unsigned long t_now) {
+    if (!outstanding) {
+        return;
+    }
+    outstanding = false;
+    if (!overdueCounted && !isOffline(t_now)) {
+        addLoss(t_now);
+    }
+}
+
+void LinkMonitor::onRequestReceived(unsigned long t_now) {
+    trafficValid = true;
+    t_lastTraffic = t_now;
+}
+
+void LinkMonitor::loop(unsigned long t_now) {
+    if (outstanding && !overdueCounted && hasEstimate() && t_now - t_sent > stats.rto && !isOffline(t_now)) {
+        overdueCounted = true;
+        addLoss(t_now);
+        offline = true;
+        t_offline = t_now;
+    }
+}
+
+void LinkMonitor::addLoss(unsigned long t_now) {
+    stats.losses++;
+    if (stats.consecutiveLosses < UINT16_MAX) {
+        stats.consecutiveLosses++;
+    }
+    updateRto();
+    if (stats.consecutiveLosses >= MO_LINK_LOSSES_OFFLINE) {
+        offline = true;
+        t_offline = t_now;
+    }
+    MO_DBG_DEBUG("request lost (%u in a row), RTO = %lu ms", stats.consecutiveLosses, stats.rto);
+}
+
+void LinkMonitor::updateRto() {
+    stats.srtt = srtt8 >> 3;
+    stats.rttvar = rttvar4 >> 2;
+
+    unsigned long rto = stats.srtt + rttvar4; //SRTT + 4 * RTTVAR
+    rto = std::max(rto, (unsigned long)MO_LINK_RTO_MIN);
+
+    //back off for each consecutive loss
+    for (uint16_t i = 0; i < stats.consecutiveLosses && rto < MO_LINK_RTO_MAX; i++) {
+        rto *= 2;
+    }
+    stats.rto = std::min(rto, (unsigned long)MO_LINK_RTO_MAX);
+}
+
+unsigned long LinkMonitor::getRto() const {
+    return hasEstimate() ? stats.rto : MO_LINK_RTO_MAX;
+}
+
+bool LinkMonitor::isOffline(unsigned long t_now) const {
+    return offline && t_now - t_offline < getRto();
+}
+
+unsigned long LinkMonitor::getAdaptiveTimeout(unsigned long maxTimeout, unsigned long t_now) const {
+    if (isOffline(t_now)) {
+        return std::min(maxTimeout, stats.srtt + (unsigned long)MO_LINK_PROBE_MARGIN);
+    }
+    if (!hasEstimate()) {
+        return maxTimeout;
+    }
+    return std::min(maxTimeout, std::max(stats.rto, (unsigned long)MO_LINK_AUTHORIZE_TIMEOUT_MIN));
+}
@@ -0,0 +1,110 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_LINKMONITOR_H
+#define MO_LINKMONITOR_H
+
+#include <stdint.h>
+
+/*
+ * Bounds of the retransmission timeout (RTO) in ms which the LinkMonitor derives from the measured round-trip times
+ */
+#ifndef MO_LINK_RTO_MIN
+#define MO_LINK_RTO_MIN 2000
+#endif
+
+#ifndef MO_LINK_RTO_MAX
+#define MO_LINK_RTO_MAX 60000
+#endif
+
+#ifndef MO_LINK_LOSSES_OFFLINE
+#define MO_LINK_LOSSES_OFFLINE 2 //consecutive requests without response after which the link is considered offline
+#endif
+
+#ifndef MO_LINK_AUTHORIZE_TIMEOUT_MIN
+#define MO_LINK_AUTHORIZE_TIMEOUT_MIN 5000 //lower bound of the adaptive Authorize timeout in ms, leaves the CSMS time for the idTag lookup
+#endif
+
+#ifndef MO_LINK_PROBE_MARGIN
+#define MO_LINK_PROBE_MARGIN 1000 //Authorize timeout while offline in ms on top of the SRTT. The Authorize probes if the link is back
+#endif
+
+namespace MicroOcpp {
+
+/*
+ * Link-health metrics, e.g. for the diagnostics of a charger on a cellular link
+ */
+struct LinkStats {
+    unsigned long srtt = 0; //smoothed round-trip time in ms
+    unsigned long rttvar = 0; //round-trip time variation in ms
+    unsigned long rto = 0; //retransmission timeout in ms
+    unsigned long lastRtt = 0;
+    unsigned long maxRtt = 0;
+    uint32_t samples = 0; //requests which have received a response
+    uint32_t losses = 0; //requests which have timed out or been overdue
+    uint16_t consecutiveLosses = 0;
+};
+
+/*
+ * Estimates the connection quality from the round-trip times of the requests which the RequestQueue sends. Like
+ * the TCP retransmission timer (RFC 6298), it keeps an exponentially weighted moving average of the RTT and its
+ * variation and derives the timeout RTO = SRTT + 4 * RTTVAR. Each consecutive loss doubles the RTO.
+ *
+ * The RTO replaces fixed timeouts where a user is waiting, like the Authorize timeout before the charger falls back
+ * to offline authorization. Moreover, the LinkMonitor considers the link offline if the in-flight request is overdue
+ * by more than the RTO or if several requests in a row have been lost, even if the socket still reports a connection.
+ * The offline verdict expires after the (backed-off) RTO. Until then, further losses aren't counted, so that the
+ * requests which are sent meanwhile can probe the link without extending the verdict
+ */
+class LinkMonitor {
+private:
+    unsigned long srtt8 = 0; //SRTT scaled by 8
+    unsigned long rttvar4 = 0; //RTTVAR scaled by 4
+
+    bool outstanding = false; //a request is in flight
+    unsigned long t_sent = 0;
+    bool overdueCounted = false; //the in-flight request has already been counted as loss
+
+    bool offline = false;
+    unsigned long t_offline = 0; //when the offline verdict has been given
+
+    bool trafficValid = false;
+    unsigned long t_lastTraffic = 0; //last response or incoming request
+
+    LinkStats stats;
+
+    void addLoss(unsigned long t_now);
+    void updateRto();
+public:
+    void onRequestSent(unsigned long t_now);
+    void onResponse(unsigned long t_now); //CALLRESULT or CALLERROR
+    void onTimeout(unsigned long t_now); //the in-flight request has been discarded without response
+    void onRequestReceived(unsigned long t_now); //incoming CALL from the server
+
+    void loop(unsigned long t_now); //counts an overdue request as loss
+
+    bool hasEstimate() const {return stats.samples > 0;}
+    unsigned long getRto() const;
+
+    //fast offline verdict: requests don't get through although the socket may still report a connection
+    bool isOffline(unsigned long t_now) const;
+
+    /*
+     * Timeout for a request which a user waits for. Without RTT samples, returns maxTimeout. Otherwise the RTO,
+     * bounded by MO_LINK_AUTHORIZE_TIMEOUT_MIN and maxTimeout. If the link is considered offline, returns the
+     * SRTT plus MO_LINK_PROBE_MARGIN, so that the caller takes the offline path soon, but still gets a response if
+     * the link is back
+     */
+    unsigned long getAdaptiveTimeout(unsigned long maxTimeout, unsigned long t_now) const;
+
+    //any response or incoming request proves that the server is reachable, like a Heartbeat
+    bool hasTraffic() const {return trafficValid;}
+    unsigned long getLastTraffic() const {return t_lastTraffic;}
+
+    const LinkStats& getStats() const {return stats;}
+};
+
+} //end namespace MicroOcpp
+
+#endif
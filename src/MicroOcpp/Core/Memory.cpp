@@ -5,6 +5,11 @@
 #include <MicroOcpp/Core/Memory.h>
 #include <MicroOcpp/Debug.h>
 
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+
 #if MO_OVERRIDE_ALLOCATION && MO_ENABLE_HEAP_PROFILER
 
 #include <map>
@@ -16,6 +21,7 @@ struct MemBlockInfo {
     void* tagger_ptr = nullptr;
     std::string tag;
     size_t size = 0;
+    bool ext = false; //block in external RAM
 
     MemBlockInfo(void* ptr, const char *tag, size_t size) : size{size} {
         updateTag(ptr, tag);
@@ -55,6 +61,7 @@ struct MemTagInfo {
 std::map<std::string,MemTagInfo> memTags;
 
 size_t memTotal, memTotalMax;
+size_t memTotalExt, memTotalExtMax; //share of external RAM
 
 void MemBlockInfo::updateTag(void* ptr, const char *tag) {
     if (!tag) {
@@ -93,6 +100,78 @@ namespace Memory {
 void* (*malloc_override)(size_t);
 void (*free_override)(void*);
 
+void *mallocInternal(const char *tag, size_t size);
+
+#if MO_ENABLE_EXTERNAL_RAM
+
+void* (*malloc_override_ext)(size_t);
+void (*free_override_ext)(void*);
+
+//address range of all blocks in external RAM. Internal and external RAM are separate address ranges
+uintptr_t ext_begin = UINTPTR_MAX;
+uintptr_t ext_end = 0;
+
+bool isExternal(void *ptr) {
+    return (uintptr_t)ptr >= ext_begin && (uintptr_t)ptr < ext_end;
+}
+
+#define MO_MEM_PLACEMENT_PREFIX_LEN 40
+
+struct PlacementRule {
+    char tag_prefix [MO_MEM_PLACEMENT_PREFIX_LEN];
+    int placement;
+};
+
+PlacementRule placementRules [MO_MEM_PLACEMENT_RULES_MAX] = {
+    {"v16.Authorization.AuthorizationList", MO_MEM_PLACEMENT_EXTERNAL},
+    {"v16.SmartCharging.", MO_MEM_PLACEMENT_EXTERNAL},
+    {"v16.Transactions.TransactionStore", MO_MEM_PLACEMENT_EXTERNAL},
+    {"v16.Metering.MeterStore", MO_MEM_PLACEMENT_EXTERNAL},
+    {"v16.Metering.TransactionMeterData", MO_MEM_PLACEMENT_EXTERNAL},
+    {"v16.Diagnostics.", MO_MEM_PLACEMENT_EXTERNAL},
+};
+size_t placementRulesSize = 6;
+
+size_t extThreshold = MO_MEM_EXT_THRESHOLD;
+
+#endif //MO_ENABLE_EXTERNAL_RAM
+
+#if MO_ENABLE_BOOT_ARENA
+
+#define MO_BOOT_ARENA_ALIGN alignof(max_align_t)
+
+size_t bootArenaSize = MO_BOOT_ARENA_SIZE;
+
+unsigned char *bootArena = nullptr;
+size_t bootArenaCapacity = 0;
+size_t bootArenaPos = 0;
+size_t bootArenaBlocks = 0;
+bool bootArenaOpen = false;
+bool bootArenaReleasePending = false; //free the region when its last object is freed
+void (*bootArenaFree)(void*) = nullptr; //free function of the region. The overrides may change in the meantime
+
+bool isBootArena(void *ptr) {
+    return bootArena && (unsigned char*)ptr >= bootArena && (unsigned char*)ptr < bootArena + bootArenaCapacity;
+}
+
+void freeBootArena() {
+    MO_DBG_DEBUG("free boot arena");
+    if (bootArenaFree) {
+        bootArenaFree(bootArena);
+    } else {
+        free(bootArena);
+    }
+    bootArena = nullptr;
+    bootArenaCapacity = 0;
+    bootArenaPos = 0;
+    bootArenaBlocks = 0;
+    bootArenaOpen = false;
+    bootArenaReleasePending = false;
+    bootArenaFree = nullptr;
+}
+
+#endif //MO_ENABLE_BOOT_ARENA
+
 }
 }
 
@@ -103,7 +182,117 @@ void mo_mem_set_malloc_free(void* (*malloc_override)(size_t), void (*free_overri
     MicroOcpp::Memory::free_override = free_override;
 }
 
-void *mo_mem_malloc(const char *tag, size_t size) {
+#if MO_ENABLE_EXTERNAL_RAM
+
+void mo_mem_set_malloc_free_ext(void* (*malloc_override)(size_t), void (*free_override)(void*)) {
+    MicroOcpp::Memory::malloc_override_ext = malloc_override;
+    MicroOcpp::Memory::free_override_ext = free_override;
+}
+
+int mo_mem_set_placement(const char *tag_prefix, int placement) {
+    if (!tag_prefix || strlen(tag_prefix) >= MO_MEM_PLACEMENT_PREFIX_LEN) {
+        MO_DBG_ERR("invalid tag prefix");
+        return -1;
+    }
+
+    for (size_t i = 0; i < placementRulesSize; i++) {
+        if (!strcmp(placementRules[i].tag_prefix, tag_prefix)) {
+            placementRules[i].placement = placement;
+            return 0;
+        }
+    }
+
+    if (placementRulesSize >= MO_MEM_PLACEMENT_RULES_MAX) {
+        MO_DBG_ERR("exceeded MO_MEM_PLACEMENT_RULES_MAX");
+        return -1;
+    }
+
+    snprintf(placementRules[placementRulesSize].tag_prefix, MO_MEM_PLACEMENT_PREFIX_LEN, "%s", tag_prefix);
+    placementRules[placementRulesSize].placement = placement;
+    placementRulesSize++;
+    return 0;
+}
+
+void mo_mem_clear_placement() {
+    placementRulesSize = 0;
+}
+
+void mo_mem_set_ext_threshold(size_t size) {
+    extThreshold = size;
+}
+
+int mo_mem_get_placement(const char *tag) {
+    if (!tag) {
+        return MO_MEM_PLACEMENT_AUTO;
+    }
+
+    int placement = MO_MEM_PLACEMENT_AUTO;
+    size_t matchLen = 0;
+
+    for (size_t i = 0; i < placementRulesSize; i++) {
+        size_t len = strlen(placementRules[i].tag_prefix);
+        if (len > matchLen && !strncmp(tag, placementRules[i].tag_prefix, len)) {
+            placement = placementRules[i].placement;
+            matchLen = len;
+        }
+    }
+
+    return placement;
+}
+
+void *mo_mem_malloc_placed(const char *tag, int placement, size_t size) {
+
+    if (placement == MO_MEM_PLACEMENT_AUTO) {
+        placement = (extThreshold && size >= extThreshold) ?
+                MO_MEM_PLACEMENT_EXTERNAL :
+                MO_MEM_PLACEMENT_INTERNAL;
+    }
+
+    if (placement != MO_MEM_PLACEMENT_EXTERNAL || !malloc_override_ext) {
+        return mallocInternal(tag, size);
+    }
+
+    MO_DBG_VERBOSE("malloc ext %zu B (%s)", size, tag ? tag : "unspecified");
+
+    void *ptr = malloc_override_ext(size);
+
+    if (!ptr) {
+        //external RAM exhausted. Fall back to internal RAM
+        return mallocInternal(tag, size);
+    }
+
+    ext_begin = std::min(ext_begin, (uintptr_t)ptr);
+    ext_end = std::max(ext_end, (uintptr_t)ptr + size);
+
+    #if MO_ENABLE_HEAP_PROFILER
+    {
+        MemBlockInfo blockInfo {ptr, tag, size};
+        blockInfo.ext = true;
+        memBlocks.emplace(ptr, std::move(blockInfo));
+
+        memTotal += size;
+        memTotalMax = std::max(memTotalMax, memTotal);
+        memTotalExt += size;
+        memTotalExtMax = std::max(memTotalExtMax, memTotalExt);
+    }
+    #endif
+    return ptr;
+}
+
+void *mo_mem_malloc_ext(const char *tag, size_t size) {
+    return mo_mem_malloc_placed(tag, MO_MEM_PLACEMENT_EXTERNAL, size);
+}
+
+void mo_mem_free_ext(void* ptr) {
+    mo_mem_free(ptr);
+}
+
+#endif //MO_ENABLE_EXTERNAL_RAM
+
+namespace MicroOcpp {
+namespace Memory {
+
+void *mallocInternal(const char *tag, size_t size) {
     MO_DBG_VERBOSE("malloc %zu B (%s)", size, tag ? tag : "unspecified");
 
     void *ptr;
@@ -124,6 +313,17 @@ void *mo_mem_malloc(const char *tag, size_t size) {
     return ptr;
 }
 
+}
+}
+
+void *mo_mem_malloc(const char *tag, size_t size) {
+    #if MO_ENABLE_EXTERNAL_RAM
+    return mo_mem_malloc_placed(tag, mo_mem_get_placement(tag), size);
+    #else
+    return mallocInternal(tag, size);
+    #endif
+}
+
 void mo_mem_free(void* ptr) {
     MO_DBG_VERBOSE("free");
 
@@ -137,6 +337,11 @@ void mo_mem_free(void* ptr) {
                 tagInfo->second -= blockInfo->second.size;
             }
             memTotal -= blockInfo->second.size;
+            #if MO_ENABLE_EXTERNAL_RAM
+            if (blockInfo->second.ext) {
+                memTotalExt -= blockInfo->second.size;
+            }
+            #endif
         }
 
         if (blockInfo != memBlocks.end()) {
@@ -145,6 +350,24 @@ void mo_mem_free(void* ptr) {
     }
     #endif
 
+    #if MO_ENABLE_BOOT_ARENA
+    if (ptr && isBootArena(ptr)) {
+        //the space stays taken until the whole region is freed
+        bootArenaBlocks--;
+        if (bootArenaBlocks == 0 && bootArenaReleasePending) {
+            freeBootArena();
+        }
+        return;
+    }
+    #endif
+
+    #if MO_ENABLE_EXTERNAL_RAM
+    if (ptr && isExternal(ptr) && free_override_ext) {
+        free_override_ext(ptr);
+        return;
+    }
+    #endif
+
     if (free_override) {
         free_override(ptr);
     } else {
@@ -152,6 +375,100 @@ void mo_mem_free(void* ptr) {
     }
 }
 
+#if MO_ENABLE_BOOT_ARENA
+
+void mo_mem_set_boot_arena_size(size_t size) {
+    bootArenaSize = size;
+}
+
+void mo_mem_boot_arena_open() {
+    if (bootArena) {
+        MO_DBG_WARN("boot arena still in use by %zu objects of the previous run", bootArenaBlocks);
+        return;
+    }
+
+    if (bootArenaSize == 0) {
+        return;
+    }
+
+    //the region bypasses the heap profiler, which records the objects in the arena instead
+    if (malloc_override) {
+        bootArena = static_cast<unsigned char*>(malloc_override(bootArenaSize));
+    } else {
+        bootArena = static_cast<unsigned char*>(malloc(bootArenaSize));
+    }
+
+    if (!bootArena) {
+        MO_DBG_WARN("cannot allocate boot arena. Use heap");
+        return;
+    }
+
+    bootArenaFree = free_override;
+    bootArenaCapacity = bootArenaSize;
+    bootArenaOpen = true;
+}
+
+void mo_mem_boot_arena_freeze() {
+    if (!bootArenaOpen) {
+        return;
+    }
+    bootArenaOpen = false;
+    MO_DBG_DEBUG("boot arena: %zu objects, %zu of %zu B", bootArenaBlocks, bootArenaPos, bootArenaCapacity);
+}
+
+void mo_mem_boot_arena_release() {
+    bootArenaOpen = false;
+    if (!bootArena) {
+        return;
+    }
+    if (bootArenaBlocks == 0) {
+        freeBootArena();
+    } else {
+        MO_DBG_DEBUG("boot arena: %zu objects outlive deinitialization", bootArenaBlocks);
+        bootArenaReleasePending = true;
+    }
+}
+
+size_t mo_mem_get_boot_arena_used() {
+    return bootArenaPos;
+}
+
+size_t mo_mem_get_boot_arena_capacity() {
+    return bootArenaCapacity;
+}
+
+size_t mo_mem_get_boot_arena_blocks() {
+    return bootArenaBlocks;
+}
+
+void *mo_mem_malloc_boot(const char *tag, size_t size) {
+    if (bootArenaOpen) {
+        size_t blockSize = ((size ? size : 1) + MO_BOOT_ARENA_ALIGN - 1) / MO_BOOT_ARENA_ALIGN * MO_BOOT_ARENA_ALIGN;
+        if (blockSize <= bootArenaCapacity - bootArenaPos) {
+            MO_DBG_VERBOSE("malloc boot %zu B (%s)", size, tag ? tag : "unspecified");
+
+            void *ptr = bootArena + bootArenaPos;
+            bootArenaPos += blockSize;
+            bootArenaBlocks++;
+
+            #if MO_ENABLE_HEAP_PROFILER
+            {
+                memBlocks.emplace(ptr, MemBlockInfo(ptr, tag, size));
+
+                memTotal += size;
+                memTotalMax = std::max(memTotalMax, memTotal);
+            }
+            #endif
+            return ptr;
+        }
+        MO_DBG_DEBUG("boot arena exhausted. Use heap for %zu B", size);
+    }
+
+    return mo_mem_malloc(tag, size);
+}
+
+#endif //MO_ENABLE_BOOT_ARENA
+
 #endif //MO_OVERRIDE_ALLOCATION
 
 #if MO_OVERRIDE_ALLOCATION && MO_ENABLE_HEAP_PROFILER
@@ -169,6 +486,37 @@ void mo_mem_reset() {
     }
 
     memTotalMax = memTotal;
+    memTotalExtMax = memTotalExt;
+}
+
+size_t mo_mem_get_total_current() {
+    return memTotal;
+}
+
+size_t mo_mem_get_total_max() {
+    return memTotalMax;
+}
+
+size_t mo_mem_get_current_heap_by_tag(const char *tag) {
+    size_t len = strlen(tag);
+    size_t size = 0;
+    for (const auto& tagInfo : memTags) {
+        if (!strncmp(tagInfo.first.c_str(), tag, len)) {
+            size += tagInfo.second.current_size;
+        }
+    }
+    return size;
+}
+
+size_t mo_mem_get_maximum_heap_by_tag(const char *tag) {
+    size_t len = strlen(tag);
+    size_t size = 0;
+    for (const auto& tagInfo : memTags) {
+        if (!strncmp(tagInfo.first.c_str(), tag, len)) {
+            size += tagInfo.second.max_size;
+        }
+    }
+    return size;
 }
 
 void mo_mem_set_tag(void *ptr, const char *tag) {
@@ -197,6 +545,19 @@ void mo_mem_set_tag(void *ptr, const char *tag) {
     }
 }
 
+void mo_mem_track_peak(const char *tag, size_t size) {
+    if (!tag) {
+        return;
+    }
+
+    auto tagInfo = memTags.find(tag);
+    if (tagInfo == memTags.end()) {
+        tagInfo = memTags.emplace(tag, 0).first;
+    }
+
+    tagInfo->second.max_size = std::max(tagInfo->second.max_size, size);
+}
+
 void mo_mem_print_stats() {
 
     MO_CONSOLE_PRINTF("\n *** Heap usage statistics ***\n");
@@ -247,6 +608,9 @@ void mo_mem_print_stats() {
     }
 
     MO_CONSOLE_PRINTF(" *** Summary ***\nBlocks: %zu\nTags: %zu\nCurrent usage: %zu B\nMaximum usage: %zu B\n", memBlocks.size(), memTags.size(), memTotal, memTotalMax);
+    #if MO_ENABLE_EXTERNAL_RAM
+    MO_CONSOLE_PRINTF("Current usage external RAM: %zu B\nMaximum usage external RAM: %zu B\n", memTotalExt, memTotalExtMax);
+    #endif
     #if MO_DBG_LEVEL >= MO_DL_DEBUG
     {
         MO_CONSOLE_PRINTF(" *** Debug information ***\nTotal blocks (control value 1): %zu B\nTags (control value): %zu\nTotal tagged (control value 2): %zu B\nTotal tagged (control value 3): %zu B\nUntagged: %zu\nTotal untagged: %zu B\n", size, tags.size(), size_control, size_control2, untagged, untagged_size);
@@ -260,6 +624,10 @@ int mo_mem_write_stats_json(char *buf, size_t size) {
     doc["total_current"] = memTotal;
     doc["total_max"] = memTotalMax;
     doc["total_blocks"] = memBlocks.size();
+    #if MO_ENABLE_EXTERNAL_RAM
+    doc["ext_current"] = memTotalExt;
+    doc["ext_max"] = memTotalExtMax;
+    #endif
 
     JsonArray by_tag = doc.createNestedArray("by_tag");
     for (const auto& tag : memTags) {
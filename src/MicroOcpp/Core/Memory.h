@@ -19,6 +19,10 @@
 #define MO_ENABLE_HEAP_PROFILER 0
 #endif
 
+#ifndef MO_ENABLE_BOOT_ARENA
+#define MO_ENABLE_BOOT_ARENA 0
+#endif
+
 
 #ifdef __cplusplus
 extern "C" {
@@ -48,10 +52,15 @@ void mo_mem_reset(); //reset maximum heap occuption
 
 void mo_mem_set_tag(void *ptr, const char *tag);
 
+void mo_mem_track_peak(const char *tag, size_t size); //record the maximum of a quantity which isn't a single heap block, e.g. the sum of all JSON buffers of an OCPP message
+
+size_t mo_mem_get_total_current(); //sum of all heap blocks in bytes
+size_t mo_mem_get_total_max(); //maximum of the sum since the last mo_mem_reset()
+
 void mo_mem_get_current_heap(const char *tag);
 void mo_mem_get_maximum_heap(const char *tag);
-void mo_mem_get_current_heap_by_tag(const char *tag);
-void mo_mem_get_maximum_heap_by_tag(const char *tag);
+size_t mo_mem_get_current_heap_by_tag(const char *tag); //sum of all heap blocks whose tag starts with tag, e.g. "Request." for all requests
+size_t mo_mem_get_maximum_heap_by_tag(const char *tag); //sum of the maxima of these tags since the last mo_mem_reset(). Exact for a single tag, an upper bound for several
 
 int mo_mem_write_stats_json(char *buf, size_t size);
 
@@ -60,19 +69,59 @@ void mo_mem_print_stats();
 #define MO_MEM_DEINIT mo_mem_deinit
 #define MO_MEM_RESET mo_mem_reset
 #define MO_MEM_SET_TAG mo_mem_set_tag
+#define MO_MEM_TRACK_PEAK mo_mem_track_peak
 #define MO_MEM_PRINT_STATS mo_mem_print_stats
 
 #else
 #define MO_MEM_DEINIT(...) (void)0
 #define MO_MEM_RESET(...) (void)0
 #define MO_MEM_SET_TAG(...) (void)0
+#define MO_MEM_TRACK_PEAK(...) (void)0
 #define MO_MEM_PRINT_STATS(...) (void)0
 #endif //MO_OVERRIDE_ALLOCATION && MO_ENABLE_HEAP_PROFILER
 
 
 #if MO_ENABLE_EXTERNAL_RAM
 
-void mo_mem_set_malloc_free_ext(void* (*malloc_override)(size_t), void (*free_override)(void*)); //pass malloc and free function to external RAM to be used with the OCPP lib. If not set or NULL, defaults to standard malloc
+#if !MO_OVERRIDE_ALLOCATION
+#error MO_ENABLE_EXTERNAL_RAM requires MO_OVERRIDE_ALLOCATION
+#endif
+
+#ifndef MO_MEM_EXT_THRESHOLD
+#define MO_MEM_EXT_THRESHOLD 1024 //allocations of at least this size go to external RAM, unless a placement rule applies. 0 = disable
+#endif
+
+#ifndef MO_MEM_PLACEMENT_RULES_MAX
+#define MO_MEM_PLACEMENT_RULES_MAX 16
+#endif
+
+#define MO_MEM_PLACEMENT_AUTO     0 //decide by size (see MO_MEM_EXT_THRESHOLD)
+#define MO_MEM_PLACEMENT_INTERNAL 1
+#define MO_MEM_PLACEMENT_EXTERNAL 2
+
+void mo_mem_set_malloc_free_ext(void* (*malloc_override)(size_t), void (*free_override)(void*)); //pass malloc and free function to external RAM to be used with the OCPP lib (e.g. ps_malloc and free). If not set or NULL, all memory is placed in internal RAM
+
+/*
+ * Placement policy. Memory tags are mapped to a heap by prefix, e.g. rule ("v16.SmartCharging.",
+ * MO_MEM_PLACEMENT_EXTERNAL) moves all charging profiles into external RAM. The longest matching
+ * prefix wins. Allocations without matching rule are placed by size. By default, the large and
+ * rarely accessed data classes (local auth list, charging profiles, tx cache, meter data and
+ * diagnostics) are placed in external RAM.
+ *
+ * Containers, strings and JSON documents pass their tag to the policy. A MemoryManaged object created
+ * with plain new is placed by size only, because the tag is set in the constructor after the
+ * allocation. To apply a rule to the object itself, pass the tag to new, e.g.
+ * new ("v16.SmartCharging.ChargingProfile") ChargingProfile().
+ *
+ * External RAM must be a separate address range from the internal heap, which is the case for
+ * PSRAM on all supported MCUs. mo_mem_free() determines the heap by the address of the block.
+ */
+int mo_mem_set_placement(const char *tag_prefix, int placement); //add or update rule. Returns 0 on success, -1 if the table is full
+void mo_mem_clear_placement(); //remove all rules, including the default rules
+void mo_mem_set_ext_threshold(size_t size); //overrides MO_MEM_EXT_THRESHOLD. 0 = disable
+int mo_mem_get_placement(const char *tag); //evaluate rules, returns MO_MEM_PLACEMENT_AUTO if no rule matches
+
+void *mo_mem_malloc_placed(const char *tag, int placement, size_t size);
 
 void *mo_mem_malloc_ext(const char *tag, size_t size);
 
@@ -87,6 +136,50 @@ void mo_mem_free_ext(void* ptr);
 #endif //MO_ENABLE_EXTERNAL_RAM
 
 
+#if MO_ENABLE_BOOT_ARENA
+
+#if !MO_OVERRIDE_ALLOCATION
+#error MO_ENABLE_BOOT_ARENA requires MO_OVERRIDE_ALLOCATION
+#endif
+
+#ifndef MO_BOOT_ARENA_SIZE
+#define MO_BOOT_ARENA_SIZE 8192 //in bytes. When the arena is exhausted, the remaining objects are allocated on the heap
+#endif
+
+/*
+ * Boot arena. Most objects which mocpp_initialize() creates live until mocpp_deinitialize(), e.g. the
+ * Services, Connectors, Configurations and OperationRegistry entries. While the arena is open, the
+ * MemoryManaged objects are taken from one contiguous region with a bump allocator, so that they don't
+ * interleave with the short-lived JSON buffers and requests on the heap. mocpp_initialize() freezes the
+ * arena when it returns; all later allocations use the heap. Freeing an object of the arena doesn't
+ * return its space. The region itself is freed after mocpp_deinitialize() has freed its last object.
+ * Classes whose objects don't live until mocpp_deinitialize() derive from TransientMemoryManaged instead.
+ */
+void mo_mem_set_boot_arena_size(size_t size); //overrides MO_BOOT_ARENA_SIZE for the next mocpp_initialize(). 0 = disable
+
+void mo_mem_boot_arena_open();    //called by mocpp_initialize()
+void mo_mem_boot_arena_freeze();  //called at the end of mocpp_initialize()
+void mo_mem_boot_arena_release(); //called by mocpp_deinitialize()
+
+size_t mo_mem_get_boot_arena_used(); //bytes taken from the arena, including the objects which have been freed in the meantime
+size_t mo_mem_get_boot_arena_capacity();
+size_t mo_mem_get_boot_arena_blocks(); //number of objects in the arena
+
+void *mo_mem_malloc_boot(const char *tag, size_t size); //takes the block from the arena while it is open, otherwise like mo_mem_malloc()
+
+#define MO_MALLOC_BOOT mo_mem_malloc_boot
+#define MO_MEM_BOOT_ARENA_OPEN mo_mem_boot_arena_open
+#define MO_MEM_BOOT_ARENA_FREEZE mo_mem_boot_arena_freeze
+#define MO_MEM_BOOT_ARENA_RELEASE mo_mem_boot_arena_release
+
+#else
+#define MO_MALLOC_BOOT MO_MALLOC
+#define MO_MEM_BOOT_ARENA_OPEN(...) (void)0
+#define MO_MEM_BOOT_ARENA_FREEZE(...) (void)0
+#define MO_MEM_BOOT_ARENA_RELEASE(...) (void)0
+#endif //MO_ENABLE_BOOT_ARENA
+
+
 #ifdef __cplusplus
 }
 
@@ -107,6 +200,8 @@ class MemoryManaged {
 private:
     #if MO_ENABLE_HEAP_PROFILER
     char *tag = nullptr;
+    #elif MO_ENABLE_EXTERNAL_RAM
+    const char *tag = nullptr; //only the first part of the tag is kept for the placement rules. Must outlive this object (usually a string literal)
     #endif
 protected:
     void updateMemoryTag(const char *src1, const char *src2 = nullptr) {
@@ -130,13 +225,18 @@ protected:
         memset(tag, 0, size);
         snprintf(tag, size, "%s", src);
         mo_mem_set_tag(this, tag);
+        #elif MO_ENABLE_EXTERNAL_RAM
+        if (src1) {
+            tag = src1;
+        }
+        (void)src2;
         #else
         (void)src1;
         (void)src2;
         #endif
     }
     const char *getMemoryTag() const {
-        #if MO_ENABLE_HEAP_PROFILER
+        #if MO_ENABLE_HEAP_PROFILER || MO_ENABLE_EXTERNAL_RAM
         return tag;
         #else
         return nullptr;
@@ -144,14 +244,20 @@ protected:
     }
 public:
     void *operator new(size_t size) {
-        return MO_MALLOC(nullptr, size);
+        return MO_MALLOC_BOOT(nullptr, size);
+    }
+    void *operator new(size_t size, const char *tag) { //e.g. new ("v16.SmartCharging.ChargingProfile") ChargingProfile(). The tag selects the placement of the object
+        return MO_MALLOC_BOOT(tag, size);
     }
     void operator delete(void * ptr) {
         MO_FREE(ptr);
     }
+    void operator delete(void * ptr, const char*) {
+        MO_FREE(ptr);
+    }
 
     MemoryManaged(const char *tag = nullptr, const char *tag_suffix = nullptr) {
-        #if MO_ENABLE_HEAP_PROFILER
+        #if MO_ENABLE_HEAP_PROFILER || MO_ENABLE_EXTERNAL_RAM
         updateMemoryTag(tag, tag_suffix);
         #endif
     }
@@ -160,6 +266,8 @@ public:
         #if MO_ENABLE_HEAP_PROFILER
         tag = other.tag;
         other.tag = nullptr;
+        #elif MO_ENABLE_EXTERNAL_RAM
+        tag = other.tag;
         #endif
     }
 
@@ -171,12 +279,36 @@ public:
     }
 
     void operator=(const MemoryManaged& other) {
-        #if MO_ENABLE_HEAP_PROFILER
+        #if MO_ENABLE_HEAP_PROFILER || MO_ENABLE_EXTERNAL_RAM
         updateMemoryTag(other.tag);
         #endif
     }
 };
 
+/*
+ * Base class of objects which don't share the lifetime of the library, e.g. open files or the simulated
+ * flash of the memory filesystem. They are taken from the heap even while the boot arena is open, because
+ * freeing an object of the arena doesn't return its space and an object which outlives
+ * mocpp_deinitialize() would keep the whole region
+ */
+class TransientMemoryManaged : public MemoryManaged {
+public:
+    void *operator new(size_t size) {
+        return MO_MALLOC(nullptr, size);
+    }
+    void *operator new(size_t size, const char *tag) {
+        return MO_MALLOC(tag, size);
+    }
+    void operator delete(void * ptr) {
+        MO_FREE(ptr);
+    }
+    void operator delete(void * ptr, const char*) {
+        MO_FREE(ptr);
+    }
+
+    TransientMemoryManaged(const char *tag = nullptr, const char *tag_suffix = nullptr) : MemoryManaged(tag, tag_suffix) { }
+};
+
 template<class T>
 struct Allocator {
 
@@ -184,6 +316,9 @@ struct Allocator {
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(tag, tag_suffix);
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = mo_mem_get_placement(tag);
+        #endif
     }
 
     template<class U>
@@ -191,12 +326,18 @@ struct Allocator {
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(other.tag);
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = other.placement;
+        #endif
     }
 
     Allocator(const Allocator& other) {
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(other.tag);
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = other.placement;
+        #endif
     }
 
     //template<class U>
@@ -205,6 +346,9 @@ struct Allocator {
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(other.tag); //ignore move semantics for allocators as it simplifies moving std::vector<T, Allocator<T>>. This is okay because the Allocator's state is only the memory tag which is not exclusively owned
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = other.placement;
+        #endif
     }
 
     ~Allocator() {
@@ -218,7 +362,11 @@ struct Allocator {
     }
 
     T *allocate(size_t count) {
-        #if MO_ENABLE_HEAP_PROFILER
+        #if MO_ENABLE_EXTERNAL_RAM && MO_ENABLE_HEAP_PROFILER
+            return static_cast<T*>(mo_mem_malloc_placed(tag, placement, sizeof(T) * count));
+        #elif MO_ENABLE_EXTERNAL_RAM
+            return static_cast<T*>(mo_mem_malloc_placed(nullptr, placement, sizeof(T) * count));
+        #elif MO_ENABLE_HEAP_PROFILER
             return static_cast<T*>(MO_MALLOC(tag, sizeof(T) * count));
         #else
             return static_cast<T*>(MO_MALLOC(nullptr, sizeof(T) * count));
@@ -249,6 +397,10 @@ struct Allocator {
 
     typedef T value_type;
 
+    #if MO_ENABLE_EXTERNAL_RAM
+    int placement = MO_MEM_PLACEMENT_AUTO; //resolved once from the tag, so that allocate() doesn't evaluate the placement rules
+    #endif
+
     #if MO_ENABLE_HEAP_PROFILER
     char *tag = nullptr;
 
@@ -293,6 +445,10 @@ Vector<T> makeVector(const char *tag) {
 
 class ArduinoJsonAllocator {
 private:
+    #if MO_ENABLE_EXTERNAL_RAM
+    int placement = MO_MEM_PLACEMENT_AUTO;
+    #endif
+
     #if MO_ENABLE_HEAP_PROFILER
     char *tag = nullptr;
 
@@ -324,12 +480,18 @@ public:
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(tag, tag_suffix);
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = mo_mem_get_placement(tag);
+        #endif
     }
 
     ArduinoJsonAllocator(const ArduinoJsonAllocator& other) {
         #if MO_ENABLE_HEAP_PROFILER
         updateMemoryTag(other.tag);
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = other.placement;
+        #endif
     }
 
     ArduinoJsonAllocator(ArduinoJsonAllocator&& other) {
@@ -337,6 +499,9 @@ public:
         tag = other.tag;
         other.tag = nullptr;
         #endif
+        #if MO_ENABLE_EXTERNAL_RAM
+        placement = other.placement;
+        #endif
     }
 
     ~ArduinoJsonAllocator() {
@@ -349,7 +514,11 @@ public:
     }
 
     void *allocate(size_t size) {
-        #if MO_ENABLE_HEAP_PROFILER
+        #if MO_ENABLE_EXTERNAL_RAM && MO_ENABLE_HEAP_PROFILER
+            return mo_mem_malloc_placed(tag, placement, size);
+        #elif MO_ENABLE_EXTERNAL_RAM
+            return mo_mem_malloc_placed(nullptr, placement, size);
+        #elif MO_ENABLE_HEAP_PROFILER
             return MO_MALLOC(tag, size);
         #else
             return MO_MALLOC(nullptr, size);
@@ -365,7 +534,7 @@ using JsonDoc = BasicJsonDocument<ArduinoJsonAllocator>;
 template<class T, typename ...Args>
 T *mo_mem_new(const char *tag, Args&& ...args)  {
     if (auto ptr = MO_MALLOC(tag, sizeof(T))) {
-        return new(ptr) T(std::forward<Args>(args)...);
+        return ::new(ptr) T(std::forward<Args>(args)...);
     }
     return nullptr; //OOM
 }
@@ -391,11 +560,23 @@ protected:
     const char *getMemoryTag() const {return nullptr;}
     void updateMemoryTag(const char*,const char*) { } 
 public:
+    void *operator new(size_t size) {return ::operator new(size);}
+    void *operator new(size_t size, const char*) {return ::operator new(size);}
+    void operator delete(void *ptr) {::operator delete(ptr);}
+    void operator delete(void *ptr, const char*) {::operator delete(ptr);}
+
     MemoryManaged() { }
     MemoryManaged(const char*) { }
     MemoryManaged(const char*,const char*) { }
 };
 
+class TransientMemoryManaged : public MemoryManaged {
+public:
+    TransientMemoryManaged() { }
+    TransientMemoryManaged(const char*) { }
+    TransientMemoryManaged(const char*,const char*) { }
+};
+
 template<class T>
 using Allocator = ::std::allocator<T>;
 
@@ -66,6 +66,24 @@ public:
     virtual const char *getErrorCode() {return nullptr;} //nullptr means no error
     virtual const char *getErrorDescription() {return "";}
     virtual std::unique_ptr<JsonDoc> getErrorDetails() {return createEmptyDocument();}
+
+    /**
+     * Zero-copy interface for operations which handle their payload as JSON text, e.g. bindings to
+     * other languages. The received payload is a slice of the received OCPP-J frame (not
+     * null-terminated and only valid during the call). Return false if not supported, then
+     * processConf / processReq is called with the deserialized payload instead.
+     */
+    virtual bool processConfRaw(const char *payload, size_t len) {return false;}
+    virtual bool processReqRaw(const char *payload, size_t len) {return false;}
+
+    /**
+     * Write the payload directly into the send buffer. Returns the payload length, a value >= size
+     * if the buffer is too small (then it will be called again with a larger buffer), or a negative
+     * value if not supported, then createReq / createConf is used instead. The onSendConf listener
+     * is not executed for payloads written by writeConf.
+     */
+    virtual int writeReq(char *buf, size_t size) {return -1;}
+    virtual int writeConf(char *buf, size_t size) {return -1;}
 };
 
 } //end namespace MicroOcpp
@@ -29,7 +29,7 @@ namespace MicroOcpp {
 
 using namespace MicroOcpp;
 
-Request::Request(std::unique_ptr<Operation> msg) : MemoryManaged("Request.", msg->getOperationType()), messageID(makeString(getMemoryTag())), operation(std::move(msg)) {
+Request::Request(std::unique_ptr<Operation> msg) : MemoryManaged("Request.", msg->getOperationType()), operation(std::move(msg)) {
     timeout_start = mocpp_tick_ms();
     debugRequest_start = mocpp_tick_ms();
 }
@@ -58,15 +58,18 @@ void Request::executeTimeout() {
     timed_out = true;
 }
 
-void Request::setMessageID(const char *id){
+bool Request::setMessageID(const char *id){
     if (!messageID.empty()){
         MO_DBG_ERR("messageID already defined");
     }
-    messageID = id;
+    if (!messageID.set(id)) {
+        MO_DBG_ERR("messageID exceeds maximum length (%s)", id);
+        return false;
+    }
+    return true;
 }
 
-Request::CreateRequestResult Request::createRequest(JsonDoc& requestJson) {
-
+void Request::initMessageID() {
     if (messageID.empty()) {
         unsigned char random [18];
         char guuid [sizeof(random) * 2 + 1];
@@ -79,6 +82,11 @@ Request::CreateRequestResult Request::createRequest(JsonDoc& requestJson) {
         guuid[8] = guuid[13] = guuid[18] = guuid[23] = '-';
         messageID = guuid;
     }
+}
+
+Request::CreateRequestResult Request::createRequest(JsonDoc& requestJson) {
+
+    initMessageID();
 
     /*
      * Create the OCPP message
@@ -87,15 +95,16 @@ Request::CreateRequestResult Request::createRequest(JsonDoc& requestJson) {
     if (!requestPayload) {
         return CreateRequestResult::Failure;
     }
+    payloadCapacity = requestPayload->capacity();
 
     /*
      * Create OCPP-J Remote Procedure Call header
      */
-    size_t json_buffsize = JSON_ARRAY_SIZE(4) + (messageID.length() + 1) + requestPayload->capacity();
+    size_t json_buffsize = JSON_ARRAY_SIZE(4) + requestPayload->capacity();
     requestJson = initJsonDoc(getMemoryTag(), json_buffsize);
 
     requestJson.add(MESSAGE_TYPE_CALL);                    //MessageType
-    requestJson.add(messageID);                      //Unique message ID
+    requestJson.add(messageID.c_str());              //Unique message ID
     requestJson.add(operation->getOperationType());  //Action
     requestJson.add(*requestPayload);                      //Payload
 
@@ -120,11 +129,59 @@ Request::CreateRequestResult Request::createRequest(JsonDoc& requestJson) {
     return CreateRequestResult::Success;
 }
 
-bool Request::receiveResponse(JsonArray response){
+size_t Request::getPayloadCapacity() {
+    return payloadCapacity;
+}
+
+namespace {
+
+/*
+ * Append the payload to the RPC header of a raw OCPP-J frame. The payload writer has been given the
+ * available bytes after the header, which leaves one more byte for the closing bracket. Returns the frame
+ * length, or the required buffer size if the frame didn't fit. A retry with that size gives the writer
+ * payloadLen + 1 bytes, i.e. enough for the payload and its terminating zero
+ */
+int completeRawFrame(char *buf, int headerLen, size_t available, int payloadLen) {
+    if (headerLen < 0 || payloadLen < 0) {
+        return -1;
+    }
+    size_t frameLen = (size_t)headerLen + (size_t)payloadLen + 1; //closing bracket
+    if ((size_t)payloadLen >= available) {
+        return (int)(frameLen + 1); //buffer too small, let caller retry with this size
+    }
+    buf[frameLen - 1] = ']';
+    buf[frameLen] = '\0';
+    return (int)frameLen;
+}
+
+} //end namespace
+
+int Request::writeRequest(char *buf, size_t size) {
+
+    initMessageID();
+
+    int headerLen = snprintf(buf, size, "[%i,\"%s\",\"%s\",", MESSAGE_TYPE_CALL, messageID.c_str(), operation->getOperationType());
+    if (headerLen < 0) {
+        return -1;
+    }
+
+    if ((size_t)headerLen + 1 >= size) {
+        return headerLen + 2; //header doesn't fit. Retry with space for at least the closing bracket
+    }
+
+    //the payload writer gets the rest of the buffer. Its terminating zero is replaced by the closing bracket
+    size_t available = size - (size_t)headerLen - 1;
+
+    int payloadLen = operation->writeReq(buf + headerLen, available);
+
+    return completeRawFrame(buf, headerLen, available, payloadLen);
+}
+
+bool Request::receiveResponse(JsonArray response, const char *rawPayload, size_t rawPayloadLen){
     /*
      * check if messageIDs match. If yes, continue with this function. If not, return false for message not consumed
      */
-    if (messageID.compare(response[1].as<const char*>())){
+    if (!messageID.equals(response[1].as<const char*>())){
         return false;
     }
 
@@ -136,7 +193,9 @@ bool Request::receiveResponse(JsonArray response){
         * Hand the payload over to the Operation object
         */
         JsonObject payload = response[2];
-        operation->processConf(payload);
+        if (!rawPayload || !operation->processConfRaw(rawPayload, rawPayloadLen)) {
+            operation->processConf(payload);
+        }
 
         /*
         * Hand the payload over to the onReceiveConf Callback
@@ -170,20 +229,24 @@ bool Request::receiveResponse(JsonArray response){
 
 }
 
-bool Request::receiveRequest(JsonArray request) {
+bool Request::receiveRequest(JsonArray request, const char *rawPayload, size_t rawPayloadLen) {
 
     if (!request[1].is<const char*>()) {
         MO_DBG_ERR("malformatted msgId");
         return false;
     }
   
-    setMessageID(request[1].as<const char*>());
-    
+    if (!setMessageID(request[1].as<const char*>())) {
+        return false;
+    }
+
     /*
      * Hand the payload over to the Request object
      */
     JsonObject payload = request[3];
-    operation->processReq(payload);
+    if (!rawPayload || !operation->processReqRaw(rawPayload, rawPayloadLen)) {
+        operation->processReq(payload);
+    }
     
     /*
      * Hand the payload over to the first Callback. It is a callback that notifies the client that request has been processed in the OCPP-library
@@ -204,6 +267,7 @@ Request::CreateResponseResult Request::createResponse(JsonDoc& response) {
         if (!payload) {
             return CreateResponseResult::Pending; //confirmation message still pending
         }
+        payloadCapacity = payload->capacity();
 
         /*
          * Create OCPP-J Remote Procedure Call header
@@ -224,6 +288,7 @@ Request::CreateResponseResult Request::createResponse(JsonDoc& response) {
         const char *errorCode = operation->getErrorCode();
         const char *errorDescription = operation->getErrorDescription();
         std::unique_ptr<JsonDoc> errorDetails = operation->getErrorDetails();
+        payloadCapacity = errorDetails->capacity();
 
         /*
          * Create OCPP-J Remote Procedure Call header
@@ -242,6 +307,28 @@ Request::CreateResponseResult Request::createResponse(JsonDoc& response) {
     return CreateResponseResult::Success;
 }
 
+int Request::writeResponse(char *buf, size_t size) {
+
+    if (operation->getErrorCode()) {
+        return -1; //CallErrors are created by createResponse
+    }
+
+    int headerLen = snprintf(buf, size, "[%i,\"%s\",", MESSAGE_TYPE_CALLRESULT, messageID.c_str());
+    if (headerLen < 0) {
+        return -1;
+    }
+
+    if ((size_t)headerLen + 1 >= size) {
+        return headerLen + 2;
+    }
+
+    size_t available = size - (size_t)headerLen - 1;
+
+    int payloadLen = operation->writeConf(buf + headerLen, available);
+
+    return completeRawFrame(buf, headerLen, available, payloadLen);
+}
+
 void Request::setOnReceiveConfListener(OnReceiveConfListener onReceiveConf){
     if (onReceiveConf)
         onReceiveConfListener = onReceiveConf;
@@ -279,8 +366,8 @@ const char *Request::getOperationType() {
     return operation ? operation->getOperationType() : "UNDEFINED";
 }
 
-void Request::setRequestSent() {
-    requestSent = true;
+void Request::setRequestSent(bool sent) {
+    requestSent = sent;
 }
 
 bool Request::isRequestSent() {
@@ -14,6 +14,11 @@
 #include <MicroOcpp/Core/RequestCallbacks.h>
 
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
+
+#ifndef MO_REQUEST_MSGID_LEN_MAX
+#define MO_REQUEST_MSGID_LEN_MAX 36 //OCPP-J: messageIds have a maximum length of 36 characters
+#endif
 
 namespace MicroOcpp {
 
@@ -22,9 +27,10 @@ class Model;
 
 class Request : public MemoryManaged {
 private:
-    String messageID;
+    StaticString<MO_REQUEST_MSGID_LEN_MAX> messageID;
     std::unique_ptr<Operation> operation;
-    void setMessageID(const char *id);
+    bool setMessageID(const char *id);
+    void initMessageID();
     OnReceiveConfListener onReceiveConfListener = [] (JsonObject payload) {};
     OnReceiveReqListener onReceiveReqListener = [] (JsonObject payload) {};
     OnSendConfListener onSendConfListener = [] (JsonObject payload) {};
@@ -38,6 +44,8 @@ private:
     
     unsigned long debugRequest_start = 0;
 
+    size_t payloadCapacity = 0;
+
     bool requestSent = false;
 public:
 
@@ -66,19 +74,28 @@ public:
     };
     CreateRequestResult createRequest(JsonDoc& out);
 
+    size_t getPayloadCapacity(); //capacity of the payload doc of the last createRequest / createResponse call
+
+    /**
+     * Zero-copy alternative to createRequest for operations which write their payload directly
+     * (see Operation::writeReq). Writes the complete OCPP-J frame into buf and returns its length. Returns
+     * a value >= size if buf is too small, or a negative value if the operation doesn't support it
+     */
+    int writeRequest(char *buf, size_t size);
+
    /**
     * Decides if message belongs to this operation instance and if yes, proccesses it. Receives both Confirmations and Errors
     * 
     * Returns true if JSON object has been consumed, false otherwise.
     */
-    bool receiveResponse(JsonArray json);
+    bool receiveResponse(JsonArray json, const char *rawPayload = nullptr, size_t rawPayloadLen = 0);
 
     /**
      * Processes the request in the JSON document. Returns true on success, false on error.
      * 
      * Returns false if the request doesn't belong to the corresponding operation instance
      */
-    bool receiveRequest(JsonArray json);
+    bool receiveRequest(JsonArray json, const char *rawPayload = nullptr, size_t rawPayloadLen = 0);
 
     /**
      * After processing a request sent by the communication counterpart, this function sends a confirmation
@@ -93,6 +110,8 @@ public:
 
     CreateResponseResult createResponse(JsonDoc& out);
 
+    int writeResponse(char *buf, size_t size); //zero-copy alternative to createResponse, see writeRequest
+
     void setOnReceiveConfListener(OnReceiveConfListener onReceiveConf); //listener executed when we received the .conf() to a .req() we sent
     void setOnReceiveReqListener(OnReceiveReqListener onReceiveReq); //listener executed when we receive a .req()
     void setOnSendConfListener(OnSendConfListener onSendConf); //listener executed when we send a .conf() to a .req() we received
@@ -114,7 +133,7 @@ public:
 
     const char *getOperationType();
 
-    void setRequestSent();
+    void setRequestSent(bool sent = true); //false: the request is sent again, e.g. after a reconnect
     bool isRequestSent();
 };
 
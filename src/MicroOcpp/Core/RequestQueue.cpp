@@ -3,6 +3,7 @@
 // MIT License
 
 #include <limits>
+#include <algorithm>
 
 #include <MicroOcpp/Core/RequestQueue.h>
 #include <MicroOcpp/Core/Request.h>
@@ -10,10 +11,12 @@
 #include <MicroOcpp/Core/OcppError.h>
 #include <MicroOcpp/Core/OperationRegistry.h>
 #include <MicroOcpp/Operations/StatusNotification.h>
+#include <MicroOcpp/Platform.h>
 
 #include <MicroOcpp/Debug.h>
 
 size_t removePayload(const char *src, size_t src_size, char *dst, size_t dst_size);
+bool locatePayload(const char *frame, size_t frame_len, size_t index, size_t *payload_offset, size_t *payload_len);
 
 using namespace MicroOcpp;
 
@@ -76,6 +79,18 @@ std::unique_ptr<Request> VolatileRequestQueue::fetchFrontRequest() {
     return result;
 }
 
+void VolatileRequestQueue::setPriorityClass(PriorityClass priorityClass) {
+    this->priorityClass = priorityClass;
+}
+
+PriorityClass VolatileRequestQueue::getFrontRequestClass() {
+    return priorityClass;
+}
+
+size_t VolatileRequestQueue::getFreeCapacity() {
+    return MO_REQUEST_CACHE_MAXSIZE - len;
+}
+
 bool VolatileRequestQueue::pushRequestBack(std::unique_ptr<Request> request) {
 
     // Don't queue up multiple StatusNotification messages for the same connectorId
@@ -129,7 +144,15 @@ RequestQueue::RequestQueue(Connection& connection, OperationRegistry& operationR
     connection.setReceiveTXTcallback(callback);
 
     memset(sendQueues, 0, sizeof(sendQueues));
-    addSendQueue(&defaultSendQueue);
+    for (size_t i = 0; i < MO_NUM_REQUEST_QUEUES; i++) {
+        frontOpNrs[i] = RequestEmitter::NoOperation;
+        frontSince[i] = 0;
+    }
+
+    for (size_t i = 0; i < MO_NUM_PRIORITY_CLASSES; i++) {
+        defaultSendQueues[i].setPriorityClass((PriorityClass)i);
+        addSendQueue(&defaultSendQueues[i]);
+    }
 }
 
 void RequestQueue::loop() {
@@ -137,24 +160,46 @@ void RequestQueue::loop() {
     /*
      * Check if front request timed out
      */
+    linkMonitor.loop(mocpp_tick_ms());
+
     if (sendReqFront && sendReqFront->isTimeoutExceeded()) {
         MO_DBG_INFO("operation timeout: %s", sendReqFront->getOperationType());
+        if (sendReqFront->isRequestSent()) {
+            linkMonitor.onTimeout(mocpp_tick_ms());
+        }
         sendReqFront->executeTimeout();
-        sendReqFront.reset();
+        resetSendReqFront();
     }
 
     if (recvReqFront && recvReqFront->isTimeoutExceeded()) {
         MO_DBG_INFO("operation timeout: %s", recvReqFront->getOperationType());
         recvReqFront->executeTimeout();
-        recvReqFront.reset();
+        resetRecvReqFront();
     }
 
-    defaultSendQueue.loop();
+    for (auto& sendQueue : defaultSendQueues) {
+        sendQueue.loop();
+    }
 
     if (!connection.isConnected()) {
+        wasConnected = false;
         return;
     }
 
+    if (!wasConnected) {
+        wasConnected = true;
+        connectedSince = mocpp_tick_ms();
+
+        if (sendReqFront && sendReqFront->isRequestSent()) {
+            //the request or its response may have been lost with the previous connection. Requests without timeout
+            //would block the queue forever, so send it again with the same message ID
+            MO_DBG_INFO("resend after reconnect: %s", sendReqFront->getOperationType());
+            sendReqFront->setRequestSent(false);
+        }
+    }
+
+    loopFanouts();
+
     /**
      * Send and dequeue a pending confirmation message, if existing
      * 
@@ -167,22 +212,43 @@ void RequestQueue::loop() {
 
     if (recvReqFront) {
 
-        auto response = initJsonDoc(getMemoryTag());
-        auto ret = recvReqFront->createResponse(response);
+        if (!recvReqReservation) {
+            size_t reservation = jsonPool.getEstimate(recvReqFront->getOperationType());
+            if (!jsonPool.reserve(reservation)) {
+                //JSON budget exhausted. There will be another attempt to send this conf message in a future loop call
+                return;
+            }
+            recvReqReservation = reservation;
+        }
 
-        if (ret == Request::CreateResponseResult::Success) {
-            auto out = makeString(getMemoryTag());
-            serializeJson(response, out);
-    
+        auto out = makeString(getMemoryTag());
+        bool created = writeRawFrame(*recvReqFront, true, out);
+
+        if (!created) {
+            auto response = initJsonDoc(getMemoryTag());
+            if (recvReqFront->createResponse(response) == Request::CreateResponseResult::Success) {
+                serializeJson(response, out);
+
+                //payload doc and RPC envelope doc exist together, then the RPC envelope doc and the serialized message
+                jsonPool.updatePeak(recvReqFront->getOperationType(),
+                        response.capacity() + std::max(recvReqFront->getPayloadCapacity(), (size_t)out.capacity()));
+                created = true;
+            }
+        }
+
+        if (created) {
             bool success = connection.sendTXT(out.c_str(), out.length());
 
             if (success) {
                 MO_DBG_TRAFFIC_OUT(out.c_str());
-                recvReqFront.reset();
+                resetRecvReqFront();
             }
-
             return;
-        } //else: There will be another attempt to send this conf message in a future loop call
+        }
+
+        //conf still pending. Don't hold the budget meanwhile. There will be another attempt in a future loop call
+        jsonPool.release(recvReqReservation);
+        recvReqReservation = 0;
     }
 
     /**
@@ -190,47 +256,109 @@ void RequestQueue::loop() {
      */
 
     if (!sendReqFront) {
+        fetchNextRequest();
+    }
+
+    if (sendReqFront && !sendReqFront->isRequestSent()) {
 
-        unsigned int minOpNr = RequestEmitter::NoOperation;
-        size_t index = MO_NUM_REQUEST_QUEUES;
-        for (size_t i = 0; i < MO_NUM_REQUEST_QUEUES && sendQueues[i]; i++) {
-            auto opNr = sendQueues[i]->getFrontRequestOpNr();
-            if (opNr < minOpNr) {
-                minOpNr = opNr;
-                index = i;
+        if (!sendReqReservation) {
+            size_t reservation = jsonPool.getEstimate(sendReqFront->getOperationType());
+            if (!jsonPool.reserve(reservation)) {
+                //JSON budget exhausted. Keep request and try again in a future loop call
+                return;
             }
+            sendReqReservation = reservation; //held until the response has been processed
         }
 
-        if (index < MO_NUM_REQUEST_QUEUES) {
-            sendReqFront = sendQueues[index]->fetchFrontRequest();
-        }
-    }
+        auto out = makeString(getMemoryTag());
+        bool created = writeRawFrame(*sendReqFront, false, out);
 
-    if (sendReqFront && !sendReqFront->isRequestSent()) {
+        if (!created) {
+            auto request = initJsonDoc(getMemoryTag());
+            if (sendReqFront->createRequest(request) == Request::CreateRequestResult::Success) {
+                serializeJson(request, out);
 
-        auto request = initJsonDoc(getMemoryTag());
-        auto ret = sendReqFront->createRequest(request);
+                jsonPool.updatePeak(sendReqFront->getOperationType(),
+                        request.capacity() + std::max(sendReqFront->getPayloadCapacity(), (size_t)out.capacity()));
+                created = true;
+            }
+        }
 
-        if (ret == Request::CreateRequestResult::Success) {
+        if (created) {
 
             //send request
-            auto out = makeString(getMemoryTag());
-            serializeJson(request, out);
-
+            auto t_send = mocpp_tick_ms();
             bool success = connection.sendTXT(out.c_str(), out.length());
 
             if (success) {
                 MO_DBG_TRAFFIC_OUT(out.c_str());
                 sendReqFront->setRequestSent(); //mask as sent and wait for response / timeout
+                linkMonitor.onRequestSent(t_send);
             }
-
             return;
         }
+
+        jsonPool.release(sendReqReservation);
+        sendReqReservation = 0;
+    }
+}
+
+void RequestQueue::resetSendReqFront() {
+    sendReqFront.reset();
+    jsonPool.release(sendReqReservation);
+    sendReqReservation = 0;
+}
+
+void RequestQueue::resetRecvReqFront() {
+    recvReqFront.reset();
+    jsonPool.release(recvReqReservation);
+    recvReqReservation = 0;
+}
+
+void RequestQueue::fetchNextRequest() {
+
+    RequestScheduler::Candidate candidates [MO_NUM_REQUEST_QUEUES];
+    size_t order [MO_NUM_REQUEST_QUEUES];
+
+    auto now = mocpp_tick_ms();
+
+    size_t n = 0;
+    for (; n < MO_NUM_REQUEST_QUEUES && sendQueues[n]; n++) {
+        auto& candidate = candidates[n];
+        candidate.opNr = sendQueues[n]->getFrontRequestOpNr();
+        if (candidate.opNr != frontOpNrs[n]) {
+            //front has changed since last poll
+            frontOpNrs[n] = candidate.opNr;
+            frontSince[n] = now;
+        }
+        if (candidate.opNr != RequestEmitter::NoOperation) {
+            candidate.priorityClass = sendQueues[n]->getFrontRequestClass();
+            //time at the front of the queue while connected. Backlogs from offline periods and the
+            //age of the data which a message carries (e.g. old meter values) don't count as overdue
+            candidate.waitTime = std::min(now - frontSince[n], now - connectedSince);
+        }
+    }
+
+    size_t count = scheduler.rank(candidates, n, order);
+
+    //if a queue can't send its front yet (e.g. retry back-off), give the next queue a chance
+    for (size_t i = 0; i < count && !sendReqFront; i++) {
+        size_t index = order[i];
+        sendReqFront = sendQueues[index]->fetchFrontRequest();
+        if (sendReqFront) {
+            frontOpNrs[index] = RequestEmitter::NoOperation; //the next front starts waiting now
+            MO_DBG_VERBOSE("fetched %s (%s, waited %lu ms)", sendReqFront->getOperationType(),
+                    serializePriorityClass(candidates[index].priorityClass), candidates[index].waitTime);
+        }
     }
 }
 
 void RequestQueue::sendRequest(std::unique_ptr<Request> op){
-    defaultSendQueue.pushRequestBack(std::move(op));
+    if (!op) {
+        return;
+    }
+    auto priorityClass = scheduler.getPriorityClass(op->getOperationType());
+    defaultSendQueues[(size_t)priorityClass].pushRequestBack(std::move(op));
 }
 
 void RequestQueue::sendRequestPreBoot(std::unique_ptr<Request> op){
@@ -241,6 +369,53 @@ void RequestQueue::sendRequestPreBoot(std::unique_ptr<Request> op){
     preBootSendQueue->pushRequestBack(std::move(op));
 }
 
+bool RequestQueue::sendFanoutPreBoot(const char *operationType, unsigned int count, FanoutProducer producer) {
+    Fanout *slot = nullptr;
+    for (auto& fanout : fanouts) {
+        if (fanout.operationType && !strcmp(fanout.operationType, operationType)) {
+            slot = &fanout; //restart
+            break;
+        }
+        if (!fanout.operationType && !slot) {
+            slot = &fanout;
+        }
+    }
+
+    if (!slot) {
+        MO_DBG_ERR("exceeded MO_NUM_FANOUTS");
+        return false;
+    }
+
+    slot->operationType = operationType;
+    slot->cursor = 0;
+    slot->count = count;
+    slot->producer = std::move(producer);
+
+    loopFanouts();
+    return true;
+}
+
+void RequestQueue::loopFanouts() {
+    if (!preBootSendQueue) {
+        return;
+    }
+
+    for (auto& fanout : fanouts) {
+        //fill up the preBootQueue at most halfway and leave the rest to other messages
+        while (fanout.operationType && preBootSendQueue->getFreeCapacity() > MO_REQUEST_CACHE_MAXSIZE / 2) {
+            if (fanout.cursor >= fanout.count) {
+                fanout.operationType = nullptr;
+                fanout.producer = nullptr;
+                break;
+            }
+            if (auto request = fanout.producer(fanout.cursor)) {
+                preBootSendQueue->pushRequestBack(std::move(request));
+            }
+            fanout.cursor++;
+        }
+    }
+}
+
 void RequestQueue::addSendQueue(RequestEmitter* sendQueue) {
     for (size_t i = 0; i < MO_NUM_REQUEST_QUEUES; i++) {
         if (!sendQueues[i]) {
@@ -260,6 +435,52 @@ unsigned int RequestQueue::getNextOpNr() {
     return nextOpNr++;
 }
 
+JsonPool& RequestQueue::getJsonPool() {
+    return jsonPool;
+}
+
+RequestScheduler& RequestQueue::getScheduler() {
+    return scheduler;
+}
+
+LinkMonitor& RequestQueue::getLinkMonitor() {
+    return linkMonitor;
+}
+
+bool RequestQueue::writeRawFrame(Request& request, bool response, String& out) {
+
+    //start with the usual size of this operation. The writers return the required size if it's too small
+    size_t size = std::min(jsonPool.getEstimate(request.getOperationType()), (size_t)MO_MAX_JSON_CAPACITY);
+
+    while (true) {
+        out.resize(size);
+        int ret = response ?
+                request.writeResponse(&out[0], size) :
+                request.writeRequest(&out[0], size);
+        if (ret < 0) {
+            //operation uses JSON documents instead
+            break;
+        }
+        if ((size_t)ret < size) {
+            out.resize((size_t)ret);
+            jsonPool.updatePeak(request.getOperationType(), size);
+            return true;
+        }
+        if ((size_t)ret == size) {
+            MO_DBG_ERR("%s: payload writer doesn't converge", request.getOperationType());
+            break;
+        }
+        if ((size_t)ret > MO_MAX_JSON_CAPACITY) {
+            MO_DBG_ERR("%s exceeds maximum message size", request.getOperationType());
+            break;
+        }
+        size = (size_t)ret;
+    }
+
+    out.clear();
+    return false;
+}
+
 bool RequestQueue::receiveMessage(const char* payload, size_t length) {
 
     MO_DBG_TRAFFIC_IN((int) length, payload);
@@ -291,18 +512,34 @@ bool RequestQueue::receiveMessage(const char* payload, size_t length) {
 
     switch (err.code()) {
         case DeserializationError::Ok: {
+            //incoming messages can't be deferred. Account them so that outgoing messages wait until they're processed
+            jsonPool.reserveForced(doc.capacity());
+
             int messageTypeId = doc[0] | -1;
 
+            //slice of the payload within the received frame for zero-copy processing
+            size_t payload_offset = 0, payload_len = 0;
+            const char *rawPayload = nullptr;
+
             if (messageTypeId == MESSAGE_TYPE_CALL) {
-                receiveRequest(doc.as<JsonArray>());      
+                if (locatePayload(payload, length, 3, &payload_offset, &payload_len)) {
+                    rawPayload = payload + payload_offset;
+                }
+                receiveRequest(doc.as<JsonArray>(), rawPayload, payload_len);
                 success = true;
             } else if (messageTypeId == MESSAGE_TYPE_CALLRESULT ||
                     messageTypeId == MESSAGE_TYPE_CALLERROR) {
-                receiveResponse(doc.as<JsonArray>());
+                if (messageTypeId == MESSAGE_TYPE_CALLRESULT &&
+                        locatePayload(payload, length, 2, &payload_offset, &payload_len)) {
+                    rawPayload = payload + payload_offset;
+                }
+                receiveResponse(doc.as<JsonArray>(), rawPayload, payload_len);
                 success = true;
             } else {
                 MO_DBG_WARN("Invalid OCPP message! (though JSON has successfully been deserialized)");
             }
+
+            jsonPool.release(doc.capacity());
             break; 
         }
         case DeserializationError::InvalidInput:
@@ -351,26 +588,33 @@ bool RequestQueue::receiveMessage(const char* payload, size_t length) {
  * This function could result in improper behavior in Charging Stations, because messages are not
  * guaranteed to be received and therefore processed in the right order.
  */
-void RequestQueue::receiveResponse(JsonArray json) {
+void RequestQueue::receiveResponse(JsonArray json, const char *rawPayload, size_t rawPayloadLen) {
 
-    if (!sendReqFront || !sendReqFront->receiveResponse(json)) {
+    if (sendReqFront && sendReqFront->receiveResponse(json, rawPayload, rawPayloadLen)) {
+        linkMonitor.onResponse(mocpp_tick_ms());
+    } else {
         MO_DBG_WARN("Received response doesn't match pending operation");
+        linkMonitor.onTimeout(mocpp_tick_ms()); //the pending operation is dropped without response
     }
 
-    sendReqFront.reset();
+    resetSendReqFront();
 }
 
-void RequestQueue::receiveRequest(JsonArray json) {
+void RequestQueue::receiveRequest(JsonArray json, const char *rawPayload, size_t rawPayloadLen) {
     auto op = operationRegistry.deserializeOperation(json[2] | "UNDEFINED");
     if (op == nullptr) {
         MO_DBG_WARN("OOM");
         return;
     }
-    receiveRequest(json, std::move(op));
+    receiveRequest(json, std::move(op), rawPayload, rawPayloadLen);
 }
 
-void RequestQueue::receiveRequest(JsonArray json, std::unique_ptr<Request> op) {
-    op->receiveRequest(json); //execute the operation
+void RequestQueue::receiveRequest(JsonArray json, std::unique_ptr<Request> op, const char *rawPayload, size_t rawPayloadLen) {
+    if (!op->receiveRequest(json, rawPayload, rawPayloadLen)) { //execute the operation
+        MO_DBG_WARN("drop malformatted request");
+        return;
+    }
+    linkMonitor.onRequestReceived(mocpp_tick_ms());
     recvQueue.pushRequestBack(std::move(op)); //enqueue so loop() plans conf sending
 }
 
@@ -406,3 +650,103 @@ size_t removePayload(const char *src, size_t src_size, char *dst, size_t dst_siz
     res_len++;
     return res_len;
 }
+
+namespace {
+
+size_t skipWhitespace(const char *src, size_t src_size, size_t i) {
+    while (i < src_size && (src[i] == ' ' || src[i] == '\t' || src[i] == '\n' || src[i] == '\r')) {
+        i++;
+    }
+    return i;
+}
+
+/*
+ * Returns the position after the JSON value which starts at position i. Expects a syntactically valid
+ * input, i.e. the frame must have been deserialized successfully before
+ */
+size_t skipValue(const char *src, size_t src_size, size_t i) {
+    int depth = 0;
+    bool inString = false;
+    for (; i < src_size; i++) {
+        char c = src[i];
+        if (inString) {
+            if (c == '\\') {
+                i++; //skip escaped character
+            } else if (c == '"') {
+                inString = false;
+                if (depth == 0) {
+                    return i + 1;
+                }
+            }
+            continue;
+        }
+        switch (c) {
+            case '"':
+                inString = true;
+                break;
+            case '{':
+            case '[':
+                depth++;
+                break;
+            case '}':
+            case ']':
+                if (depth == 0) {
+                    return i; //end of enclosing array
+                }
+                depth--;
+                if (depth == 0) {
+                    return i + 1;
+                }
+                break;
+            case ',':
+                if (depth == 0) {
+                    return i;
+                }
+                break;
+            default:
+                break;
+        }
+    }
+    return i;
+}
+
+} //end namespace
+
+/*
+ * Finds the element at position index of the OCPP-J frame and returns its offset and length within the
+ * frame. This allows to pass the payload of a received message as a slice of the original input, e.g.
+ *
+ * [2, "75705e50-682d-404e-b400-1bca33d41e19", "ChangeConfiguration", {"key":"a","value":"b"}]
+ *                                                                     ^-----------------------^
+ *                                                                     index 3
+ */
+bool locatePayload(const char *frame, size_t frame_len, size_t index, size_t *payload_offset, size_t *payload_len) {
+    size_t i = skipWhitespace(frame, frame_len, 0);
+    if (i >= frame_len || frame[i] != '[') {
+        return false;
+    }
+    i++;
+
+    for (size_t k = 0; k < index; k++) {
+        i = skipWhitespace(frame, frame_len, i);
+        i = skipValue(frame, frame_len, i);
+        i = skipWhitespace(frame, frame_len, i);
+        if (i >= frame_len || frame[i] != ',') {
+            return false;
+        }
+        i++;
+    }
+
+    size_t begin = skipWhitespace(frame, frame_len, i);
+    size_t end = skipValue(frame, frame_len, begin);
+    while (end > begin && (frame[end - 1] == ' ' || frame[end - 1] == '\t' || frame[end - 1] == '\n' || frame[end - 1] == '\r')) {
+        end--;
+    }
+    if (begin >= end) {
+        return false;
+    }
+
+    *payload_offset = begin;
+    *payload_len = end - begin;
+    return true;
+}
@@ -9,8 +9,12 @@
 
 #include <MicroOcpp/Core/Connection.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/JsonPool.h>
+#include <MicroOcpp/Core/RequestScheduler.h>
+#include <MicroOcpp/Core/LinkMonitor.h>
 
 #include <memory>
+#include <functional>
 #include <ArduinoJson.h>
 
 #ifndef MO_REQUEST_CACHE_MAXSIZE
@@ -18,7 +22,11 @@
 #endif
 
 #ifndef MO_NUM_REQUEST_QUEUES
-#define MO_NUM_REQUEST_QUEUES 10
+#define MO_NUM_REQUEST_QUEUES 16
+#endif
+
+#ifndef MO_NUM_FANOUTS
+#define MO_NUM_FANOUTS 2 //concurrent fan-outs, e.g. TriggerMessage for MeterValues and StatusNotification of all connectors
 #endif
 
 namespace MicroOcpp {
@@ -33,12 +41,15 @@ public:
 
     virtual unsigned int getFrontRequestOpNr() = 0; //return OpNr of front request or NoOperation if queue is empty
     virtual std::unique_ptr<Request> fetchFrontRequest() = 0;
+
+    virtual PriorityClass getFrontRequestClass() {return PriorityClass::Transactional;} //see RequestScheduler
 };
 
 class VolatileRequestQueue : public RequestEmitter, public MemoryManaged {
 private:
     std::unique_ptr<Request> requests [MO_REQUEST_CACHE_MAXSIZE];
     size_t front = 0, len = 0;
+    PriorityClass priorityClass = PriorityClass::Transactional;
 public:
     VolatileRequestQueue();
     ~VolatileRequestQueue();
@@ -47,30 +58,66 @@ public:
     unsigned int getFrontRequestOpNr() override;
     std::unique_ptr<Request> fetchFrontRequest() override;
 
+    void setPriorityClass(PriorityClass priorityClass);
+    PriorityClass getFrontRequestClass() override;
+
     bool pushRequestBack(std::unique_ptr<Request> request);
+
+    size_t getFreeCapacity();
 };
 
+/*
+ * Creates the request for index (e.g. connectorId) of a fan-out or nullptr if there is nothing to send
+ * for this index
+ */
+using FanoutProducer = std::function<std::unique_ptr<Request>(unsigned int index)>;
+
 class RequestQueue : public MemoryManaged {
 private:
     Connection& connection;
     OperationRegistry& operationRegistry;
 
     RequestEmitter* sendQueues [MO_NUM_REQUEST_QUEUES];
-    VolatileRequestQueue defaultSendQueue;
+    VolatileRequestQueue defaultSendQueues [MO_NUM_PRIORITY_CLASSES]; //one per priority class
     VolatileRequestQueue *preBootSendQueue = nullptr;
     std::unique_ptr<Request> sendReqFront;
+    size_t sendReqReservation = 0; //JSON budget held by sendReqFront until it has been answered or timed out
 
     VolatileRequestQueue recvQueue;
     std::unique_ptr<Request> recvReqFront;
+    size_t recvReqReservation = 0; //JSON budget held by recvReqFront until its conf has been sent
+
+    JsonPool jsonPool; //memory budget for all messages in flight
+    void resetSendReqFront(); //drop sendReqFront and release its reservation
+    void resetRecvReqFront();
+
+    RequestScheduler scheduler;
+    LinkMonitor linkMonitor;
+    unsigned int frontOpNrs [MO_NUM_REQUEST_QUEUES]; //front of each send queue when it was last polled
+    unsigned long frontSince [MO_NUM_REQUEST_QUEUES]; //since when the front has been waiting
+    bool wasConnected = false;
+    unsigned long connectedSince = 0; //requests only age while the connection is up
+    void fetchNextRequest();
 
     bool receiveMessage(const char* payload, size_t length); //receive from  server: either a request or response
-    void receiveRequest(JsonArray json);
-    void receiveRequest(JsonArray json, std::unique_ptr<Request> op);
-    void receiveResponse(JsonArray json);
+    void receiveRequest(JsonArray json, const char *rawPayload = nullptr, size_t rawPayloadLen = 0);
+    void receiveRequest(JsonArray json, std::unique_ptr<Request> op, const char *rawPayload = nullptr, size_t rawPayloadLen = 0);
+    void receiveResponse(JsonArray json, const char *rawPayload = nullptr, size_t rawPayloadLen = 0);
+
+    bool writeRawFrame(Request& request, bool response, String& out); //zero-copy serialization, see Operation::writeReq
+
+    struct Fanout {
+        const char *operationType = nullptr; //nullptr = unused
+        unsigned int cursor = 0;
+        unsigned int count = 0;
+        FanoutProducer producer;
+    };
+    Fanout fanouts [MO_NUM_FANOUTS];
+    void loopFanouts();
 
     unsigned long sockTrackLastConnected = 0;
 
-    unsigned int nextOpNr = 10; //Nr 0 - 9 reservered for internal purposes
+    unsigned int nextOpNr = RequestScheduler::SequencedOpNr; //Nr 0 - 9 reservered for internal purposes
 public:
     RequestQueue() = delete;
     RequestQueue(const RequestQueue&) = delete;
@@ -83,10 +130,24 @@ public:
     void sendRequest(std::unique_ptr<Request> request); //send an OCPP operation request to the server; adds request to default queue
     void sendRequestPreBoot(std::unique_ptr<Request> request); //send an OCPP operation request to the server; adds request to preBootQueue
 
+    /*
+     * Sends a request of the same operationType for index = 0 ... count - 1 via the preBootQueue. The
+     * requests are created one by one when the preBootQueue has capacity, so that large fan-outs don't
+     * evict other messages. A new fan-out with the same operationType restarts the previous one.
+     * operationType must be a static string. Returns false if the fan-out capacity is exhausted
+     */
+    bool sendFanoutPreBoot(const char *operationType, unsigned int count, FanoutProducer producer);
+
     void addSendQueue(RequestEmitter* sendQueue);
     void setPreBootSendQueue(VolatileRequestQueue *preBootQueue);
 
     unsigned int getNextOpNr();
+
+    JsonPool& getJsonPool();
+
+    RequestScheduler& getScheduler(); //priority classes and deadlines of outgoing requests
+
+    LinkMonitor& getLinkMonitor(); //round-trip times and link health
 };
 
 } //end namespace MicroOcpp
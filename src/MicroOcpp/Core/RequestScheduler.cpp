@@ -0,0 +1,195 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/RequestScheduler.h>
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+
+using namespace MicroOcpp;
+
+namespace MicroOcpp {
+
+const char *serializePriorityClass(PriorityClass priorityClass) {
+    switch (priorityClass) {
+        case PriorityClass::Interactive:
+            return "Interactive";
+        case PriorityClass::Transactional:
+            return "Transactional";
+        case PriorityClass::Telemetry:
+            return "Telemetry";
+        case PriorityClass::Bulk:
+            return "Bulk";
+    }
+    return "_Undefined";
+}
+
+} //namespace MicroOcpp
+
+namespace {
+
+struct DefaultClass {
+    const char *operationType;
+    PriorityClass priorityClass;
+};
+
+//operation types which are not listed here are Transactional
+const DefaultClass defaultClasses [] = {
+    {"Authorize",                       PriorityClass::Interactive},
+    {"MeterValues",                     PriorityClass::Telemetry},
+    {"Heartbeat",                       PriorityClass::Telemetry},
+    {"DiagnosticsStatusNotification",   PriorityClass::Bulk},
+    {"FirmwareStatusNotification",      PriorityClass::Bulk},
+    {"LogStatusNotification",           PriorityClass::Bulk},
+    {"SecurityEventNotification",       PriorityClass::Bulk},
+    {"SignedFirmwareStatusNotification",PriorityClass::Bulk},
+    {"NotifyReport",                    PriorityClass::Bulk},
+};
+
+} //namespace
+
+RequestScheduler::RequestScheduler() : MemoryManaged("RequestScheduler"), overrides(makeVector<ClassOverride>(getMemoryTag())) {
+    deadlines[(size_t)PriorityClass::Interactive] = MO_PRIORITY_DEADLINE_INTERACTIVE;
+    deadlines[(size_t)PriorityClass::Transactional] = MO_PRIORITY_DEADLINE_TRANSACTIONAL;
+    deadlines[(size_t)PriorityClass::Telemetry] = MO_PRIORITY_DEADLINE_TELEMETRY;
+    deadlines[(size_t)PriorityClass::Bulk] = MO_PRIORITY_DEADLINE_BULK;
+}
+
+void RequestScheduler::setPriorityClass(const char *operationType, PriorityClass priorityClass) {
+    if (!operationType || strlen(operationType) > MO_PRIORITY_OPTYPE_LEN_MAX) {
+        MO_DBG_ERR("invalid operationType");
+        return;
+    }
+
+    for (auto& entry : overrides) {
+        if (!strcmp(entry.operationType.c_str(), operationType)) {
+            entry.priorityClass = priorityClass;
+            return;
+        }
+    }
+
+    if (overrides.size() >= MO_PRIORITY_OVERRIDES_MAX) {
+        MO_DBG_ERR("exceeded MO_PRIORITY_OVERRIDES_MAX");
+        return;
+    }
+
+    ClassOverride entry;
+    entry.operationType.set(operationType);
+    entry.priorityClass = priorityClass;
+    overrides.push_back(entry);
+}
+
+PriorityClass RequestScheduler::getPriorityClass(const char *operationType) {
+    if (!operationType) {
+        return PriorityClass::Transactional;
+    }
+
+    for (const auto& entry : overrides) {
+        if (!strcmp(entry.operationType.c_str(), operationType)) {
+            return entry.priorityClass;
+        }
+    }
+
+    for (const auto& entry : defaultClasses) {
+        if (!strcmp(entry.operationType, operationType)) {
+            return entry.priorityClass;
+        }
+    }
+
+    return PriorityClass::Transactional;
+}
+
+void RequestScheduler::setDeadline(PriorityClass priorityClass, unsigned long deadlineMs) {
+    deadlines[(size_t)priorityClass] = deadlineMs;
+}
+
+unsigned long RequestScheduler::getDeadline(PriorityClass priorityClass) {
+    return deadlines[(size_t)priorityClass];
+}
+
+bool RequestScheduler::isOverdue(const Candidate& candidate) {
+    auto deadline = deadlines[(size_t)candidate.priorityClass];
+    return deadline && candidate.waitTime >= deadline;
+}
+
+bool RequestScheduler::precedes(const Candidate& a, const Candidate& b) {
+
+    bool aOverdue = isOverdue(a);
+    bool bOverdue = isOverdue(b);
+
+    if (aOverdue != bOverdue) {
+        return aOverdue;
+    }
+
+    if (aOverdue && bOverdue) {
+        auto aExcess = a.waitTime - deadlines[(size_t)a.priorityClass];
+        auto bExcess = b.waitTime - deadlines[(size_t)b.priorityClass];
+        if (aExcess != bExcess) {
+            return aExcess > bExcess;
+        }
+    }
+
+    if (a.priorityClass != b.priorityClass) {
+        return a.priorityClass < b.priorityClass;
+    }
+
+    return a.opNr < b.opNr;
+}
+
+size_t RequestScheduler::rank(const Candidate *candidates, size_t n, size_t *order) {
+
+    size_t sequencedIndex = n; //sequenced candidate with the lowest OpNr
+    PriorityClass sequencedClass = PriorityClass::Bulk; //highest class of all sequenced candidates
+
+    for (size_t i = 0; i < n; i++) {
+        const auto& candidate = candidates[i];
+        if (candidate.opNr == 0) {
+            //blocks all other queues
+            order[0] = i;
+            return 1;
+        }
+        if (candidate.opNr != NoOperation && candidate.opNr >= SequencedOpNr) {
+            if (sequencedIndex >= n || candidate.opNr < candidates[sequencedIndex].opNr) {
+                sequencedIndex = i;
+            }
+            if (candidate.priorityClass < sequencedClass) {
+                sequencedClass = candidate.priorityClass;
+            }
+        }
+    }
+
+    Candidate sequencedCandidate;
+    if (sequencedIndex < n) {
+        sequencedCandidate = candidates[sequencedIndex];
+        sequencedCandidate.priorityClass = sequencedClass;
+    }
+
+    //insertion sort, stable for equal ranks
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        if (candidates[i].opNr == NoOperation) {
+            continue;
+        }
+        if (candidates[i].opNr >= SequencedOpNr && i != sequencedIndex) {
+            continue;
+        }
+
+        const auto& candidate = i == sequencedIndex ? sequencedCandidate : candidates[i];
+
+        size_t pos = count;
+        while (pos > 0) {
+            size_t prev = order[pos - 1];
+            const auto& prevCandidate = prev == sequencedIndex ? sequencedCandidate : candidates[prev];
+            if (!precedes(candidate, prevCandidate)) {
+                break;
+            }
+            order[pos] = prev;
+            pos--;
+        }
+        order[pos] = i;
+        count++;
+    }
+
+    return count;
+}
@@ -0,0 +1,113 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_REQUESTSCHEDULER_H
+#define MO_REQUESTSCHEDULER_H
+
+#include <stddef.h>
+#include <limits>
+
+#include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
+
+/*
+ * Deadlines of the priority classes in ms. A request which waits longer than its deadline at the front of
+ * its send queue is sent before requests of higher classes (starvation protection). 0 = no deadline
+ */
+#ifndef MO_PRIORITY_DEADLINE_INTERACTIVE
+#define MO_PRIORITY_DEADLINE_INTERACTIVE 2000
+#endif
+
+#ifndef MO_PRIORITY_DEADLINE_TRANSACTIONAL
+#define MO_PRIORITY_DEADLINE_TRANSACTIONAL 10000
+#endif
+
+#ifndef MO_PRIORITY_DEADLINE_TELEMETRY
+#define MO_PRIORITY_DEADLINE_TELEMETRY 60000
+#endif
+
+#ifndef MO_PRIORITY_DEADLINE_BULK
+#define MO_PRIORITY_DEADLINE_BULK 300000
+#endif
+
+#ifndef MO_PRIORITY_OVERRIDES_MAX
+#define MO_PRIORITY_OVERRIDES_MAX 16 //number of operation types which can be assigned to a different class at runtime
+#endif
+
+#define MO_PRIORITY_OPTYPE_LEN_MAX 32
+
+namespace MicroOcpp {
+
+/*
+ * Priority classes of outgoing requests, from highest to lowest priority
+ */
+enum class PriorityClass : unsigned char {
+    Interactive,   //a user is waiting for the result, e.g. Authorize
+    Transactional, //StartTransaction, StopTransaction, TransactionEvent, StatusNotification and unclassified operations
+    Telemetry,     //MeterValues, Heartbeat
+    Bulk           //status reports of long-running jobs and security events, e.g. FirmwareStatusNotification
+};
+
+#define MO_NUM_PRIORITY_CLASSES 4
+
+const char *serializePriorityClass(PriorityClass priorityClass);
+
+/*
+ * Scheduling policy of the RequestQueue. Only one request can be in flight at a time, so whenever the
+ * connection is idle, the RequestQueue ranks the fronts of all send queues and sends the first one:
+ *
+ * 1. An OpNr of 0 blocks all other send queues (BootNotification before the registration is accepted)
+ * 2. OpNrs from RequestScheduler::SequencedOpNr on are sequence numbers of transaction-related messages.
+ *    They must be sent in order, so only the lowest of them is eligible. It inherits the highest class
+ *    of the sequenced messages which wait behind it (priority inheritance)
+ * 3. Requests which exceed the deadline of their class come first, the most overdue request first
+ * 4. Then the request with the highest class, then the lower OpNr
+ *
+ * Confirmations to requests from the server are always sent before any request.
+ */
+class RequestScheduler : public MemoryManaged {
+public:
+    static const unsigned int NoOperation = std::numeric_limits<unsigned int>::max(); //see RequestEmitter::NoOperation
+    static const unsigned int SequencedOpNr = 10; //OpNrs 0 - 9 are reserved for internal purposes
+
+    struct Candidate {
+        PriorityClass priorityClass = PriorityClass::Transactional;
+        unsigned int opNr = 0;
+        unsigned long waitTime = 0; //ms which the request has been waiting at the front of its queue
+    };
+private:
+    unsigned long deadlines [MO_NUM_PRIORITY_CLASSES];
+
+    struct ClassOverride {
+        StaticString<MO_PRIORITY_OPTYPE_LEN_MAX> operationType;
+        PriorityClass priorityClass;
+    };
+    Vector<ClassOverride> overrides;
+
+    bool isOverdue(const Candidate& candidate);
+public:
+    RequestScheduler();
+
+    /*
+     * Assign operation types to classes. Operation types without entry default to Transactional
+     */
+    void setPriorityClass(const char *operationType, PriorityClass priorityClass);
+    PriorityClass getPriorityClass(const char *operationType);
+
+    void setDeadline(PriorityClass priorityClass, unsigned long deadlineMs); //0 = no deadline
+    unsigned long getDeadline(PriorityClass priorityClass);
+
+    bool precedes(const Candidate& a, const Candidate& b); //if a must be sent before b
+
+    /*
+     * Rank the fronts of the send queues. candidates[i] describes the front of send queue i. Writes the
+     * indices of the eligible candidates in the order in which they should be tried into order (of
+     * size n) and returns their number
+     */
+    size_t rank(const Candidate *candidates, size_t n, size_t *order);
+};
+
+} //namespace MicroOcpp
+
+#endif
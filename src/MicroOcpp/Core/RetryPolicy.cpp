@@ -0,0 +1,134 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/RetryPolicy.h>
+#include <MicroOcpp/Platform.h>
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+
+using namespace MicroOcpp;
+
+namespace {
+
+//finalizer of MurmurHash3
+uint32_t mix32(uint32_t h) {
+    h ^= h >> 16;
+    h *= 0x85ebca6b;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35;
+    h ^= h >> 16;
+    return h;
+}
+
+//CALLERROR codes which indicate that the server cannot process the message in its current form
+const char *const permanentErrors [] = {
+    "NotImplemented",
+    "NotSupported",
+    "ProtocolError",
+    "SecurityError",
+    "FormationViolation",
+    "FormatViolation", //OCPP 2.0.1 spelling
+    "PropertyConstraintViolation",
+    "OccurenceConstraintViolation",
+    "OccurrenceConstraintViolation", //OCPP 2.0.1 spelling
+    "TypeConstraintViolation",
+};
+
+} //namespace
+
+namespace MicroOcpp {
+
+RetryDecision classifyCallError(const char *errorCode) {
+    if (!errorCode) {
+        return RetryDecision::Retry;
+    }
+    for (size_t i = 0; i < sizeof(permanentErrors) / sizeof(permanentErrors[0]); i++) {
+        if (!strcmp(errorCode, permanentErrors[i])) {
+            return RetryDecision::GiveUp;
+        }
+    }
+    return RetryDecision::Retry; //InternalError, GenericError and unknown codes
+}
+
+} //namespace MicroOcpp
+
+RetryPolicy::RetryPolicy() : MemoryManaged("RetryPolicy") {
+    seed = mix32((uint32_t)mocpp_tick_ms() ^ 0x9e3779b9);
+}
+
+void RetryPolicy::setJitter(unsigned int percent) {
+    if (percent > 100) {
+        MO_DBG_ERR("invalid jitter");
+        return;
+    }
+    jitter = percent;
+}
+
+void RetryPolicy::addEntropy(const char *data, size_t len) {
+    //FNV-1a
+    uint32_t h = 2166136261U;
+    for (size_t i = 0; i < len; i++) {
+        h ^= (unsigned char)data[i];
+        h *= 16777619U;
+    }
+    seed = mix32(seed ^ h);
+}
+
+unsigned long RetryPolicy::getRetryDelay(unsigned int attemptNr, unsigned long interval, uint32_t salt, unsigned long backoffMax) const {
+    if (attemptNr == 0 || interval == 0) {
+        return 0;
+    }
+
+    if (backoffMax < interval) {
+        backoffMax = interval;
+    }
+
+#if MO_RETRY_BACKOFF_EXPONENTIAL
+    unsigned long delay = interval;
+    for (unsigned int i = 1; i < attemptNr && delay < backoffMax; i++) {
+        delay *= 2;
+    }
+#else
+    unsigned long delay = attemptNr <= backoffMax / interval ? interval * attemptNr : backoffMax;
+#endif
+
+    if (delay > backoffMax) {
+        delay = backoffMax;
+    }
+
+    if (jitter) {
+        uint32_t r = mix32(seed ^ mix32(salt) ^ (attemptNr * 0x9e3779b9)) & 0x3ff; //uniform in [0, 1024)
+        unsigned long range = delay / 100UL * jitter;
+        delay -= (unsigned long)((uint64_t)range * r / 1024U);
+    }
+
+    return delay;
+}
+
+void RetryPolicy::setServerBackoff(unsigned long delay) {
+    MO_DBG_INFO("server-hinted backoff: %lu ms", delay);
+    holdOffStart = mocpp_tick_ms();
+    holdOffPeriod = delay;
+}
+
+bool RetryPolicy::isHeldOff() {
+    if (holdOffPeriod && mocpp_tick_ms() - holdOffStart >= holdOffPeriod) {
+        holdOffPeriod = 0;
+    }
+    return holdOffPeriod != 0;
+}
+
+RetryDecision RetryPolicy::onCallError(const char *errorCode, JsonObject errorDetails) {
+    int retryAfter = errorDetails["retryAfter"] | -1;
+    if (retryAfter > 0) {
+        setServerBackoff((unsigned long)retryAfter * 1000UL);
+    }
+
+    auto decision = classifyCallError(errorCode);
+    if (decision == RetryDecision::GiveUp) {
+        MO_DBG_WARN("server rejected message permanently (%s)", errorCode ? errorCode : "");
+    }
+    return decision;
+}
@@ -0,0 +1,86 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_RETRYPOLICY_H
+#define MO_RETRYPOLICY_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <MicroOcpp/Core/Memory.h>
+
+/*
+ * Progression of the retry delays. 0 (default): the delay grows linearly by the retry interval
+ * (TransactionMessageRetryInterval * attemptNr) like in previous versions. 1: the delay doubles with each
+ * failed attempt (exponential backoff)
+ */
+#ifndef MO_RETRY_BACKOFF_EXPONENTIAL
+#define MO_RETRY_BACKOFF_EXPONENTIAL 0
+#endif
+
+#ifndef MO_RETRY_BACKOFF_MAX
+#define MO_RETRY_BACKOFF_MAX 86400 //upper limit of the retry delay in s (unless the configured interval exceeds it)
+#endif
+
+/*
+ * Retry delays are shortened by a random share of up to MO_RETRY_JITTER percent. This spreads the retries
+ * of a fleet which failed at the same time, e.g. during a CSMS outage. 0 = no jitter
+ */
+#ifndef MO_RETRY_JITTER
+#define MO_RETRY_JITTER 25
+#endif
+
+namespace MicroOcpp {
+
+enum class RetryDecision : unsigned char {
+    Retry, //transient failure, e.g. timeout or InternalError
+    GiveUp //the server would reject the message again, e.g. FormationViolation
+};
+
+/*
+ * Classifies the errorCode of a CALLERROR
+ */
+RetryDecision classifyCallError(const char *errorCode);
+
+/*
+ * Retry engine shared by the transaction-related messages and the BootNotification. The senders keep
+ * their attempt counters and times and ask this class when the next attempt is due.
+ */
+class RetryPolicy : public MemoryManaged {
+private:
+    uint32_t seed;
+    unsigned int jitter = MO_RETRY_JITTER;
+
+    unsigned long holdOffStart = 0;
+    unsigned long holdOffPeriod = 0; //ms; server-hinted backoff. 0 = none
+public:
+    RetryPolicy();
+
+    void setJitter(unsigned int percent);
+    void addEntropy(const char *data, size_t len); //decorrelates the jitter of devices which share the same boot timing, e.g. with the serial number
+
+    /*
+     * Delay in ms after attempt number attemptNr (1 = first attempt) until the next attempt may be sent.
+     * interval is the configured base interval in ms. The salt identifies the message, so that the
+     * delay is stable between calls and concurrent messages get different jitter. The backoff stops at
+     * backoffMax (in ms), unless the interval exceeds it
+     */
+    unsigned long getRetryDelay(unsigned int attemptNr, unsigned long interval, uint32_t salt, unsigned long backoffMax = MO_RETRY_BACKOFF_MAX * 1000UL) const;
+
+    /*
+     * Server-hinted backoff: no retries before delay (in ms) has elapsed. A new hint replaces the previous one
+     */
+    void setServerBackoff(unsigned long delay);
+    bool isHeldOff(); //server-hinted backoff pending
+
+    /*
+     * Evaluates a CALLERROR: classifies the errorCode and takes over a server hint in the error details.
+     * MicroOcpp accepts the vendor-specific key "retryAfter" (in s) as hint
+     */
+    RetryDecision onCallError(const char *errorCode, JsonObject errorDetails);
+};
+
+} //namespace MicroOcpp
+
+#endif
@@ -0,0 +1,80 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_STATICSTRING_H
+#define MO_STATICSTRING_H
+
+#include <stddef.h>
+#include <string.h>
+
+namespace MicroOcpp {
+
+/*
+ * String with inline storage for up to N characters (+ terminating zero). Replaces heap Strings for
+ * members with a known maximum length, like OCPP CiStrings, messageIds or measurand names. Objects
+ * holding a StaticString don't need any further allocations and can be copied with memcpy semantics
+ */
+template<size_t N>
+class StaticString {
+private:
+    char buf [N + 1] = {'\0'};
+public:
+    StaticString() = default;
+    StaticString(const char *str) {
+        set(str);
+    }
+
+    StaticString(const StaticString& other) = default;
+    StaticString& operator=(const StaticString& other) = default;
+
+    StaticString& operator=(const char *str) {
+        set(str);
+        return *this;
+    }
+
+    /*
+     * Copies str into the internal buffer. Returns false if str exceeds the capacity. In that case,
+     * the stored string is truncated to N characters
+     */
+    bool set(const char *str) {
+        if (!str) {
+            buf[0] = '\0';
+            return true;
+        }
+        size_t len = 0;
+        while (len < N && str[len] != '\0') {
+            buf[len] = str[len];
+            len++;
+        }
+        buf[len] = '\0';
+        return str[len] == '\0';
+    }
+
+    bool set(const char *str, size_t len) {
+        bool fits = len <= N;
+        if (!fits) {
+            len = N;
+        }
+        if (str) {
+            memcpy(buf, str, len);
+        } else {
+            len = 0;
+        }
+        buf[len] = '\0';
+        return fits;
+    }
+
+    const char *c_str() const {return buf;}
+    size_t length() const {return strlen(buf);}
+    bool empty() const {return buf[0] == '\0';}
+    void clear() {buf[0] = '\0';}
+
+    bool equals(const char *str) const {return str && !strcmp(buf, str);}
+
+    static constexpr size_t capacity() {return N;}
+};
+
+} //namespace MicroOcpp
+
+#endif
@@ -0,0 +1,148 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_STATICVECTOR_H
+#define MO_STATICVECTOR_H
+
+#include <stddef.h>
+#include <new>
+#include <utility>
+
+namespace MicroOcpp {
+
+/*
+ * Vector with inline storage for up to N elements. Replaces heap Vectors for collections with a
+ * compile-time maximum, like the periods of a charging schedule. The elements are stored in the
+ * object itself, so a StaticVector member doesn't need any further allocations and keeps its
+ * elements next to the owning object.
+ *
+ * The interface is a subset of std::vector. Insertions beyond the capacity are rejected: push_back()
+ * and emplace_back() return false and leave the StaticVector unchanged, so the caller must check
+ * full() or the return value where the bound isn't enforced beforehand. Note that a rejected
+ * emplace_back(new X()) doesn't take ownership of the new object
+ */
+template<class T, size_t N>
+class StaticVector {
+private:
+    alignas(T) unsigned char storage [N > 0 ? N * sizeof(T) : 1];
+    size_t len = 0;
+
+    T *ptr() {return reinterpret_cast<T*>(storage);}
+    const T *ptr() const {return reinterpret_cast<const T*>(storage);}
+public:
+    using value_type = T;
+    using iterator = T*;
+    using const_iterator = const T*;
+
+    StaticVector() = default;
+
+    StaticVector(const StaticVector& other) {
+        for (const auto& el : other) {
+            emplace_back(el);
+        }
+    }
+
+    StaticVector(StaticVector&& other) {
+        for (auto& el : other) {
+            emplace_back(std::move(el));
+        }
+        other.clear();
+    }
+
+    ~StaticVector() {
+        clear();
+    }
+
+    StaticVector& operator=(const StaticVector& other) {
+        if (this != &other) {
+            clear();
+            for (const auto& el : other) {
+                emplace_back(el);
+            }
+        }
+        return *this;
+    }
+
+    StaticVector& operator=(StaticVector&& other) {
+        if (this != &other) {
+            clear();
+            for (auto& el : other) {
+                emplace_back(std::move(el));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    template<class... Args>
+    bool emplace_back(Args&&... args) {
+        if (len >= N) {
+            return false;
+        }
+        ::new ((void*) (ptr() + len)) T(std::forward<Args>(args)...);
+        len++;
+        return true;
+    }
+
+    bool push_back(const T& el) {return emplace_back(el);}
+    bool push_back(T&& el) {return emplace_back(std::move(el));}
+
+    void pop_back() {
+        if (len > 0) {
+            len--;
+            ptr()[len].~T();
+        }
+    }
+
+    iterator erase(iterator pos) {
+        return erase(pos, pos + 1);
+    }
+
+    iterator erase(iterator first, iterator last) {
+        if (first == last) {
+            return first;
+        }
+        iterator it = first;
+        for (iterator src = last; src != end(); src++, it++) {
+            *it = std::move(*src);
+        }
+        size_t removed = (size_t)(last - first);
+        for (size_t i = 0; i < removed; i++) {
+            pop_back();
+        }
+        return first;
+    }
+
+    void clear() {
+        while (len > 0) {
+            pop_back();
+        }
+    }
+
+    T& operator[](size_t i) {return ptr()[i];}
+    const T& operator[](size_t i) const {return ptr()[i];}
+
+    T& front() {return ptr()[0];}
+    const T& front() const {return ptr()[0];}
+    T& back() {return ptr()[len - 1];}
+    const T& back() const {return ptr()[len - 1];}
+
+    iterator begin() {return ptr();}
+    iterator end() {return ptr() + len;}
+    const_iterator begin() const {return ptr();}
+    const_iterator end() const {return ptr() + len;}
+
+    T *data() {return ptr();}
+    const T *data() const {return ptr();}
+
+    size_t size() const {return len;}
+    bool empty() const {return len == 0;}
+    bool full() const {return len >= N;}
+
+    static constexpr size_t capacity() {return N;}
+};
+
+} //namespace MicroOcpp
+
+#endif
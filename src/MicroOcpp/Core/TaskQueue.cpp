@@ -0,0 +1,76 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/TaskQueue.h>
+#include <MicroOcpp/Platform.h>
+#include <MicroOcpp/Debug.h>
+
+using namespace MicroOcpp;
+
+namespace MicroOcpp {
+
+class FunctionTask : public Task, public MemoryManaged {
+private:
+    std::function<TaskStatus()> fn;
+public:
+    FunctionTask(std::function<TaskStatus()> fn) : MemoryManaged("TaskQueue.FunctionTask"), fn(fn) { }
+
+    TaskStatus step() override {
+        return fn();
+    }
+};
+
+} //end namespace MicroOcpp
+
+std::unique_ptr<Task> MicroOcpp::makeTask(std::function<TaskStatus()> step) {
+    return std::unique_ptr<Task>(new FunctionTask(step));
+}
+
+TaskQueue::TaskQueue() : MemoryManaged("TaskQueue"), tasks(makeVector<std::unique_ptr<Task>>(getMemoryTag())) {
+
+}
+
+void TaskQueue::addTask(std::unique_ptr<Task> task) {
+    if (!task) {
+        MO_DBG_ERR("invalid arg");
+        return;
+    }
+    tasks.push_back(std::move(task));
+}
+
+bool TaskQueue::stepNext() {
+    if (tasks.empty()) {
+        return false;
+    }
+
+    if (cursor >= tasks.size()) {
+        cursor = 0;
+    }
+
+    //the step may add further tasks, so don't hold references into the Vector
+    auto status = tasks[cursor]->step();
+
+    if (status == TaskStatus::Done) {
+        tasks.erase(tasks.begin() + cursor);
+    } else {
+        cursor++;
+    }
+    return true;
+}
+
+void TaskQueue::loop(unsigned long t_start, unsigned long budget) {
+    if (!stepNext()) {
+        return;
+    }
+
+    while (mocpp_tick_ms() - t_start < budget) {
+        if (!stepNext()) {
+            break;
+        }
+    }
+}
+
+void TaskQueue::flush() {
+    while (stepNext());
+}
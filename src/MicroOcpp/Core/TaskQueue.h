@@ -0,0 +1,66 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_TASKQUEUE_H
+#define MO_TASKQUEUE_H
+
+#include <MicroOcpp/Core/Memory.h>
+
+#include <functional>
+#include <memory>
+#include <stdint.h>
+
+#ifndef MO_LOOP_BUDGET_MS
+#define MO_LOOP_BUDGET_MS 5 //time budget of mocpp_loop() in ms. Pending tasks only run in the remaining time of each loop call
+#endif
+
+namespace MicroOcpp {
+
+enum class TaskStatus : uint8_t {
+    Pending, //resume in a later step
+    Done
+};
+
+/*
+ * Resumable unit of work. Each step() call performs a bounded portion of the work and returns Pending to
+ * be resumed in a later loop call. Heavy operations keep their progress in the Task object (i.e. as a
+ * state machine) instead of blocking mocpp_loop() until they're complete
+ */
+class Task {
+public:
+    virtual ~Task() = default;
+    virtual TaskStatus step() = 0;
+};
+
+/*
+ * Task from a step function. The function keeps its progress in captured variables, like a generator
+ */
+std::unique_ptr<Task> makeTask(std::function<TaskStatus()> step);
+
+/*
+ * Runs the pending Tasks cooperatively. Each loop() call resumes the Tasks in round-robin order until the
+ * time budget is used up. To guarantee progress, at least one step is executed per call
+ */
+class TaskQueue : public MemoryManaged {
+private:
+    Vector<std::unique_ptr<Task>> tasks;
+    size_t cursor = 0; //next task to resume
+public:
+    TaskQueue();
+
+    void addTask(std::unique_ptr<Task> task);
+
+    bool stepNext(); //resume the next Task by one step. Returns false if no task is pending
+
+    //resume pending Tasks until mocpp_tick_ms() - t_start >= budget
+    void loop(unsigned long t_start, unsigned long budget);
+
+    void flush(); //run all Tasks to completion, e.g. before deinitialization
+
+    size_t size() const {return tasks.size();}
+};
+
+} //end namespace MicroOcpp
+
+#endif
@@ -4,7 +4,6 @@
 
 #include <MicroOcpp/Core/Time.h>
 #include <string.h>
-#include <ctype.h>	
 
 namespace MicroOcpp {
 
@@ -27,71 +26,136 @@ Timestamp::Timestamp(const Timestamp& other) : MemoryManaged("Timestamp") {
                 MemoryManaged("Timestamp"), year(year), month(month), day(day), hour(hour), minute(minute), second(second) { }
 #endif //MO_ENABLE_TIMESTAMP_MILLISECONDS
 
+namespace TimeKernels {
+
+const uint8_t DAYS_PER_MONTH [12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+
+bool isLeapYear(int year) {
+    return (year % 4 == 0 && (year % 100 != 0 || year % 400 == 0));
+}
+
+/*
+ * Number of days since 1970-01-01 of a proleptic Gregorian date. month and day are 1-based; the day may
+ * exceed the length of the month. Constant-time variant of the algorithm by Howard Hinnant, see
+ * http://howardhinnant.github.io/date_algorithms.html#days_from_civil
+ */
+int32_t daysFromCivil(int32_t year, int32_t month, int32_t day) {
+    year -= month <= 2;
+    const int32_t era = (year >= 0 ? year : year - 399) / 400;
+    const int32_t yoe = year - era * 400;                                 // [0, 399]
+    const int32_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1; // [0, 365]
+    const int32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;            // [0, 146096]
+    return era * 146097 + doe - 719468;
+}
+
+/*
+ * Inverse of daysFromCivil. Writes the 1-based month and day
+ */
+void civilFromDays(int32_t days, int32_t& year, int32_t& month, int32_t& day) {
+    days += 719468;
+    const int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const int32_t doe = days - era * 146097;                              // [0, 146096]
+    const int32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // [0, 399]
+    const int32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);          // [0, 365]
+    const int32_t mp = (5 * doy + 2) / 153;                               // [0, 11]
+    day = doy - (153 * mp + 2) / 5 + 1;                                   // [1, 31]
+    month = mp < 10 ? mp + 3 : mp - 9;                                    // [1, 12]
+    year = yoe + era * 400 + (month <= 2);
+}
+
+/*
+ * Returns true if all 8 bytes of the word are ASCII digits. Byte-wise operation, independent of the
+ * endianness
+ */
+bool isEightDigits(uint64_t word) {
+    return ((word & 0xF0F0F0F0F0F0F0F0ULL) |
+            (((word + 0x0606060606060606ULL) & 0xF0F0F0F0F0F0F0F0ULL) >> 4)) == 0x3333333333333333ULL;
+}
+
+/*
+ * Validates a word of 8 characters against a pattern of digits and separators. sepMask selects the
+ * separator bytes and sepVal contains their expected values. The separator positions are then
+ * substituted by '0' so that the whole word can be checked for digits in one step
+ */
+bool matchPattern(const char *str, const char *sepMask, const char *sepVal) {
+    uint64_t word, mask, val;
+    memcpy(&word, str, sizeof(word));
+    memcpy(&mask, sepMask, sizeof(mask));
+    memcpy(&val, sepVal, sizeof(val));
+    return (word & mask) == val &&
+           isEightDigits((word & ~mask) | (0x3030303030303030ULL & mask));
+}
+
+int parseTwoDigits(const char *str) {
+    return (str[0] - '0') * 10 + (str[1] - '0');
+}
+
+bool isDigit(char c) {
+    return (unsigned char) (c - '0') < 10;
+}
+
+const char DIGIT_PAIRS [] =
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+void writeTwoDigits(char *out, int val) {
+    memcpy(out, DIGIT_PAIRS + 2 * ((unsigned int) val % 100), 2);
+}
+
+} //namespace TimeKernels
+
+using namespace TimeKernels;
+
 int noDays(int month, int year) {
-    return (month == 0 || month == 2 || month == 4 || month == 6 || month == 7 || month == 9 || month == 11) ? 31 :
-            ((month == 3 || month == 5 || month == 8 || month == 10) ? 30 :
-            ((year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) ? 29 : 28));
+    return DAYS_PER_MONTH[month] + (month == 1 && isLeapYear(year));
 }
 
 bool Timestamp::setTime(const char *jsonDateString) {
 
     const int JSONDATE_MINLENGTH = 19;
 
-    if (strlen(jsonDateString) < JSONDATE_MINLENGTH){
+    //reads up to the first terminating zero and guarantees that the following 8-byte loads stay within the string
+    if (memchr(jsonDateString, '\0', JSONDATE_MINLENGTH)){
         return false;
     }
 
-    if (!isdigit(jsonDateString[0]) ||  //2
-        !isdigit(jsonDateString[1]) ||    //0
-        !isdigit(jsonDateString[2]) ||    //1
-        !isdigit(jsonDateString[3]) ||    //3
-        jsonDateString[4] != '-' ||       //-
-        !isdigit(jsonDateString[5]) ||    //0
-        !isdigit(jsonDateString[6]) ||    //2
-        jsonDateString[7] != '-' ||       //-
-        !isdigit(jsonDateString[8]) ||    //0
-        !isdigit(jsonDateString[9]) ||    //1
-        jsonDateString[10] != 'T' ||      //T
-        !isdigit(jsonDateString[11]) ||   //2
-        !isdigit(jsonDateString[12]) ||   //0
-        jsonDateString[13] != ':' ||      //:
-        !isdigit(jsonDateString[14]) ||   //5
-        !isdigit(jsonDateString[15]) ||   //3
-        jsonDateString[16] != ':' ||      //:
-        !isdigit(jsonDateString[17]) ||   //3
-        !isdigit(jsonDateString[18])) {   //2
-                                        //ignore subsequent characters
+    //validate "YYYY-MM-" and "DDThh:mm" in one word each, then ":ss" byte-wise. Ignore subsequent characters
+    if (!matchPattern(jsonDateString,     "\0\0\0\0\xFF\0\0\xFF", "\0\0\0\0-\0\0-") ||
+        !matchPattern(jsonDateString + 8, "\0\0\xFF\0\0\xFF\0\0", "\0\0T\0\0:\0\0") ||
+        jsonDateString[16] != ':' ||
+        !isDigit(jsonDateString[17]) ||
+        !isDigit(jsonDateString[18])) {
         return false;
     }
-    
-    int year  =  (jsonDateString[0] - '0') * 1000 +
-                (jsonDateString[1] - '0') * 100 +
-                (jsonDateString[2] - '0') * 10 +
-                (jsonDateString[3] - '0');
-    int month =  (jsonDateString[5] - '0') * 10 +
-                (jsonDateString[6] - '0') - 1;
-    int day   =  (jsonDateString[8] - '0') * 10 +
-                (jsonDateString[9] - '0') - 1;
-    int hour  =  (jsonDateString[11] - '0') * 10 +
-                (jsonDateString[12] - '0');
-    int minute = (jsonDateString[14] - '0') * 10 +
-                (jsonDateString[15] - '0');
-    int second = (jsonDateString[17] - '0') * 10 +
-                (jsonDateString[18] - '0');
-
-    //optional fractals
+
+    int year  = parseTwoDigits(jsonDateString) * 100 + parseTwoDigits(jsonDateString + 2);
+    int month = parseTwoDigits(jsonDateString + 5) - 1;
+    int day   = parseTwoDigits(jsonDateString + 8) - 1;
+    int hour  = parseTwoDigits(jsonDateString + 11);
+    int minute = parseTwoDigits(jsonDateString + 14);
+    int second = parseTwoDigits(jsonDateString + 17);
+
+    //optional fractals. Take up to 3 digits, ignore further digits
     int ms = 0;
     if (jsonDateString[19] == '.') {
-        if (isdigit(jsonDateString[20]) ||   //1
-            isdigit(jsonDateString[21]) ||   //2
-            isdigit(jsonDateString[22])) {
-            
-            ms  =  (jsonDateString[20] - '0') * 100 +
-                    (jsonDateString[21] - '0') * 10 +
-                    (jsonDateString[22] - '0');
-        } else {
+        if (!isDigit(jsonDateString[20])) {
             return false;
         }
+        ms = (jsonDateString[20] - '0') * 100;
+        if (isDigit(jsonDateString[21])) {
+            ms += (jsonDateString[21] - '0') * 10;
+            if (isDigit(jsonDateString[22])) {
+                ms += (jsonDateString[22] - '0');
+            }
+        }
     }
 
     if (year < 1970 || year >= 2038 ||
@@ -120,30 +184,22 @@ bool Timestamp::setTime(const char *jsonDateString) {
 bool Timestamp::toJsonString(char *jsonDateString, size_t buffsize) const {
     if (buffsize < JSONDATE_LENGTH + 1) return false;
 
-    jsonDateString[0] = ((char) ((year / 1000) % 10)) + '0';
-    jsonDateString[1] = ((char) ((year / 100) % 10)) + '0';
-    jsonDateString[2] = ((char) ((year / 10) % 10))  + '0';
-    jsonDateString[3] = ((char) ((year / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString, year / 100);
+    writeTwoDigits(jsonDateString + 2, year);
     jsonDateString[4] = '-';
-    jsonDateString[5] = ((char) (((month + 1) / 10) % 10))  + '0';
-    jsonDateString[6] = ((char) (((month + 1) / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 5, month + 1);
     jsonDateString[7] = '-';
-    jsonDateString[8] = ((char) (((day + 1) / 10) % 10))  + '0';
-    jsonDateString[9] = ((char) (((day + 1) / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 8, day + 1);
     jsonDateString[10] = 'T';
-    jsonDateString[11] = ((char) ((hour / 10) % 10))  + '0';
-    jsonDateString[12] = ((char) ((hour / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 11, hour);
     jsonDateString[13] = ':';
-    jsonDateString[14] = ((char) ((minute / 10) % 10))  + '0';
-    jsonDateString[15] = ((char) ((minute / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 14, minute);
     jsonDateString[16] = ':';
-    jsonDateString[17] = ((char) ((second / 10) % 10))  + '0';
-    jsonDateString[18] = ((char) ((second / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 17, second);
 #if MO_ENABLE_TIMESTAMP_MILLISECONDS
     jsonDateString[19] = '.';
     jsonDateString[20] = ((char) ((ms / 100) % 10))  + '0';
-    jsonDateString[21] = ((char) ((ms / 10) % 10))  + '0';
-    jsonDateString[22] = ((char) ((ms / 1) % 10))  + '0';
+    writeTwoDigits(jsonDateString + 21, ms);
     jsonDateString[23] = 'Z';
     jsonDateString[24] = '\0';
 #else
@@ -178,32 +234,27 @@ Timestamp &Timestamp::operator+=(int secs) {
 
     if (hour >= 0 && hour < 24) return *this;
 
-    day += hour / 24;
+    int32_t dday = hour / 24;
     hour %= 24;
     if (hour < 0) {
-        day--;
+        dday--;
         hour += 24;
     }
 
-    while (day >= noDays(month, year)) {
-        day -= noDays(month, year);
-        month++;
-        
-        if (month >= 12) {
-            month -= 12;
-            year++;
-        }
-    }
+    dday += day;
 
-    while (day < 0) {
-        month--;
-        if (month < 0) {
-            month += 12;
-            year--;
-        }
-        day += noDays(month, year);
+    if (dday >= 0 && dday < 28) {
+        //still within the same month
+        day = dday;
+        return *this;
     }
 
+    int32_t y, m, d;
+    civilFromDays(daysFromCivil(year, month + 1, 1) + dday, y, m, d);
+    year = y;
+    month = m - 1;
+    day = d - 1;
+
     return *this;
 }
 
@@ -229,30 +280,8 @@ Timestamp &Timestamp::operator-=(int secs) {
 }
 
 int Timestamp::operator-(const Timestamp &rhs) const {
-    //dt = rhs - mocpp_base
-    
-    int16_t year_base, year_end;
-    if (year <= rhs.year) {
-        year_base = year;
-        year_end = rhs.year;
-    } else {
-        year_base = rhs.year;
-        year_end = year;
-    }
-
-    int16_t lhsDays = day;
-    int16_t rhsDays = rhs.day;
-
-    for (int16_t iy = year_base; iy <= year_end; iy++) {
-        for (int16_t im = 0; im < 12; im++) {
-            if (year > iy || (year == iy && month > im)) {
-                lhsDays += noDays(im, iy);
-            }
-            if (rhs.year > iy || (rhs.year == iy && rhs.month > im)) {
-                rhsDays += noDays(im, iy);
-            }
-        }
-    }
+    int32_t lhsDays = daysFromCivil(year, month + 1, day + 1);
+    int32_t rhsDays = daysFromCivil(rhs.year, rhs.month + 1, rhs.day + 1);
 
     int dt = (lhsDays - rhsDays) * (24 * 3600) + (hour - rhs.hour) * 3600 + (minute - rhs.minute) * 60 + second - rhs.second;
     return dt;
@@ -331,6 +360,22 @@ Clock::Clock() {
 
 }
 
+void Clock::updateMonotonicMs() {
+    auto tReading = mocpp_tick_ms();
+    monotonicMs += (decltype(mocpp_tick_ms())) (tReading - lastTick); //unsigned subtraction also works across overflows
+    lastTick = tReading;
+}
+
+uint64_t Clock::getMonotonicMs() {
+    updateMonotonicMs();
+    return monotonicMs;
+}
+
+uint64_t Clock::getMsSinceSync() {
+    updateMonotonicMs();
+    return monotonicMs - system_basetime;
+}
+
 bool Clock::setTime(const char* jsonDateString) {
 
     Timestamp timestamp = Timestamp();
@@ -339,34 +384,161 @@ bool Clock::setTime(const char* jsonDateString) {
         return false;
     }
 
-    system_basetime = mocpp_tick_ms();
+    updateMonotonicMs();
+
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    updateDrift(timestamp);
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+
+    system_basetime = monotonicMs;
     mocpp_basetime = timestamp;
 
     currentTime = mocpp_basetime;
-    lastUpdate = system_basetime;
+    currentTimeElapsed = 0;
+    currentTimeTick = lastTick;
+    currentTimeValid = true;
 
     return true;
 }
 
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+void Clock::updateDrift(const Timestamp& serverTime) {
+
+    if (!driftAnchorValid) {
+        driftAnchorTime = serverTime;
+        driftAnchorMs = monotonicMs;
+        driftAnchorValid = true;
+        return;
+    }
+
+    int64_t localMs = (int64_t) (monotonicMs - driftAnchorMs);
+    int64_t serverMs = (int64_t) (serverTime - driftAnchorTime) * 1000LL;
+    int64_t errorMs = serverMs - localMs;
+
+    //tolerate the maximum drift and the uncertainty of the timestamps
+    int64_t toleranceMs = localMs * MO_CLOCK_DRIFT_MAX_PPM / 1000000LL + (int64_t) MO_CLOCK_DRIFT_JITTER_MS;
+    if (errorMs > toleranceMs || errorMs < -toleranceMs) {
+        //not explainable by drift. The time has been set manually or the server time jumped. Restart estimation
+        driftAnchorTime = serverTime;
+        driftAnchorMs = monotonicMs;
+        return;
+    }
+
+    if (localMs < (int64_t) MO_CLOCK_DRIFT_MIN_BASELINE * 1000LL) {
+        //too short for a precise estimate. Keep anchor and wait for the next sample
+        return;
+    }
+
+    if (errorMs <= (int64_t) MO_CLOCK_DRIFT_JITTER_MS && errorMs >= -(int64_t) MO_CLOCK_DRIFT_JITTER_MS) {
+        //within the uncertainty of the timestamps. Not significant, wait until the baseline has grown
+        return;
+    }
+
+    int64_t sample = errorMs * 1000000000LL / localMs; //in 1/1000 ppm
+    if (sample > MO_CLOCK_DRIFT_MAX_PPM * 1000LL) {
+        sample = MO_CLOCK_DRIFT_MAX_PPM * 1000LL;
+    } else if (sample < -MO_CLOCK_DRIFT_MAX_PPM * 1000LL) {
+        sample = -MO_CLOCK_DRIFT_MAX_PPM * 1000LL;
+    }
+
+    //deviation of the sample from the estimate so far, i.e. the drift which the compensation has missed
+    int64_t deviation = sample >= driftAvg ? sample - driftAvg : driftAvg - sample;
+    if (driftResidual < 0) {
+        driftResidual = (int32_t) deviation;
+    } else {
+        driftResidual = (int32_t) (driftResidual + (deviation - driftResidual) / MO_CLOCK_DRIFT_EWMA_WEIGHT);
+    }
+
+    int64_t avg = driftAvg + (sample - driftAvg) / MO_CLOCK_DRIFT_EWMA_WEIGHT;
+    if (avg > MO_CLOCK_DRIFT_MAX_PPM * 1000LL) {
+        avg = MO_CLOCK_DRIFT_MAX_PPM * 1000LL;
+    } else if (avg < -MO_CLOCK_DRIFT_MAX_PPM * 1000LL) {
+        avg = -MO_CLOCK_DRIFT_MAX_PPM * 1000LL;
+    }
+    driftAvg = (int32_t) avg;
+    driftPpm = (int32_t) ((avg + (avg >= 0 ? 500 : -500)) / 1000);
+
+    if (localMs >= (int64_t) MO_CLOCK_DRIFT_MAX_BASELINE * 1000LL) {
+        //start next baseline to follow slow changes of the drift (e.g. temperature, aging)
+        driftAnchorTime = serverTime;
+        driftAnchorMs = monotonicMs;
+    }
+}
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+
+int32_t Clock::getDriftPpm() {
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    return driftPpm;
+#else
+    return 0;
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+}
+
+int32_t Clock::getResidualDriftPpm() {
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    if (driftResidual < 0) {
+        return -1;
+    }
+    int32_t residualPpm = (driftResidual + 999) / 1000;
+    return residualPpm >= 1 ? residualPpm : 1;
+#else
+    return -1;
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+}
+
+void Clock::setDriftPpm(int32_t driftPpm) {
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    if (driftPpm > MO_CLOCK_DRIFT_MAX_PPM) {
+        driftPpm = MO_CLOCK_DRIFT_MAX_PPM;
+    } else if (driftPpm < -MO_CLOCK_DRIFT_MAX_PPM) {
+        driftPpm = -MO_CLOCK_DRIFT_MAX_PPM;
+    }
+    this->driftPpm = driftPpm;
+    driftAvg = driftPpm * 1000;
+    driftResidual = -1;
+    currentTimeValid = false;
+#else
+    (void)driftPpm;
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+}
+
 const Timestamp &Clock::now() {
     auto tReading = mocpp_tick_ms();
-    auto delta = tReading - lastUpdate;
+    if (currentTimeValid && tReading == currentTimeTick) {
+        //same ms tick as last call
+        return currentTime;
+    }
+
+    updateMonotonicMs();
+
+    uint64_t elapsed = monotonicMs - system_basetime;
 
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    elapsed = (uint64_t) ((int64_t) elapsed + (int64_t) elapsed * driftPpm / 1000000LL);
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+
+#if !MO_ENABLE_TIMESTAMP_MILLISECONDS
+    elapsed -= elapsed % 1000; //currentTime only changes once per second
+#endif //!MO_ENABLE_TIMESTAMP_MILLISECONDS
+
+    if (!currentTimeValid || elapsed != currentTimeElapsed) {
+        currentTime = mocpp_basetime;
+        currentTime += (int) (elapsed / 1000);
 #if MO_ENABLE_TIMESTAMP_MILLISECONDS
-    currentTime.addMilliseconds(delta);
-    lastUpdate = tReading;
-#else
-    auto deltaSecs = delta / 1000;
-    currentTime += deltaSecs;
-    lastUpdate += deltaSecs * 1000;
+        currentTime.addMilliseconds((int) (elapsed % 1000));
 #endif //MO_ENABLE_TIMESTAMP_MILLISECONDS
+        currentTimeElapsed = elapsed;
+    }
+
+    currentTimeTick = tReading;
+    currentTimeValid = true;
 
     return currentTime;
 }
 
 Timestamp Clock::adjustPrebootTimestamp(const Timestamp& t) {
     auto systemtime_in = t - Timestamp();
-    if (systemtime_in > (int) system_basetime / 1000) {
+    if (systemtime_in > (int) (system_basetime / 1000)) {
         return mocpp_basetime;
     }
     return mocpp_basetime - ((int) (system_basetime / 1000) - systemtime_in);
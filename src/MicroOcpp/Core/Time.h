@@ -97,14 +97,60 @@ public:
 extern const Timestamp MIN_TIME;
 extern const Timestamp MAX_TIME;
 
+#ifndef MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+#define MO_ENABLE_CLOCK_DRIFT_COMPENSATION 1
+#endif
+
+#ifndef MO_CLOCK_DRIFT_MAX_PPM
+#define MO_CLOCK_DRIFT_MAX_PPM 500 //maximum plausible crystal drift. Larger deviations are regarded as time jumps
+#endif
+
+#ifndef MO_CLOCK_DRIFT_MIN_BASELINE
+#define MO_CLOCK_DRIFT_MIN_BASELINE (24 * 3600) //in secs. Minimum time between two server time samples to estimate the drift from
+#endif
+
+#ifndef MO_CLOCK_DRIFT_JITTER_MS
+#define MO_CLOCK_DRIFT_JITTER_MS 3000 //uncertainty of two server time samples (1s resolution of each timestamp and the transmission delay). Smaller deviations aren't learned as drift
+#endif
+
+#ifndef MO_CLOCK_DRIFT_EWMA_WEIGHT
+#define MO_CLOCK_DRIFT_EWMA_WEIGHT 8 //the drift estimate is a moving average over the samples of the time syncs. Each new sample contributes 1/MO_CLOCK_DRIFT_EWMA_WEIGHT
+#endif
+
+#ifndef MO_CLOCK_DRIFT_MAX_BASELINE
+#define MO_CLOCK_DRIFT_MAX_BASELINE (7 * 24 * 3600) //in secs. Restart the estimation after this period to follow slow drift changes
+#endif
+
 class Clock {
 private:
 
     Timestamp mocpp_basetime = Timestamp();
-    decltype(mocpp_tick_ms()) system_basetime = 0; //the value of mocpp_tick_ms() when OCPP server's time was taken
-    decltype(mocpp_tick_ms()) lastUpdate = 0;
+    uint64_t system_basetime = 0; //the value of monotonicMs when OCPP server's time was taken
+
+    decltype(mocpp_tick_ms()) lastTick = 0; //last reading of mocpp_tick_ms()
+    uint64_t monotonicMs = 0; //ms since start, accumulated from mocpp_tick_ms(). Doesn't overflow like mocpp_tick_ms()
+    void updateMonotonicMs();
 
     Timestamp currentTime = Timestamp();
+    uint64_t currentTimeElapsed = 0; //elapsed time since system_basetime which currentTime was computed for
+    decltype(mocpp_tick_ms()) currentTimeTick = 0; //mocpp_tick_ms() reading of currentTime. Within the same tick, now() returns the cached value
+    bool currentTimeValid = false;
+
+#if MO_ENABLE_CLOCK_DRIFT_COMPENSATION
+    /*
+     * The drift is learned from successive server time samples. The estimation compares the elapsed server
+     * time with the elapsed monotonicMs since an anchor sample. Longer baselines give more precise results,
+     * so the anchor is only replaced after MO_CLOCK_DRIFT_MAX_BASELINE or if the server time jumps. The
+     * samples of the single time syncs are smoothed by a moving average
+     */
+    Timestamp driftAnchorTime = Timestamp();
+    uint64_t driftAnchorMs = 0;
+    bool driftAnchorValid = false;
+    int32_t driftPpm = 0; //positive if mocpp_tick_ms() runs slow
+    int32_t driftAvg = 0; //moving average of the drift samples in 1/1000 ppm. driftPpm is the rounded value
+    int32_t driftResidual = -1; //moving average of the deviation between the samples and driftAvg in 1/1000 ppm. -1 if no sample yet
+    void updateDrift(const Timestamp& serverTime);
+#endif //MO_ENABLE_CLOCK_DRIFT_COMPENSATION
 
 public:
 
@@ -136,6 +182,32 @@ public:
      * run of this library. The caller must check this
      */
     Timestamp adjustPrebootTimestamp(const Timestamp& t);
+
+    /*
+     * Milliseconds since start of this library. Unlike mocpp_tick_ms(), this counter doesn't overflow
+     */
+    uint64_t getMonotonicMs();
+
+    /*
+     * Milliseconds since the last time sync with the server, or since start of this library if the Clock
+     * hasn't been set yet
+     */
+    uint64_t getMsSinceSync();
+
+    /*
+     * Learned drift of mocpp_tick_ms() in parts per million. The Clock compensates the drift between two
+     * time syncs with the server. Positive if mocpp_tick_ms() runs slower than the server time.
+     * setDriftPpm() allows to restore a previously learned value, e.g. after a reboot
+     */
+    int32_t getDriftPpm();
+    void setDriftPpm(int32_t driftPpm);
+
+    /*
+     * Expected drift which remains after the compensation, in parts per million. It's the mean deviation
+     * of the drift samples from the learned drift, rounded up and at least 1 ppm. Returns -1 if the Clock
+     * hasn't learned the drift from the server time yet (including after setDriftPpm())
+     */
+    int32_t getResidualDriftPpm();
 };
 
 }
@@ -0,0 +1,549 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Trace.h>
+#include <MicroOcpp/Platform.h>
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+
+/*
+ * Trace file format. Numbers are unsigned LEB128 varints unless noted otherwise. Strings are encoded as
+ * varint (length + 1) followed by the characters and a terminating zero, or varint 0 for nullptr
+ *
+ *     header: magic "MOTR" | format version (1 byte) | bootNr | OCPP version major, minor, patch (1 byte each) | t_begin
+ *
+ *     Tick:       type | dt in ms | repeat
+ *     FrameOut:   type | accepted (1 byte) | length | frame
+ *     FrameIn:    type | length | frame
+ *     InputDecl:  type | inputId | value type (1 byte) | connectorId | number of strings (1 byte) | name, measurand, unit, location, phase
+ *     InputValue: type | inputId | Bool: 1 byte, Int: zigzag varint, Float: 4 bytes little endian, String: string
+ *     Call:       type | connectorId | number of strings (1 byte) | name, args
+ *     Truncated:  type
+ *
+ * All records after a Tick belong to the last loop call of that Tick
+ */
+
+#define TRACE_MAGIC "MOTR"
+#define TRACE_VARINT_MAXLEN 5
+#define TRACE_TICK_MAXLEN (1 + 2 * TRACE_VARINT_MAXLEN)
+
+using namespace MicroOcpp;
+
+TraceReader::TraceReader(const unsigned char *buf, size_t size) : MemoryManaged("Trace"), buf(buf), size(size), valueTypes(makeVector<TraceValueType>(getMemoryTag())) {
+
+}
+
+bool TraceReader::readVarint(uint32_t& val) {
+    val = 0;
+    for (unsigned int i = 0; i < TRACE_VARINT_MAXLEN; i++) {
+        if (pos >= size) {
+            return false;
+        }
+        unsigned char b = buf[pos++];
+        val |= (uint32_t)(b & 0x7F) << (7 * i);
+        if (!(b & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TraceReader::readString(const char*& str) {
+    uint32_t len;
+    if (!readVarint(len)) {
+        return false;
+    }
+    if (len == 0) {
+        str = nullptr;
+        return true;
+    }
+    if (len > size - pos || buf[pos + len - 1] != '\0') {
+        return false;
+    }
+    str = (const char*)buf + pos;
+    pos += len;
+    return true;
+}
+
+bool TraceReader::readHeader(TraceHeader& header) {
+    uint32_t bootNr, t_begin;
+    if (size < sizeof(TRACE_MAGIC) - 1 + 1 || memcmp(buf, TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1) || buf[sizeof(TRACE_MAGIC) - 1] != MO_TRACE_FORMAT) {
+        malformed = true;
+        return false;
+    }
+    pos = sizeof(TRACE_MAGIC) - 1 + 1;
+    if (!readVarint(bootNr) || size - pos < 3) {
+        malformed = true;
+        return false;
+    }
+    header.bootNr = (uint16_t)bootNr;
+    header.versionMajor = buf[pos++];
+    header.versionMinor = buf[pos++];
+    header.versionPatch = buf[pos++];
+    if (!readVarint(t_begin)) {
+        malformed = true;
+        return false;
+    }
+    header.t_begin = t_begin;
+    return true;
+}
+
+bool TraceReader::next(TraceRecord& record) {
+    if (malformed || pos >= size) {
+        return false;
+    }
+
+    record = TraceRecord();
+    record.type = (TraceRecordType)buf[pos++];
+
+    uint32_t val;
+    bool success = true;
+
+    switch (record.type) {
+        case TraceRecordType::Tick: {
+            uint32_t repeat = 0;
+            success = readVarint(val) && readVarint(repeat);
+            record.dt = val;
+            record.repeat = repeat;
+            break;
+        }
+        case TraceRecordType::FrameOut:
+        case TraceRecordType::FrameIn:
+            if (record.type == TraceRecordType::FrameOut) {
+                if (pos >= size) {
+                    success = false;
+                    break;
+                }
+                record.accepted = buf[pos++] != 0;
+            }
+            success = readVarint(val) && val <= size - pos;
+            if (success) {
+                record.data = (const char*)buf + pos;
+                record.len = val;
+                pos += val;
+            }
+            break;
+        case TraceRecordType::InputDecl:
+        case TraceRecordType::Call:
+            if (record.type == TraceRecordType::InputDecl) {
+                success = readVarint(val) && val == valueTypes.size() && pos < size && buf[pos] <= (unsigned char)TraceValueType::String;
+                if (!success) {
+                    break;
+                }
+                record.inputId = val;
+                record.valueType = (TraceValueType)buf[pos++];
+                valueTypes.push_back(record.valueType);
+            }
+            success = readVarint(val) && pos < size && buf[pos] <= MO_TRACE_MAXSTRINGS;
+            if (!success) {
+                break;
+            }
+            record.connectorId = val;
+            record.nStr = buf[pos++];
+            for (size_t i = 0; success && i < record.nStr; i++) {
+                success = readString(record.str[i]);
+            }
+            break;
+        case TraceRecordType::InputValue:
+            success = readVarint(val) && val < valueTypes.size();
+            if (!success) {
+                break;
+            }
+            record.inputId = val;
+            record.valueType = valueTypes[val];
+            switch (record.valueType) {
+                case TraceValueType::Bool:
+                    success = pos < size;
+                    if (success) {
+                        record.boolValue = buf[pos++] != 0;
+                    }
+                    break;
+                case TraceValueType::Int:
+                    success = readVarint(val);
+                    record.intValue = (int32_t)((val >> 1) ^ (~(val & 1) + 1)); //zigzag
+                    break;
+                case TraceValueType::Float:
+                    success = size - pos >= 4;
+                    if (success) {
+                        uint32_t bits = (uint32_t)buf[pos] | ((uint32_t)buf[pos + 1] << 8) | ((uint32_t)buf[pos + 2] << 16) | ((uint32_t)buf[pos + 3] << 24);
+                        memcpy(&record.floatValue, &bits, sizeof(float));
+                        pos += 4;
+                    }
+                    break;
+                case TraceValueType::String:
+                    success = readString(record.strValue);
+                    break;
+            }
+            break;
+        case TraceRecordType::Truncated:
+            break;
+        default:
+            success = false;
+            break;
+    }
+
+    if (!success) {
+        MO_DBG_ERR("malformed trace at %zu", pos);
+        malformed = true;
+    }
+    return success;
+}
+
+#if MO_ENABLE_TRACE
+
+TraceRecorder::TraceRecorder(std::unique_ptr<FileAdapter> file, uint16_t bootNr, const ProtocolVersion& version, unsigned long t_begin)
+        : MemoryManaged("Trace"), file(std::move(file)), t_last(t_begin) {
+
+    writeBytes(TRACE_MAGIC, sizeof(TRACE_MAGIC) - 1);
+    writeByte(MO_TRACE_FORMAT);
+    writeVarint(bootNr);
+    writeByte((unsigned char)version.major);
+    writeByte((unsigned char)version.minor);
+    writeByte((unsigned char)version.patch);
+    writeVarint((uint32_t)t_begin);
+}
+
+TraceRecorder::~TraceRecorder() {
+    if (!stopped && runRepeat > 0 && reserve(0)) {
+        writeTick();
+    }
+    flush();
+}
+
+void TraceRecorder::writeByte(unsigned char b) {
+    if (bufLen >= sizeof(buf)) {
+        flush();
+    }
+    buf[bufLen++] = b;
+}
+
+void TraceRecorder::writeVarint(uint32_t val) {
+    while (val >= 0x80) {
+        writeByte((unsigned char)(val | 0x80));
+        val >>= 7;
+    }
+    writeByte((unsigned char)val);
+}
+
+void TraceRecorder::writeBytes(const char *data, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        writeByte((unsigned char)data[i]);
+    }
+}
+
+void TraceRecorder::writeString(const char *str) {
+    if (!str) {
+        writeVarint(0);
+        return;
+    }
+    size_t len = strlen(str) + 1;
+    writeVarint((uint32_t)len);
+    writeBytes(str, len);
+}
+
+void TraceRecorder::writeTick() {
+    if (runRepeat > 0) {
+        writeByte((unsigned char)TraceRecordType::Tick);
+        writeVarint((uint32_t)runDt);
+        writeVarint((uint32_t)runRepeat);
+        runRepeat = 0;
+    }
+}
+
+bool TraceRecorder::reserve(size_t len) {
+    if (stopped) {
+        return false;
+    }
+    if (getSize() + TRACE_TICK_MAXLEN + len + 1 > MO_TRACE_MAXSIZE) {
+        MO_DBG_WARN("trace exceeds MO_TRACE_MAXSIZE, stop capture");
+        writeTick();
+        writeByte((unsigned char)TraceRecordType::Truncated);
+        flush();
+        stopped = true;
+        return false;
+    }
+    return true;
+}
+
+bool TraceRecorder::beginRecord(TraceRecordType type, size_t maxLen) {
+    if (!reserve(maxLen)) {
+        return false;
+    }
+    writeTick();
+    writeByte((unsigned char)type);
+    return true;
+}
+
+void TraceRecorder::flush() {
+    if (bufLen == 0) {
+        return;
+    }
+    if (file && file->write((const char*)buf, bufLen) != bufLen) {
+        MO_DBG_ERR("trace write error, stop capture");
+        file.reset();
+        stopped = true;
+    }
+    written += bufLen;
+    bufLen = 0;
+}
+
+void TraceRecorder::onLoop(unsigned long t_now) {
+    if (stopped) {
+        return;
+    }
+    unsigned long dt = t_now - t_last;
+    t_last = t_now;
+
+    if (runRepeat > 0 && dt == runDt) {
+        runRepeat++;
+        return;
+    }
+
+    if (runRepeat > 0) {
+        if (!reserve(0)) {
+            return;
+        }
+        writeTick();
+    }
+
+    runDt = dt;
+    runRepeat = 1;
+}
+
+void TraceRecorder::onFrameOut(const char *msg, size_t len, bool accepted) {
+    if (!beginRecord(TraceRecordType::FrameOut, 1 + TRACE_VARINT_MAXLEN + len)) {
+        return;
+    }
+    writeByte(accepted ? 1 : 0);
+    writeVarint((uint32_t)len);
+    writeBytes(msg, len);
+}
+
+void TraceRecorder::onFrameIn(const char *msg, size_t len) {
+    if (!beginRecord(TraceRecordType::FrameIn, TRACE_VARINT_MAXLEN + len)) {
+        return;
+    }
+    writeVarint((uint32_t)len);
+    writeBytes(msg, len);
+}
+
+void TraceRecorder::onCall(const char *name, unsigned int connectorId, const char *arg1, const char *arg2) {
+    const char *str [] = {name, arg1, arg2};
+    size_t len = TRACE_VARINT_MAXLEN + 1;
+    for (size_t i = 0; i < sizeof(str) / sizeof(str[0]); i++) {
+        len += TRACE_VARINT_MAXLEN + (str[i] ? strlen(str[i]) + 1 : 0);
+    }
+    if (!beginRecord(TraceRecordType::Call, len)) {
+        return;
+    }
+    writeVarint(connectorId);
+    writeByte(sizeof(str) / sizeof(str[0]));
+    for (size_t i = 0; i < sizeof(str) / sizeof(str[0]); i++) {
+        writeString(str[i]);
+    }
+}
+
+unsigned int TraceRecorder::declareInput(TraceValueType type, const char *name, unsigned int connectorId,
+        const char *measurand, const char *unit, const char *location, const char *phase) {
+
+    unsigned int inputId = nInputs++; //the ids must stay consecutive even if the record is dropped
+
+    const char *str [] = {name, measurand, unit, location, phase};
+    size_t nStr = type == TraceValueType::Float ? 5 : 1;
+    size_t len = 2 * TRACE_VARINT_MAXLEN + 2;
+    for (size_t i = 0; i < nStr; i++) {
+        len += TRACE_VARINT_MAXLEN + (str[i] ? strlen(str[i]) + 1 : 0);
+    }
+    if (!beginRecord(TraceRecordType::InputDecl, len)) {
+        return inputId;
+    }
+    writeVarint(inputId);
+    writeByte((unsigned char)type);
+    writeVarint(connectorId);
+    writeByte((unsigned char)nStr);
+    for (size_t i = 0; i < nStr; i++) {
+        writeString(str[i]);
+    }
+    return inputId;
+}
+
+void TraceRecorder::writeValue(TraceValueType type, const void *value) {
+    switch (type) {
+        case TraceValueType::Bool:
+            writeByte(*(const bool*)value ? 1 : 0);
+            break;
+        case TraceValueType::Int: {
+            int32_t v = *(const int32_t*)value;
+            writeVarint(((uint32_t)v << 1) ^ (uint32_t)(v >> 31)); //zigzag
+            break;
+        }
+        case TraceValueType::Float: {
+            uint32_t bits;
+            memcpy(&bits, value, sizeof(float));
+            for (unsigned int i = 0; i < 4; i++) {
+                writeByte((unsigned char)(bits >> (8 * i)));
+            }
+            break;
+        }
+        case TraceValueType::String:
+            writeString(*(const char* const*)value);
+            break;
+    }
+}
+
+std::function<bool()> TraceRecorder::traceBoolInput(std::function<bool()> input, const char *name, unsigned int connectorId) {
+    if (!input) {
+        return input;
+    }
+    unsigned int inputId = declareInput(TraceValueType::Bool, name, connectorId);
+    bool last = false;
+    bool valid = false;
+    return [this, input, inputId, last, valid] () mutable {
+        bool value = input();
+        if ((!valid || value != last) && beginRecord(TraceRecordType::InputValue, TRACE_VARINT_MAXLEN + 1)) {
+            writeVarint(inputId);
+            writeValue(TraceValueType::Bool, &value);
+        }
+        last = value;
+        valid = true;
+        return value;
+    };
+}
+
+std::function<int()> TraceRecorder::traceIntInput(std::function<int()> input, const char *name, unsigned int connectorId) {
+    if (!input) {
+        return input;
+    }
+    unsigned int inputId = declareInput(TraceValueType::Int, name, connectorId);
+    int32_t last = 0;
+    bool valid = false;
+    return [this, input, inputId, last, valid] () mutable {
+        int32_t value = input();
+        if ((!valid || value != last) && beginRecord(TraceRecordType::InputValue, 2 * TRACE_VARINT_MAXLEN)) {
+            writeVarint(inputId);
+            writeValue(TraceValueType::Int, &value);
+        }
+        last = value;
+        valid = true;
+        return value;
+    };
+}
+
+std::function<float()> TraceRecorder::traceFloatInput(std::function<float()> input, const char *name, unsigned int connectorId,
+        const char *measurand, const char *unit, const char *location, const char *phase) {
+    if (!input) {
+        return input;
+    }
+    unsigned int inputId = declareInput(TraceValueType::Float, name, connectorId, measurand, unit, location, phase);
+    float last = 0.f;
+    bool valid = false;
+    return [this, input, inputId, last, valid] () mutable {
+        float value = input();
+        if ((!valid || value != last) && beginRecord(TraceRecordType::InputValue, TRACE_VARINT_MAXLEN + 4)) {
+            writeVarint(inputId);
+            writeValue(TraceValueType::Float, &value);
+        }
+        last = value;
+        valid = true;
+        return value;
+    };
+}
+
+std::function<const char*()> TraceRecorder::traceStringInput(std::function<const char*()> input, const char *name, unsigned int connectorId) {
+    if (!input) {
+        return input;
+    }
+    unsigned int inputId = declareInput(TraceValueType::String, name, connectorId);
+    auto last = std::make_shared<String>(makeString(getMemoryTag()));
+    bool lastNull = true;
+    bool valid = false;
+    return [this, input, inputId, last, lastNull, valid] () mutable {
+        const char *value = input();
+        bool changed = !valid || (value == nullptr) != lastNull || (value && *last != value);
+        if (changed && beginRecord(TraceRecordType::InputValue, 2 * TRACE_VARINT_MAXLEN + (value ? strlen(value) + 1 : 0))) {
+            writeVarint(inputId);
+            writeValue(TraceValueType::String, &value);
+        }
+        if (changed) {
+            *last = value ? value : "";
+            lastNull = value == nullptr;
+        }
+        valid = true;
+        return value;
+    };
+}
+
+std::unique_ptr<TraceRecorder> MicroOcpp::makeTraceRecorder(std::shared_ptr<FilesystemAdapter> filesystem, uint16_t bootNr, const ProtocolVersion& version) {
+    if (!filesystem) {
+        MO_DBG_WARN("trace capture requires a filesystem");
+        return nullptr;
+    }
+
+    char path [MO_MAX_PATH_SIZE];
+    auto ret = snprintf(path, sizeof(path), MO_FILENAME_PREFIX MO_TRACE_FN_PREFIX "%u.bin", (unsigned int)(bootNr % MO_TRACE_FILES));
+    if (ret < 0 || (size_t)ret >= sizeof(path)) {
+        MO_DBG_ERR("fn error: %i", ret);
+        return nullptr;
+    }
+
+    auto file = filesystem->open(path, "w");
+    if (!file) {
+        MO_DBG_ERR("could not create %s", path);
+        return nullptr;
+    }
+
+    MO_DBG_INFO("capture trace into %s", path);
+    return std::unique_ptr<TraceRecorder>(new TraceRecorder(std::move(file), bootNr, version, mocpp_tick_ms()));
+}
+
+TraceConnection::TraceConnection(Connection& connection) : MemoryManaged("Trace"), connection(connection) {
+
+}
+
+void TraceConnection::setRecorder(TraceRecorder *recorder) {
+    this->recorder = recorder;
+    if (recorder) {
+        connectedInput = recorder->traceBoolInput([this] () {return connection.isConnected();}, "Connected", 0);
+    } else {
+        connectedInput = nullptr;
+    }
+}
+
+void TraceConnection::loop() {
+    connection.loop();
+}
+
+bool TraceConnection::sendTXT(const char *msg, size_t length) {
+    bool accepted = connection.sendTXT(msg, length);
+    if (recorder) {
+        recorder->onFrameOut(msg, length, accepted);
+    }
+    return accepted;
+}
+
+void TraceConnection::setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) {
+    this->receiveTXT = receiveTXT;
+    ReceiveTXTcallback callback = [this] (const char *msg, size_t length) {
+        if (recorder) {
+            recorder->onFrameIn(msg, length);
+        }
+        return this->receiveTXT(msg, length);
+    };
+    connection.setReceiveTXTcallback(callback);
+}
+
+unsigned long TraceConnection::getLastRecv() {
+    return connection.getLastRecv();
+}
+
+unsigned long TraceConnection::getLastConnected() {
+    return connection.getLastConnected();
+}
+
+bool TraceConnection::isConnected() {
+    return connectedInput ? connectedInput() : connection.isConnected();
+}
+
+#endif //MO_ENABLE_TRACE
@@ -0,0 +1,203 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_TRACE_H
+#define MO_TRACE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Version.h>
+
+/*
+ * Trace capture: records the OCPP frames in both directions, the values of the Inputs, the transaction
+ * calls of the application and mocpp_tick_ms() at each mocpp_loop() into a compact binary file. The
+ * replay tool (tests/benchmarks/replay) feeds a trace back into MO with virtual time, so a slowdown in
+ * the field becomes reproducible on the host. Capturing is enabled at runtime with the configuration
+ * Cst_TraceCapture and takes effect at the next boot.
+ *
+ * The trace contains the OCPP traffic as is, including idTags and the AuthorizationKey
+ */
+#ifndef MO_ENABLE_TRACE
+#define MO_ENABLE_TRACE 0
+#endif
+
+#ifndef MO_TRACE_FN_PREFIX
+#define MO_TRACE_FN_PREFIX "trace-" //file name is MO_TRACE_FN_PREFIX + (bootNr % MO_TRACE_FILES) + ".bin"
+#endif
+
+#ifndef MO_TRACE_FILES
+#define MO_TRACE_FILES 2 //keep the traces of this number of boots
+#endif
+
+#ifndef MO_TRACE_BUFSIZE
+#define MO_TRACE_BUFSIZE 256 //records are collected in RAM and written to flash in blocks of this size
+#endif
+
+#ifndef MO_TRACE_MAXSIZE
+#define MO_TRACE_MAXSIZE 65536 //bytes per trace file; the capture stops when exceeded
+#endif
+
+#define MO_TRACE_FORMAT 1
+
+namespace MicroOcpp {
+
+enum class TraceRecordType : uint8_t {
+    Tick = 1,   //one or more mocpp_loop() calls, each advancing mocpp_tick_ms() by the same delta
+    FrameOut,   //frame passed to Connection::sendTXT and its return value
+    FrameIn,    //frame received from the server
+    InputDecl,  //Input has been set by the application
+    InputValue, //value of an Input has changed
+    Call,       //transaction call of the application, e.g. beginTransaction()
+    Truncated   //trace exceeded MO_TRACE_MAXSIZE
+};
+
+enum class TraceValueType : uint8_t {
+    Bool,
+    Int,
+    Float,
+    String
+};
+
+#define MO_TRACE_MAXSTRINGS 5 //strings of an InputDecl (name, measurand, unit, location, phase) or Call (name, args)
+
+struct TraceHeader {
+    uint16_t bootNr = 0;
+    int versionMajor = 1, versionMinor = 6, versionPatch = 0; //OCPP version
+    unsigned long t_begin = 0; //mocpp_tick_ms() when the capture started
+};
+
+struct TraceRecord {
+    TraceRecordType type;
+
+    unsigned long dt = 0; //Tick
+    unsigned long repeat = 0;
+
+    const char *data = nullptr; //FrameOut, FrameIn. Not zero-terminated
+    size_t len = 0;
+    bool accepted = false; //FrameOut
+
+    unsigned int inputId = 0; //InputDecl, InputValue
+    unsigned int connectorId = 0; //InputDecl, Call
+    TraceValueType valueType = TraceValueType::Bool;
+
+    bool boolValue = false; //InputValue
+    int32_t intValue = 0;
+    float floatValue = 0.f;
+    const char *strValue = nullptr;
+
+    const char *str [MO_TRACE_MAXSTRINGS] = {nullptr}; //InputDecl, Call. Zero-terminated or nullptr
+    size_t nStr = 0;
+};
+
+/*
+ * Parses a trace in memory. The strings of the records point into the buffer
+ */
+class TraceReader : public MemoryManaged {
+private:
+    const unsigned char *buf;
+    size_t size;
+    size_t pos = 0;
+    bool malformed = false;
+
+    Vector<TraceValueType> valueTypes; //by inputId
+
+    bool readVarint(uint32_t& val);
+    bool readString(const char*& str);
+public:
+    TraceReader(const unsigned char *buf, size_t size);
+
+    bool readHeader(TraceHeader& header);
+    bool next(TraceRecord& record); //returns false at the end of the trace or if it is malformed
+
+    bool isMalformed() {return malformed;}
+};
+
+#if MO_ENABLE_TRACE
+
+class TraceRecorder : public MemoryManaged {
+private:
+    std::unique_ptr<FileAdapter> file;
+
+    unsigned char buf [MO_TRACE_BUFSIZE];
+    size_t bufLen = 0;
+    size_t written = 0;
+    bool stopped = false;
+
+    unsigned long t_last = 0;
+    unsigned long runDt = 0; //pending Tick record
+    unsigned long runRepeat = 0;
+
+    unsigned int nInputs = 0;
+
+    bool reserve(size_t len); //check that len bytes and the pending Tick fit into MO_TRACE_MAXSIZE; otherwise stop the capture
+    bool beginRecord(TraceRecordType type, size_t maxLen); //writes the pending Tick. Returns false if the trace is full
+    void writeTick();
+    void writeByte(unsigned char b);
+    void writeVarint(uint32_t val);
+    void writeBytes(const char *data, size_t len);
+    void writeString(const char *str);
+    void writeValue(TraceValueType type, const void *value);
+
+    unsigned int declareInput(TraceValueType type, const char *name, unsigned int connectorId,
+            const char *measurand = nullptr, const char *unit = nullptr, const char *location = nullptr, const char *phase = nullptr);
+public:
+    TraceRecorder(std::unique_ptr<FileAdapter> file, uint16_t bootNr, const ProtocolVersion& version, unsigned long t_begin);
+    ~TraceRecorder();
+
+    void onLoop(unsigned long t_now);
+    void onFrameOut(const char *msg, size_t len, bool accepted);
+    void onFrameIn(const char *msg, size_t len);
+    void onCall(const char *name, unsigned int connectorId, const char *arg1 = nullptr, const char *arg2 = nullptr);
+
+    //wrap an Input so that each change of its value is recorded
+    std::function<bool()> traceBoolInput(std::function<bool()> input, const char *name, unsigned int connectorId);
+    std::function<int()> traceIntInput(std::function<int()> input, const char *name, unsigned int connectorId);
+    std::function<float()> traceFloatInput(std::function<float()> input, const char *name, unsigned int connectorId,
+            const char *measurand = nullptr, const char *unit = nullptr, const char *location = nullptr, const char *phase = nullptr);
+    std::function<const char*()> traceStringInput(std::function<const char*()> input, const char *name, unsigned int connectorId);
+
+    void flush(); //write the buffered records to the file
+
+    size_t getSize() {return written + bufLen;}
+};
+
+/*
+ * Opens the trace file of this boot. Returns nullptr if the file can't be created
+ */
+std::unique_ptr<TraceRecorder> makeTraceRecorder(std::shared_ptr<FilesystemAdapter> filesystem, uint16_t bootNr, const ProtocolVersion& version);
+
+/*
+ * Decorator which passes the frames and the connection state of the application's Connection to the
+ * TraceRecorder, if one is attached
+ */
+class TraceConnection : public Connection, public MemoryManaged {
+private:
+    Connection& connection;
+    TraceRecorder *recorder = nullptr;
+    ReceiveTXTcallback receiveTXT;
+    std::function<bool()> connectedInput;
+public:
+    TraceConnection(Connection& connection);
+
+    void setRecorder(TraceRecorder *recorder);
+
+    void loop() override;
+    bool sendTXT(const char *msg, size_t length) override;
+    void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) override;
+    unsigned long getLastRecv() override;
+    unsigned long getLastConnected() override;
+    bool isConnected() override;
+};
+
+#endif //MO_ENABLE_TRACE
+
+} //namespace MicroOcpp
+
+#endif
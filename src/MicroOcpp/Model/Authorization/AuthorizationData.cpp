@@ -7,6 +7,7 @@
 #if MO_ENABLE_LOCAL_AUTH
 
 #include <MicroOcpp/Model/Authorization/AuthorizationData.h>
+#include <MicroOcpp/Core/EnumTable.h>
 #include <MicroOcpp/Debug.h>
 
 using namespace MicroOcpp;
@@ -20,26 +21,23 @@ AuthorizationData::AuthorizationData(AuthorizationData&& other) : MemoryManaged(
 }
 
 AuthorizationData::~AuthorizationData() {
-    MO_FREE(parentIdTag);
-    parentIdTag = nullptr;
+
 }
 
 AuthorizationData& AuthorizationData::operator=(AuthorizationData&& other) {
     parentIdTag = other.parentIdTag;
-    other.parentIdTag = nullptr;
+    other.parentIdTag.clear();
     expiryDate = std::move(other.expiryDate);
-    strncpy(idTag, other.idTag, IDTAG_LEN_MAX + 1);
-    idTag[IDTAG_LEN_MAX] = '\0';
+    idTag = other.idTag;
     status = other.status;
     return *this;
 }
 
 void AuthorizationData::readJson(JsonObject entry, bool compact) {
     if (entry.containsKey(AUTHDATA_KEY_IDTAG(compact))) {
-        strncpy(idTag, entry[AUTHDATA_KEY_IDTAG(compact)], IDTAG_LEN_MAX + 1);
-        idTag[IDTAG_LEN_MAX] = '\0';
+        idTag.set(entry[AUTHDATA_KEY_IDTAG(compact)] | "");
     } else {
-        idTag[0] = '\0';
+        idTag.clear();
     }
 
     JsonObject idTagInfo;
@@ -59,18 +57,9 @@ void AuthorizationData::readJson(JsonObject entry, bool compact) {
     }
 
     if (idTagInfo.containsKey(AUTHDATA_KEY_PARENTIDTAG(compact))) {
-        MO_FREE(parentIdTag);
-        parentIdTag = nullptr;
-        parentIdTag = static_cast<char*>(MO_MALLOC(getMemoryTag(), IDTAG_LEN_MAX + 1));
-        if (parentIdTag) {
-            strncpy(parentIdTag, idTagInfo[AUTHDATA_KEY_PARENTIDTAG(compact)], IDTAG_LEN_MAX + 1);
-            parentIdTag[IDTAG_LEN_MAX] = '\0';
-        } else {
-            MO_DBG_ERR("OOM");
-        }
+        parentIdTag.set(idTagInfo[AUTHDATA_KEY_PARENTIDTAG(compact)] | "");
     } else {
-        MO_FREE(parentIdTag);
-        parentIdTag = nullptr;
+        parentIdTag.clear();
     }
 
     if (idTagInfo.containsKey(AUTHDATA_KEY_STATUS(compact))) {
@@ -86,19 +75,19 @@ void AuthorizationData::readJson(JsonObject entry, bool compact) {
 
 size_t AuthorizationData::getJsonCapacity() const {
     return JSON_OBJECT_SIZE(2) +
-            (idTag[0] != '\0' ? 
+            (!idTag.empty() ? 
                 JSON_OBJECT_SIZE(1) : 0) +
             (expiryDate ?
                 JSON_OBJECT_SIZE(1) + JSONDATE_LENGTH + 1 : 0) +
-            (parentIdTag ?
+            (!parentIdTag.empty() ?
                 JSON_OBJECT_SIZE(1) : 0) +
             (status != AuthorizationStatus::UNDEFINED ?
                 JSON_OBJECT_SIZE(1) : 0);
 }
 
 void AuthorizationData::writeJson(JsonObject& entry, bool compact) {
-    if (idTag[0] != '\0') {
-        entry[AUTHDATA_KEY_IDTAG(compact)] = (const char*) idTag;
+    if (!idTag.empty()) {
+        entry[AUTHDATA_KEY_IDTAG(compact)] = idTag.c_str();
     }
 
     JsonObject idTagInfo;
@@ -115,8 +104,8 @@ void AuthorizationData::writeJson(JsonObject& entry, bool compact) {
         }
     }
 
-    if (parentIdTag) {
-        idTagInfo[AUTHDATA_KEY_PARENTIDTAG(compact)] = (const char *) parentIdTag;
+    if (!parentIdTag.empty()) {
+        idTagInfo[AUTHDATA_KEY_PARENTIDTAG(compact)] = parentIdTag.c_str();
     }
 
     if (status != AuthorizationStatus::Accepted) {
@@ -127,57 +116,42 @@ void AuthorizationData::writeJson(JsonObject& entry, bool compact) {
 }
 
 const char *AuthorizationData::getIdTag() const {
-    return idTag;
+    return idTag.c_str();
 }
 Timestamp *AuthorizationData::getExpiryDate() const {
     return expiryDate.get();
 }
 const char *AuthorizationData::getParentIdTag() const {
-    return parentIdTag;
+    return parentIdTag.empty() ? nullptr : parentIdTag.c_str();
 }
 AuthorizationStatus AuthorizationData::getAuthorizationStatus() const {
     return status;
 }
 
 void AuthorizationData::reset() {
-    idTag[0] = '\0';
+    idTag.clear();
 }
 
+namespace MicroOcpp {
+
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<6,8> authorizationStatusTable {
+    {"Accepted", "Blocked", "Expired", "Invalid", "ConcurrentTx", nullptr},
+    {1, 0, 4, 3, 0xFF, 0xFF, 0xFF, 2},
+    0U};
+static_assert(authorizationStatusTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+} //end namespace MicroOcpp
+
 const char *MicroOcpp::serializeAuthorizationStatus(AuthorizationStatus status) {
-    switch (status) {
-        case (AuthorizationStatus::Accepted):
-            return "Accepted";
-        case (AuthorizationStatus::Blocked):
-            return "Blocked";
-        case (AuthorizationStatus::Expired):
-            return "Expired";
-        case (AuthorizationStatus::Invalid):
-            return "Invalid";
-        case (AuthorizationStatus::ConcurrentTx):
-            return "ConcurrentTx";
-        default:
-            return "UNDEFINED";
-    }
+    const char *name = authorizationStatusTable.encode((size_t)status);
+    return name ? name : "UNDEFINED";
 }
 
 MicroOcpp::AuthorizationStatus MicroOcpp::deserializeAuthorizationStatus(const char *cstr) {
-    if (!cstr) {
-        return AuthorizationStatus::UNDEFINED;
-    }
-
-    if (!strcmp(cstr, "Accepted")) {
-        return AuthorizationStatus::Accepted;
-    } else if (!strcmp(cstr, "Blocked")) {
-        return AuthorizationStatus::Blocked;
-    } else if (!strcmp(cstr, "Expired")) {
-        return AuthorizationStatus::Expired;
-    } else if (!strcmp(cstr, "Invalid")) {
-        return AuthorizationStatus::Invalid;
-    } else if (!strcmp(cstr, "ConcurrentTx")) {
-        return AuthorizationStatus::ConcurrentTx;
-    } else {
-        return AuthorizationStatus::UNDEFINED;
-    }
+    AuthorizationStatus res = AuthorizationStatus::UNDEFINED;
+    authorizationStatusTable.decode(cstr, res);
+    return res;
 }
 
 #endif //MO_ENABLE_LOCAL_AUTH
@@ -12,6 +12,7 @@
 #include <MicroOcpp/Operations/CiStrings.h>
 #include <MicroOcpp/Core/Time.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
 #include <ArduinoJson.h>
 #include <memory>
 
@@ -41,10 +42,10 @@ class AuthorizationData : public MemoryManaged {
 private:
     //data structure optimized for memory consumption
 
-    char *parentIdTag = nullptr;
+    StaticString<IDTAG_LEN_MAX> parentIdTag;
     std::unique_ptr<Timestamp> expiryDate;
 
-    char idTag [IDTAG_LEN_MAX + 1] = {'\0'};
+    StaticString<IDTAG_LEN_MAX> idTag;
 
     AuthorizationStatus status = AuthorizationStatus::UNDEFINED;
 public:
@@ -14,7 +14,7 @@
 
 using namespace MicroOcpp;
 
-AuthorizationList::AuthorizationList() : MemoryManaged("v16.Authorization.AuthorizationList"), localAuthorizationList(makeVector<AuthorizationData>(getMemoryTag())) {
+AuthorizationList::AuthorizationList() : MemoryManaged("v16.Authorization.AuthorizationList"), localAuthorizationList(makeVector<AuthorizationData>(getMemoryTag())), staged(makeVector<AuthorizationData>(getMemoryTag())) {
 
 }
 
@@ -175,8 +175,134 @@ bool AuthorizationList::readJson(JsonArray authlistJson, int listVersion, bool d
     return true;
 }
 
+bool AuthorizationList::stageJson(JsonArray authlistJson, int listVersion, bool differential) {
+
+    if (isMergePending()) {
+        //the previous update must be complete before the next one is checked against the list
+        mergeStaged(staged.size());
+    }
+
+    for (size_t i = 0; i < authlistJson.size(); i++) {
+
+        //check if JSON object is valid
+        if (!authlistJson[i].as<JsonObject>().containsKey(AUTHDATA_KEY_IDTAG(false))) {
+            return false;
+        }
+
+        //updates need a status. In the staged entries, UNDEFINED marks remove commands
+        if (authlistJson[i].as<JsonObject>().containsKey(AUTHDATA_KEY_IDTAGINFO) &&
+                deserializeAuthorizationStatus(authlistJson[i][AUTHDATA_KEY_IDTAGINFO][AUTHDATA_KEY_STATUS(false)] | "_Undefined") == AuthorizationStatus::UNDEFINED) {
+            return false;
+        }
+    }
+
+    unsigned int resultingListLength = 0;
+
+    if (!differential) {
+        //every entry will insert an idTag
+        resultingListLength = authlistJson.size();
+    } else {
+        //update type is differential; only unkown entries will insert an idTag
+        resultingListLength = localAuthorizationList.size();
+
+        for (size_t i = 0; i < authlistJson.size(); i++) {
+            bool found = get(authlistJson[i][AUTHDATA_KEY_IDTAG(false)]);
+            bool remove = !authlistJson[i].as<JsonObject>().containsKey(AUTHDATA_KEY_IDTAGINFO);
+            if (found && remove) {
+                resultingListLength--;
+            } else if (!found && !remove) {
+                resultingListLength++;
+            }
+        }
+    }
+
+    if (resultingListLength > MO_LocalAuthListMaxLength) {
+        MO_DBG_WARN("localAuthList capacity exceeded");
+        return false;
+    }
+
+    staged.reserve(authlistJson.size());
+
+    for (size_t i = 0; i < authlistJson.size(); i++) {
+        bool remove = !authlistJson[i].as<JsonObject>().containsKey(AUTHDATA_KEY_IDTAGINFO);
+        if (remove && !differential) {
+            continue;
+        }
+        staged.emplace_back();
+        staged.back().readJson(authlistJson[i], false);
+    }
+
+    if (!differential) {
+        //the staged entries are the complete new list
+        std::sort(staged.begin(), staged.end(),
+                [] (const AuthorizationData& lhs, const AuthorizationData& rhs) {
+                    return strcmp(lhs.getIdTag(), rhs.getIdTag()) < 0;
+                });
+        localAuthorizationList.swap(staged);
+        staged.clear();
+        staged.shrink_to_fit();
+
+        this->listVersion = localAuthorizationList.empty() ? 0 : listVersion;
+        return true;
+    }
+
+    if (staged.empty()) {
+        this->listVersion = localAuthorizationList.empty() ? 0 : listVersion;
+        return true;
+    }
+
+    localAuthorizationList.reserve(resultingListLength);
+    stagedPos = 0;
+    stagedListVersion = listVersion;
+    return true;
+}
+
+bool AuthorizationList::mergeStaged(size_t maxEntries) {
+
+    if (!isMergePending()) {
+        return true;
+    }
+
+    size_t end = stagedPos + std::min(maxEntries, staged.size() - stagedPos);
+
+    for (; stagedPos < end; stagedPos++) {
+        auto& entry = staged[stagedPos];
+
+        //the list remains sorted after each entry, so lookups between two steps are valid
+        auto it = std::lower_bound(localAuthorizationList.begin(), localAuthorizationList.end(), entry,
+                [] (const AuthorizationData& lhs, const AuthorizationData& rhs) {
+                    return strcmp(lhs.getIdTag(), rhs.getIdTag()) < 0;
+                });
+        bool found = it != localAuthorizationList.end() && !strcmp(it->getIdTag(), entry.getIdTag());
+
+        if (entry.getAuthorizationStatus() == AuthorizationStatus::UNDEFINED) {
+            //remove command
+            if (found) {
+                localAuthorizationList.erase(it);
+            }
+        } else if (found) {
+            *it = std::move(entry);
+        } else {
+            localAuthorizationList.insert(it, std::move(entry));
+        }
+    }
+
+    if (stagedPos < staged.size()) {
+        return false;
+    }
+
+    staged.clear();
+    staged.shrink_to_fit();
+    stagedPos = 0;
+
+    this->listVersion = localAuthorizationList.empty() ? 0 : stagedListVersion;
+    return true;
+}
+
 void AuthorizationList::clear() {
     localAuthorizationList.clear();
+    staged.clear();
+    stagedPos = 0;
     listVersion = 0;
 }
 
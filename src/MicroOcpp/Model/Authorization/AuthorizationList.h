@@ -26,6 +26,11 @@ class AuthorizationList : public MemoryManaged {
 private:
     int listVersion = 0;
     Vector<AuthorizationData> localAuthorizationList; //sorted list
+
+    //differential update which is applied in steps. Entries without status are remove commands
+    Vector<AuthorizationData> staged;
+    size_t stagedPos = 0;
+    int stagedListVersion = 0;
 public:
     AuthorizationList();
     ~AuthorizationList();
@@ -35,11 +40,17 @@ public:
     bool readJson(JsonArray localAuthorizationList, int listVersion, bool differential = false, bool compact = false); //compact: if true, then use compact non-ocpp representation
     void clear();
 
+    //like readJson, but only parses the entries. Differential updates are applied by mergeStaged() afterwards
+    bool stageJson(JsonArray localAuthorizationList, int listVersion, bool differential);
+    bool mergeStaged(size_t maxEntries); //apply up to maxEntries staged entries. Returns true if the update is complete
+    bool isMergePending() {return !staged.empty();}
+
     size_t getJsonCapacity();
     void writeJson(JsonArray authListOut, bool compact = false);
 
     int getListVersion() {return listVersion;}
     size_t size(); //used in unit tests
+    AuthorizationData& at(size_t index) {return localAuthorizationList[index];} //index in sorted order
 
 };
 
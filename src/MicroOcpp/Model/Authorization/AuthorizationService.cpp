@@ -18,7 +18,10 @@
 #include <MicroOcpp/Operations/StatusNotification.h>
 #include <MicroOcpp/Debug.h>
 
+#include <algorithm>
+
 #define MO_LOCALAUTHORIZATIONLIST_FN (MO_FILENAME_PREFIX "localauth.jsn")
+#define MO_LOCALAUTHORIZATIONLIST_TMP_FN (MO_FILENAME_PREFIX "localauth.tmp") //deferred store. The FilesystemAdapter has no rename, so it's copied over the list file
 
 using namespace MicroOcpp;
 
@@ -51,12 +54,30 @@ bool AuthorizationService::loadLists() {
     }
 
     size_t msize = 0;
-    if (filesystem->stat(MO_LOCALAUTHORIZATIONLIST_FN, &msize) != 0) {
+    bool listExists = filesystem->stat(MO_LOCALAUTHORIZATIONLIST_FN, &msize) == 0;
+    bool tmpExists = filesystem->stat(MO_LOCALAUTHORIZATIONLIST_TMP_FN, &msize) == 0;
+
+    if (!listExists && !tmpExists) {
         MO_DBG_DEBUG("no local authorization list stored already");
         return true;
     }
-    
-    auto doc = FilesystemUtils::loadJson(filesystem, MO_LOCALAUTHORIZATIONLIST_FN, getMemoryTag());
+
+    std::unique_ptr<JsonDoc> doc;
+    if (listExists) {
+        doc = FilesystemUtils::loadJson(filesystem, MO_LOCALAUTHORIZATIONLIST_FN, getMemoryTag());
+    }
+
+    if (tmpExists) {
+        if (doc) {
+            //deferred store was interrupted before the copy. The list file is still complete
+            filesystem->remove(MO_LOCALAUTHORIZATIONLIST_TMP_FN);
+        } else {
+            //deferred store was interrupted during the copy. The temporary file is complete
+            MO_DBG_WARN("restore %s", MO_LOCALAUTHORIZATIONLIST_TMP_FN);
+            doc = FilesystemUtils::loadJson(filesystem, MO_LOCALAUTHORIZATIONLIST_TMP_FN, getMemoryTag());
+        }
+    }
+
     if (!doc) {
         MO_DBG_ERR("failed to load %s", MO_LOCALAUTHORIZATIONLIST_FN);
         return false;
@@ -102,23 +123,184 @@ size_t AuthorizationService::getLocalListSize() {
 }
 
 bool AuthorizationService::updateLocalList(JsonArray localAuthorizationListJson, int listVersion, bool differential) {
-    bool success = localAuthorizationList.readJson(localAuthorizationListJson, listVersion, differential, false);
+    bool success = localAuthorizationList.stageJson(localAuthorizationListJson, listVersion, differential);
 
     if (success) {
-        
-        auto doc = initJsonDoc(getMemoryTag(),
-                JSON_OBJECT_SIZE(3) +
-                localAuthorizationList.getJsonCapacity());
-
-        JsonObject root = doc.to<JsonObject>();
-        root["listVersion"] = listVersion;
-        JsonArray authListCompact = root.createNestedArray("localAuthorizationList");
-        localAuthorizationList.writeJson(authListCompact, true);
-        success = FilesystemUtils::storeJson(filesystem, MO_LOCALAUTHORIZATIONLIST_FN, doc);
-
-        if (!success) {
-            loadLists();
+        localAuthorizationList.mergeStaged(localAuthorizationListJson.size());
+        success = storeLocalList();
+        storeRestart |= storePending; //a deferred store can't resume with the changed list
+    }
+
+    return success;
+}
+
+bool AuthorizationService::updateLocalListDeferred(JsonArray localAuthorizationListJson, int listVersion, bool differential) {
+    //only parse the payload here. It's released after this call
+    bool success = localAuthorizationList.stageJson(localAuthorizationListJson, listVersion, differential);
+
+    if (success && !storePending) {
+        storePending = true;
+        storeStage = StoreStage::Merge;
+        storeRestart = false;
+        context.getTaskQueue().addTask(makeTask([this] () {
+            return storeLocalListStep();
+        }));
+    } else if (success) {
+        storeRestart = true; //the pending Task will store this update too
+    }
+
+    return success;
+}
+
+TaskStatus AuthorizationService::storeLocalListStep() {
+
+    if (storeRestart && storeStage != StoreStage::Copy) {
+        //the temporary file is outdated. Don't interrupt the copy, the temporary file is the only complete version then
+        storeSrc.reset();
+        storeStage = StoreStage::Merge;
+        storeRestart = false;
+    }
+
+    switch (storeStage) {
+        case StoreStage::Merge: {
+            if (!localAuthorizationList.mergeStaged(MO_LOCALAUTH_STEP_SIZE)) {
+                return TaskStatus::Pending;
+            }
+
+            if (!filesystem) {
+                MO_DBG_ERR("no fs access");
+                return storeLocalListFailure();
+            }
+
+            storeSrc = filesystem->open(MO_LOCALAUTHORIZATIONLIST_TMP_FN, "w");
+            if (!storeSrc) {
+                MO_DBG_ERR("could not open %s", MO_LOCALAUTHORIZATIONLIST_TMP_FN);
+                return storeLocalListFailure();
+            }
+
+            char header [64];
+            auto ret = snprintf(header, sizeof(header), "{\"listVersion\":%i,\"localAuthorizationList\":[", localAuthorizationList.getListVersion());
+            if (ret < 0 || (size_t)ret >= sizeof(header) || storeSrc->write(header, (size_t)ret) != (size_t)ret) {
+                MO_DBG_ERR("write error");
+                return storeLocalListFailure();
+            }
+
+            storeCursor = 0;
+            storeStage = StoreStage::Write;
+            return TaskStatus::Pending;
+        }
+        case StoreStage::Write: {
+            size_t end = std::min(storeCursor + MO_LOCALAUTH_STEP_SIZE, localAuthorizationList.size());
+
+            for (; storeCursor < end; storeCursor++) {
+                auto& entry = localAuthorizationList.at(storeCursor);
+
+                auto doc = initJsonDoc(getMemoryTag(), entry.getJsonCapacity());
+                JsonObject entryJson = doc.to<JsonObject>();
+                entry.writeJson(entryJson, true);
+
+                if (doc.overflowed() ||
+                        (storeCursor > 0 && storeSrc->write(",", 1) != 1)) {
+                    MO_DBG_ERR("write error");
+                    return storeLocalListFailure();
+                }
+
+                ArduinoJsonFileAdapter fileWriter {storeSrc.get()};
+                if (serializeJson(doc, fileWriter) != measureJson(doc)) {
+                    MO_DBG_ERR("write error");
+                    return storeLocalListFailure();
+                }
+            }
+
+            if (storeCursor < localAuthorizationList.size()) {
+                return TaskStatus::Pending;
+            }
+
+            if (storeSrc->write("]}", 2) != 2) {
+                MO_DBG_ERR("write error");
+                return storeLocalListFailure();
+            }
+            storeSrc.reset(); //close
+
+            storeSrc = filesystem->open(MO_LOCALAUTHORIZATIONLIST_TMP_FN, "r");
+            storeDst = filesystem->open(MO_LOCALAUTHORIZATIONLIST_FN, "w");
+            if (!storeSrc || !storeDst) {
+                MO_DBG_ERR("could not open %s", MO_LOCALAUTHORIZATIONLIST_FN);
+                return storeLocalListFailure();
+            }
+
+            storeStage = StoreStage::Copy;
+            return TaskStatus::Pending;
+        }
+        case StoreStage::Copy: {
+            char buf [128];
+            size_t len = sizeof(buf);
+            for (size_t i = 0; i < MO_LOCALAUTH_STEP_SIZE && len == sizeof(buf); i++) {
+                len = storeSrc->read(buf, sizeof(buf));
+                if (len > 0 && storeDst->write(buf, len) != len) {
+                    MO_DBG_ERR("write error");
+                    return storeLocalListFailure();
+                }
+            }
+
+            if (len == sizeof(buf)) {
+                return TaskStatus::Pending; //not at the end of the file yet
+            }
+
+            storeSrc.reset();
+            storeDst.reset();
+            filesystem->remove(MO_LOCALAUTHORIZATIONLIST_TMP_FN);
+
+            if (storeRestart) {
+                //store the update which came in during the copy
+                storeStage = StoreStage::Merge;
+                storeRestart = false;
+                return TaskStatus::Pending;
+            }
+
+            MO_DBG_DEBUG("stored local list");
+            storeFailed = false;
+            storePending = false;
+            return TaskStatus::Done;
+        }
+    }
+
+    return storeLocalListFailure();
+}
+
+TaskStatus AuthorizationService::storeLocalListFailure() {
+    storeSrc.reset();
+    storeDst.reset();
+
+    if (filesystem && storeStage != StoreStage::Copy) {
+        size_t msize = 0;
+        if (filesystem->stat(MO_LOCALAUTHORIZATIONLIST_TMP_FN, &msize) == 0) {
+            filesystem->remove(MO_LOCALAUTHORIZATIONLIST_TMP_FN);
         }
+    } //else: keep the temporary file, the list file is incomplete
+
+    loadLists();
+
+    storeStage = StoreStage::Merge;
+    storeRestart = false;
+    storeFailed = true;
+    storePending = false;
+    return TaskStatus::Done;
+}
+
+bool AuthorizationService::storeLocalList() {
+    auto doc = initJsonDoc(getMemoryTag(),
+            JSON_OBJECT_SIZE(3) +
+            localAuthorizationList.getJsonCapacity());
+
+    JsonObject root = doc.to<JsonObject>();
+    root["listVersion"] = localAuthorizationList.getListVersion();
+    JsonArray authListCompact = root.createNestedArray("localAuthorizationList");
+    localAuthorizationList.writeJson(authListCompact, true);
+    bool success = FilesystemUtils::storeJson(filesystem, MO_LOCALAUTHORIZATIONLIST_FN, doc);
+
+    if (!success) {
+        loadLists();
     }
 
     return success;
@@ -13,6 +13,11 @@
 #include <MicroOcpp/Core/FilesystemAdapter.h>
 #include <MicroOcpp/Core/Configuration.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/TaskQueue.h>
+
+#ifndef MO_LOCALAUTH_STEP_SIZE
+#define MO_LOCALAUTH_STEP_SIZE 8 //number of list entries which a deferred update merges or writes per loop step
+#endif
 
 namespace MicroOcpp {
 
@@ -26,6 +31,23 @@ private:
 
     std::shared_ptr<Configuration> localAuthListEnabledBool;
 
+    bool storePending = false;
+    bool storeFailed = false;
+    bool storeLocalList();
+
+    //deferred store: merge the staged update, serialize it into a temporary file and copy that over the list file
+    enum class StoreStage : uint8_t {
+        Merge,
+        Write,
+        Copy
+    };
+    StoreStage storeStage = StoreStage::Merge;
+    bool storeRestart = false; //list updated while writing
+    size_t storeCursor = 0;
+    std::unique_ptr<FileAdapter> storeSrc, storeDst;
+    TaskStatus storeLocalListStep();
+    TaskStatus storeLocalListFailure();
+
 public:
     AuthorizationService(Context& context, std::shared_ptr<FilesystemAdapter> filesystem);
     ~AuthorizationService();
@@ -39,6 +61,11 @@ public:
 
     bool updateLocalList(JsonArray localAuthorizationListJson, int listVersion, bool differential);
 
+    //like updateLocalList, but merges and writes the list in the steps of a Task which runs in later loop calls
+    bool updateLocalListDeferred(JsonArray localAuthorizationListJson, int listVersion, bool differential);
+    bool isStorePending() {return storePending;}
+    bool isStoreFailed() {return storeFailed;} //result of the last deferred write
+
     void notifyAuthorization(const char *idTag, JsonObject idTagInfo);
 };
 
@@ -3,13 +3,16 @@
 // MIT License
 
 #include <limits>
+#include <algorithm>
 
 #include <MicroOcpp/Model/Boot/BootService.h>
 #include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Connection.h>
 #include <MicroOcpp/Model/Model.h>
 #include <MicroOcpp/Core/Configuration.h>
 #include <MicroOcpp/Core/Request.h>
 #include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Core/EnumTable.h>
 #include <MicroOcpp/Operations/BootNotification.h>
 #include <MicroOcpp/Platform.h>
 #include <MicroOcpp/Debug.h>
@@ -28,17 +31,23 @@ void PreBootQueue::activatePostBootCommunication() {
     activatedPostBootCommunication = true;
 }
 
+namespace MicroOcpp {
+
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<4,4> registrationStatusTable {
+    {"Accepted", "Pending", "Rejected", nullptr},
+    {0xFF, 2, 1, 0},
+    3U};
+static_assert(registrationStatusTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+} //end namespace MicroOcpp
+
 RegistrationStatus MicroOcpp::deserializeRegistrationStatus(const char *serialized) {
-    if (!strcmp(serialized, "Accepted")) {
-        return RegistrationStatus::Accepted;
-    } else if (!strcmp(serialized, "Pending")) {
-        return RegistrationStatus::Pending;
-    } else if (!strcmp(serialized, "Rejected")) {
-        return RegistrationStatus::Rejected;
-    } else {
+    RegistrationStatus res = RegistrationStatus::UNDEFINED;
+    if (!registrationStatusTable.decode(serialized, res)) {
         MO_DBG_ERR("deserialization error");
-        return RegistrationStatus::UNDEFINED;
     }
+    return res;
 }
 
 BootService::BootService(Context& context, std::shared_ptr<FilesystemAdapter> filesystem) : MemoryManaged("v16.Boot.BootService"), context(context), filesystem(filesystem), cpCredentials{makeString(getMemoryTag())} {
@@ -92,16 +101,34 @@ void BootService::loop() {
         return;
     }
     
-    if (mocpp_tick_ms() - lastBootNotification < (interval_s * 1000UL)) {
+    if (mocpp_tick_ms() - lastBootNotification < retryDelay) {
+        return;
+    }
+
+    auto& retryPolicy = context.getModel().getRetryPolicy();
+    if (attemptNr > 0 && retryPolicy.isHeldOff()) {
         return;
     }
 
+    /*
+     * Without response, back off from the default interval up to MO_BOOT_BACKOFF_MAX. Offline periods
+     * don't count as failed attempts. An interval from the server (Pending or Rejected) is used as is, see
+     * setRetryInterval()
+     */
+    if (context.getConnection().isConnected()) {
+        attemptNr++;
+    }
+    retryDelay = retryPolicy.getRetryDelay(std::max(1U, attemptNr), interval_s * 1000UL, 0, MO_BOOT_BACKOFF_MAX * 1000UL);
+
     /*
      * Create BootNotification. The BootNotifaction object will fetch its paremeters from
      * this class and notify this class about the response
      */
     auto bootNotification = makeRequest(new Ocpp16::BootNotification(context.getModel(), getChargePointCredentials()));
-    bootNotification->setTimeout(interval_s * 1000UL);
+    bootNotification->setTimeout(std::min(retryDelay, interval_s * 1000UL)); //the next attempt doesn't overlap with this one
+    bootNotification->setOnReceiveErrorListener([&retryPolicy] (const char *code, const char*, JsonObject details) {
+        retryPolicy.onCallError(code, details); //BootNotification is retried in any case, only take over server hint
+    });
     context.getRequestQueue().sendRequestPreBoot(std::move(bootNotification));
 
     lastBootNotification = mocpp_tick_ms();
@@ -113,6 +140,7 @@ void BootService::setChargePointCredentials(JsonObject credentials) {
         MO_DBG_ERR("serialization error");
         cpCredentials = "{}";
     }
+    context.getModel().getRetryPolicy().addEntropy(cpCredentials.c_str(), cpCredentials.size()); //serial numbers decorrelate retries in a fleet
 }
 
 void BootService::setChargePointCredentials(const char *credentials) {
@@ -120,6 +148,7 @@ void BootService::setChargePointCredentials(const char *credentials) {
     if (cpCredentials.size() < 2) {
         cpCredentials = "{}";
     }
+    context.getModel().getRetryPolicy().addEntropy(cpCredentials.c_str(), cpCredentials.size()); //serial numbers decorrelate retries in a fleet
 }
 
 std::unique_ptr<JsonDoc> BootService::getChargePointCredentials() {
@@ -157,6 +186,8 @@ void BootService::setRetryInterval(unsigned long interval_s) {
         this->interval_s = interval_s;
     }
     lastBootNotification = mocpp_tick_ms();
+    retryDelay = this->interval_s * 1000UL; //server hint, no backoff
+    attemptNr = 0;
 }
 
 bool BootService::loadBootStats(std::shared_ptr<FilesystemAdapter> filesystem, BootStats& bstats) {
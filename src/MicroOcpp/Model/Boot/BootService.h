@@ -13,6 +13,10 @@
 
 #define MO_BOOT_INTERVAL_DEFAULT 60
 
+#ifndef MO_BOOT_BACKOFF_MAX
+#define MO_BOOT_BACKOFF_MAX 300 //upper limit of the BootNotification retry delay in s. The charger is out of service until it's accepted
+#endif
+
 #ifndef MO_BOOTSTATS_LONGTIME_MS
 #define MO_BOOTSTATS_LONGTIME_MS 180 * 1000
 #endif
@@ -61,6 +65,8 @@ private:
 
     unsigned long interval_s = MO_BOOT_INTERVAL_DEFAULT;
     unsigned long lastBootNotification = -1UL / 2;
+    unsigned long retryDelay = 0; //ms until next BootNotification
+    unsigned int attemptNr = 0; //BootNotifications without response since the last server-defined interval
 
     RegistrationStatus status = RegistrationStatus::Pending;
     
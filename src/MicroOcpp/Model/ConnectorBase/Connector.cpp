@@ -35,42 +35,16 @@ using namespace MicroOcpp;
 
 Connector::Connector(Context& context, std::shared_ptr<FilesystemAdapter> filesystem, unsigned int connectorId)
         : MemoryManaged("v16.ConnectorBase.Connector"), context(context), model(context.getModel()), filesystem(filesystem), connectorId(connectorId),
-          errorDataInputs(makeVector<std::function<ErrorData ()>>(getMemoryTag())), trackErrorDataInputs(makeVector<bool>(getMemoryTag())) {
+          errorDataInputs(makeVector<std::function<ErrorData ()>>(getMemoryTag())), trackErrorDataInputs(makeVector<bool>(getMemoryTag())),
+          table(model.getConnectorTable()), configs(table.getConfigs()) {
+
+    table.addConnector(connectorId);
 
     context.getRequestQueue().addSendQueue(this); //register at RequestQueue as Request emitter
 
     snprintf(availabilityBoolKey, sizeof(availabilityBoolKey), MO_CONFIG_EXT_PREFIX "AVAIL_CONN_%d", connectorId);
     availabilityBool = declareConfiguration<bool>(availabilityBoolKey, true, MO_KEYVALUE_FN, false, false, false);
 
-#if MO_ENABLE_CONNECTOR_LOCK
-    declareConfiguration<bool>("UnlockConnectorOnEVSideDisconnect", true); //read-write
-#else
-    declareConfiguration<bool>("UnlockConnectorOnEVSideDisconnect", false, CONFIGURATION_VOLATILE, true); //read-only because there is no connector lock
-#endif //MO_ENABLE_CONNECTOR_LOCK
-
-    connectionTimeOutInt = declareConfiguration<int>("ConnectionTimeOut", 30);
-    minimumStatusDurationInt = declareConfiguration<int>("MinimumStatusDuration", 0);
-    stopTransactionOnInvalidIdBool = declareConfiguration<bool>("StopTransactionOnInvalidId", true);
-    stopTransactionOnEVSideDisconnectBool = declareConfiguration<bool>("StopTransactionOnEVSideDisconnect", true);
-    localPreAuthorizeBool = declareConfiguration<bool>("LocalPreAuthorize", false);
-    localAuthorizeOfflineBool = declareConfiguration<bool>("LocalAuthorizeOffline", true);
-    allowOfflineTxForUnknownIdBool = MicroOcpp::declareConfiguration<bool>("AllowOfflineTxForUnknownId", false);
-
-    //if the EVSE goes offline, can it continue to charge without sending StartTx / StopTx to the server when going online again?
-    silentOfflineTransactionsBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SilentOfflineTransactions", false);
-
-    //how long the EVSE tries the Authorize request before it enters offline mode
-    authorizationTimeoutInt = MicroOcpp::declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "AuthorizationTimeout", 20);
-
-    //FreeVend mode
-    freeVendActiveBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "FreeVendActive", false);
-    freeVendIdTagString = declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "FreeVendIdTag", "");
-
-    txStartOnPowerPathClosedBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "TxStartOnPowerPathClosed", false);
-
-    transactionMessageAttemptsInt = declareConfiguration<int>("TransactionMessageAttempts", 3);
-    transactionMessageRetryIntervalInt = declareConfiguration<int>("TransactionMessageRetryInterval", 60);
-
     if (!availabilityBool) {
         MO_DBG_ERR("Cannot declare availabilityBool");
     }
@@ -81,37 +55,39 @@ Connector::Connector(Context& context, std::shared_ptr<FilesystemAdapter> filesy
 
     unsigned int txNrPivot = std::numeric_limits<unsigned int>::max();
 
-    filesystem->ftw_root([this, txFnamePrefix, txFnamePrefixLen, &txNrPivot] (const char *fname) {
-        if (!strncmp(fname, txFnamePrefix, txFnamePrefixLen)) {
-            unsigned int parsedTxNr = 0;
-            for (size_t i = txFnamePrefixLen; fname[i] >= '0' && fname[i] <= '9'; i++) {
-                parsedTxNr *= 10;
-                parsedTxNr += fname[i] - '0';
-            }
-
-            if (txNrPivot == std::numeric_limits<unsigned int>::max()) {
-                txNrPivot = parsedTxNr;
-                txNrBegin = parsedTxNr;
-                txNrEnd = (parsedTxNr + 1) % MAX_TX_CNT;
-                return 0;
-            }
+    if (filesystem) { //otherwise volatile mode without stored txs
+        filesystem->ftw_root([this, txFnamePrefix, txFnamePrefixLen, &txNrPivot] (const char *fname) {
+            if (!strncmp(fname, txFnamePrefix, txFnamePrefixLen)) {
+                unsigned int parsedTxNr = 0;
+                for (size_t i = txFnamePrefixLen; fname[i] >= '0' && fname[i] <= '9'; i++) {
+                    parsedTxNr *= 10;
+                    parsedTxNr += fname[i] - '0';
+                }
 
-            if ((parsedTxNr + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT < MAX_TX_CNT / 2) {
-                //parsedTxNr is after pivot point
-                if ((parsedTxNr + 1 + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT > (txNrEnd + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT) {
+                if (txNrPivot == std::numeric_limits<unsigned int>::max()) {
+                    txNrPivot = parsedTxNr;
+                    txNrBegin = parsedTxNr;
                     txNrEnd = (parsedTxNr + 1) % MAX_TX_CNT;
+                    return 0;
                 }
-            } else if ((txNrPivot + MAX_TX_CNT - parsedTxNr) % MAX_TX_CNT < MAX_TX_CNT / 2) {
-                //parsedTxNr is before pivot point
-                if ((txNrPivot + MAX_TX_CNT - parsedTxNr) % MAX_TX_CNT > (txNrPivot + MAX_TX_CNT - txNrBegin) % MAX_TX_CNT) {
-                    txNrBegin = parsedTxNr;
+
+                if ((parsedTxNr + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT < MAX_TX_CNT / 2) {
+                    //parsedTxNr is after pivot point
+                    if ((parsedTxNr + 1 + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT > (txNrEnd + MAX_TX_CNT - txNrPivot) % MAX_TX_CNT) {
+                        txNrEnd = (parsedTxNr + 1) % MAX_TX_CNT;
+                    }
+                } else if ((txNrPivot + MAX_TX_CNT - parsedTxNr) % MAX_TX_CNT < MAX_TX_CNT / 2) {
+                    //parsedTxNr is before pivot point
+                    if ((txNrPivot + MAX_TX_CNT - parsedTxNr) % MAX_TX_CNT > (txNrPivot + MAX_TX_CNT - txNrBegin) % MAX_TX_CNT) {
+                        txNrBegin = parsedTxNr;
+                    }
                 }
-            }
 
-            MO_DBG_DEBUG("found %s%u.jsn - Internal range from %u to %u (exclusive)", txFnamePrefix, parsedTxNr, txNrBegin, txNrEnd);
-        }
-        return 0;
-    });
+                MO_DBG_DEBUG("found %s%u.jsn - Internal range from %u to %u (exclusive)", txFnamePrefix, parsedTxNr, txNrBegin, txNrEnd);
+            }
+            return 0;
+        });
+    }
 
     MO_DBG_DEBUG("found %u transactions for connector %u. Internal range from %u to %u (exclusive)", (txNrEnd + MAX_TX_CNT - txNrBegin) % MAX_TX_CNT, connectorId, txNrBegin, txNrEnd);
     txNrFront = txNrBegin;
@@ -178,7 +154,7 @@ ChargePointStatus Connector::getStatus() {
         /*
          * Either in Preparing or Finishing state. Only way to know is from previous state
          */
-        const auto previous = currentStatus;
+        const auto previous = table.getCurrentStatus(connectorId);
         if (previous == ChargePointStatus_Finishing ||
                 previous == ChargePointStatus_Charging ||
                 previous == ChargePointStatus_SuspendedEV ||
@@ -220,12 +196,12 @@ bool Connector::ocppPermitsCharge() {
     bool suspendDeAuthorizedIdTag = transaction && transaction->isIdTagDeauthorized(); //if idTag status is "DeAuthorized" and if charging should stop
     
     //check special case for DeAuthorized idTags: FreeVend mode
-    if (suspendDeAuthorizedIdTag && freeVendActiveBool && freeVendActiveBool->getBool()) {
+    if (suspendDeAuthorizedIdTag && configs.freeVendActiveBool && configs.freeVendActiveBool->getBool()) {
         suspendDeAuthorizedIdTag = false;
     }
 
     // check charge permission depending on TxStartPoint
-    if (txStartOnPowerPathClosedBool && txStartOnPowerPathClosedBool->getBool()) {
+    if (configs.txStartOnPowerPathClosedBool && configs.txStartOnPowerPathClosedBool->getBool()) {
         // tx starts when the power path is closed. Advertise charging before transaction
         return transaction &&
                 transaction->isActive() &&
@@ -290,7 +266,7 @@ void Connector::loop() {
             
         if (connectorPluggedInput) {
             if (transaction->isRunning() && transaction->isActive() && !connectorPluggedInput()) {
-                if (!stopTransactionOnEVSideDisconnectBool || stopTransactionOnEVSideDisconnectBool->getBool()) {
+                if (!configs.stopTransactionOnEVSideDisconnectBool || configs.stopTransactionOnEVSideDisconnectBool->getBool()) {
                     MO_DBG_DEBUG("Stop Tx due to EV disconnect");
                     transaction->setStopReason("EVDisconnected");
                     transaction->setInactive();
@@ -301,9 +277,9 @@ void Connector::loop() {
             if (transaction->isActive() &&
                     !transaction->getStartSync().isRequested() &&
                     transaction->getBeginTimestamp() > MIN_TIME &&
-                    connectionTimeOutInt && connectionTimeOutInt->getInt() > 0 &&
+                    configs.connectionTimeOutInt && configs.connectionTimeOutInt->getInt() > 0 &&
                     !connectorPluggedInput() &&
-                    model.getClock().now() - transaction->getBeginTimestamp() >= connectionTimeOutInt->getInt()) {
+                    model.getClock().now() - transaction->getBeginTimestamp() >= configs.connectionTimeOutInt->getInt()) {
 
                 MO_DBG_INFO("Session mngt: timeout");
                 transaction->setInactive();
@@ -316,7 +292,7 @@ void Connector::loop() {
         if (transaction->isActive() &&
                 transaction->isIdTagDeauthorized() && ( //transaction has been deAuthorized
                     !transaction->isRunning() ||        //if transaction hasn't started yet, always end
-                    !stopTransactionOnInvalidIdBool || stopTransactionOnInvalidIdBool->getBool())) { //if transaction is running, behavior depends on StopTransactionOnInvalidId
+                    !configs.stopTransactionOnInvalidIdBool || configs.stopTransactionOnInvalidIdBool->getBool())) { //if transaction is running, behavior depends on StopTransactionOnInvalidId
             
             MO_DBG_DEBUG("DeAuthorize session");
             transaction->setStopReason("DeAuthorized");
@@ -334,7 +310,7 @@ void Connector::loop() {
             if (transaction->isActive() && transaction->isAuthorized() &&  //tx must be authorized
                     (!connectorPluggedInput || connectorPluggedInput()) && //if applicable, connector must be plugged
                     isOperative() && //only start tx if charger is free of error conditions
-                    (!txStartOnPowerPathClosedBool || !txStartOnPowerPathClosedBool->getBool() || !evReadyInput || evReadyInput()) && //if applicable, postpone tx start point to PowerPathClosed
+                    (!configs.txStartOnPowerPathClosedBool || !configs.txStartOnPowerPathClosedBool->getBool() || !evReadyInput || evReadyInput()) && //if applicable, postpone tx start point to PowerPathClosed
                     (!startTxReadyInput || startTxReadyInput())) { //if defined, user Input for allowing StartTx must be true
                 //start Transaction
 
@@ -423,9 +399,9 @@ void Connector::loop() {
     } //end transaction-related operations
 
     //handle FreeVend mode
-    if (freeVendActiveBool && freeVendActiveBool->getBool() && connectorPluggedInput) {
+    if (configs.freeVendActiveBool && configs.freeVendActiveBool->getBool() && connectorPluggedInput) {
         if (!freeVendTrackPlugged && connectorPluggedInput() && !transaction) {
-            const char *idTag = freeVendIdTagString ? freeVendIdTagString->getString() : "";
+            const char *idTag = configs.freeVendIdTagString ? configs.freeVendIdTagString->getString() : "";
             if (!idTag || *idTag == '\0') {
                 idTag = "A0000000";
             }
@@ -447,6 +423,8 @@ void Connector::loop() {
     if (model.getVersion().major == 1 && model.getClock().now() >= MIN_TIME) {
         //OCPP 1.6: use StatusNotification to send error codes
 
+        const int reportedErrorIndex = table.getReportedErrorIndex(connectorId);
+
         if (reportedErrorIndex >= 0) {
             auto error = errorDataInputs[reportedErrorIndex].operator()();
             if (error.isError) {
@@ -478,51 +456,53 @@ void Connector::loop() {
 
         if (errorDataIndex != reportedErrorIndex) {
             if (errorDataIndex >= 0 || MO_REPORT_NOERROR) {
-                reportedStatus = ChargePointStatus_UNDEFINED; //trigger sending currentStatus again with code NoError
+                table.invalidateReportedStatus(connectorId); //trigger sending currentStatus again with code NoError
             } else {
-                reportedErrorIndex = -1;
+                table.clearReportedError(connectorId);
             }
         }
     } //if (model.getVersion().major == 1)
 
     auto status = getStatus();
 
-    if (status != currentStatus) {
+    if (status != table.getCurrentStatus(connectorId)) {
         MO_DBG_DEBUG("Status changed %s -> %s %s",
-                currentStatus == ChargePointStatus_UNDEFINED ? "" : cstrFromOcppEveState(currentStatus),
+                table.getCurrentStatus(connectorId) == ChargePointStatus_UNDEFINED ? "" : cstrFromOcppEveState(table.getCurrentStatus(connectorId)),
                 cstrFromOcppEveState(status),
-                minimumStatusDurationInt->getInt() ? " (will report delayed)" : "");
-        currentStatus = status;
-        t_statusTransition = mocpp_tick_ms();
+                configs.minimumStatusDurationInt->getInt() ? " (will report delayed)" : "");
     }
 
-    if (reportedStatus != currentStatus &&
-            model.getClock().now() >= MIN_TIME &&
-            (minimumStatusDurationInt->getInt() <= 0 || //MinimumStatusDuration disabled
-            mocpp_tick_ms() - t_statusTransition >= ((unsigned long) minimumStatusDurationInt->getInt()) * 1000UL)) {
-        reportedStatus = currentStatus;
-        reportedErrorIndex = errorDataIndex;
-        if (errorDataIndex >= 0) {
-            trackErrorDataInputs[errorDataIndex] = true;
-        }
-        Timestamp reportedTimestamp = model.getClock().now();
-        reportedTimestamp -= (mocpp_tick_ms() - t_statusTransition) / 1000UL;
-
-        auto statusNotification =
-            #if MO_ENABLE_V201
-            model.getVersion().major == 2 ?
-                makeRequest(
-                    new Ocpp201::StatusNotification(connectorId, reportedStatus, reportedTimestamp)) :
-            #endif //MO_ENABLE_V201
-                makeRequest(
-                    new Ocpp16::StatusNotification(connectorId, reportedStatus, reportedTimestamp, errorData));
-
-        statusNotification->setTimeout(0);
-        context.initiateRequest(std::move(statusNotification));
-        return;
+    table.updateStatus(connectorId, status, errorDataIndex, mocpp_tick_ms());
+    statusErrorData = errorData;
+
+    //the Model sends the StatusNotification after the loop of all connectors, see reportStatus()
+}
+
+void Connector::reportStatus() {
+
+    table.setReported(connectorId);
+
+    auto errorDataIndex = table.getReportedErrorIndex(connectorId);
+    if (errorDataIndex >= 0 && (size_t)errorDataIndex < trackErrorDataInputs.size()) {
+        trackErrorDataInputs[errorDataIndex] = true;
     }
 
-    return;
+    auto reportedStatus = table.getCurrentStatus(connectorId);
+
+    Timestamp reportedTimestamp = model.getClock().now();
+    reportedTimestamp -= (mocpp_tick_ms() - table.getStatusTransition(connectorId)) / 1000UL;
+
+    auto statusNotification =
+        #if MO_ENABLE_V201
+        model.getVersion().major == 2 ?
+            makeRequest(
+                new Ocpp201::StatusNotification(connectorId, reportedStatus, reportedTimestamp)) :
+        #endif //MO_ENABLE_V201
+            makeRequest(
+                new Ocpp16::StatusNotification(connectorId, reportedStatus, reportedTimestamp, statusErrorData));
+
+    statusNotification->setTimeout(0);
+    context.initiateRequest(std::move(statusNotification));
 }
 
 bool Connector::isFaulted() {
@@ -536,6 +516,7 @@ bool Connector::isFaulted() {
 }
 
 const char *Connector::getErrorCode() {
+    const int reportedErrorIndex = table.getReportedErrorIndex(connectorId);
     if (reportedErrorIndex >= 0) {
         auto error = errorDataInputs[reportedErrorIndex].operator()();
         if (error.isError && error.errorCode) {
@@ -641,7 +622,7 @@ std::shared_ptr<Transaction> Connector::allocateTransaction() {
 
     if (!tx) {
         //couldn't create normal transaction -> check if to start charging without real transaction
-        if (silentOfflineTransactionsBool && silentOfflineTransactionsBool->getBool()) {
+        if (configs.silentOfflineTransactionsBool && configs.silentOfflineTransactionsBool->getBool()) {
             //try to handle charging session without sending StartTx or StopTx to the server
             tx = model.getTransactionStore()->createTransaction(connectorId, txNrEnd, true);
 
@@ -766,7 +747,7 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
     transaction->setBeginTimestamp(model.getClock().now());
 
     //check for local preauthorization
-    if (localAuthFound && localPreAuthorizeBool && localPreAuthorizeBool->getBool()) {
+    if (localAuthFound && configs.localPreAuthorizeBool && configs.localPreAuthorizeBool->getBool()) {
         MO_DBG_DEBUG("Begin transaction process (%s), preauthorized locally", idTag != nullptr ? idTag : "");
 
         if (reservationId >= 0) {
@@ -777,10 +758,32 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
         updateTxNotification(TxNotification::Authorized);
     }
 
+    //check for speculative authorization
+    speculativeTxPending = false;
+    if (localAuthFound && !transaction->isAuthorized() && configs.speculativeAuthorizeBool && configs.speculativeAuthorizeBool->getBool()) {
+        MO_DBG_DEBUG("Begin transaction process (%s), authorized speculatively", idTag != nullptr ? idTag : "");
+
+        if (reservationId >= 0) {
+            transaction->setReservationId(reservationId);
+        }
+        transaction->setAuthorized();
+
+        speculativeTxPending = true;
+        speculativeTxNr = transaction->getTxNr();
+        speculativeTxSince = mocpp_tick_ms();
+
+        updateTxNotification(TxNotification::Authorized);
+    }
+
     transaction->commit();
 
     auto authorize = makeRequest(new Ocpp16::Authorize(context.getModel(), idTag));
-    authorize->setTimeout(authorizationTimeoutInt && authorizationTimeoutInt->getInt() > 0 ? authorizationTimeoutInt->getInt() * 1000UL : 20UL * 1000UL);
+    unsigned long authorizationTimeout = configs.authorizationTimeoutInt && configs.authorizationTimeoutInt->getInt() > 0 ? configs.authorizationTimeoutInt->getInt() * 1000UL : 20UL * 1000UL;
+    if (configs.authorizationTimeoutAdaptiveBool && configs.authorizationTimeoutAdaptiveBool->getBool()) {
+        //shorten the timeout to the measured RTO, or to a short probe if requests currently don't get through
+        authorizationTimeout = context.getRequestQueue().getLinkMonitor().getAdaptiveTimeout(authorizationTimeout, mocpp_tick_ms());
+    }
+    authorize->setTimeout(authorizationTimeout);
 
     if (!context.getConnection().isConnected()) {
         //WebSockt unconnected. Enter offline mode immediately
@@ -793,6 +796,10 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
 
         if (strcmp("Accepted", idTagInfo["status"] | "UNDEFINED")) {
             //Authorization rejected, abort transaction
+            if (withdrawSpeculativeTx(*tx)) {
+                updateTxNotification(TxNotification::AuthorizationRejected);
+                return;
+            }
             MO_DBG_DEBUG("Authorize rejected (%s), abort tx process", tx->getIdTag());
             tx->setIdTagDeauthorized();
             tx->commit();
@@ -816,6 +823,7 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
                 } else {
                     //reservation found for connector but does not match idTag or parentIdTag
                     MO_DBG_INFO("connector %u reserved - abort transaction", connectorId);
+                    withdrawSpeculativeTx(*tx);
                     tx->setInactive();
                     tx->commit();
                     updateTxNotification(TxNotification::ReservationConflict);
@@ -829,11 +837,15 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
             tx->setParentIdTag(idTagInfo["parentIdTag"] | "");
         }
 
+        bool speculative = confirmSpeculativeTx(*tx);
+
         MO_DBG_DEBUG("Authorized transaction process (%s)", tx->getIdTag());
         tx->setAuthorized();
         tx->commit();
 
-        updateTxNotification(TxNotification::Authorized);
+        if (!speculative) {
+            updateTxNotification(TxNotification::Authorized);
+        }
     });
 
     //capture local auth and reservation check in for timeout handler
@@ -861,30 +873,37 @@ std::shared_ptr<Transaction> Connector::beginTransaction(const char *idTag) {
             return;
         }
 
-        if (localAuthFound && localAuthorizeOfflineBool && localAuthorizeOfflineBool->getBool()) {
+        if (localAuthFound && configs.localAuthorizeOfflineBool && configs.localAuthorizeOfflineBool->getBool()) {
             MO_DBG_DEBUG("Offline transaction process (%s), locally authorized", tx->getIdTag());
             if (reservationId >= 0) {
                 tx->setReservationId(reservationId);
             }
+            bool speculative = confirmSpeculativeTx(*tx);
             tx->setAuthorized();
             tx->commit();
 
-            updateTxNotification(TxNotification::Authorized);
+            if (!speculative) {
+                updateTxNotification(TxNotification::Authorized);
+            }
             return;
         }
 
-        if (allowOfflineTxForUnknownIdBool && allowOfflineTxForUnknownIdBool->getBool()) {
+        if (configs.allowOfflineTxForUnknownIdBool && configs.allowOfflineTxForUnknownIdBool->getBool()) {
             MO_DBG_DEBUG("Offline transaction process (%s), allow unknown ID", tx->getIdTag());
             if (reservationId >= 0) {
                 tx->setReservationId(reservationId);
             }
+            bool speculative = confirmSpeculativeTx(*tx);
             tx->setAuthorized();
             tx->commit();
-            updateTxNotification(TxNotification::Authorized);
+            if (!speculative) {
+                updateTxNotification(TxNotification::Authorized);
+            }
             return;
         }
 
         MO_DBG_DEBUG("Abort transaction process (%s): timeout", tx->getIdTag());
+        withdrawSpeculativeTx(*tx);
         tx->setInactive();
         tx->commit();
         updateTxNotification(TxNotification::AuthorizationTimeout);
@@ -1130,6 +1149,50 @@ unsigned int Connector::getFrontRequestOpNr() {
     return NoOperation;
 }
 
+bool Connector::isTxMsgRetryDue(SendStatus& sendStatus, bool stopTx) {
+    if (sendStatus.getAttemptNr() == 0) {
+        return true;
+    }
+
+    auto& retryPolicy = model.getRetryPolicy();
+    if (retryPolicy.isHeldOff()) {
+        return false;
+    }
+
+    uint32_t salt = ((uint32_t)connectorId << 24) ^ ((uint32_t)transactionFront->getTxNr() << 1) ^ (stopTx ? 1 : 0);
+    unsigned long delay = retryPolicy.getRetryDelay(sendStatus.getAttemptNr(),
+                                                    (unsigned long)std::max(0, configs.transactionMessageRetryIntervalInt->getInt()) * 1000UL,
+                                                    salt);
+
+    Timestamp nextAttempt = sendStatus.getAttemptTime() + (int)(delay / 1000UL);
+    return nextAttempt <= model.getClock().now();
+}
+
+bool Connector::confirmSpeculativeTx(Transaction& tx) {
+    if (!speculativeTxPending || tx.getTxNr() != speculativeTxNr) {
+        return false;
+    }
+    speculativeTxPending = false;
+    MO_DBG_DEBUG("speculative transaction confirmed (%s)", tx.getIdTag());
+    return true;
+}
+
+bool Connector::withdrawSpeculativeTx(Transaction& tx) {
+    if (!speculativeTxPending || tx.getTxNr() != speculativeTxNr) {
+        return false;
+    }
+    speculativeTxPending = false;
+
+    MO_DBG_INFO("withdraw speculative transaction (%s)", tx.getIdTag());
+
+    //the charger has already delivered energy. Stop the tx and report it with StartTx and StopTx like any other
+    //tx, so that the server can account for the energy. The StartTx isn't held back anymore
+    tx.setStopReason("DeAuthorized");
+    tx.setInactive();
+    tx.commit();
+    return true;
+}
+
 std::unique_ptr<Request> Connector::fetchFrontRequest() {
 
     if (transactionFront && !transactionFront->isSilent()) {
@@ -1146,7 +1209,7 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
                 cancelStartTx = true;
             }
 
-            if ((int)transactionFront->getStartSync().getAttemptNr() >= transactionMessageAttemptsInt->getInt()) {
+            if ((int)transactionFront->getStartSync().getAttemptNr() >= configs.transactionMessageAttemptsInt->getInt()) {
                 MO_DBG_WARN("exceeded TransactionMessageAttempts. Discard transaction");
 
                 cancelStartTx = true;
@@ -1165,10 +1228,14 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
                 return nullptr;
             }
 
-            Timestamp nextAttempt = transactionFront->getStartSync().getAttemptTime() +
-                                    transactionFront->getStartSync().getAttemptNr() * std::max(0, transactionMessageRetryIntervalInt->getInt());
+            if (speculativeTxPending && transactionFront->getTxNr() == speculativeTxNr &&
+                    configs.speculativeAuthorizeWindowInt &&
+                    mocpp_tick_ms() - speculativeTxSince < (unsigned long)std::max(0, configs.speculativeAuthorizeWindowInt->getInt()) * 1000UL) {
+                //wait for the Authorize.conf, so that the StartTx doesn't precede the authorization
+                return nullptr;
+            }
 
-            if (nextAttempt > model.getClock().now()) {
+            if (!isTxMsgRetryDue(transactionFront->getStartSync(), false)) {
                 return nullptr;
             }
 
@@ -1186,9 +1253,16 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
                 }
             });
             auto transactionFront_capture = transactionFront;
+            startTx->setOnReceiveErrorListener([this, transactionFront_capture] (const char *code, const char*, JsonObject details) {
+                if (model.getRetryPolicy().onCallError(code, details) == RetryDecision::GiveUp) {
+                    //retrying would be rejected again. Let the onAbort listener discard the tx
+                    transactionFront_capture->getStartSync().setAttemptNr(std::max(transactionFront_capture->getStartSync().getAttemptNr(),
+                                                                                   (unsigned int)std::max(0, configs.transactionMessageAttemptsInt->getInt())));
+                }
+            });
             startTx->setOnAbortListener([this, transactionFront_capture] () {
                 //shortcut to the attemptNr check above. Relevant if other operations block the queue while this StartTx is timing out
-                if (transactionFront_capture && (int)transactionFront_capture->getStartSync().getAttemptNr() >= transactionMessageAttemptsInt->getInt()) {
+                if (transactionFront_capture && (int)transactionFront_capture->getStartSync().getAttemptNr() >= configs.transactionMessageAttemptsInt->getInt()) {
                     MO_DBG_WARN("exceeded TransactionMessageAttempts. Discard transaction");
 
                     transactionFront_capture->setSilent();
@@ -1209,7 +1283,7 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
         if (transactionFront->getStopSync().isRequested() && !transactionFront->getStopSync().isConfirmed()) {
             //send StopTx?
 
-            if ((int)transactionFront->getStopSync().getAttemptNr() >= transactionMessageAttemptsInt->getInt()) {
+            if ((int)transactionFront->getStopSync().getAttemptNr() >= configs.transactionMessageAttemptsInt->getInt()) {
                 MO_DBG_WARN("exceeded TransactionMessageAttempts. Discard transaction");
 
                 transactionFront->setSilent();
@@ -1222,10 +1296,7 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
                 return nullptr;
             }
 
-            Timestamp nextAttempt = transactionFront->getStopSync().getAttemptTime() +
-                                    transactionFront->getStopSync().getAttemptNr() * std::max(0, transactionMessageRetryIntervalInt->getInt());
-
-            if (nextAttempt > model.getClock().now()) {
+            if (!isTxMsgRetryDue(transactionFront->getStopSync(), true)) {
                 return nullptr;
             }
 
@@ -1249,7 +1320,7 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
             auto transactionFront_capture = transactionFront;
             stopTx->setOnAbortListener([this, transactionFront_capture] () {
                 //shortcut to the attemptNr check above. Relevant if other operations block the queue while this StopTx is timing out
-                if ((int)transactionFront_capture->getStopSync().getAttemptNr() >= transactionMessageAttemptsInt->getInt()) {
+                if ((int)transactionFront_capture->getStopSync().getAttemptNr() >= configs.transactionMessageAttemptsInt->getInt()) {
                     MO_DBG_WARN("exceeded TransactionMessageAttempts. Discard transaction");
 
                     transactionFront_capture->setSilent();
@@ -1272,10 +1343,16 @@ std::unique_ptr<Request> Connector::fetchFrontRequest() {
 }
 
 bool Connector::triggerStatusNotification() {
+    context.getRequestQueue().sendRequestPreBoot(createTriggeredStatusNotification());
+    return true;
+}
+
+std::unique_ptr<Request> Connector::createTriggeredStatusNotification() {
 
     ErrorData errorData {nullptr};
     errorData.severity = 0;
 
+    const int reportedErrorIndex = table.getReportedErrorIndex(connectorId);
     if (reportedErrorIndex >= 0) {
         errorData = errorDataInputs[reportedErrorIndex].operator()();
     } else {
@@ -1297,9 +1374,7 @@ bool Connector::triggerStatusNotification() {
 
     statusNotification->setTimeout(60000);
 
-    context.getRequestQueue().sendRequestPreBoot(std::move(statusNotification));
-
-    return true;
+    return statusNotification;
 }
 
 unsigned int Connector::getTxNrBeginHistory() {
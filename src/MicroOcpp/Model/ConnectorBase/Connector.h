@@ -8,6 +8,7 @@
 #include <MicroOcpp/Model/ConnectorBase/ChargePointStatus.h>
 #include <MicroOcpp/Model/ConnectorBase/ChargePointErrorData.h>
 #include <MicroOcpp/Model/ConnectorBase/Notification.h>
+#include <MicroOcpp/Model/ConnectorBase/ConnectorTable.h>
 #include <MicroOcpp/Model/ConnectorBase/UnlockConnectorResult.h>
 #include <MicroOcpp/Core/RequestQueue.h>
 #include <MicroOcpp/Core/ConfigurationKeyValue.h>
@@ -34,6 +35,7 @@ class Context;
 class Model;
 class Operation;
 class Transaction;
+class SendStatus;
 
 class Connector : public RequestEmitter, public MemoryManaged {
 private:
@@ -54,14 +56,12 @@ private:
     std::function<bool()> evseReadyInput;
     Vector<std::function<ErrorData ()>> errorDataInputs;
     Vector<bool> trackErrorDataInputs;
-    int reportedErrorIndex = -1; //last reported error
+    ErrorData statusErrorData {nullptr}; //error of the next StatusNotification
     bool isFaulted();
     const char *getErrorCode();
 
-    ChargePointStatus currentStatus = ChargePointStatus_UNDEFINED;
-    std::shared_ptr<Configuration> minimumStatusDurationInt; //in seconds
-    ChargePointStatus reportedStatus = ChargePointStatus_UNDEFINED;
-    unsigned long t_statusTransition = 0;
+    ConnectorTable& table; //status of this connector is stored in the packed arrays of the Model
+    ConnectorConfigs& configs; //shared by all connectors
 
 #if MO_ENABLE_CONNECTOR_LOCK
     std::function<UnlockConnectorResult()> onUnlockConnector;
@@ -73,24 +73,8 @@ private:
 
     std::function<void(Transaction*,TxNotification)> txNotificationOutput;
 
-    std::shared_ptr<Configuration> connectionTimeOutInt; //in seconds
-    std::shared_ptr<Configuration> stopTransactionOnInvalidIdBool;
-    std::shared_ptr<Configuration> stopTransactionOnEVSideDisconnectBool;
-    std::shared_ptr<Configuration> localPreAuthorizeBool;
-    std::shared_ptr<Configuration> localAuthorizeOfflineBool;
-    std::shared_ptr<Configuration> allowOfflineTxForUnknownIdBool;
-
-    std::shared_ptr<Configuration> silentOfflineTransactionsBool;
-    std::shared_ptr<Configuration> authorizationTimeoutInt; //in seconds
-    std::shared_ptr<Configuration> freeVendActiveBool;
-    std::shared_ptr<Configuration> freeVendIdTagString;
     bool freeVendTrackPlugged = false;
 
-    std::shared_ptr<Configuration> txStartOnPowerPathClosedBool; // this postpones the tx start point to when evReadyInput becomes true
-
-    std::shared_ptr<Configuration> transactionMessageAttemptsInt;
-    std::shared_ptr<Configuration> transactionMessageRetryIntervalInt;
-
     bool trackLoopExecute = false; //if loop has been executed once
 
     unsigned int txNrBegin = 0; //oldest (historical) transaction on flash. Has no function, but is useful for error diagnosis
@@ -98,6 +82,15 @@ private:
     unsigned int txNrEnd = 0; //one position behind newest transaction
 
     std::shared_ptr<Transaction> transactionFront;
+
+    bool isTxMsgRetryDue(SendStatus& sendStatus, bool stopTx); //TransactionMessageRetryInterval elapsed, see RetryPolicy
+
+    //speculative authorization: the tx runs on a local hit while the Authorize is pending. Its StartTx is held back for the speculation window
+    bool speculativeTxPending = false;
+    unsigned int speculativeTxNr = 0;
+    unsigned long speculativeTxSince = 0;
+    bool confirmSpeculativeTx(Transaction& tx); //returns true if tx has been authorized speculatively
+    bool withdrawSpeculativeTx(Transaction& tx); //returns true if tx has been authorized speculatively and is stopped now
 public:
     Connector(Context& context, std::shared_ptr<FilesystemAdapter> filesystem, unsigned int connectorId);
     Connector(const Connector&) = delete;
@@ -139,6 +132,8 @@ public:
 
     void loop();
 
+    void reportStatus(); //send StatusNotification with the current status. Called by the Model when due
+
     ChargePointStatus getStatus();
 
     bool ocppPermitsCharge();
@@ -159,6 +154,7 @@ public:
     std::unique_ptr<Request> fetchFrontRequest() override;
 
     bool triggerStatusNotification();
+    std::unique_ptr<Request> createTriggeredStatusNotification(); //like triggerStatusNotification, but returns the request instead of sending it
 
     unsigned int getTxNrBeginHistory(); //if getTxNrBeginHistory() != getTxNrFront(), then return value is the txNr of the oldest tx history entry. If equal to getTxNrFront(), then the history is empty
     unsigned int getTxNrFront(); //if getTxNrEnd() != getTxNrFront(), then return value is the txNr of the oldest transaction queued to be sent to the server. If equal to getTxNrEnd(), then there is no tx to be sent to the server
@@ -0,0 +1,110 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/ConnectorBase/ConnectorTable.h>
+#include <MicroOcpp/Model/ConnectorBase/UnlockConnectorResult.h>
+#include <MicroOcpp/Core/Configuration.h>
+
+using namespace MicroOcpp;
+
+ConnectorTable::ConnectorTable() : MemoryManaged("v16.ConnectorBase.ConnectorTable"),
+        currentStatus(makeVector<ChargePointStatus>(getMemoryTag())),
+        reportedStatus(makeVector<ChargePointStatus>(getMemoryTag())),
+        t_statusTransition(makeVector<unsigned long>(getMemoryTag())),
+        errorIndex(makeVector<int>(getMemoryTag())),
+        reportedErrorIndex(makeVector<int>(getMemoryTag())) {
+
+}
+
+ConnectorConfigs& ConnectorTable::getConfigs() {
+    if (configsDeclared) {
+        return configs;
+    }
+    configsDeclared = true;
+
+#if MO_ENABLE_CONNECTOR_LOCK
+    declareConfiguration<bool>("UnlockConnectorOnEVSideDisconnect", true); //read-write
+#else
+    declareConfiguration<bool>("UnlockConnectorOnEVSideDisconnect", false, CONFIGURATION_VOLATILE, true); //read-only because there is no connector lock
+#endif //MO_ENABLE_CONNECTOR_LOCK
+
+    configs.connectionTimeOutInt = declareConfiguration<int>("ConnectionTimeOut", 30);
+    configs.minimumStatusDurationInt = declareConfiguration<int>("MinimumStatusDuration", 0);
+    configs.stopTransactionOnInvalidIdBool = declareConfiguration<bool>("StopTransactionOnInvalidId", true);
+    configs.stopTransactionOnEVSideDisconnectBool = declareConfiguration<bool>("StopTransactionOnEVSideDisconnect", true);
+    configs.localPreAuthorizeBool = declareConfiguration<bool>("LocalPreAuthorize", false);
+    configs.localAuthorizeOfflineBool = declareConfiguration<bool>("LocalAuthorizeOffline", true);
+    configs.allowOfflineTxForUnknownIdBool = declareConfiguration<bool>("AllowOfflineTxForUnknownId", false);
+
+    //if the EVSE goes offline, can it continue to charge without sending StartTx / StopTx to the server when going online again?
+    configs.silentOfflineTransactionsBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SilentOfflineTransactions", false);
+
+    //how long the EVSE tries the Authorize request before it enters offline mode
+    configs.authorizationTimeoutInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "AuthorizationTimeout", 20);
+
+    //bound the Authorize timeout by the RTO which the LinkMonitor measures
+    configs.authorizationTimeoutAdaptiveBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "AuthorizationTimeoutAdaptive", true);
+
+    //on a local hit, start the tx immediately and stop it with the reason DeAuthorized if the server rejects the idTag
+    configs.speculativeAuthorizeBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SpeculativeAuthorize", false);
+    configs.speculativeAuthorizeWindowInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "SpeculativeAuthorizeWindow", 10);
+
+    //FreeVend mode
+    configs.freeVendActiveBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "FreeVendActive", false);
+    configs.freeVendIdTagString = declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "FreeVendIdTag", "");
+
+    configs.txStartOnPowerPathClosedBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "TxStartOnPowerPathClosed", false);
+
+    configs.transactionMessageAttemptsInt = declareConfiguration<int>("TransactionMessageAttempts", 3);
+    configs.transactionMessageRetryIntervalInt = declareConfiguration<int>("TransactionMessageRetryInterval", 60);
+
+    return configs;
+}
+
+void ConnectorTable::addConnector(unsigned int connectorId) {
+    if (connectorId < size()) {
+        return;
+    }
+    currentStatus.resize(connectorId + 1, ChargePointStatus_UNDEFINED);
+    reportedStatus.resize(connectorId + 1, ChargePointStatus_UNDEFINED);
+    t_statusTransition.resize(connectorId + 1, 0);
+    errorIndex.resize(connectorId + 1, -1);
+    reportedErrorIndex.resize(connectorId + 1, -1);
+}
+
+void ConnectorTable::updateStatus(unsigned int connectorId, ChargePointStatus status, int errorIndex, unsigned long t_now) {
+    this->errorIndex[connectorId] = errorIndex;
+    if (status != currentStatus[connectorId]) {
+        currentStatus[connectorId] = status;
+        t_statusTransition[connectorId] = t_now;
+    }
+}
+
+void ConnectorTable::invalidateReportedStatus(unsigned int connectorId) {
+    reportedStatus[connectorId] = ChargePointStatus_UNDEFINED;
+}
+
+void ConnectorTable::clearReportedError(unsigned int connectorId) {
+    reportedErrorIndex[connectorId] = -1;
+}
+
+void ConnectorTable::setReported(unsigned int connectorId) {
+    reportedStatus[connectorId] = currentStatus[connectorId];
+    reportedErrorIndex[connectorId] = errorIndex[connectorId];
+}
+
+unsigned int ConnectorTable::nextReportDue(unsigned int begin, unsigned long t_now, unsigned long minimumStatusDuration) const {
+    const unsigned int n = size();
+    const ChargePointStatus *current = currentStatus.data();
+    const ChargePointStatus *reported = reportedStatus.data();
+    const unsigned long *t_transition = t_statusTransition.data();
+
+    for (unsigned int i = begin; i < n; i++) {
+        if (reported[i] != current[i] &&
+                t_now - t_transition[i] >= minimumStatusDuration) {
+            return i;
+        }
+    }
+    return n;
+}
@@ -0,0 +1,82 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_CONNECTORTABLE_H
+#define MO_CONNECTORTABLE_H
+
+#include <MicroOcpp/Model/ConnectorBase/ChargePointStatus.h>
+#include <MicroOcpp/Core/ConfigurationKeyValue.h>
+#include <MicroOcpp/Core/Memory.h>
+
+#include <memory>
+
+namespace MicroOcpp {
+
+/*
+ * Configurations which apply to all connectors. The Connectors share one instance instead of holding
+ * their own handles to the same keys
+ */
+struct ConnectorConfigs {
+    std::shared_ptr<Configuration> minimumStatusDurationInt; //in seconds
+    std::shared_ptr<Configuration> connectionTimeOutInt; //in seconds
+    std::shared_ptr<Configuration> stopTransactionOnInvalidIdBool;
+    std::shared_ptr<Configuration> stopTransactionOnEVSideDisconnectBool;
+    std::shared_ptr<Configuration> localPreAuthorizeBool;
+    std::shared_ptr<Configuration> localAuthorizeOfflineBool;
+    std::shared_ptr<Configuration> allowOfflineTxForUnknownIdBool;
+
+    std::shared_ptr<Configuration> silentOfflineTransactionsBool;
+    std::shared_ptr<Configuration> authorizationTimeoutInt; //in seconds
+    std::shared_ptr<Configuration> authorizationTimeoutAdaptiveBool; //derive the Authorize timeout from the measured round-trip times
+    std::shared_ptr<Configuration> speculativeAuthorizeBool; //start the tx on a local hit and confirm it with the Authorize in parallel
+    std::shared_ptr<Configuration> speculativeAuthorizeWindowInt; //in seconds
+    std::shared_ptr<Configuration> freeVendActiveBool;
+    std::shared_ptr<Configuration> freeVendIdTagString;
+
+    std::shared_ptr<Configuration> txStartOnPowerPathClosedBool; // this postpones the tx start point to when evReadyInput becomes true
+
+    std::shared_ptr<Configuration> transactionMessageAttemptsInt;
+    std::shared_ptr<Configuration> transactionMessageRetryIntervalInt;
+};
+
+/*
+ * Status of all connectors in packed arrays, indexed by connectorId. Each Connector derives its status in
+ * its loop and updates its row. Then the Model scans the arrays in one pass for status changes which are
+ * due for a StatusNotification, so the reporting step doesn't visit each Connector object
+ */
+class ConnectorTable : public MemoryManaged {
+private:
+    ConnectorConfigs configs;
+    bool configsDeclared = false;
+
+    Vector<ChargePointStatus> currentStatus;
+    Vector<ChargePointStatus> reportedStatus;
+    Vector<unsigned long> t_statusTransition;
+    Vector<int> errorIndex; //index of the errorDataInput for the next StatusNotification or -1 if no error
+    Vector<int> reportedErrorIndex; //last reported error
+public:
+    ConnectorTable();
+
+    ConnectorConfigs& getConfigs(); //declares the configurations at the first call
+
+    void addConnector(unsigned int connectorId);
+    unsigned int size() const {return (unsigned int)currentStatus.size();}
+
+    ChargePointStatus getCurrentStatus(unsigned int connectorId) const {return currentStatus[connectorId];}
+    unsigned long getStatusTransition(unsigned int connectorId) const {return t_statusTransition[connectorId];}
+    int getReportedErrorIndex(unsigned int connectorId) const {return reportedErrorIndex[connectorId];}
+
+    void updateStatus(unsigned int connectorId, ChargePointStatus status, int errorIndex, unsigned long t_now);
+
+    void invalidateReportedStatus(unsigned int connectorId); //send currentStatus again, e.g. with a new error code
+    void clearReportedError(unsigned int connectorId);
+    void setReported(unsigned int connectorId); //the currentStatus is sent now
+
+    //first connectorId >= begin with a status change which has persisted for minimumStatusDuration (ms) or size() if none
+    unsigned int nextReportDue(unsigned int begin, unsigned long t_now, unsigned long minimumStatusDuration) const;
+};
+
+} //end namespace MicroOcpp
+
+#endif
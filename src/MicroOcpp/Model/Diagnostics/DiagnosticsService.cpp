@@ -504,7 +504,7 @@ void DiagnosticsService::setFtpServerCert(const char *cert) {
 bool g_diagsSent = false;
 
 std::unique_ptr<DiagnosticsService> MicroOcpp::makeDefaultDiagnosticsService(Context& context, std::shared_ptr<FilesystemAdapter> filesystem) {
-    std::unique_ptr<DiagnosticsService> diagService = std::unique_ptr<DiagnosticsService>(new DiagnosticsService(context));
+    std::unique_ptr<DiagnosticsService> diagService = std::unique_ptr<DiagnosticsService>(new ("v16.Diagnostics.DiagnosticsService") DiagnosticsService(context));
 
     diagService->setDiagnosticsReader(
         [] (char *buf, size_t size) -> size_t {
@@ -541,7 +541,7 @@ std::unique_ptr<DiagnosticsService> MicroOcpp::makeDefaultDiagnosticsService(Con
 #elif MO_ENABLE_MBEDTLS
 
 std::unique_ptr<DiagnosticsService> MicroOcpp::makeDefaultDiagnosticsService(Context& context, std::shared_ptr<FilesystemAdapter> filesystem) {
-    std::unique_ptr<DiagnosticsService> diagService = std::unique_ptr<DiagnosticsService>(new DiagnosticsService(context));
+    std::unique_ptr<DiagnosticsService> diagService = std::unique_ptr<DiagnosticsService>(new ("v16.Diagnostics.DiagnosticsService") DiagnosticsService(context));
 
     diagService->setDiagnosticsReader(nullptr, nullptr, filesystem); //report the built-in MO defaults
 
@@ -6,14 +6,37 @@
 #include <MicroOcpp/Core/Context.h>
 #include <MicroOcpp/Core/Request.h>
 #include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/LinkMonitor.h>
+#include <MicroOcpp/Model/Model.h>
 #include <MicroOcpp/Operations/Heartbeat.h>
 #include <MicroOcpp/Platform.h>
 
 using namespace MicroOcpp;
 
-HeartbeatService::HeartbeatService(Context& context) : MemoryManaged("v16.Heartbeat.HeartbeatService"), context(context) {
+bool HeartbeatSchedule::isDue(unsigned long t_now, unsigned long interval, bool deferOnTraffic, const LinkMonitor& linkMonitor, uint64_t msSinceSync, int32_t residualDriftPpm) const {
+    if (t_now - lastHeartbeat < interval) {
+        return false;
+    }
+
+    if (deferOnTraffic &&
+            linkMonitor.hasTraffic() &&
+            t_now - linkMonitor.getLastTraffic() < interval &&
+            !isResyncDue(msSinceSync, residualDriftPpm)) {
+        //the server has been reachable within the interval. Defer until the link has been silent for the interval
+        return false;
+    }
+
+    return true;
+}
+
+bool HeartbeatSchedule::isResyncDue(uint64_t msSinceSync, int32_t residualDriftPpm) {
+    uint64_t driftPpm = residualDriftPpm >= 0 ? (uint64_t) residualDriftPpm : (uint64_t) MO_HEARTBEAT_RESYNC_DRIFT_PPM;
+    return msSinceSync * driftPpm / 1000000ULL >= MO_HEARTBEAT_RESYNC_MAX_ERROR;
+}
+
+HeartbeatService::HeartbeatService(Context& context) : MemoryManaged("v16.Heartbeat.HeartbeatService"), context(context), schedule(mocpp_tick_ms()) {
     heartbeatIntervalInt = declareConfiguration<int>("HeartbeatInterval", 86400);
-    lastHeartbeat = mocpp_tick_ms();
+    deferOnTrafficBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "HeartbeatDeferOnTraffic", false);
 
     //Register message handler for TriggerMessage operation
     context.getOperationRegistry().registerOperation("Heartbeat", [&context] () {
@@ -25,8 +48,13 @@ void HeartbeatService::loop() {
     hbInterval *= 1000UL; //conversion s -> ms
     unsigned long now = mocpp_tick_ms();
 
-    if (now - lastHeartbeat >= hbInterval) {
-        lastHeartbeat = now;
+    auto& clock = context.getModel().getClock();
+
+    if (schedule.isDue(now, hbInterval, deferOnTrafficBool->getBool(),
+                context.getRequestQueue().getLinkMonitor(),
+                clock.getMsSinceSync(),
+                clock.getResidualDriftPpm())) {
+        schedule.onHeartbeat(now);
 
         auto heartbeat = makeRequest(new Ocpp16::Heartbeat(context.getModel()));
         context.initiateRequest(std::move(heartbeat));
@@ -6,20 +6,55 @@
 #define MO_HEARTBEATSERVICE_H
 
 #include <memory>
+#include <stdint.h>
 
 #include <MicroOcpp/Core/ConfigurationKeyValue.h>
 #include <MicroOcpp/Core/Memory.h>
 
+/*
+ * With Cst_HeartbeatDeferOnTraffic, the Heartbeat is still sent when the Clock needs a resync. The expected
+ * error of the Clock grows by its residual drift since the last time sync (BootNotification or Heartbeat).
+ * Once it exceeds MO_HEARTBEAT_RESYNC_MAX_ERROR (in ms), the next due Heartbeat isn't deferred. As long as
+ * the Clock hasn't learned the drift, the residual drift is assumed to be MO_HEARTBEAT_RESYNC_DRIFT_PPM
+ */
+#ifndef MO_HEARTBEAT_RESYNC_DRIFT_PPM
+#define MO_HEARTBEAT_RESYNC_DRIFT_PPM 100
+#endif
+
+#ifndef MO_HEARTBEAT_RESYNC_MAX_ERROR
+#define MO_HEARTBEAT_RESYNC_MAX_ERROR 1000
+#endif
+
 namespace MicroOcpp {
 
 class Context;
+class LinkMonitor;
+
+/*
+ * Decides when the next Heartbeat is due. By default, a Heartbeat is sent every HeartbeatInterval. If
+ * deferOnTraffic is set, any response or incoming request proves liveness like a Heartbeat, so the
+ * Heartbeat is only sent after the link has been silent for the HeartbeatInterval or if the Clock needs
+ * a resync
+ */
+class HeartbeatSchedule {
+private:
+    unsigned long lastHeartbeat;
+public:
+    HeartbeatSchedule(unsigned long t_now) : lastHeartbeat(t_now) { }
+
+    bool isDue(unsigned long t_now, unsigned long interval, bool deferOnTraffic, const LinkMonitor& linkMonitor, uint64_t msSinceSync, int32_t residualDriftPpm = -1) const;
+    void onHeartbeat(unsigned long t_now) {lastHeartbeat = t_now;}
+
+    static bool isResyncDue(uint64_t msSinceSync, int32_t residualDriftPpm = -1); //residualDriftPpm: see Clock::getResidualDriftPpm(). -1 for MO_HEARTBEAT_RESYNC_DRIFT_PPM
+};
 
 class HeartbeatService : public MemoryManaged {
 private:
     Context& context;
 
-    unsigned long lastHeartbeat;
+    HeartbeatSchedule schedule;
     std::shared_ptr<Configuration> heartbeatIntervalInt;
+    std::shared_ptr<Configuration> deferOnTrafficBool;
 
 public:
     HeartbeatService(Context& context);
@@ -0,0 +1,201 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Metering/MeterAggregator.h>
+
+#if MO_ENABLE_METER_AGGREGATION
+
+#include <MicroOcpp/Core/EnumTable.h>
+#include <MicroOcpp/Platform.h>
+#include <MicroOcpp/Debug.h>
+
+namespace MicroOcpp {
+
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<5,8> aggregationStatisticTable {
+    {"Mean", "Min", "Max", "Last", nullptr},
+    {0xFF, 0xFF, 2, 3, 0xFF, 1, 0xFF, 0},
+    2U};
+static_assert(aggregationStatisticTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+} //namespace MicroOcpp
+
+using namespace MicroOcpp;
+
+#define MS_PER_HOUR 3600000.f
+
+MeterAggregator::MeterAggregator(std::shared_ptr<Configuration> statisticString) : statisticString(statisticString) {
+    reset(mocpp_tick_ms());
+}
+
+int MeterAggregator::getWindowIndex(ReadingContext context) {
+    switch (context) {
+        case ReadingContext_SamplePeriodic:
+            return 0;
+        case ReadingContext_SampleClock:
+            return 1;
+        default:
+            return -1;
+    }
+}
+
+int MeterAggregator::addChannel(SampledValueSampler *input) {
+    if (nChannels >= MO_METER_AGGREGATION_CHANNELS) {
+        MO_DBG_WARN("no aggregation channel left for %s. Increase MO_METER_AGGREGATION_CHANNELS", input->getProperties().getMeasurand());
+        return -1;
+    }
+    inputs[nChannels] = input;
+    for (auto& window : windows) {
+        window.count = 0;
+    }
+    return (int) nChannels++;
+}
+
+void MeterAggregator::sample(unsigned long t_now) {
+    float values [MO_METER_AGGREGATION_CHANNELS];
+    for (size_t i = 0; i < nChannels; i++) {
+        if (!inputs[i]->readNumeric(ReadingContext_SamplePeriodic, values[i])) {
+            values[i] = windows[0].count > 0 ? windows[0].lastV[i] : 0.f;
+        }
+    }
+    update(values, t_now);
+}
+
+void MeterAggregator::update(const float *values, unsigned long t_now) {
+    for (auto& window : windows) {
+        window.update(values, nChannels, t_now);
+    }
+}
+
+void MeterAggregator::Window::update(const float *values, size_t n, unsigned long t_now) {
+
+    if (count == 0) {
+        //first sample of the window. Count its value back to the window begin for the energy integration
+        float dtH = (float) (t_now - t_window) / MS_PER_HOUR;
+        for (size_t i = 0; i < n; i++) {
+            minV[i] = values[i];
+            maxV[i] = values[i];
+            sumV[i] = values[i];
+            lastV[i] = values[i];
+            energyWh[i] = values[i] * dtH;
+        }
+    } else {
+        //branchless loop over contiguous arrays which the compiler can vectorize
+        float dtH = (float) (t_now - t_last) / MS_PER_HOUR;
+        for (size_t i = 0; i < n; i++) {
+            float v = values[i];
+            minV[i] = v < minV[i] ? v : minV[i];
+            maxV[i] = v > maxV[i] ? v : maxV[i];
+            sumV[i] += v;
+            energyWh[i] += 0.5f * (lastV[i] + v) * dtH; //trapezoidal rule
+            lastV[i] = v;
+        }
+    }
+
+    count++;
+    t_last = t_now;
+}
+
+void MeterAggregator::reset(ReadingContext context, unsigned long t_now) {
+    int index = getWindowIndex(context);
+    if (index < 0) {
+        return;
+    }
+    auto& window = windows[index];
+    window.count = 0;
+    window.t_window = t_now;
+    window.t_last = t_now;
+}
+
+void MeterAggregator::reset(unsigned long t_now) {
+    reset(ReadingContext_SamplePeriodic, t_now);
+    reset(ReadingContext_SampleClock, t_now);
+}
+
+uint32_t MeterAggregator::getCount(ReadingContext context) const {
+    int index = getWindowIndex(context);
+    return index >= 0 ? windows[index].count : 0;
+}
+
+unsigned long MeterAggregator::getWindowBegin(ReadingContext context) const {
+    int index = getWindowIndex(context);
+    return windows[index >= 0 ? index : 0].t_window;
+}
+
+float MeterAggregator::getValue(int channel, AggregationStatistic statistic, ReadingContext context) const {
+    int index = getWindowIndex(context);
+    if (channel < 0 || (size_t) channel >= nChannels || index < 0 || windows[index].count == 0) {
+        return 0.f;
+    }
+    auto& window = windows[index];
+    switch (statistic) {
+        case AggregationStatistic::Min:
+            return window.minV[channel];
+        case AggregationStatistic::Max:
+            return window.maxV[channel];
+        case AggregationStatistic::Last:
+            return window.lastV[channel];
+        case AggregationStatistic::EnergyInterval:
+            //extend the last sample until now
+            return window.energyWh[channel] + window.lastV[channel] * (float) (mocpp_tick_ms() - window.t_last) / MS_PER_HOUR;
+        case AggregationStatistic::Mean:
+            break;
+    }
+    return window.sumV[channel] / (float) window.count;
+}
+
+AggregationStatistic MeterAggregator::getReportStatistic() const {
+    AggregationStatistic res = AggregationStatistic::Mean;
+    if (statisticString && !aggregationStatisticTable.decode(statisticString->getString(), res)) {
+        res = AggregationStatistic::Mean;
+    }
+    return res;
+}
+
+AggregatedSampler::AggregatedSampler(std::unique_ptr<SampledValueSampler> input, MeterAggregator& aggregator, int channel) :
+        SampledValueSampler(input->getProperties()), MemoryManaged("v16.Metering.AggregatedSampler"), input(std::move(input)), source(nullptr), aggregator(aggregator), channel(channel), energyInterval(false) {
+    source = this->input.get();
+}
+
+AggregatedSampler::AggregatedSampler(SampledValueProperties properties, SampledValueSampler *source, MeterAggregator& aggregator, int channel) :
+        SampledValueSampler(properties), MemoryManaged("v16.Metering.AggregatedSampler"), input(nullptr), source(source), aggregator(aggregator), channel(channel), energyInterval(true) {
+
+}
+
+std::unique_ptr<SampledValue> AggregatedSampler::takeValue(ReadingContext context) {
+
+    if (!energyInterval && (!MeterAggregator::isAggregated(context) || aggregator.getCount(context) == 0)) {
+        //instantaneous reading, or no high-rate samples in this window
+        return input->takeValue(context);
+    }
+
+    //the interval of other contexts (e.g. Trigger) is the current Sample.Periodic window
+    auto window = MeterAggregator::isAggregated(context) ? context : ReadingContext_SamplePeriodic;
+
+    float value = 0.f;
+
+    if (aggregator.getCount(window) > 0) {
+        value = aggregator.getValue(channel, energyInterval ? AggregationStatistic::EnergyInterval : aggregator.getReportStatistic(), window);
+    } else if (source->readNumeric(context, value)) {
+        //integrate the momentary power over the window
+        value *= (float) (mocpp_tick_ms() - aggregator.getWindowBegin(window)) / MS_PER_HOUR;
+    }
+
+    return std::unique_ptr<SampledValueConcrete<float, SampledValueDeSerializer<float>>>(new SampledValueConcrete<float, SampledValueDeSerializer<float>>(
+            properties,
+            context,
+            std::move(value)));
+}
+
+std::unique_ptr<SampledValue> AggregatedSampler::deserializeValue(JsonObject svJson) {
+    if (input) {
+        return input->deserializeValue(svJson);
+    }
+    return std::unique_ptr<SampledValueConcrete<float, SampledValueDeSerializer<float>>>(new SampledValueConcrete<float, SampledValueDeSerializer<float>>(
+            properties,
+            deserializeReadingContext(svJson["context"] | "NOT_SET"),
+            SampledValueDeSerializer<float>::deserialize(svJson["value"] | "")));
+}
+
+#endif //MO_ENABLE_METER_AGGREGATION
@@ -0,0 +1,124 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_METERAGGREGATOR_H
+#define MO_METERAGGREGATOR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+
+#include <MicroOcpp/Model/Metering/SampledValue.h>
+#include <MicroOcpp/Core/ConfigurationKeyValue.h>
+
+/*
+ * High-rate sampling stage of the MeteringConnector. Between two MeterValues, it reads the numeric inputs
+ * at Cst_MeterAggregationRate samples per second and keeps min, max, mean and last value per input. The
+ * Sample.Periodic and Sample.Clock MeterValues then report the statistic Cst_MeterAggregationStatistic of
+ * their past sample interval instead of the instantaneous reading, so short spikes between two samples
+ * aren't lost. Both contexts have their own aggregation window. Other contexts (e.g. Trigger or
+ * Transaction.Begin) report the instantaneous reading. Energy measurands (like
+ * Energy.Active.Import.Register) aren't aggregated. If the aggregation is enabled, a power input
+ * additionally provides the measurand Energy.Active.Import.Interval, integrated from the high-rate samples
+ */
+#ifndef MO_ENABLE_METER_AGGREGATION
+#define MO_ENABLE_METER_AGGREGATION 1
+#endif
+
+#ifndef MO_METER_AGGREGATION_CHANNELS
+#define MO_METER_AGGREGATION_CHANNELS 8 //aggregated inputs per connector, e.g. power, voltage and current of 3 phases
+#endif
+
+#if MO_ENABLE_METER_AGGREGATION
+
+namespace MicroOcpp {
+
+enum class AggregationStatistic {
+    Mean,
+    Min,
+    Max,
+    Last,
+    EnergyInterval //integrated energy in Wh of a power input
+};
+
+/*
+ * Streaming aggregates in fixed-size accumulators. The channels are stored column-wise, so one update runs
+ * the same operations over contiguous arrays, which the compiler can vectorize across phases
+ */
+class MeterAggregator {
+private:
+    struct Window {
+        float minV [MO_METER_AGGREGATION_CHANNELS];
+        float maxV [MO_METER_AGGREGATION_CHANNELS];
+        float sumV [MO_METER_AGGREGATION_CHANNELS];
+        float lastV [MO_METER_AGGREGATION_CHANNELS];
+        float energyWh [MO_METER_AGGREGATION_CHANNELS];
+
+        uint32_t count = 0; //samples since the last reset
+        unsigned long t_window = 0; //begin of the aggregation window
+        unsigned long t_last = 0; //time of the last sample
+
+        void update(const float *values, size_t n, unsigned long t_now);
+    };
+
+    Window windows [2]; //Sample.Periodic and Sample.Clock
+
+    SampledValueSampler *inputs [MO_METER_AGGREGATION_CHANNELS]; //not owned
+    size_t nChannels = 0;
+
+    std::shared_ptr<Configuration> statisticString;
+
+    static int getWindowIndex(ReadingContext context); //-1 if the context isn't aggregated
+public:
+    MeterAggregator(std::shared_ptr<Configuration> statisticString);
+
+    //returns the channel index of the input or -1 if all channels are taken
+    int addChannel(SampledValueSampler *input);
+    size_t getChannelCount() const {return nChannels;}
+    SampledValueSampler *getInput(int channel) {return inputs[channel];}
+
+    //read all inputs and add them to the aggregates
+    void sample(unsigned long t_now);
+
+    //add one sample for all channels. values has getChannelCount() entries
+    void update(const float *values, unsigned long t_now);
+
+    //start a new aggregation window for the MeterValues of this context
+    void reset(ReadingContext context, unsigned long t_now);
+    void reset(unsigned long t_now); //all windows
+
+    static bool isAggregated(ReadingContext context) {return getWindowIndex(context) >= 0;}
+
+    uint32_t getCount(ReadingContext context = ReadingContext_SamplePeriodic) const;
+    unsigned long getWindowBegin(ReadingContext context = ReadingContext_SamplePeriodic) const;
+
+    //statistic of the channel in the current window of the context. Only valid if getCount(context) > 0
+    float getValue(int channel, AggregationStatistic statistic, ReadingContext context = ReadingContext_SamplePeriodic) const;
+
+    AggregationStatistic getReportStatistic() const; //Cst_MeterAggregationStatistic
+};
+
+/*
+ * Replaces a numeric input in the samplers of the MeteringConnector. If the aggregation window of the
+ * reading context contains samples, it reports the aggregate. Otherwise, it reads the input like before
+ */
+class AggregatedSampler : public SampledValueSampler, public MemoryManaged {
+private:
+    std::unique_ptr<SampledValueSampler> input; //nullptr for derived measurands like Energy.Active.Import.Interval
+    SampledValueSampler *source; //power input for derived measurands
+    MeterAggregator& aggregator;
+    int channel;
+    bool energyInterval;
+public:
+    AggregatedSampler(std::unique_ptr<SampledValueSampler> input, MeterAggregator& aggregator, int channel);
+    AggregatedSampler(SampledValueProperties properties, SampledValueSampler *source, MeterAggregator& aggregator, int channel); //Energy.Active.Import.Interval of a power input
+
+    std::unique_ptr<SampledValue> takeValue(ReadingContext context) override;
+    std::unique_ptr<SampledValue> deserializeValue(JsonObject svJson) override;
+};
+
+} //end namespace MicroOcpp
+
+#endif //MO_ENABLE_METER_AGGREGATION
+#endif
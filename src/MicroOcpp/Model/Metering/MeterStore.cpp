@@ -9,14 +9,10 @@
 
 #include <algorithm>
 
-#ifndef MO_MAX_STOPTXDATA_LEN
-#define MO_MAX_STOPTXDATA_LEN 4
-#endif
-
 using namespace MicroOcpp;
 
 TransactionMeterData::TransactionMeterData(unsigned int connectorId, unsigned int txNr, std::shared_ptr<FilesystemAdapter> filesystem)
-        : MemoryManaged("v16.Metering.TransactionMeterData"), connectorId(connectorId), txNr(txNr), filesystem{filesystem}, txData{makeVector<std::unique_ptr<MeterValue>>(getMemoryTag())} {
+        : MemoryManaged("v16.Metering.TransactionMeterData"), connectorId(connectorId), txNr(txNr), filesystem{filesystem} {
     
     if (!filesystem) {
         MO_DBG_DEBUG("volatile mode");
@@ -39,7 +35,7 @@ bool TransactionMeterData::addTxData(std::unique_ptr<MeterValue> mv) {
         return true;
     }
 
-    bool replaceLast = mvCount >= MO_MAX_STOPTXDATA_LEN; //txData size exceeded? overwrite last entry instead of appending
+    bool replaceLast = mvCount >= MO_MAX_STOPTXDATA_LEN || txData.full(); //txData size exceeded? overwrite last entry instead of appending
 
     if (filesystem) {
 
@@ -83,10 +79,10 @@ bool TransactionMeterData::addTxData(std::unique_ptr<MeterValue> mv) {
     return true;
 }
 
-Vector<std::unique_ptr<MeterValue>> TransactionMeterData::retrieveStopTxData() {
+StopTxData TransactionMeterData::retrieveStopTxData() {
     if (isFinalized()) {
         MO_DBG_ERR("Can only retrieve once");
-        return makeVector<std::unique_ptr<MeterValue>>(getMemoryTag());
+        return StopTxData();
     }
     finalize();
     MO_DBG_DEBUG("creating sd");
@@ -9,9 +9,16 @@
 #include <MicroOcpp/Model/Transactions/Transaction.h>
 #include <MicroOcpp/Core/FilesystemAdapter.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticVector.h>
+
+#ifndef MO_MAX_STOPTXDATA_LEN
+#define MO_MAX_STOPTXDATA_LEN 4
+#endif
 
 namespace MicroOcpp {
 
+using StopTxData = StaticVector<std::unique_ptr<MeterValue>, MO_MAX_STOPTXDATA_LEN>; //transactionData of StopTransaction
+
 class TransactionMeterData : public MemoryManaged {
 private:
     const unsigned int connectorId; //assignment to Transaction object
@@ -22,14 +29,14 @@ private:
 
     std::shared_ptr<FilesystemAdapter> filesystem;
 
-    Vector<std::unique_ptr<MeterValue>> txData;
+    StopTxData txData;
 
 public:
     TransactionMeterData(unsigned int connectorId, unsigned int txNr, std::shared_ptr<FilesystemAdapter> filesystem);
 
     bool addTxData(std::unique_ptr<MeterValue> mv);
 
-    Vector<std::unique_ptr<MeterValue>> retrieveStopTxData(); //will invalidate internal cache
+    StopTxData retrieveStopTxData(); //will invalidate internal cache
 
     bool restore(MeterValueBuilder& mvBuilder); //load record from memory; true if record found, false if nothing loaded
 
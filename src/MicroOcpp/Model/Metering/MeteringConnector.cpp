@@ -20,34 +20,42 @@
 using namespace MicroOcpp;
 using namespace MicroOcpp::Ocpp16;
 
-MeteringConnector::MeteringConnector(Context& context, int connectorId, MeterStore& meterStore)
-        : MemoryManaged("v16.Metering.MeteringConnector"), context(context), model(context.getModel()), connectorId{connectorId}, meterStore(meterStore), meterData(makeVector<std::unique_ptr<MeterValue>>(getMemoryTag())), samplers(makeVector<std::unique_ptr<SampledValueSampler>>(getMemoryTag())) {
-
-    context.getRequestQueue().addSendQueue(this);
-
-    auto meterValuesSampledDataString = declareConfiguration<const char*>("MeterValuesSampledData", "");
+void MeteringConfigs::declare() {
+    meterValuesSampledDataString = declareConfiguration<const char*>("MeterValuesSampledData", "Energy.Active.Import.Register,Power.Active.Import");
     declareConfiguration<int>("MeterValuesSampledDataMaxLength", 8, CONFIGURATION_VOLATILE, true);
     meterValueSampleIntervalInt = declareConfiguration<int>("MeterValueSampleInterval", 60);
 
-    auto stopTxnSampledDataString = declareConfiguration<const char*>("StopTxnSampledData", "");
+    stopTxnSampledDataString = declareConfiguration<const char*>("StopTxnSampledData", "");
     declareConfiguration<int>("StopTxnSampledDataMaxLength", 8, CONFIGURATION_VOLATILE, true);
 
-    auto meterValuesAlignedDataString = declareConfiguration<const char*>("MeterValuesAlignedData", "");
+    meterValuesAlignedDataString = declareConfiguration<const char*>("MeterValuesAlignedData", "Energy.Active.Import.Register,Power.Active.Import");
     declareConfiguration<int>("MeterValuesAlignedDataMaxLength", 8, CONFIGURATION_VOLATILE, true);
     clockAlignedDataIntervalInt  = declareConfiguration<int>("ClockAlignedDataInterval", 0);
 
-    auto stopTxnAlignedDataString = declareConfiguration<const char*>("StopTxnAlignedData", "");
+    stopTxnAlignedDataString = declareConfiguration<const char*>("StopTxnAlignedData", "");
 
     meterValuesInTxOnlyBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "MeterValuesInTxOnly", true);
     stopTxnDataCapturePeriodicBool = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "StopTxnDataCapturePeriodic", false);
 
-    transactionMessageAttemptsInt = declareConfiguration<int>("TransactionMessageAttempts", 3);
-    transactionMessageRetryIntervalInt = declareConfiguration<int>("TransactionMessageRetryInterval", 60);
+#if MO_ENABLE_METER_AGGREGATION
+    meterAggregationRateInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "MeterAggregationRate", 0);
+    meterAggregationStatisticString = declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "MeterAggregationStatistic", "Mean"); //Mean, Min, Max or Last
+#endif //MO_ENABLE_METER_AGGREGATION
+}
+
+MeteringConnector::MeteringConnector(Context& context, int connectorId, MeterStore& meterStore, MeteringConfigs& configs)
+        : MemoryManaged("v16.Metering.MeteringConnector"), context(context), model(context.getModel()), connectorId{connectorId}, meterStore(meterStore), meterData(makeVector<std::unique_ptr<MeterValue>>(getMemoryTag())), samplers(makeVector<std::unique_ptr<SampledValueSampler>>(getMemoryTag())),
+#if MO_ENABLE_METER_AGGREGATION
+          aggregator(configs.meterAggregationStatisticString),
+#endif //MO_ENABLE_METER_AGGREGATION
+          configs(configs), connectorConfigs(model.getConnectorTable().getConfigs()) {
 
-    sampledDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, meterValuesSampledDataString));
-    alignedDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, meterValuesAlignedDataString));
-    stopTxnSampledDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, stopTxnSampledDataString));
-    stopTxnAlignedDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, stopTxnAlignedDataString));
+    context.getRequestQueue().addSendQueue(this);
+
+    sampledDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, configs.meterValuesSampledDataString));
+    alignedDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, configs.meterValuesAlignedDataString));
+    stopTxnSampledDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, configs.stopTxnSampledDataString));
+    stopTxnAlignedDataBuilder = std::unique_ptr<MeterValueBuilder>(new MeterValueBuilder(samplers, configs.stopTxnAlignedDataString));
 }
 
 void MeteringConnector::loop() {
@@ -61,6 +69,9 @@ void MeteringConnector::loop() {
 
     if (txBreak) {
         lastSampleTime = mocpp_tick_ms();
+#if MO_ENABLE_METER_AGGREGATION
+        aggregator.reset(lastSampleTime);
+#endif //MO_ENABLE_METER_AGGREGATION
     }
 
     if (model.getConnector(connectorId)) {
@@ -79,19 +90,33 @@ void MeteringConnector::loop() {
         } else {
             //check outside of transaction
 
-            if (connectorId != 0 && meterValuesInTxOnlyBool->getBool()) {
+            if (connectorId != 0 && configs.meterValuesInTxOnlyBool->getBool()) {
                 //don't take any MeterValues outside of transactions on connectorIds other than 0
                 return;
             }
         }
     }
 
-    if (clockAlignedDataIntervalInt->getInt() >= 1 && model.getClock().now() >= MIN_TIME) {
+#if MO_ENABLE_METER_AGGREGATION
+    if (configs.meterAggregationRateInt->getInt() >= 1 && powerChannel >= 0 && !energyIntervalAdded) {
+        addEnergyIntervalSampler();
+    }
+
+    if (configs.meterAggregationRateInt->getInt() >= 1 && aggregator.getChannelCount() > 0) {
+        unsigned long t_now = mocpp_tick_ms();
+        if (t_now - lastAggregationTime >= 1000UL / (unsigned long) configs.meterAggregationRateInt->getInt()) {
+            aggregator.sample(t_now);
+            lastAggregationTime = t_now;
+        }
+    }
+#endif //MO_ENABLE_METER_AGGREGATION
+
+    if (configs.clockAlignedDataIntervalInt->getInt() >= 1 && model.getClock().now() >= MIN_TIME) {
 
         auto& timestampNow = model.getClock().now();
         auto dt = nextAlignedTime - timestampNow;
         if (dt <= 0 ||                              //normal case: interval elapsed
-                dt > clockAlignedDataIntervalInt->getInt()) {   //special case: clock has been adjusted or first run
+                dt > configs.clockAlignedDataIntervalInt->getInt()) {   //special case: clock has been adjusted or first run
 
             MO_DBG_DEBUG("Clock aligned measurement %ds: %s", dt,
                 abs(dt) <= 60 ?
@@ -116,28 +141,36 @@ void MeteringConnector::loop() {
                         stopTxnData->addTxData(std::move(alignedStopTx));
                     }
                 }
+
+#if MO_ENABLE_METER_AGGREGATION
+                aggregator.reset(ReadingContext_SampleClock, mocpp_tick_ms());
+                if (configs.meterValueSampleIntervalInt->getInt() < 1) {
+                    //no periodic samples which would start the next periodic window. Other contexts report its energy interval
+                    aggregator.reset(ReadingContext_SamplePeriodic, mocpp_tick_ms());
+                }
+#endif //MO_ENABLE_METER_AGGREGATION
             }
 
             Timestamp midnightBase = Timestamp(2010,0,0,0,0,0);
             auto intervall = timestampNow - midnightBase;
             intervall %= 3600 * 24;
             Timestamp midnight = timestampNow - intervall;
-            intervall += clockAlignedDataIntervalInt->getInt();
+            intervall += configs.clockAlignedDataIntervalInt->getInt();
             if (intervall >= 3600 * 24) {
                 //next measurement is tomorrow; set to precisely 00:00 
                 nextAlignedTime = midnight;
                 nextAlignedTime += 3600 * 24;
             } else {
-                intervall /= clockAlignedDataIntervalInt->getInt();
-                nextAlignedTime = midnight + (intervall * clockAlignedDataIntervalInt->getInt());
+                intervall /= configs.clockAlignedDataIntervalInt->getInt();
+                nextAlignedTime = midnight + (intervall * configs.clockAlignedDataIntervalInt->getInt());
             }
         }
     }
 
-    if (meterValueSampleIntervalInt->getInt() >= 1) {
+    if (configs.meterValueSampleIntervalInt->getInt() >= 1) {
         //record periodic tx data
 
-        if (mocpp_tick_ms() - lastSampleTime >= (unsigned long) (meterValueSampleIntervalInt->getInt() * 1000)) {
+        if (mocpp_tick_ms() - lastSampleTime >= (unsigned long) (configs.meterValueSampleIntervalInt->getInt() * 1000)) {
             if (auto sampledMeterValue = sampledDataBuilder->takeSample(model.getClock().now(), ReadingContext_SamplePeriodic)) {
                 if (meterData.size() >= MO_METERVALUES_CACHE_MAXSIZE) {
                     MO_DBG_INFO("MeterValue cache full. Drop old MV");
@@ -150,13 +183,16 @@ void MeteringConnector::loop() {
                 meterData.push_back(std::move(sampledMeterValue));
             }
 
-            if (stopTxnData && stopTxnDataCapturePeriodicBool->getBool()) {
+            if (stopTxnData && configs.stopTxnDataCapturePeriodicBool->getBool()) {
                 auto sampleStopTx = stopTxnSampledDataBuilder->takeSample(model.getClock().now(), ReadingContext_SamplePeriodic);
                 if (sampleStopTx) {
                     stopTxnData->addTxData(std::move(sampleStopTx));
                 }
             }
             lastSampleTime = mocpp_tick_ms();
+#if MO_ENABLE_METER_AGGREGATION
+            aggregator.reset(ReadingContext_SamplePeriodic, lastSampleTime);
+#endif //MO_ENABLE_METER_AGGREGATION
         }
     }
 }
@@ -181,9 +217,48 @@ void MeteringConnector::addMeterValueSampler(std::unique_ptr<SampledValueSampler
     if (!strcmp(meterValueSampler->getProperties().getMeasurand(), "Energy.Active.Import.Register")) {
         energySamplerIndex = samplers.size();
     }
+
+#if MO_ENABLE_METER_AGGREGATION
+    //aggregate numeric inputs, except energy registers and intervals which are reported with their current reading
+    auto& properties = meterValueSampler->getProperties();
+    if (meterValueSampler->isNumeric() && strncmp(properties.getMeasurand(), "Energy.", strlen("Energy."))) {
+        int channel = aggregator.addChannel(meterValueSampler.get());
+        if (channel >= 0) {
+            bool activePower = !strcmp(properties.getMeasurand(), "Power.Active.Import") && !*properties.getPhase() &&
+                    (!*properties.getUnit() || !strcmp(properties.getUnit(), "W") || !strcmp(properties.getUnit(), "kW"));
+            if (activePower && powerChannel < 0) {
+                powerChannel = channel;
+                powerKW = !strcmp(properties.getUnit(), "kW");
+            }
+            samplers.push_back(std::unique_ptr<SampledValueSampler>(new AggregatedSampler(std::move(meterValueSampler), aggregator, channel)));
+
+            if (configs.meterAggregationRateInt->getInt() >= 1 && channel == powerChannel) {
+                addEnergyIntervalSampler();
+            } //else: added when the aggregation is enabled
+            return;
+        }
+    }
+#endif //MO_ENABLE_METER_AGGREGATION
+
     samplers.push_back(std::move(meterValueSampler));
 }
 
+#if MO_ENABLE_METER_AGGREGATION
+void MeteringConnector::addEnergyIntervalSampler() {
+    energyIntervalAdded = true;
+
+    if (existsSampler("Energy.Active.Import.Interval", strlen("Energy.Active.Import.Interval"))) {
+        return; //provided by the host
+    }
+
+    //derive the energy of the sample interval from the power input
+    SampledValueProperties energyProperties;
+    energyProperties.setMeasurand("Energy.Active.Import.Interval");
+    energyProperties.setUnit(powerKW ? "kWh" : "Wh");
+    samplers.push_back(std::unique_ptr<SampledValueSampler>(new AggregatedSampler(energyProperties, aggregator.getInput(powerChannel), aggregator, powerChannel)));
+}
+#endif //MO_ENABLE_METER_AGGREGATION
+
 std::unique_ptr<SampledValue> MeteringConnector::readTxEnergyMeter(ReadingContext model) {
     if (energySamplerIndex >= 0 && (size_t) energySamplerIndex < samplers.size()) {
         return samplers[energySamplerIndex]->takeValue(model);
@@ -259,20 +334,35 @@ unsigned int MeteringConnector::getFrontRequestOpNr() {
     return NoOperation;
 }
 
+PriorityClass MeteringConnector::getFrontRequestClass() {
+    return PriorityClass::Telemetry;
+}
+
 std::unique_ptr<Request> MeteringConnector::fetchFrontRequest() {
 
     if (!meterDataFront) {
         return nullptr;
     }
 
-    if ((int)meterDataFront->getAttemptNr() >= transactionMessageAttemptsInt->getInt()) {
+    if ((int)meterDataFront->getAttemptNr() >= connectorConfigs.transactionMessageAttemptsInt->getInt()) {
         MO_DBG_WARN("exceeded TransactionMessageAttempts. Discard MeterValue");
         meterDataFront.reset();
         return nullptr;
     }
 
-    if (mocpp_tick_ms() - meterDataFront->getAttemptTime() < meterDataFront->getAttemptNr() * (unsigned long)(std::max(0, transactionMessageRetryIntervalInt->getInt())) * 1000UL) {
-        return nullptr;
+    if (meterDataFront->getAttemptNr() > 0) {
+        auto& retryPolicy = model.getRetryPolicy();
+        if (retryPolicy.isHeldOff()) {
+            return nullptr;
+        }
+
+        uint32_t salt = ((uint32_t)connectorId << 24) ^ (uint32_t)(meterDataFront->getTimestamp() - MIN_TIME);
+        unsigned long delay = retryPolicy.getRetryDelay(meterDataFront->getAttemptNr(),
+                                                        (unsigned long)std::max(0, connectorConfigs.transactionMessageRetryIntervalInt->getInt()) * 1000UL,
+                                                        salt);
+        if (mocpp_tick_ms() - meterDataFront->getAttemptTime() < delay) {
+            return nullptr;
+        }
     }
 
     meterDataFront->advanceAttemptNr();
@@ -297,6 +387,12 @@ std::unique_ptr<Request> MeteringConnector::fetchFrontRequest() {
         MO_DBG_DEBUG("drop MV front");
         meterDataFront.reset();
     });
+    meterValues->setOnReceiveErrorListener([this] (const char *code, const char*, JsonObject details) {
+        if (model.getRetryPolicy().onCallError(code, details) == RetryDecision::GiveUp) {
+            MO_DBG_WARN("server rejected MeterValue. Discard");
+            meterDataFront.reset();
+        }
+    });
 
     return meterValues;
 }
@@ -10,6 +10,7 @@
 
 #include <MicroOcpp/Model/Metering/MeterValue.h>
 #include <MicroOcpp/Model/Metering/MeterStore.h>
+#include <MicroOcpp/Model/Metering/MeterAggregator.h>
 #include <MicroOcpp/Model/Transactions/Transaction.h>
 #include <MicroOcpp/Core/ConfigurationKeyValue.h>
 #include <MicroOcpp/Core/RequestQueue.h>
@@ -25,6 +26,32 @@ class Context;
 class Model;
 class Operation;
 class MeterStore;
+struct ConnectorConfigs;
+
+/*
+ * Metering configurations which apply to all connectors. The MeteringService declares them once and
+ * the MeteringConnectors share the handles
+ */
+struct MeteringConfigs {
+    std::shared_ptr<Configuration> meterValuesSampledDataString;
+    std::shared_ptr<Configuration> stopTxnSampledDataString;
+    std::shared_ptr<Configuration> meterValuesAlignedDataString;
+    std::shared_ptr<Configuration> stopTxnAlignedDataString;
+
+    std::shared_ptr<Configuration> meterValueSampleIntervalInt;
+
+    std::shared_ptr<Configuration> clockAlignedDataIntervalInt;
+
+    std::shared_ptr<Configuration> meterValuesInTxOnlyBool;
+    std::shared_ptr<Configuration> stopTxnDataCapturePeriodicBool;
+
+#if MO_ENABLE_METER_AGGREGATION
+    std::shared_ptr<Configuration> meterAggregationRateInt; //high-rate samples per second, 0 disables the aggregation
+    std::shared_ptr<Configuration> meterAggregationStatisticString;
+#endif //MO_ENABLE_METER_AGGREGATION
+
+    void declare();
+};
 
 class MeteringConnector : public MemoryManaged, public RequestEmitter {
 private:
@@ -42,11 +69,6 @@ private:
     std::unique_ptr<MeterValueBuilder> stopTxnSampledDataBuilder;
     std::unique_ptr<MeterValueBuilder> stopTxnAlignedDataBuilder;
 
-    std::shared_ptr<Configuration> sampledDataSelectString;
-    std::shared_ptr<Configuration> alignedDataSelectString;
-    std::shared_ptr<Configuration> stopTxnSampledDataSelectString;
-    std::shared_ptr<Configuration> stopTxnAlignedDataSelectString;
-
     unsigned long lastSampleTime = 0; //0 means not charging right now
     Timestamp nextAlignedTime;
     std::shared_ptr<Transaction> transaction;
@@ -55,17 +77,19 @@ private:
     Vector<std::unique_ptr<SampledValueSampler>> samplers;
     int energySamplerIndex {-1};
 
-    std::shared_ptr<Configuration> meterValueSampleIntervalInt;
-
-    std::shared_ptr<Configuration> clockAlignedDataIntervalInt;
-
-    std::shared_ptr<Configuration> meterValuesInTxOnlyBool;
-    std::shared_ptr<Configuration> stopTxnDataCapturePeriodicBool;
-
-    std::shared_ptr<Configuration> transactionMessageAttemptsInt;
-    std::shared_ptr<Configuration> transactionMessageRetryIntervalInt;
+#if MO_ENABLE_METER_AGGREGATION
+    MeterAggregator aggregator;
+    unsigned long lastAggregationTime = 0;
+    int powerChannel = -1; //aggregation channel of the power input for Energy.Active.Import.Interval
+    bool powerKW = false;
+    bool energyIntervalAdded = false;
+    void addEnergyIntervalSampler(); //once the aggregation is enabled
+#endif //MO_ENABLE_METER_AGGREGATION
+
+    MeteringConfigs& configs; //shared by all connectors
+    ConnectorConfigs& connectorConfigs; //TransactionMessageAttempts and -RetryInterval
 public:
-    MeteringConnector(Context& context, int connectorId, MeterStore& meterStore);
+    MeteringConnector(Context& context, int connectorId, MeterStore& meterStore, MeteringConfigs& configs);
 
     void loop();
 
@@ -88,6 +112,7 @@ public:
     //RequestEmitter implementation
     unsigned int getFrontRequestOpNr() override;
     std::unique_ptr<Request> fetchFrontRequest() override;
+    PriorityClass getFrontRequestClass() override;
 
 };
 
@@ -16,15 +16,12 @@ using namespace MicroOcpp;
 MeteringService::MeteringService(Context& context, int numConn, std::shared_ptr<FilesystemAdapter> filesystem)
       : MemoryManaged("v16.Metering.MeteringService"), context(context), meterStore(filesystem), connectors(makeVector<std::unique_ptr<MeteringConnector>>(getMemoryTag())) {
 
-    //set factory defaults for Metering-related config keys
-    declareConfiguration<const char*>("MeterValuesSampledData", "Energy.Active.Import.Register,Power.Active.Import");
-    declareConfiguration<const char*>("StopTxnSampledData", "");
-    declareConfiguration<const char*>("MeterValuesAlignedData", "Energy.Active.Import.Register,Power.Active.Import");
-    declareConfiguration<const char*>("StopTxnAlignedData", "");
-    
+    //declare the Metering-related config keys once for all connectors
+    configs.declare();
+
     connectors.reserve(numConn);
     for (int i = 0; i < numConn; i++) {
-        connectors.emplace_back(new MeteringConnector(context, i, meterStore));
+        connectors.emplace_back(new MeteringConnector(context, i, meterStore, configs));
     }
 
     std::function<bool(const char*)> validateSelectString = [this] (const char *csl) {
@@ -23,6 +23,7 @@ class MeteringService : public MemoryManaged {
 private:
     Context& context;
     MeterStore meterStore;
+    MeteringConfigs configs;
 
     Vector<std::unique_ptr<MeteringConnector>> connectors;
 public:
@@ -5,34 +5,28 @@
 #include <string.h>
 
 #include <MicroOcpp/Model/Metering/ReadingContext.h>
+#include <MicroOcpp/Core/EnumTable.h>
 #include <MicroOcpp/Debug.h>
 
 namespace MicroOcpp {
 
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<9,16> readingContextTable {
+    {nullptr, "Interruption.Begin", "Interruption.End", "Other", "Sample.Clock", "Sample.Periodic", "Transaction.Begin", "Transaction.End", "Trigger"},
+    {4, 0xFF, 2, 7, 1, 3, 0xFF, 6, 0xFF, 8, 0xFF, 0xFF, 5, 0xFF, 0xFF, 0xFF},
+    0U};
+static_assert(readingContextTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
 const char *serializeReadingContext(ReadingContext context) {
-    switch (context) {
-        case (ReadingContext_InterruptionBegin):
-            return "Interruption.Begin";
-        case (ReadingContext_InterruptionEnd):
-            return "Interruption.End";
-        case (ReadingContext_Other):
-            return "Other";
-        case (ReadingContext_SampleClock):
-            return "Sample.Clock";
-        case (ReadingContext_SamplePeriodic):
-            return "Sample.Periodic";
-        case (ReadingContext_TransactionBegin):
-            return "Transaction.Begin";
-        case (ReadingContext_TransactionEnd):
-            return "Transaction.End";
-        case (ReadingContext_Trigger):
-            return "Trigger";
-        default:
-            MO_DBG_ERR("ReadingContext not specified");
-            /* fall through */
-        case (ReadingContext_UNDEFINED):
-            return "";
+    if (context == ReadingContext_UNDEFINED) {
+        return "";
+    }
+    const char *name = readingContextTable.encode((size_t)context);
+    if (!name) {
+        MO_DBG_ERR("ReadingContext not specified");
+        return "";
     }
+    return name;
 }
 ReadingContext deserializeReadingContext(const char *context) {
     if (!context) {
@@ -40,26 +34,11 @@ ReadingContext deserializeReadingContext(const char *context) {
         return ReadingContext_UNDEFINED;
     }
 
-    if (!strcmp(context, "Sample.Periodic")) {
-        return ReadingContext_SamplePeriodic;
-    } else if (!strcmp(context, "Sample.Clock")) {
-        return ReadingContext_SampleClock;
-    } else if (!strcmp(context, "Transaction.Begin")) {
-        return ReadingContext_TransactionBegin;
-    } else if (!strcmp(context, "Transaction.End")) {
-        return ReadingContext_TransactionEnd;
-    } else if (!strcmp(context, "Other")) {
-        return ReadingContext_Other;
-    } else if (!strcmp(context, "Interruption.Begin")) {
-        return ReadingContext_InterruptionBegin;
-    } else if (!strcmp(context, "Interruption.End")) {
-        return ReadingContext_InterruptionEnd;
-    } else if (!strcmp(context, "Trigger")) {
-        return ReadingContext_Trigger;
+    ReadingContext res = ReadingContext_UNDEFINED;
+    if (!readingContextTable.decode(context, res)) {
+        MO_DBG_ERR("ReadingContext not specified %.10s", context);
     }
-
-    MO_DBG_ERR("ReadingContext not specified %.10s", context);
-    return ReadingContext_UNDEFINED;
+    return res;
 }
 
 } //namespace MicroOcpp
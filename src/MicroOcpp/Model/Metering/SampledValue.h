@@ -11,8 +11,26 @@
 
 #include <MicroOcpp/Model/Metering/ReadingContext.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
 #include <MicroOcpp/Platform.h>
 
+//maximum string lengths of the SampledValue properties (exceeding strings are cropped)
+#ifndef MO_SAMPLEDVALUE_FORMAT_LEN_MAX
+#define MO_SAMPLEDVALUE_FORMAT_LEN_MAX 15 // "SignedData"
+#endif
+#ifndef MO_SAMPLEDVALUE_MEASURAND_LEN_MAX
+#define MO_SAMPLEDVALUE_MEASURAND_LEN_MAX 39 // "Energy.Reactive.Import.Register"
+#endif
+#ifndef MO_SAMPLEDVALUE_PHASE_LEN_MAX
+#define MO_SAMPLEDVALUE_PHASE_LEN_MAX 7 // "L1-L2"
+#endif
+#ifndef MO_SAMPLEDVALUE_LOCATION_LEN_MAX
+#define MO_SAMPLEDVALUE_LOCATION_LEN_MAX 7 // "Outlet"
+#endif
+#ifndef MO_SAMPLEDVALUE_UNIT_LEN_MAX
+#define MO_SAMPLEDVALUE_UNIT_LEN_MAX 15 // "Fahrenheit"
+#endif
+
 namespace MicroOcpp {
 
 template <class T>
@@ -42,27 +60,36 @@ public:
     static int32_t toInteger(float& val) {return (int32_t) val;}
 };
 
+//conversion of numeric sample types for the MeterAggregator. Other types aren't aggregated
+template <class T>
+struct SampledValueNumeric {
+    static const bool numeric = false;
+    static bool toFloat(const T&, float&) {return false;}
+};
+
+template <>
+struct SampledValueNumeric<int32_t> {
+    static const bool numeric = true;
+    static bool toFloat(const int32_t& val, float& out) {out = (float) val; return true;}
+};
+
+template <>
+struct SampledValueNumeric<float> {
+    static const bool numeric = true;
+    static bool toFloat(const float& val, float& out) {out = val; return true;}
+};
+
 class SampledValueProperties {
 private:
-    String format;
-    String measurand;
-    String phase;
-    String location;
-    String unit;
+    StaticString<MO_SAMPLEDVALUE_FORMAT_LEN_MAX> format;
+    StaticString<MO_SAMPLEDVALUE_MEASURAND_LEN_MAX> measurand;
+    StaticString<MO_SAMPLEDVALUE_PHASE_LEN_MAX> phase;
+    StaticString<MO_SAMPLEDVALUE_LOCATION_LEN_MAX> location;
+    StaticString<MO_SAMPLEDVALUE_UNIT_LEN_MAX> unit;
 
 public:
-    SampledValueProperties() :
-            format(makeString("v16.Metering.SampledValueProperties")),
-            measurand(makeString("v16.Metering.SampledValueProperties")),
-            phase(makeString("v16.Metering.SampledValueProperties")),
-            location(makeString("v16.Metering.SampledValueProperties")),
-            unit(makeString("v16.Metering.SampledValueProperties")) { }
-    SampledValueProperties(const SampledValueProperties& other) :
-            format(other.format),
-            measurand(other.measurand),
-            phase(other.phase),
-            location(other.location),
-            unit(other.unit) { }
+    SampledValueProperties() = default;
+    SampledValueProperties(const SampledValueProperties& other) = default;
     ~SampledValueProperties() = default;
 
     void setFormat(const char *format) {this->format = format;}
@@ -119,6 +146,8 @@ public:
     virtual ~SampledValueSampler() = default;
     virtual std::unique_ptr<SampledValue> takeValue(ReadingContext context) = 0;
     virtual std::unique_ptr<SampledValue> deserializeValue(JsonObject svJson) = 0;
+    virtual bool isNumeric() {return false;}
+    virtual bool readNumeric(ReadingContext context, float& value) {return false;} //sample without creating a SampledValue. Returns false if not numeric
     const SampledValueProperties& getProperties() {return properties;};
 };
 
@@ -140,6 +169,10 @@ public:
             deserializeReadingContext(svJson["context"] | "NOT_SET"),
             DeSerializer::deserialize(svJson["value"] | "")));
     }
+    bool isNumeric() override {return SampledValueNumeric<T>::numeric;}
+    bool readNumeric(ReadingContext context, float& value) override {
+        return SampledValueNumeric<T>::numeric && SampledValueNumeric<T>::toFloat(sampler(context), value);
+    }
 };
 
 } //end namespace MicroOcpp
@@ -26,6 +26,8 @@
 
 #include <MicroOcpp/Debug.h>
 
+#include <algorithm>
+
 using namespace MicroOcpp;
 
 Model::Model(ProtocolVersion version, uint16_t bootNr) : MemoryManaged("Model"), connectors(makeVector<std::unique_ptr<Connector>>(getMemoryTag())), version(version), bootNr(bootNr) {
@@ -53,6 +55,21 @@ void Model::loop() {
         connector->loop();
     }
 
+    if (!connectors.empty() && clock.now() >= MIN_TIME) {
+        //report the status changes of all connectors in one pass over the packed status arrays
+        auto minimumStatusDurationInt = connectorTable.getConfigs().minimumStatusDurationInt;
+        unsigned long minimumStatusDuration = minimumStatusDurationInt && minimumStatusDurationInt->getInt() > 0 ?
+                (unsigned long) minimumStatusDurationInt->getInt() * 1000UL : 0;
+        unsigned long t_now = mocpp_tick_ms();
+        unsigned int numConnectors = std::min((unsigned int)connectors.size(), connectorTable.size());
+
+        for (unsigned int cId = connectorTable.nextReportDue(0, t_now, minimumStatusDuration);
+                cId < numConnectors;
+                cId = connectorTable.nextReportDue(cId + 1, t_now, minimumStatusDuration)) {
+            connectors[cId]->reportStatus();
+        }
+    }
+
     if (chargeControlCommon)
         chargeControlCommon->loop();
 
@@ -136,6 +153,10 @@ Connector *Model::getConnector(unsigned int connectorId) {
     return connectors[connectorId].get();
 }
 
+ConnectorTable& Model::getConnectorTable() {
+    return connectorTable;
+}
+
 void Model::setMeteringSerivce(std::unique_ptr<MeteringService> ms) {
     meteringService = std::move(ms);
     capabilitiesUpdated = true;
@@ -279,6 +300,10 @@ Clock& Model::getClock() {
     return clock;
 }
 
+RetryPolicy& Model::getRetryPolicy() {
+    return retryPolicy;
+}
+
 const ProtocolVersion& Model::getVersion() const {
     return version;
 }
@@ -8,9 +8,11 @@
 #include <memory>
 
 #include <MicroOcpp/Core/Time.h>
+#include <MicroOcpp/Core/RetryPolicy.h>
 #include <MicroOcpp/Core/Memory.h>
 #include <MicroOcpp/Version.h>
 #include <MicroOcpp/Model/ConnectorBase/Connector.h>
+#include <MicroOcpp/Model/ConnectorBase/ConnectorTable.h>
 
 namespace MicroOcpp {
 
@@ -50,6 +52,7 @@ class MeteringService;
 
 class Model : public MemoryManaged {
 private:
+    ConnectorTable connectorTable; //must outlive the connectors
     Vector<std::unique_ptr<Connector>> connectors;
     std::unique_ptr<TransactionStore> transactionStore;
     std::unique_ptr<SmartChargingService> smartChargingService;
@@ -84,6 +87,8 @@ private:
 
     Clock clock;
 
+    RetryPolicy retryPolicy;
+
     ProtocolVersion version;
 
     bool capabilitiesUpdated = true;
@@ -114,6 +119,7 @@ public:
     void setConnectors(Vector<std::unique_ptr<Connector>>&& connectors);
     unsigned int getNumConnectors() const;
     Connector *getConnector(unsigned int connectorId);
+    ConnectorTable& getConnectorTable();
 
     void setMeteringSerivce(std::unique_ptr<MeteringService> meteringService);
     MeteringService* getMeteringService() const;
@@ -169,6 +175,8 @@ public:
 
     Clock &getClock();
 
+    RetryPolicy& getRetryPolicy();
+
     const ProtocolVersion& getVersion() const;
 
     uint16_t getBootNr();
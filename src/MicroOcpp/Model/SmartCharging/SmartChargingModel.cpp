@@ -3,6 +3,7 @@
 // MIT License
 
 #include <MicroOcpp/Model/SmartCharging/SmartChargingModel.h>
+#include <MicroOcpp/Core/EnumTable.h>
 #include <MicroOcpp/Debug.h>
 
 #include <string.h>
@@ -10,6 +11,29 @@
 
 using namespace MicroOcpp;
 
+namespace MicroOcpp {
+
+//generated with tests/benchmarks/scripts/gen_enum_tables.py
+constexpr EnumTable<3,4> chargingProfilePurposeTable {
+    {"ChargePointMaxProfile", "TxDefaultProfile", "TxProfile"},
+    {0, 2, 0xFF, 1},
+    0U};
+static_assert(chargingProfilePurposeTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+constexpr EnumTable<3,4> chargingProfileKindTable {
+    {"Absolute", "Recurring", "Relative"},
+    {2, 0xFF, 0, 1},
+    3U};
+static_assert(chargingProfileKindTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+constexpr EnumTable<3,4> recurrencyKindTable {
+    {nullptr, "Daily", "Weekly"},
+    {0xFF, 1, 2, 0xFF},
+    1U};
+static_assert(recurrencyKindTable.isPerfect(), "regenerate with gen_enum_tables.py");
+
+} //end namespace MicroOcpp
+
 ChargeRate MicroOcpp::chargeRate_min(const ChargeRate& a, const ChargeRate& b) {
     ChargeRate res;
     res.power = std::min(a.power, b.power);
@@ -18,7 +42,7 @@ ChargeRate MicroOcpp::chargeRate_min(const ChargeRate& a, const ChargeRate& b) {
     return res;
 }
 
-ChargingSchedule::ChargingSchedule() : MemoryManaged("v16.SmartCharging.SmartChargingModel"), chargingSchedulePeriod{makeVector<ChargingSchedulePeriod>(getMemoryTag())} {
+ChargingSchedule::ChargingSchedule() : MemoryManaged("v16.SmartCharging.SmartChargingModel") {
 
 }
 
@@ -231,39 +255,10 @@ bool ChargingProfile::toJson(JsonDoc& doc) {
     }
     doc["stackLevel"] = stackLevel;
 
-    switch (chargingProfilePurpose) {
-        case (ChargingProfilePurposeType::ChargePointMaxProfile):
-            doc["chargingProfilePurpose"] = "ChargePointMaxProfile";
-            break;
-        case (ChargingProfilePurposeType::TxDefaultProfile):
-            doc["chargingProfilePurpose"] = "TxDefaultProfile";
-            break;
-        case (ChargingProfilePurposeType::TxProfile):
-            doc["chargingProfilePurpose"] = "TxProfile";
-            break;
-    }
-
-    switch (chargingProfileKind) {
-        case (ChargingProfileKindType::Absolute):
-            doc["chargingProfileKind"] = "Absolute";
-            break;
-        case (ChargingProfileKindType::Recurring):
-            doc["chargingProfileKind"] = "Recurring";
-            break;
-        case (ChargingProfileKindType::Relative):
-            doc["chargingProfileKind"] = "Relative";
-            break;
-    }
-
-    switch (recurrencyKind) {
-        case (RecurrencyKindType::Daily):
-            doc["recurrencyKind"] = "Daily";
-            break;
-        case (RecurrencyKindType::Weekly):
-            doc["recurrencyKind"] = "Weekly";
-            break;
-        default:
-            break;
+    doc["chargingProfilePurpose"] = chargingProfilePurposeTable.encode((size_t)chargingProfilePurpose);
+    doc["chargingProfileKind"] = chargingProfileKindTable.encode((size_t)chargingProfileKind);
+    if (auto recurrencyKindStr = recurrencyKindTable.encode((size_t)recurrencyKind)) {
+        doc["recurrencyKind"] = recurrencyKindStr;
     }
 
     char timeStr [JSONDATE_LENGTH + 1] = {'\0'};
@@ -361,7 +356,7 @@ bool loadChargingSchedulePeriod(JsonObject& json, ChargingSchedulePeriod& out) {
 } //end namespace MicroOcpp
 
 std::unique_ptr<ChargingProfile> MicroOcpp::loadChargingProfile(JsonObject& json) {
-    auto res = std::unique_ptr<ChargingProfile>(new ChargingProfile());
+    auto res = std::unique_ptr<ChargingProfile>(new ("v16.SmartCharging.ChargingProfile") ChargingProfile());
 
     int chargingProfileId = json["chargingProfileId"] | -1;
     if (chargingProfileId >= 0) {
@@ -385,35 +380,19 @@ std::unique_ptr<ChargingProfile> MicroOcpp::loadChargingProfile(JsonObject& json
     }
 
     const char *chargingProfilePurposeStr = json["chargingProfilePurpose"] | "Invalid";
-    if (!strcmp(chargingProfilePurposeStr, "ChargePointMaxProfile")) {
-        res->chargingProfilePurpose = ChargingProfilePurposeType::ChargePointMaxProfile;
-    } else if (!strcmp(chargingProfilePurposeStr, "TxDefaultProfile")) {
-        res->chargingProfilePurpose = ChargingProfilePurposeType::TxDefaultProfile;
-    } else if (!strcmp(chargingProfilePurposeStr, "TxProfile")) {
-        res->chargingProfilePurpose = ChargingProfilePurposeType::TxProfile;
-    } else {
+    if (!chargingProfilePurposeTable.decode(chargingProfilePurposeStr, res->chargingProfilePurpose)) {
         MO_DBG_WARN("format violation");
         return nullptr;
     }
 
     const char *chargingProfileKindStr = json["chargingProfileKind"] | "Invalid";
-    if (!strcmp(chargingProfileKindStr, "Absolute")) {
-        res->chargingProfileKind = ChargingProfileKindType::Absolute;
-    } else if (!strcmp(chargingProfileKindStr, "Recurring")) {
-        res->chargingProfileKind = ChargingProfileKindType::Recurring;
-    } else if (!strcmp(chargingProfileKindStr, "Relative")) {
-        res->chargingProfileKind = ChargingProfileKindType::Relative;
-    } else {
+    if (!chargingProfileKindTable.decode(chargingProfileKindStr, res->chargingProfileKind)) {
         MO_DBG_WARN("format violation");
         return nullptr;
     }
 
     const char *recurrencyKindStr = json["recurrencyKind"] | "Invalid";
-    if (!strcmp(recurrencyKindStr, "Daily")) {
-        res->recurrencyKind = RecurrencyKindType::Daily;
-    } else if (!strcmp(recurrencyKindStr, "Weekly")) {
-        res->recurrencyKind = RecurrencyKindType::Weekly;
-    }
+    recurrencyKindTable.decode(recurrencyKindStr, res->recurrencyKind);
 
     MO_DBG_DEBUG("Deserialize JSON: chargingProfileId=%i, chargingProfilePurpose=%s, recurrencyKind=%s", chargingProfileId, chargingProfilePurposeStr, recurrencyKindStr);
 
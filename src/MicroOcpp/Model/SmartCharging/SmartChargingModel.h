@@ -24,6 +24,7 @@
 
 #include <MicroOcpp/Core/Time.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticVector.h>
 
 namespace MicroOcpp {
 
@@ -80,7 +81,7 @@ public:
     int duration = -1;
     Timestamp startSchedule;
     ChargingRateUnitType chargingRateUnit;
-    Vector<ChargingSchedulePeriod> chargingSchedulePeriod;
+    StaticVector<ChargingSchedulePeriod, MO_ChargingScheduleMaxPeriods> chargingSchedulePeriod;
     float minChargingRate = -1.0f;
 
     ChargingProfileKindType chargingProfileKind; //copied from ChargingProfile to increase cohesion of limit algorithms
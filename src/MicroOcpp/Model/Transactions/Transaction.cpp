@@ -8,23 +8,23 @@
 using namespace MicroOcpp;
 
 bool Transaction::setIdTag(const char *idTag) {
-    auto ret = snprintf(this->idTag, IDTAG_LEN_MAX + 1, "%s", idTag);
-    return ret >= 0 && ret < IDTAG_LEN_MAX + 1;
+    dirty = true;
+    return this->idTag.set(idTag);
 }
 
 bool Transaction::setParentIdTag(const char *idTag) {
-    auto ret = snprintf(this->parentIdTag, IDTAG_LEN_MAX + 1, "%s", idTag);
-    return ret >= 0 && ret < IDTAG_LEN_MAX + 1;
+    dirty = true;
+    return this->parentIdTag.set(idTag);
 }
 
 bool Transaction::setStopIdTag(const char *idTag) {
-    auto ret = snprintf(stop_idTag, IDTAG_LEN_MAX + 1, "%s", idTag);
-    return ret >= 0 && ret < IDTAG_LEN_MAX + 1;
+    dirty = true;
+    return stop_idTag.set(idTag);
 }
 
 bool Transaction::setStopReason(const char *reason) {
-    auto ret = snprintf(stop_reason, REASON_LEN_MAX + 1, "%s", reason);
-    return ret >= 0 && ret < REASON_LEN_MAX + 1;
+    dirty = true;
+    return stop_reason.set(reason);
 }
 
 bool Transaction::commit() {
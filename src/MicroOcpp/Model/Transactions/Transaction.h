@@ -9,6 +9,7 @@
 
 #include <MicroOcpp/Core/Time.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/StaticString.h>
 #include <MicroOcpp/Operations/CiStrings.h>
 
 namespace MicroOcpp {
@@ -31,18 +32,23 @@ private:
     unsigned int opNr = 0;
     unsigned int attemptNr = 0;
     Timestamp attemptTime = MIN_TIME;
+
+    bool dirty = false; //modified since the last commit
 public:
-    void setRequested() {this->requested = true;}
+    void setRequested() {this->requested = true; dirty = true;}
     bool isRequested() {return requested;}
-    void confirm() {confirmed = true;}
+    void confirm() {confirmed = true; dirty = true;}
     bool isConfirmed() {return confirmed;}
-    void setOpNr(unsigned int opNr) {this->opNr = opNr;}
+    void setOpNr(unsigned int opNr) {this->opNr = opNr; dirty = true;}
     unsigned int getOpNr() {return opNr;}
-    void advanceAttemptNr() {attemptNr++;}
-    void setAttemptNr(unsigned int attemptNr) {this->attemptNr = attemptNr;}
+    void advanceAttemptNr() {attemptNr++; dirty = true;}
+    void setAttemptNr(unsigned int attemptNr) {this->attemptNr = attemptNr; dirty = true;}
     unsigned int getAttemptNr() {return attemptNr;}
     const Timestamp& getAttemptTime() {return attemptTime;}
-    void setAttemptTime(const Timestamp& timestamp) {attemptTime = timestamp;}
+    void setAttemptTime(const Timestamp& timestamp) {attemptTime = timestamp; dirty = true;}
+
+    bool isDirty() {return dirty;}
+    void clearDirty() {dirty = false;}
 };
 
 class Transaction : public MemoryManaged {
@@ -54,8 +60,8 @@ private:
     /*
      * Attributes existing before StartTransaction
      */
-    char idTag [IDTAG_LEN_MAX + 1] = {'\0'};
-    char parentIdTag [IDTAG_LEN_MAX + 1] = {'\0'};
+    StaticString<IDTAG_LEN_MAX> idTag;
+    StaticString<IDTAG_LEN_MAX> parentIdTag;
     bool authorized = false;    //if the given idTag was authorized
     bool deauthorized = false;  //if the server revoked a local authorization
     Timestamp begin_timestamp = MIN_TIME;
@@ -75,11 +81,11 @@ private:
      * Attributes of StopTransaction
      */
     SendStatus stop_sync;
-    char stop_idTag [IDTAG_LEN_MAX + 1] = {'\0'};
+    StaticString<IDTAG_LEN_MAX> stop_idTag;
     int32_t stop_meter = -1;
     Timestamp stop_timestamp = MIN_TIME;
     uint16_t stop_bootNr = 0;
-    char stop_reason [REASON_LEN_MAX + 1] = {'\0'};
+    StaticString<REASON_LEN_MAX> stop_reason;
 
     /*
      * General attributes
@@ -89,6 +95,8 @@ private:
 
     bool silent = false; //silent Tx: process tx locally, without reporting to the server
 
+    bool dirty = false; //modified since the last commit
+
 public:
     Transaction(ConnectorTransactionStore& context, unsigned int connectorId, unsigned int txNr, bool silent = false) : 
                 MemoryManaged("v16.Transactions.Transaction"),
@@ -117,68 +125,75 @@ public:
      */
     bool commit();
 
+    /*
+     * The setters mark the tx as modified. The TransactionStore clears the flag when the tx has been stored
+     * or loaded, so that a cached tx object can be told apart from its stored version without reading it
+     */
+    bool isDirty() {return dirty || start_sync.isDirty() || stop_sync.isDirty();}
+    void clearDirty() {dirty = false; start_sync.clearDirty(); stop_sync.clearDirty();}
+
     /*
      * Getters and setters for (mostly) internal use
      */
-    void setInactive() {active = false;}
+    void setInactive() {active = false; dirty = true;}
 
     bool setIdTag(const char *idTag);
-    const char *getIdTag() {return idTag;}
+    const char *getIdTag() {return idTag.c_str();}
 
     bool setParentIdTag(const char *idTag);
-    const char *getParentIdTag() {return parentIdTag;}
+    const char *getParentIdTag() {return parentIdTag.c_str();}
 
-    void setAuthorized() {authorized = true;}
-    void setIdTagDeauthorized() {deauthorized = true;}
+    void setAuthorized() {authorized = true; dirty = true;}
+    void setIdTagDeauthorized() {deauthorized = true; dirty = true;}
 
-    void setBeginTimestamp(Timestamp timestamp) {begin_timestamp = timestamp;}
+    void setBeginTimestamp(Timestamp timestamp) {begin_timestamp = timestamp; dirty = true;}
     const Timestamp& getBeginTimestamp() {return begin_timestamp;}
 
-    void setReservationId(int reservationId) {this->reservationId = reservationId;}
+    void setReservationId(int reservationId) {this->reservationId = reservationId; dirty = true;}
     int getReservationId() {return reservationId;}
 
-    void setTxProfileId(int txProfileId) {this->txProfileId = txProfileId;}
+    void setTxProfileId(int txProfileId) {this->txProfileId = txProfileId; dirty = true;}
     int getTxProfileId() {return txProfileId;}
 
     SendStatus& getStartSync() {return start_sync;}
 
-    void setMeterStart(int32_t meter) {start_meter = meter;}
+    void setMeterStart(int32_t meter) {start_meter = meter; dirty = true;}
     bool isMeterStartDefined() {return start_meter >= 0;}
     int32_t getMeterStart() {return start_meter;}
 
-    void setStartTimestamp(Timestamp timestamp) {start_timestamp = timestamp;}
+    void setStartTimestamp(Timestamp timestamp) {start_timestamp = timestamp; dirty = true;}
     const Timestamp& getStartTimestamp() {return start_timestamp;}
 
-    void setStartBootNr(uint16_t bootNr) {start_bootNr = bootNr;} 
+    void setStartBootNr(uint16_t bootNr) {start_bootNr = bootNr; dirty = true;} 
     uint16_t getStartBootNr() {return start_bootNr;}
 
-    void setTransactionId(int transactionId) {this->transactionId = transactionId;}
+    void setTransactionId(int transactionId) {this->transactionId = transactionId; dirty = true;}
 
     SendStatus& getStopSync() {return stop_sync;}
 
     bool setStopIdTag(const char *idTag);
-    const char *getStopIdTag() {return stop_idTag;}
+    const char *getStopIdTag() {return stop_idTag.c_str();}
 
-    void setMeterStop(int32_t meter) {stop_meter = meter;}
+    void setMeterStop(int32_t meter) {stop_meter = meter; dirty = true;}
     bool isMeterStopDefined() {return stop_meter >= 0;}
     int32_t getMeterStop() {return stop_meter;}
 
-    void setStopTimestamp(Timestamp timestamp) {stop_timestamp = timestamp;}
+    void setStopTimestamp(Timestamp timestamp) {stop_timestamp = timestamp; dirty = true;}
     const Timestamp& getStopTimestamp() {return stop_timestamp;}
 
-    void setStopBootNr(uint16_t bootNr) {stop_bootNr = bootNr;} 
+    void setStopBootNr(uint16_t bootNr) {stop_bootNr = bootNr; dirty = true;} 
     uint16_t getStopBootNr() {return stop_bootNr;}
 
     bool setStopReason(const char *reason);
-    const char *getStopReason() {return stop_reason;}
+    const char *getStopReason() {return stop_reason.c_str();}
 
-    void setConnectorId(unsigned int connectorId) {this->connectorId = connectorId;}
+    void setConnectorId(unsigned int connectorId) {this->connectorId = connectorId; dirty = true;}
     unsigned int getConnectorId() {return connectorId;}
 
-    void setTxNr(unsigned int txNr) {this->txNr = txNr;}
+    void setTxNr(unsigned int txNr) {this->txNr = txNr; dirty = true;}
     unsigned int getTxNr() {return txNr;} //internal primary key of this tx object
 
-    void setSilent() {silent = true;}
+    void setSilent() {silent = true; dirty = true;}
     bool isSilent() {return silent;} //no data will be sent to server and server will not assign transactionId
 };
 
@@ -0,0 +1,446 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Transactions/TransactionHistory.h>
+
+#if MO_ENABLE_TX_HISTORY
+
+#include <MicroOcpp/Model/Transactions/Transaction.h>
+#include <MicroOcpp/Model/ConnectorBase/Connector.h> //MAX_TX_CNT
+#include <MicroOcpp/Debug.h>
+
+#include <string.h>
+#include <ctype.h>
+
+/*
+ * Index file format (all numbers little endian). The index consists of two segment files. New records
+ * are appended to the segment with the higher sequence number. When it is full, the other segment is
+ * overwritten with a new, empty segment.
+ *
+ *     header: magic "MOTH" | u32 sequence number
+ *     records of 32 bytes:
+ *         u32 txNr | i32 transactionId | u32 idTag hash | i32 start | i32 stop | i32 meterStart | i32 meterStop |
+ *         u8 connectorId | u8 flags | u16 Fletcher-16 checksum of the preceding 30 bytes
+ *
+ * Timestamps are in seconds since MIN_TIME; 0 means undefined
+ */
+
+#define TXHIST_HEADER_SIZE 8
+#define TXHIST_RECORD_SIZE 32
+#define TXHIST_SEGMENT_SIZE (MO_TX_HISTORY_SIZE / 2) //records per segment
+#define TXHIST_READ_CHUNK 8 //records per read access
+
+static_assert(MO_TX_HISTORY_SIZE >= 2, "MO_TX_HISTORY_SIZE must be at least 2");
+
+using namespace MicroOcpp;
+
+namespace {
+
+void writeU32(unsigned char *buf, uint32_t val) {
+    buf[0] = (unsigned char) (val & 0xFF);
+    buf[1] = (unsigned char) ((val >> 8) & 0xFF);
+    buf[2] = (unsigned char) ((val >> 16) & 0xFF);
+    buf[3] = (unsigned char) ((val >> 24) & 0xFF);
+}
+
+uint32_t readU32(const unsigned char *buf) {
+    return (uint32_t) buf[0] |
+            ((uint32_t) buf[1] << 8) |
+            ((uint32_t) buf[2] << 16) |
+            ((uint32_t) buf[3] << 24);
+}
+
+uint16_t fletcher16(const unsigned char *buf, size_t len) {
+    uint16_t sum1 = 0, sum2 = 0;
+    for (size_t i = 0; i < len; i++) {
+        sum1 = (sum1 + buf[i]) % 255;
+        sum2 = (sum2 + sum1) % 255;
+    }
+    return (uint16_t) ((sum2 << 8) | sum1);
+}
+
+int32_t toSeconds(const Timestamp& t) {
+    return t > MIN_TIME ? (int32_t) (t - MIN_TIME) : 0;
+}
+
+void encodeRecord(const TxSummary& summary, unsigned char *buf) {
+    writeU32(buf, (uint32_t) summary.txNr);
+    writeU32(buf + 4, (uint32_t) summary.transactionId);
+    writeU32(buf + 8, summary.idTagHash);
+    writeU32(buf + 12, (uint32_t) toSeconds(summary.start));
+    writeU32(buf + 16, (uint32_t) toSeconds(summary.stop));
+    writeU32(buf + 20, (uint32_t) summary.meterStart);
+    writeU32(buf + 24, (uint32_t) summary.meterStop);
+    buf[28] = (unsigned char) summary.connectorId;
+    buf[29] = summary.flags;
+    auto checksum = fletcher16(buf, 30);
+    buf[30] = (unsigned char) (checksum & 0xFF);
+    buf[31] = (unsigned char) (checksum >> 8);
+}
+
+bool decodeRecord(const unsigned char *buf, TxSummary& summary) {
+    auto checksum = fletcher16(buf, 30);
+    if (buf[30] != (unsigned char) (checksum & 0xFF) || buf[31] != (unsigned char) (checksum >> 8)) {
+        return false;
+    }
+    summary.txNr = (unsigned int) readU32(buf);
+    summary.transactionId = (int) (int32_t) readU32(buf + 4);
+    summary.idTagHash = readU32(buf + 8);
+    summary.start = MIN_TIME;
+    if (auto secs = (int32_t) readU32(buf + 12)) {
+        summary.start += secs;
+    }
+    summary.stop = MIN_TIME;
+    if (auto secs = (int32_t) readU32(buf + 16)) {
+        summary.stop += secs;
+    }
+    summary.meterStart = (int32_t) readU32(buf + 20);
+    summary.meterStop = (int32_t) readU32(buf + 24);
+    summary.connectorId = buf[28];
+    summary.flags = buf[29];
+    return true;
+}
+
+} //namespace
+
+int32_t TxSummary::getEnergy() const {
+    if (meterStart < 0 || meterStop < meterStart) {
+        return 0;
+    }
+    return meterStop - meterStart;
+}
+
+TransactionHistory::TransactionHistory(unsigned int nConnectors, std::shared_ptr<FilesystemAdapter> filesystem) :
+        MemoryManaged("v16.Transactions.TransactionHistory"),
+        filesystem(filesystem),
+        lastTxNr(makeVector<int>(getMemoryTag())) {
+
+    lastTxNr.resize(nConnectors, -1);
+}
+
+bool TransactionHistory::getPath(unsigned int segment, char *path, size_t size) {
+    auto ret = snprintf(path, size, MO_FILENAME_PREFIX MO_TX_HISTORY_FN_PREFIX "%u.bin", segment);
+    if (ret < 0 || (size_t)ret >= size) {
+        MO_DBG_ERR("fn error: %i", ret);
+        return false;
+    }
+    return true;
+}
+
+bool TransactionHistory::load() {
+    if (!filesystem) {
+        return false;
+    }
+
+    if (loaded) {
+        bool removed = false;
+        for (unsigned int i = 0; i < 2; i++) {
+            char path [MO_MAX_PATH_SIZE];
+            size_t size;
+            if (segments[i].exists && getPath(i, path, sizeof(path)) && filesystem->stat(path, &size) != 0) {
+                removed = true;
+            }
+        }
+        if (!removed) {
+            return true;
+        }
+        //e.g. by a factory reset. Continue with a new index
+        MO_DBG_WARN("tx history files have been removed");
+        reset();
+    }
+
+    for (unsigned int i = 0; i < 2; i++) {
+        char path [MO_MAX_PATH_SIZE];
+        if (!getPath(i, path, sizeof(path))) {
+            return false;
+        }
+
+        size_t size;
+        if (filesystem->stat(path, &size) != 0 || size < TXHIST_HEADER_SIZE) {
+            continue;
+        }
+
+        auto file = filesystem->open(path, "r");
+        if (!file) {
+            continue;
+        }
+
+        unsigned char header [TXHIST_HEADER_SIZE];
+        if (file->read((char*) header, sizeof(header)) != sizeof(header) || memcmp(header, "MOTH", 4)) {
+            MO_DBG_ERR("invalid segment %s. Overwrite with next rotation", path);
+            continue;
+        }
+
+        segments[i].exists = true;
+        segments[i].seq = readU32(header + 4);
+        segments[i].count = (size - TXHIST_HEADER_SIZE) / TXHIST_RECORD_SIZE;
+        segments[i].torn = (size - TXHIST_HEADER_SIZE) % TXHIST_RECORD_SIZE != 0;
+    }
+
+    if (segments[0].exists && segments[1].exists) {
+        current = segments[1].seq > segments[0].seq ? 1 : 0;
+    } else {
+        current = segments[1].exists ? 1 : 0;
+    }
+
+    loaded = true;
+
+    //restore the last recorded session per connector
+    size_t nMissing = lastTxNr.size();
+    forEach([this, &nMissing] (const TxSummary& summary) {
+        if (summary.connectorId < lastTxNr.size() && lastTxNr[summary.connectorId] < 0) {
+            lastTxNr[summary.connectorId] = (int) summary.txNr;
+            nMissing--;
+        }
+        return nMissing > 0;
+    });
+
+    MO_DBG_DEBUG("loaded tx history: %zu sessions", size());
+    return true;
+}
+
+void TransactionHistory::reset() {
+    for (unsigned int i = 0; i < 2; i++) {
+        segments[i] = Segment();
+    }
+    current = 0;
+    for (auto& txNr : lastTxNr) {
+        txNr = -1;
+    }
+    loaded = false;
+}
+
+bool TransactionHistory::startSegment(unsigned int segment, uint32_t seq) {
+    char path [MO_MAX_PATH_SIZE];
+    if (!getPath(segment, path, sizeof(path))) {
+        return false;
+    }
+
+    auto file = filesystem->open(path, "w");
+    if (!file) {
+        MO_DBG_ERR("cannot create %s", path);
+        return false;
+    }
+
+    unsigned char header [TXHIST_HEADER_SIZE];
+    memcpy(header, "MOTH", 4);
+    writeU32(header + 4, seq);
+    if (file->write((const char*) header, sizeof(header)) != sizeof(header)) {
+        MO_DBG_ERR("cannot write %s", path);
+        segments[segment].exists = false;
+        return false;
+    }
+
+    segments[segment].exists = true;
+    segments[segment].seq = seq;
+    segments[segment].count = 0;
+    segments[segment].torn = false;
+    return true;
+}
+
+bool TransactionHistory::append(const TxSummary& summary) {
+    if (!segments[current].exists) {
+        if (!startSegment(current, 1)) {
+            return false;
+        }
+    } else if (segments[current].count >= TXHIST_SEGMENT_SIZE || segments[current].torn) {
+        //rotate: drop the older half of the history
+        unsigned int next = current ? 0 : 1;
+        if (!startSegment(next, segments[current].seq + 1)) {
+            return false;
+        }
+        current = next;
+    }
+
+    char path [MO_MAX_PATH_SIZE];
+    if (!getPath(current, path, sizeof(path))) {
+        return false;
+    }
+
+    auto file = filesystem->open(path, "a");
+    if (!file) {
+        MO_DBG_ERR("cannot open %s", path);
+        return false;
+    }
+
+    unsigned char record [TXHIST_RECORD_SIZE];
+    encodeRecord(summary, record);
+    if (file->write((const char*) record, sizeof(record)) != sizeof(record)) {
+        MO_DBG_ERR("cannot write %s", path);
+        segments[current].torn = true;
+        return false;
+    }
+
+    segments[current].count++;
+    return true;
+}
+
+void TransactionHistory::onCommit(Transaction& transaction) {
+    if (!transaction.getStartSync().isRequested() || !transaction.getStopSync().isRequested()) {
+        return; //only record sessions which have started and stopped
+    }
+
+    auto connectorId = transaction.getConnectorId();
+    auto txNr = transaction.getTxNr();
+
+    if (connectorId >= lastTxNr.size()) {
+        MO_DBG_ERR("invalid connectorId");
+        return;
+    }
+
+    if (!load()) {
+        return;
+    }
+
+    //the sessions of a connector stop in the order of their txNrs. Skip the tx if it isn't newer than the last recorded one
+    if (lastTxNr[connectorId] >= 0) {
+        auto delta = (txNr + MAX_TX_CNT - (unsigned int) lastTxNr[connectorId]) % MAX_TX_CNT;
+        if (delta == 0 || delta > MAX_TX_CNT / 2) {
+            return;
+        }
+    }
+
+    TxSummary summary;
+    summary.connectorId = connectorId;
+    summary.txNr = txNr;
+    summary.transactionId = transaction.getStartSync().isConfirmed() ? transaction.getTransactionId() : -1;
+    summary.idTagHash = hashIdTag(transaction.getIdTag());
+    summary.start = transaction.getStartTimestamp();
+    summary.stop = transaction.getStopTimestamp();
+    summary.meterStart = transaction.getMeterStart();
+    summary.meterStop = transaction.getMeterStop();
+    if (transaction.getStartSync().isConfirmed()) {
+        summary.flags |= TxSummary_StartConfirmed;
+    }
+    if (transaction.isAuthorized()) {
+        summary.flags |= TxSummary_Authorized;
+    }
+    if (transaction.isIdTagDeauthorized()) {
+        summary.flags |= TxSummary_Deauthorized;
+    }
+    if (transaction.isSilent()) {
+        summary.flags |= TxSummary_Silent;
+    }
+
+    if (append(summary)) {
+        lastTxNr[connectorId] = (int) txNr;
+        MO_DBG_DEBUG("recorded session %u-%u", connectorId, txNr);
+    }
+}
+
+bool TransactionHistory::forEachInSegment(unsigned int segment, const std::function<bool(const TxSummary&)>& fn) {
+    if (!segments[segment].exists || segments[segment].count == 0) {
+        return true;
+    }
+
+    char path [MO_MAX_PATH_SIZE];
+    if (!getPath(segment, path, sizeof(path))) {
+        return true;
+    }
+
+    auto file = filesystem->open(path, "r");
+    if (!file) {
+        MO_DBG_ERR("cannot open %s", path);
+        return true;
+    }
+
+    unsigned char buf [TXHIST_READ_CHUNK * TXHIST_RECORD_SIZE];
+
+    //read backwards in chunks, newest record first
+    size_t n = segments[segment].count;
+    while (n > 0) {
+        size_t chunk = n < TXHIST_READ_CHUNK ? n : TXHIST_READ_CHUNK;
+        size_t begin = n - chunk;
+        file->seek(TXHIST_HEADER_SIZE + begin * TXHIST_RECORD_SIZE);
+        if (file->read((char*) buf, chunk * TXHIST_RECORD_SIZE) != chunk * TXHIST_RECORD_SIZE) {
+            MO_DBG_ERR("read error %s", path);
+            return true;
+        }
+        for (size_t i = chunk; i-- > 0;) {
+            TxSummary summary;
+            if (!decodeRecord(buf + i * TXHIST_RECORD_SIZE, summary)) {
+                MO_DBG_WARN("skip corrupt record in %s", path);
+                continue;
+            }
+            if (!fn(summary)) {
+                return false;
+            }
+        }
+        n = begin;
+    }
+
+    return true;
+}
+
+bool TransactionHistory::forEach(std::function<bool(const TxSummary&)> fn) {
+    if (!load()) {
+        return false;
+    }
+
+    if (!forEachInSegment(current, fn)) {
+        return true;
+    }
+    forEachInSegment(current ? 0 : 1, fn);
+    return true;
+}
+
+size_t TransactionHistory::size() {
+    if (!load()) {
+        return 0;
+    }
+    return segments[0].count + segments[1].count;
+}
+
+size_t TransactionHistory::findByIdTag(const char *idTag, TxSummary *out, size_t maxCount) {
+    auto idTagHash = hashIdTag(idTag);
+    size_t count = 0;
+    if (maxCount == 0) {
+        return 0;
+    }
+    forEach([idTagHash, out, maxCount, &count] (const TxSummary& summary) {
+        if (summary.idTagHash == idTagHash) {
+            out[count++] = summary;
+        }
+        return count < maxCount;
+    });
+    return count;
+}
+
+size_t TransactionHistory::findByTime(const Timestamp& from, const Timestamp& to, TxSummary *out, size_t maxCount) {
+    size_t count = 0;
+    if (maxCount == 0) {
+        return 0;
+    }
+    forEach([&from, &to, out, maxCount, &count] (const TxSummary& summary) {
+        const Timestamp& start = summary.start > MIN_TIME ? summary.start : summary.stop;
+        if (start < to && summary.stop >= from) {
+            out[count++] = summary;
+        }
+        return count < maxCount;
+    });
+    return count;
+}
+
+int32_t TransactionHistory::getEnergy(const Timestamp& from, const Timestamp& to, unsigned int connectorId) {
+    int32_t energy = 0;
+    forEach([&from, &to, connectorId, &energy] (const TxSummary& summary) {
+        if ((connectorId == 0 || summary.connectorId == connectorId) &&
+                summary.stop >= from && summary.stop < to) {
+            energy += summary.getEnergy();
+        }
+        return true;
+    });
+    return energy;
+}
+
+uint32_t TransactionHistory::hashIdTag(const char *idTag) {
+    //FNV-1a
+    uint32_t hash = 2166136261U;
+    for (const char *c = idTag; c && *c; c++) {
+        hash = (hash ^ (uint32_t) tolower((unsigned char) *c)) * 16777619U;
+    }
+    return hash;
+}
+
+#endif //MO_ENABLE_TX_HISTORY
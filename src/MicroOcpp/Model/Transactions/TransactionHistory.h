@@ -0,0 +1,120 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_TRANSACTIONHISTORY_H
+#define MO_TRANSACTIONHISTORY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <functional>
+#include <memory>
+
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/Time.h>
+
+/*
+ * Transaction history: a compact index of the finished charging sessions (OCPP 1.6). When a tx is
+ * stopped, the TransactionStore appends a summary of 32 bytes to the index. The index retains many more
+ * sessions than the full tx records (MO_TXRECORD_SIZE per connector) and can be queried by idTag and
+ * time range without loading the tx records, e.g. for a local display or billing.
+ */
+#ifndef MO_ENABLE_TX_HISTORY
+#define MO_ENABLE_TX_HISTORY 0
+#endif
+
+#ifndef MO_TX_HISTORY_SIZE
+#define MO_TX_HISTORY_SIZE 256 //max number of sessions in the index. When full, the oldest half is dropped
+#endif
+
+//two segment files hist-0.bin and hist-1.bin. The prefix must not start with "tx", "sd" or "op", otherwise ClearCache
+//and the recovery of the persistent storage would delete the index together with the tx records
+#define MO_TX_HISTORY_FN_PREFIX "hist-"
+
+#if MO_ENABLE_TX_HISTORY
+
+namespace MicroOcpp {
+
+class Transaction;
+
+enum TxSummaryFlags : uint8_t {
+    TxSummary_StartConfirmed = 1 << 0, //the server has confirmed the StartTransaction before the session ended
+    TxSummary_Authorized     = 1 << 1,
+    TxSummary_Deauthorized   = 1 << 2, //the server has rejected the idTag in the StartTransaction.conf
+    TxSummary_Silent         = 1 << 3  //not reported to the server
+};
+
+struct TxSummary {
+    unsigned int connectorId = 0;
+    unsigned int txNr = 0;
+    int transactionId = -1; //-1 if the server hasn't assigned it before the session ended
+    uint32_t idTagHash = 0; //see TransactionHistory::hashIdTag()
+    Timestamp start = MIN_TIME;
+    Timestamp stop = MIN_TIME;
+    int32_t meterStart = -1;
+    int32_t meterStop = -1;
+    uint8_t flags = 0; //TxSummaryFlags
+
+    int32_t getEnergy() const; //meterStop - meterStart or 0 if undefined
+};
+
+class TransactionHistory : public MemoryManaged {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+
+    struct Segment {
+        bool exists = false;
+        uint32_t seq = 0; //the segment with the higher seq is appended to
+        size_t count = 0; //number of records
+        bool torn = false; //incomplete record at the end, e.g. after a power loss
+    };
+    Segment segments [2];
+    unsigned int current = 0;
+
+    Vector<int> lastTxNr; //per connector: txNr of the last recorded session or -1
+
+    bool loaded = false;
+
+    bool getPath(unsigned int segment, char *path, size_t size);
+    bool load(); //called before each access. Starts over if the files have been removed meanwhile
+    void reset();
+    bool startSegment(unsigned int segment, uint32_t seq);
+    bool append(const TxSummary& summary);
+    bool forEachInSegment(unsigned int segment, const std::function<bool(const TxSummary&)>& fn);
+public:
+    TransactionHistory(unsigned int nConnectors, std::shared_ptr<FilesystemAdapter> filesystem);
+
+    void onCommit(Transaction& transaction); //appends the summary when the tx has been stopped
+
+    /*
+     * Enumerates the sessions from the newest to the oldest. Stops when fn returns false
+     */
+    bool forEach(std::function<bool(const TxSummary&)> fn);
+
+    size_t size(); //number of sessions in the index
+
+    /*
+     * The last sessions of idTag, newest first. Returns the number of entries written to out. Because
+     * the index only keeps a 32 bit hash of the idTag, the result can include sessions of another idTag
+     * with the same hash in rare cases
+     */
+    size_t findByIdTag(const char *idTag, TxSummary *out, size_t maxCount);
+
+    /*
+     * Sessions which overlap with the time range [from, to), newest first
+     */
+    size_t findByTime(const Timestamp& from, const Timestamp& to, TxSummary *out, size_t maxCount);
+
+    /*
+     * Energy in Wh of the sessions which stopped within [from, to). connectorId 0 sums up all connectors
+     */
+    int32_t getEnergy(const Timestamp& from, const Timestamp& to, unsigned int connectorId = 0);
+
+    static uint32_t hashIdTag(const char *idTag); //case-insensitive like the IdToken
+};
+
+} //namespace MicroOcpp
+
+#endif //MO_ENABLE_TX_HISTORY
+#endif
@@ -14,7 +14,8 @@ ConnectorTransactionStore::ConnectorTransactionStore(TransactionStore& context,
         context(context),
         connectorId(connectorId),
         filesystem(filesystem),
-        transactions{makeVector<std::weak_ptr<Transaction>>(getMemoryTag())} {
+        transactions{makeVector<std::weak_ptr<Transaction>>(getMemoryTag())},
+        cache{makeVector<std::shared_ptr<Transaction>>(getMemoryTag())} {
 
 }
 
@@ -22,8 +23,78 @@ ConnectorTransactionStore::~ConnectorTransactionStore() {
 
 }
 
+void ConnectorTransactionStore::updateCache(Transaction *transaction) {
+    if (cacheSize == 0) {
+        return;
+    }
+
+    std::shared_ptr<Transaction> entry;
+    for (auto cached = cache.begin(); cached != cache.end(); cached++) {
+        if (cached->get() == transaction) {
+            entry = std::move(*cached);
+            cache.erase(cached);
+            break;
+        }
+    }
+
+    if (!entry) {
+        //tx has been evicted from the cache before or is new. Get the owning pointer from the weak references
+        for (auto& cached : transactions) {
+            auto tx = cached.lock();
+            if (tx && tx.get() == transaction) {
+                entry = std::move(tx);
+                break;
+            }
+        }
+    }
+
+    if (!entry) {
+        return;
+    }
+
+    evict(entry->getTxNr()); //outdated tx object with the same txNr
+
+    while (cache.size() >= cacheSize) {
+        cache.erase(cache.begin());
+    }
+
+    cache.push_back(std::move(entry));
+}
+
+void ConnectorTransactionStore::evict(unsigned int txNr) {
+    for (auto cached = cache.begin(); cached != cache.end(); cached++) {
+        if ((*cached)->getTxNr() == txNr) {
+            cache.erase(cached);
+            return;
+        }
+    }
+}
+
+void ConnectorTransactionStore::setCacheSize(size_t cacheSize) {
+    this->cacheSize = cacheSize;
+    while (cache.size() > cacheSize) {
+        cache.erase(cache.begin());
+    }
+}
+
 std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned int txNr) {
 
+    //check strong cache first. If the cache holds the only reference, the previous users may have modified it without commit
+    for (auto cached = cache.begin(); cached != cache.end(); cached++) {
+        if ((*cached)->getTxNr() == txNr) {
+            if (cached->use_count() == 1 && (*cached)->isDirty()) {
+                //discard and reload from flash
+                cache.erase(cached);
+                break;
+            }
+            //cache hit - move to most recently used
+            auto entry = std::move(*cached);
+            cache.erase(cached);
+            cache.push_back(entry);
+            return entry;
+        }
+    }
+
     //check for most recent element of cache first because of temporal locality
     if (!transactions.empty()) {
         if (auto cached = transactions.back().lock()) {
@@ -94,7 +165,12 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::getTransaction(unsigned
         }
     }
 
+    transaction->clearDirty(); //same as stored
+
     transactions.push_back(transaction);
+
+    updateCache(transaction.get());
+
     return transaction;
 }
 
@@ -102,11 +178,6 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::createTransaction(unsign
 
     auto transaction = std::allocate_shared<Transaction>(makeAllocator<Transaction>(getMemoryTag()), *this, connectorId, txNr, silent);
 
-    if (!commit(transaction.get())) {
-        MO_DBG_ERR("FS error");
-        return nullptr;
-    }
-
     //before adding new entry, clean cache
     auto cached = transactions.begin();
     while (cached != transactions.end()) {
@@ -119,6 +190,13 @@ std::shared_ptr<Transaction> ConnectorTransactionStore::createTransaction(unsign
     }
 
     transactions.push_back(transaction);
+
+    if (!commit(transaction.get())) {
+        MO_DBG_ERR("FS error");
+        transactions.pop_back();
+        return nullptr;
+    }
+
     return transaction;
 }
 
@@ -144,15 +222,28 @@ bool ConnectorTransactionStore::commit(Transaction *transaction) {
 
     if (!FilesystemUtils::storeJson(filesystem, fn, txDoc)) {
         MO_DBG_ERR("FS error");
+        evict(transaction->getTxNr());
         return false;
     }
 
+    transaction->clearDirty();
+
+    updateCache(transaction);
+
+#if MO_ENABLE_TX_HISTORY
+    if (auto history = context.getHistory()) {
+        history->onCommit(*transaction);
+    }
+#endif //MO_ENABLE_TX_HISTORY
+
     //success
     return true;
 }
 
 bool ConnectorTransactionStore::remove(unsigned int txNr) {
 
+    evict(txNr);
+
     if (!filesystem) {
         MO_DBG_DEBUG("no FS: nothing to remove");
         return true;
@@ -183,6 +274,12 @@ TransactionStore::TransactionStore(unsigned int nConnectors, std::shared_ptr<Fil
         connectors.push_back(std::unique_ptr<ConnectorTransactionStore>(
             new ConnectorTransactionStore(*this, i, filesystem)));
     }
+
+#if MO_ENABLE_TX_HISTORY
+    if (filesystem) {
+        history = std::unique_ptr<TransactionHistory>(new TransactionHistory(nConnectors, filesystem));
+    }
+#endif //MO_ENABLE_TX_HISTORY
 }
 
 bool TransactionStore::commit(Transaction *transaction) {
@@ -221,3 +318,9 @@ bool TransactionStore::remove(unsigned int connectorId, unsigned int txNr) {
     }
     return connectors[connectorId]->remove(txNr);
 }
+
+void TransactionStore::setCacheSize(size_t cacheSize) {
+    for (auto& connector : connectors) {
+        connector->setCacheSize(cacheSize);
+    }
+}
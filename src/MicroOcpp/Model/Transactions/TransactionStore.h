@@ -6,9 +6,14 @@
 #define MO_TRANSACTIONSTORE_H
 
 #include <MicroOcpp/Model/Transactions/Transaction.h>
+#include <MicroOcpp/Model/Transactions/TransactionHistory.h>
 #include <MicroOcpp/Core/FilesystemAdapter.h>
 #include <MicroOcpp/Core/Memory.h>
 
+#ifndef MO_TXSTORE_CACHE_SIZE
+#define MO_TXSTORE_CACHE_SIZE 2 //per connector: recently used transactions which stay parsed in RAM after their users have released them. 0 = disabled
+#endif
+
 namespace MicroOcpp {
 
 class TransactionStore;
@@ -22,6 +27,16 @@ private:
     
     Vector<std::weak_ptr<Transaction>> transactions;
 
+    /*
+     * Strong LRU cache. If the last user of a tx has modified it without commit, the tx is dirty and is
+     * loaded from flash again
+     */
+    Vector<std::shared_ptr<Transaction>> cache; //least recently used first
+    size_t cacheSize = MO_TXSTORE_CACHE_SIZE;
+
+    void updateCache(Transaction *transaction); //tx has been loaded or committed
+    void evict(unsigned int txNr);
+
 public:
     ConnectorTransactionStore(TransactionStore& context, unsigned int connectorId, std::shared_ptr<FilesystemAdapter> filesystem);
     ConnectorTransactionStore(const ConnectorTransactionStore&) = delete;
@@ -36,11 +51,16 @@ public:
     std::shared_ptr<Transaction> createTransaction(unsigned int txNr, bool silent = false);
 
     bool remove(unsigned int txNr);
+
+    void setCacheSize(size_t cacheSize);
 };
 
 class TransactionStore : public MemoryManaged {
 private:
     Vector<std::unique_ptr<ConnectorTransactionStore>> connectors;
+#if MO_ENABLE_TX_HISTORY
+    std::unique_ptr<TransactionHistory> history;
+#endif //MO_ENABLE_TX_HISTORY
 public:
     TransactionStore(unsigned int nConnectors, std::shared_ptr<FilesystemAdapter> filesystem);
 
@@ -50,6 +70,12 @@ public:
     std::shared_ptr<Transaction> createTransaction(unsigned int connectorId, unsigned int txNr, bool silent = false);
 
     bool remove(unsigned int connectorId, unsigned int txNr);
+
+    void setCacheSize(size_t cacheSize); //per connector
+
+#if MO_ENABLE_TX_HISTORY
+    TransactionHistory *getHistory() {return history.get();} //nullptr if no filesystem
+#endif //MO_ENABLE_TX_HISTORY
 };
 
 }
@@ -0,0 +1,94 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Operations/RawOperation.h>
+#include <MicroOcpp/Debug.h>
+
+using MicroOcpp::RawOperation;
+using MicroOcpp::JsonDoc;
+
+RawOperation::RawOperation(const char *operationType, RawPayloadWriter writeReq, RawPayloadReader processConf, void *user_data) :
+        MemoryManaged("Operation.Custom.", operationType),
+        operationType{makeString(getMemoryTag(), operationType)},
+        writeReqCb{writeReq},
+        processConfCb{processConf},
+        user_data{user_data} {
+
+}
+
+RawOperation::RawOperation(const char *operationType, RawPayloadReader processReq, RawPayloadWriter writeConf, void *user_data) :
+        MemoryManaged("Operation.Custom.", operationType),
+        operationType{makeString(getMemoryTag(), operationType)},
+        processReqCb{processReq},
+        writeConfCb{writeConf},
+        user_data{user_data} {
+
+}
+
+RawOperation::~RawOperation() {
+
+}
+
+const char* RawOperation::getOperationType() {
+    return operationType.c_str();
+}
+
+void RawOperation::processPayload(RawPayloadReader cb, JsonObject payload) {
+    //fallback if the received payload is not available as a slice of the input, e.g. if it has been cropped
+    auto buf = makeString(getMemoryTag());
+    serializeJson(payload, buf);
+    cb(buf.c_str(), buf.length(), user_data);
+}
+
+int RawOperation::writeReq(char *buf, size_t size) {
+    int ret = writeReqCb(buf, size, user_data);
+    if (ret < 0) {
+        MO_DBG_ERR("%s: cannot create payload", operationType.c_str());
+    }
+    return ret;
+}
+
+std::unique_ptr<JsonDoc> RawOperation::createReq() {
+    return nullptr; //only reached if writeReq failed. Try again later
+}
+
+bool RawOperation::processConfRaw(const char *payload, size_t len) {
+    if (processConfCb) {
+        processConfCb(payload, len, user_data);
+    }
+    return true;
+}
+
+void RawOperation::processConf(JsonObject payload) {
+    if (processConfCb) {
+        processPayload(processConfCb, payload);
+    }
+}
+
+bool RawOperation::processReqRaw(const char *payload, size_t len) {
+    processReqCb(payload, len, user_data);
+    return true;
+}
+
+void RawOperation::processReq(JsonObject payload) {
+    processPayload(processReqCb, payload);
+}
+
+int RawOperation::writeConf(char *buf, size_t size) {
+    int ret = writeConfCb(buf, size, user_data);
+    if (ret < 0) {
+        MO_DBG_ERR("%s: cannot create payload", operationType.c_str());
+        failure = true; //respond with CallError
+    }
+    return ret;
+}
+
+std::unique_ptr<JsonDoc> RawOperation::createConf() {
+    failure = true; //payload could not be written into the send buffer. Respond with CallError on the next attempt
+    return nullptr;
+}
+
+const char *RawOperation::getErrorCode() {
+    return failure ? "InternalError" : nullptr;
+}
@@ -0,0 +1,60 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#ifndef MO_RAWOPERATION_H
+#define MO_RAWOPERATION_H
+
+#include <MicroOcpp/Core/Operation.h>
+
+namespace MicroOcpp {
+
+/*
+ * Custom operation which exchanges its payloads as JSON text through plain C callbacks. Received payloads
+ * are passed as slices of the received frame and outgoing payloads are written directly into the send
+ * buffer, i.e. without intermediate JSON documents. Used by the C API (see ocpp_sendRequestRaw)
+ */
+typedef int  (*RawPayloadWriter) (char *buf, size_t size, void *user_data); //returns length like snprintf or -1 on failure
+typedef void (*RawPayloadReader) (const char *payload, size_t len, void *user_data);
+
+class RawOperation : public Operation, public MemoryManaged {
+private:
+    String operationType;
+    RawPayloadWriter writeReqCb = nullptr;
+    RawPayloadReader processConfCb = nullptr;
+    RawPayloadReader processReqCb = nullptr;
+    RawPayloadWriter writeConfCb = nullptr;
+    void *user_data = nullptr;
+
+    bool failure = false;
+
+    void processPayload(RawPayloadReader cb, JsonObject payload);
+public:
+
+    //for operations initiated at this device
+    RawOperation(const char *operationType, RawPayloadWriter writeReq, RawPayloadReader processConf, void *user_data);
+
+    //for operations received from remote
+    RawOperation(const char *operationType, RawPayloadReader processReq, RawPayloadWriter writeConf, void *user_data);
+
+    ~RawOperation();
+
+    const char* getOperationType() override;
+
+    int writeReq(char *buf, size_t size) override;
+    std::unique_ptr<JsonDoc> createReq() override;
+
+    bool processConfRaw(const char *payload, size_t len) override;
+    void processConf(JsonObject payload) override;
+
+    bool processReqRaw(const char *payload, size_t len) override;
+    void processReq(JsonObject payload) override;
+
+    int writeConf(char *buf, size_t size) override;
+    std::unique_ptr<JsonDoc> createConf() override;
+
+    const char *getErrorCode() override;
+};
+
+} //end namespace MicroOcpp
+#endif
@@ -53,10 +53,19 @@ void SendLocalList::processReq(JsonObject payload) {
         return;
     }
 
-    updateFailure = !authService.updateLocalList(localAuthorizationList, listVersion, differential);
+    updateFailure = !authService.updateLocalListDeferred(localAuthorizationList, listVersion, differential);
+    storePending = !updateFailure;
 }
 
 std::unique_ptr<JsonDoc> SendLocalList::createConf(){
+    if (storePending) {
+        if (authService.isStorePending()) {
+            return nullptr; //wait until the list is stored
+        }
+        updateFailure = authService.isStoreFailed();
+        storePending = false;
+    }
+
     auto doc = makeJsonDoc(getMemoryTag(), JSON_OBJECT_SIZE(1));
     JsonObject payload = doc->to<JsonObject>();
 
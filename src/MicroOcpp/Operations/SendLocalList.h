@@ -23,6 +23,7 @@ private:
     const char *errorCode = nullptr;
     bool updateFailure = true;
     bool versionMismatch = false;
+    bool storePending = false; //the list is written to flash in a later loop call
 public:
     SendLocalList(AuthorizationService& authService);
 
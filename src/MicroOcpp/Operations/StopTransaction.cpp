@@ -20,7 +20,7 @@ StopTransaction::StopTransaction(Model& model, std::shared_ptr<Transaction> tran
 
 }
 
-StopTransaction::StopTransaction(Model& model, std::shared_ptr<Transaction> transaction, Vector<std::unique_ptr<MicroOcpp::MeterValue>> transactionData)
+StopTransaction::StopTransaction(Model& model, std::shared_ptr<Transaction> transaction, StopTxData transactionData)
         : MemoryManaged("v16.Operation.", "StopTransaction"), model(model), transaction(transaction), transactionData(std::move(transactionData)) {
 
 }
@@ -133,8 +133,13 @@ void StopTransaction::processConf(JsonObject payload) {
 
 bool StopTransaction::processErr(const char *code, const char *description, JsonObject details) {
 
+    if (model.getRetryPolicy().onCallError(code, details) == RetryDecision::Retry) {
+        //transient server error. Abort and retry according to TransactionMessageAttempts / -RetryInterval
+        return true;
+    }
+
     if (transaction) {
-        transaction->getStopSync().confirm(); //no retry behavior for now; consider data "arrived" at server
+        transaction->getStopSync().confirm(); //retry would fail again; consider data "arrived" at server
         transaction->commit();
     }
 
@@ -9,6 +9,7 @@
 #include <MicroOcpp/Core/Memory.h>
 #include <MicroOcpp/Core/Time.h>
 #include <MicroOcpp/Operations/CiStrings.h>
+#include <MicroOcpp/Model/Metering/MeterStore.h>
 
 namespace MicroOcpp {
 
@@ -25,12 +26,12 @@ class StopTransaction : public Operation, public MemoryManaged {
 private:
     Model& model;
     std::shared_ptr<Transaction> transaction;
-    Vector<std::unique_ptr<MeterValue>> transactionData;
+    StopTxData transactionData;
 public:
 
     StopTransaction(Model& model, std::shared_ptr<Transaction> transaction);
 
-    StopTransaction(Model& model, std::shared_ptr<Transaction> transaction, Vector<std::unique_ptr<MicroOcpp::MeterValue>> transactionData);
+    StopTransaction(Model& model, std::shared_ptr<Transaction> transaction, StopTxData transactionData);
 
     const char* getOperationType() override;
 
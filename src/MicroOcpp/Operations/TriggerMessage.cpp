@@ -33,12 +33,14 @@ void TriggerMessage::processReq(JsonObject payload) {
     if (!strcmp(requestedMessage, "MeterValues")) {
         if (auto mService = context.getModel().getMeteringService()) {
             if (connectorId < 0) {
-                auto nConnectors = mService->getNumConnectors();
-                for (decltype(nConnectors) cId = 0; cId < nConnectors; cId++) {
-                    if (auto meterValues = mService->takeTriggeredMeterValues(cId)) {
-                        context.getRequestQueue().sendRequestPreBoot(std::move(meterValues));
-                        statusMessage = "Accepted";
-                    }
+                //create the MeterValues connector by connector when the queue has capacity
+                auto& context = this->context;
+                if (mService->getNumConnectors() > 0 &&
+                        context.getRequestQueue().sendFanoutPreBoot("MeterValues", (unsigned int)mService->getNumConnectors(), [&context] (unsigned int cId) -> std::unique_ptr<Request> {
+                            auto mService = context.getModel().getMeteringService();
+                            return mService ? mService->takeTriggeredMeterValues((int)cId) : nullptr;
+                        })) {
+                    statusMessage = "Accepted";
                 }
             } else if (connectorId < mService->getNumConnectors()) {
                 if (auto meterValues = mService->takeTriggeredMeterValues(connectorId)) {
@@ -60,11 +62,22 @@ void TriggerMessage::processReq(JsonObject payload) {
             errorCode = "PropertyConstraintViolation";
         }
 
-        for (auto i = cIdRangeBegin; i < cIdRangeEnd; i++) {
-            auto connector = context.getModel().getConnector(i);
-            if (connector->triggerStatusNotification()) {
+        if (cIdRangeEnd - cIdRangeBegin > 1) {
+            //create the StatusNotifications connector by connector when the queue has capacity
+            auto& context = this->context;
+            if (context.getRequestQueue().sendFanoutPreBoot("StatusNotification", cIdRangeEnd, [&context] (unsigned int cId) -> std::unique_ptr<Request> {
+                        auto connector = context.getModel().getConnector(cId);
+                        return connector ? connector->createTriggeredStatusNotification() : nullptr;
+                    })) {
                 statusMessage = "Accepted";
             }
+        } else {
+            for (auto i = cIdRangeBegin; i < cIdRangeEnd; i++) {
+                auto connector = context.getModel().getConnector(i);
+                if (connector->triggerStatusNotification()) {
+                    statusMessage = "Accepted";
+                }
+            }
         }
     } else {
         auto msg = context.getOperationRegistry().deserializeOperation(requestedMessage);
@@ -7,6 +7,10 @@
 
 #include <MicroOcpp/Model/Certificates/Certificate_c.h>
 #include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Request.h>
+#include <MicroOcpp/Core/OperationRegistry.h>
+#include <MicroOcpp/Operations/RawOperation.h>
 
 #include <MicroOcpp/Platform.h>
 #include <MicroOcpp/Debug.h>
@@ -392,3 +396,41 @@ void ocpp_startTransaction(const char *idTag, OnMessage onConfirmation, OnAbort
 void ocpp_stopTransaction(OnMessage onConfirmation, OnAbort onAbort, OnTimeout onTimeout, OnCallError onError) {
     stopTransaction(adaptFn(onConfirmation), adaptFn(onAbort), adaptFn(onTimeout), adaptFn(onError));
 }
+
+void ocpp_sendRequestRaw(const char *operationType, OCPP_WritePayload writeReq, OCPP_ReadPayload onConfirmation, void (*onAbort)(void *user_data), void *user_data) {
+    auto context = getOcppContext();
+    if (!context) {
+        MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
+        return;
+    }
+    if (!operationType || !writeReq) {
+        MO_DBG_ERR("invalid args");
+        return;
+    }
+
+    auto request = MicroOcpp::makeRequest(new MicroOcpp::RawOperation(operationType, writeReq, onConfirmation, user_data));
+    if (onAbort) {
+        request->setOnAbortListener([onAbort, user_data] () {
+            onAbort(user_data);
+        });
+    }
+    context->initiateRequest(std::move(request));
+}
+
+void ocpp_setRequestHandlerRaw(const char *operationType, OCPP_ReadPayload onRequest, OCPP_WritePayload writeConf, void *user_data) {
+    auto context = getOcppContext();
+    if (!context) {
+        MO_DBG_ERR("OCPP uninitialized"); //need to call mocpp_initialize before
+        return;
+    }
+    if (!operationType || !onRequest || !writeConf) {
+        MO_DBG_ERR("invalid args");
+        return;
+    }
+
+    auto captureOpType = MicroOcpp::makeString("MicroOcpp_c.cpp", operationType);
+
+    context->getOperationRegistry().registerOperation(operationType, [captureOpType, onRequest, writeConf, user_data] () {
+        return new MicroOcpp::RawOperation(captureOpType.c_str(), onRequest, writeConf, user_data);
+    });
+}
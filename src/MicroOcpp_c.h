@@ -198,6 +198,27 @@ void ocpp_startTransaction(const char *idTag, OnMessage onConfirmation, OnAbort
 
 void ocpp_stopTransaction(OnMessage onConfirmation, OnAbort onAbort, OnTimeout onTimeout, OnCallError onError);
 
+/*
+ * Zero-copy custom operations. The payloads are exchanged as JSON text without intermediate JSON
+ * documents and without the receive buffer of the callbacks above:
+ *
+ * - Received payloads are slices of the received OCPP-J frame. They are not null-terminated and only
+ *   valid during the callback
+ * - Outgoing payloads are written directly into the send buffer. The writer gets a buffer of `size`
+ *   bytes and returns the payload length like snprintf, i.e. if the return value is >= size, the
+ *   writer will be called again with a buffer of sufficient size. The buffer is never null. Return -1
+ *   on failure
+ *
+ * onAbort is optional and is called when the request times out or the server responds with a CallError.
+ * Incoming requests for which writeConf fails are answered with a CallError
+ */
+typedef int  (*OCPP_WritePayload) (char *buf, size_t size, void *user_data);
+typedef void (*OCPP_ReadPayload)  (const char *payload, size_t len, void *user_data);
+
+void ocpp_sendRequestRaw(const char *operationType, OCPP_WritePayload writeReq, OCPP_ReadPayload onConfirmation, void (*onAbort)(void *user_data), void *user_data);
+
+void ocpp_setRequestHandlerRaw(const char *operationType, OCPP_ReadPayload onRequest, OCPP_WritePayload writeConf, void *user_data);
+
 #ifdef __cplusplus
 }
 #endif
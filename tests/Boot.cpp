@@ -9,15 +9,21 @@
 #include <MicroOcpp/Core/Configuration.h>
 #include <MicroOcpp/Core/Request.h>
 #include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Core/FilesystemSnapshot.h>
+#include <MicroOcpp/Core/LinkMonitor.h>
 #include <MicroOcpp/Operations/BootNotification.h>
 #include <MicroOcpp/Operations/StatusNotification.h>
 #include <MicroOcpp/Operations/CustomOperation.h>
 #include <MicroOcpp/Model/Boot/BootService.h>
+#include <MicroOcpp/Model/Heartbeat/HeartbeatService.h>
 #include <MicroOcpp/Model/Transactions/TransactionStore.h>
 #include <MicroOcpp/Debug.h>
 #include <catch2/catch.hpp>
 #include "./helpers/testHelper.h"
 
+#include <algorithm>
+#include <vector>
+
 #define CHARGEPOINTMODEL "Test model"
 #define CHARGEPOINTVENDOR "Test vendor"
 
@@ -44,6 +50,40 @@ public:
     std::unique_ptr<JsonDoc> createConf() override {return createEmptyDocument();}
 };
 
+//counts the accesses to the underlying filesystem
+class CountingFilesystemAdapter : public FilesystemAdapter {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+public:
+    size_t nStat = 0;
+    size_t nOpenRead = 0;
+    bool failRemove = false;
+    bool failOpenWrite = false;
+
+    CountingFilesystemAdapter(std::shared_ptr<FilesystemAdapter> filesystem) : filesystem(filesystem) { }
+
+    int stat(const char *path, size_t *size) override {
+        nStat++;
+        return filesystem->stat(path, size);
+    }
+    std::unique_ptr<FileAdapter> open(const char *fn, const char *mode) override {
+        if (!strcmp(mode, "r")) {
+            nOpenRead++;
+        } else if (failOpenWrite) {
+            return nullptr;
+        }
+        return filesystem->open(fn, mode);
+    }
+    bool remove(const char *fn) override {
+        if (failRemove) {
+            return false;
+        }
+        return filesystem->remove(fn);
+    }
+    int ftw_root(std::function<int(const char *fpath)> fn) override {
+        return filesystem->ftw_root(fn);
+    }
+};
 
 TEST_CASE( "Boot Behavior" ) {
     printf("\nRun %s\n",  "Boot Behavior");
@@ -89,6 +129,43 @@ TEST_CASE( "Boot Behavior" ) {
         REQUIRE(getOcppContext()->getModel().getClock().now() >= MIN_TIME);
     }
 
+    SECTION("BootNotification - bounded backoff") {
+
+        //the server fails all BootNotifications
+        std::vector<unsigned long> attemptTimes;
+
+        getOcppContext()->getOperationRegistry().registerOperation("BootNotification",
+            [&attemptTimes] () {
+                return new Ocpp16::CustomOperation("BootNotification",
+                    [&attemptTimes] (JsonObject) {
+                        //process req
+                        attemptTimes.push_back(mocpp_tick_ms());
+                    },
+                    [] () {
+                        //create conf
+                        return createEmptyDocument();
+                    },
+                    [] () {
+                        //error code
+                        return "InternalError";
+                    });
+            });
+
+        const size_t nAttempts = 16;
+        for (unsigned int i = 0; i < 2000 && attemptTimes.size() < nAttempts; i++) {
+            loop();
+        }
+        REQUIRE( attemptTimes.size() == nAttempts );
+
+        unsigned long maxDelay = 0;
+        for (size_t i = 1; i < attemptTimes.size(); i++) {
+            maxDelay = std::max(maxDelay, attemptTimes[i] - attemptTimes[i - 1]);
+        }
+
+        REQUIRE( maxDelay > MO_BOOT_INTERVAL_DEFAULT * 1000UL ); //backs off
+        REQUIRE( maxDelay <= MO_BOOT_BACKOFF_MAX * 1000UL + 100UL ); //bounded, plus the time step of loop()
+    }
+
     SECTION("BootNotification - Pending") {
 
         MO_DBG_INFO("Queue messages before BootNotification to see if they come through");
@@ -227,6 +304,70 @@ TEST_CASE( "Boot Behavior" ) {
         REQUIRE( checkProcessedHeartbeat );
     }
 
+    SECTION("Heartbeat deferred on traffic") {
+
+        loop(); //BootNotification
+
+        declareConfiguration<int>("HeartbeatInterval", 86400)->setInt(10);
+        auto deferOnTraffic = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "HeartbeatDeferOnTraffic", false);
+
+        unsigned int nHeartbeats = 0;
+        getOcppContext()->getOperationRegistry().setOnRequest("Heartbeat",
+            [&nHeartbeats] (JsonObject) {
+                nHeartbeats++;
+            });
+
+        auto sendDataTransfer = [] () {
+            getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation(
+                    "DataTransfer",
+                    [] () {
+                        //create req
+                        auto doc = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                        (*doc)["vendorId"] = "MicroOcpp";
+                        return doc;},
+                    [] (JsonObject) { })));
+        };
+
+        //Heartbeat every interval regardless of traffic
+        for (unsigned int i = 0; i < 20; i++) {
+            sendDataTransfer();
+            loop();
+        }
+        REQUIRE( nHeartbeats >= 5 );
+
+        //traffic every 3 s proves liveness
+        deferOnTraffic->setBool(true);
+        nHeartbeats = 0;
+        for (unsigned int i = 0; i < 20; i++) {
+            sendDataTransfer();
+            loop();
+        }
+        REQUIRE( nHeartbeats == 0 );
+
+        //link silent for the interval
+        for (unsigned int i = 0; i < 4; i++) {
+            loop();
+        }
+        REQUIRE( nHeartbeats == 1 );
+
+        //Clock needs resync - Heartbeat regardless of traffic
+        const uint64_t resyncMs = (uint64_t) MO_HEARTBEAT_RESYNC_MAX_ERROR * 1000000ULL / MO_HEARTBEAT_RESYNC_DRIFT_PPM;
+        LinkMonitor linkMonitor;
+        linkMonitor.onRequestReceived(19000);
+        HeartbeatSchedule schedule {10000};
+        REQUIRE( !schedule.isDue(19000, 10000, true, linkMonitor, 9000) );
+        REQUIRE( !schedule.isDue(20000, 10000, true, linkMonitor, 10000) );
+        REQUIRE( schedule.isDue(20000, 10000, true, linkMonitor, resyncMs) );
+        REQUIRE( schedule.isDue(20000, 10000, false, linkMonitor, 10000) );
+
+        //the residual drift of the compensated Clock replaces the default assumption
+        REQUIRE( !schedule.isDue(20000, 10000, true, linkMonitor, resyncMs, MO_HEARTBEAT_RESYNC_DRIFT_PPM / 10) );
+        REQUIRE( schedule.isDue(20000, 10000, true, linkMonitor, resyncMs * 10, MO_HEARTBEAT_RESYNC_DRIFT_PPM / 10) );
+        REQUIRE( schedule.isDue(20000, 10000, true, linkMonitor, resyncMs, -1) );
+
+        deferOnTraffic->setBool(false);
+    }
+
     SECTION("PreBoot transactions") {
         declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "PreBootTransactions", true)->setBool(true);
         declareConfiguration<bool>("AllowOfflineTxForUnknownId", true)->setBool(true);
@@ -426,6 +567,184 @@ TEST_CASE( "Boot Behavior" ) {
         REQUIRE( !strcmp(declareConfiguration<const char*>("neverDeclaredInsideMO", "newVal")->getString(), "newVal") ); //config has been removed
     }
 
+#if MO_ENABLE_SNAPSHOT
+    SECTION("Warm boot") {
+
+        //populate the store: configuration, transaction and local state
+        loop();
+        beginTransaction_authorized("mIdTag");
+        loop();
+        REQUIRE( getChargePointStatus() == ChargePointStatus_Charging );
+
+        declareConfiguration<const char*>("keepConfigOverWarmBoot", "originalVal");
+        configuration_save();
+
+        mocpp_deinitialize();
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 ); //not taken while a tx is running
+
+        //reference: boot with the per-file loaders
+        auto coldFs = std::make_shared<CountingFilesystemAdapter>(filesystem);
+        mocpp_initialize(loopback, ChargerCredentials(), coldFs);
+        auto coldStat = coldFs->nStat;
+        auto coldOpenRead = coldFs->nOpenRead;
+        mocpp_deinitialize();
+
+        REQUIRE( decorateSnapshot(filesystem)->storeSnapshot() );
+
+        //boot from the snapshot
+        auto warmFs = std::make_shared<CountingFilesystemAdapter>(filesystem);
+        mocpp_initialize(loopback, ChargerCredentials(), warmFs);
+
+        REQUIRE( warmFs->nOpenRead < coldOpenRead );
+        REQUIRE( warmFs->nStat < coldStat );
+
+        //the bootstats have been updated, but they aren't part of the snapshot
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+
+        loop();
+
+        //restored state equals the per-file state
+        REQUIRE( getChargePointStatus() == ChargePointStatus_Charging );
+        REQUIRE( getTransaction() != nullptr );
+        REQUIRE( !strcmp(getTransactionIdTag(), "mIdTag") );
+        REQUIRE( !strcmp(declareConfiguration<const char*>("keepConfigOverWarmBoot", "otherVal")->getString(), "originalVal") );
+
+        //modification invalidates the snapshot on flash before it's written
+        endTransaction();
+        loop();
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 );
+
+        //no tx running, so deinitialization renews the snapshot and the next boot is warm again
+        mocpp_deinitialize();
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+
+        warmFs = std::make_shared<CountingFilesystemAdapter>(filesystem);
+        mocpp_initialize(loopback, ChargerCredentials(), warmFs);
+        REQUIRE( warmFs->nOpenRead < coldOpenRead );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+
+        loop();
+        REQUIRE( getChargePointStatus() == ChargePointStatus_Available );
+        REQUIRE( !strcmp(declareConfiguration<const char*>("keepConfigOverWarmBoot", "otherVal")->getString(), "originalVal") );
+
+        mocpp_deinitialize();
+
+        //stale or corrupt snapshot falls back to the per-file loaders
+        auto file = filesystem->open(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, "w");
+        file->write("MOSS corrupt snapshot with invalid CRC", sizeof("MOSS corrupt snapshot with invalid CRC") - 1);
+        file.reset();
+
+        mocpp_initialize(loopback, ChargerCredentials(), filesystem);
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 ); //discarded
+        loop();
+
+        REQUIRE( getChargePointStatus() == ChargePointStatus_Available );
+        REQUIRE( !strcmp(declareConfiguration<const char*>("keepConfigOverWarmBoot", "otherVal")->getString(), "originalVal") );
+    }
+
+    SECTION("Snapshot invalidation fails") {
+
+        loop();
+        mocpp_deinitialize(); //stores the snapshot
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+
+        auto failingFs = std::make_shared<CountingFilesystemAdapter>(filesystem);
+        failingFs->failRemove = true;
+        auto fsSnapshot = decorateSnapshot(failingFs);
+        REQUIRE( fsSnapshot->isSnapshotValid() );
+
+        //the snapshot file can't be removed, so it's truncated before the write is passed through
+        auto file = fsSnapshot->open(MO_FILENAME_PREFIX "snapshot-test.jsn", "w");
+        REQUIRE( file );
+        REQUIRE( file->write("{}", 2) == 2 );
+        file.reset();
+        REQUIRE( !fsSnapshot->isSnapshotValid() );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+        REQUIRE( msize == 0 );
+        REQUIRE( !decorateSnapshot(failingFs)->isSnapshotValid() ); //the next boot doesn't roll back the write
+
+        //neither remove nor truncate work, so the modifications are refused
+        REQUIRE( fsSnapshot->storeSnapshot() );
+        failingFs->failOpenWrite = true;
+        REQUIRE( fsSnapshot->open(MO_FILENAME_PREFIX "snapshot-test.jsn", "w") == nullptr );
+        REQUIRE( !fsSnapshot->remove(MO_FILENAME_PREFIX "snapshot-test.jsn") );
+        REQUIRE( fsSnapshot->isSnapshotValid() );
+
+        failingFs->failRemove = false;
+        failingFs->failOpenWrite = false;
+        REQUIRE( fsSnapshot->remove(MO_FILENAME_PREFIX "snapshot-test.jsn") );
+        REQUIRE( !fsSnapshot->isSnapshotValid() );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "snapshot-test.jsn", &msize) != 0 );
+
+        mocpp_initialize(loopback, ChargerCredentials(), filesystem);
+    }
+
+    SECTION("Stepwise snapshot store") {
+
+        loop();
+        mocpp_deinitialize();
+
+        size_t msize = 0;
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+        REQUIRE( filesystem->remove(MO_FILENAME_PREFIX MO_SNAPSHOT_FN) );
+
+        auto fsSnapshot = decorateSnapshot(filesystem);
+        REQUIRE( !fsSnapshot->isSnapshotValid() );
+
+        size_t nfiles = 0;
+        fsSnapshot->ftw_root([&nfiles] (const char *fname) {
+            if (strcmp(fname, "bootstats.jsn")) {
+                nfiles++; //the bootstats aren't part of the snapshot
+            }
+            return 0;
+        });
+        REQUIRE( nfiles >= 2 );
+
+        //one step per file and a final step for the trailer
+        REQUIRE( fsSnapshot->beginStore() );
+        REQUIRE( fsSnapshot->isStorePending() );
+        size_t nsteps = 0;
+        while (fsSnapshot->storeStep() == TaskStatus::Pending) {
+            REQUIRE( !fsSnapshot->isSnapshotValid() );
+            nsteps++;
+        }
+        REQUIRE( nsteps == nfiles );
+        REQUIRE( fsSnapshot->isSnapshotValid() );
+        REQUIRE( !fsSnapshot->isStorePending() );
+        REQUIRE( decorateSnapshot(filesystem)->isSnapshotValid() );
+
+        //a modification between the steps aborts the store
+        auto file = fsSnapshot->open(MO_FILENAME_PREFIX "snapshot-test.jsn", "w");
+        REQUIRE( file );
+        file.reset();
+        REQUIRE( fsSnapshot->beginStore() );
+        REQUIRE( fsSnapshot->storeStep() == TaskStatus::Pending );
+        REQUIRE( fsSnapshot->remove(MO_FILENAME_PREFIX "snapshot-test.jsn") );
+        REQUIRE( !fsSnapshot->isStorePending() );
+        REQUIRE( fsSnapshot->storeStep() == TaskStatus::Done );
+        REQUIRE( !fsSnapshot->isSnapshotValid() );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 );
+
+        //mocpp_loop renews the snapshot in the TaskQueue after MO_SNAPSHOT_DELAY
+        mocpp_initialize(loopback, ChargerCredentials(), filesystem);
+        loop();
+        declareConfiguration<const char*>("snapshotTestConfig", "val");
+        configuration_save();
+        loop();
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) != 0 );
+
+        mtime += MO_SNAPSHOT_DELAY * 1000;
+        loop();
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX MO_SNAPSHOT_FN, &msize) == 0 );
+        REQUIRE( decorateSnapshot(filesystem)->isSnapshotValid() );
+    }
+#endif //MO_ENABLE_SNAPSHOT
+
     SECTION("Boot with v201") {
 
         mocpp_deinitialize();
@@ -0,0 +1,178 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Memory.h>
+
+#if MO_ENABLE_BOOT_ARENA
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <catch2/catch.hpp>
+#include "./helpers/testHelper.h"
+
+using namespace MicroOcpp;
+
+namespace {
+
+struct Managed : public MemoryManaged {
+    char payload [40];
+    Managed() : MemoryManaged("UnitTests") { }
+};
+
+struct Transient : public TransientMemoryManaged {
+    char payload [40];
+    Transient() : TransientMemoryManaged("UnitTests") { }
+};
+
+} //namespace
+
+TEST_CASE( "Boot arena" ) {
+    printf("\nRun %s\n",  "Boot arena");
+
+    //all objects of the previous tests have been freed
+    REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+
+    mo_mem_set_boot_arena_size(256);
+    mo_mem_boot_arena_open();
+    REQUIRE( mo_mem_get_boot_arena_capacity() == 256 );
+    REQUIRE( mo_mem_get_boot_arena_used() == 0 );
+
+    SECTION("Fallback to the heap when exhausted") {
+        auto first = new Managed();
+        size_t blockSize = mo_mem_get_boot_arena_used();
+        REQUIRE( blockSize >= sizeof(Managed) );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 1 );
+
+        std::vector<Managed*> objs;
+        while (mo_mem_get_boot_arena_used() + blockSize <= 256) {
+            objs.push_back(new Managed());
+        }
+        size_t used = mo_mem_get_boot_arena_used();
+        size_t blocks = mo_mem_get_boot_arena_blocks();
+        REQUIRE( blocks == objs.size() + 1 );
+
+        //exhausted: the next object is taken from the heap
+        auto overflow = new Managed();
+        REQUIRE( overflow );
+        REQUIRE( mo_mem_get_boot_arena_used() == used );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == blocks );
+
+        delete overflow;
+        REQUIRE( mo_mem_get_boot_arena_blocks() == blocks );
+
+        for (auto obj : objs) {
+            delete obj;
+        }
+        delete first;
+        mo_mem_boot_arena_release();
+    }
+
+    SECTION("Free inside the arena") {
+        auto obj1 = new Managed();
+        auto obj2 = new Managed();
+        size_t used = mo_mem_get_boot_arena_used();
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 2 );
+
+        //the space stays taken, but the object count drops
+        delete obj1;
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 1 );
+        REQUIRE( mo_mem_get_boot_arena_used() == used );
+
+        mo_mem_boot_arena_freeze();
+
+        //frozen: new objects go to the heap
+        auto obj3 = new Managed();
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 1 );
+        REQUIRE( mo_mem_get_boot_arena_used() == used );
+        delete obj3;
+
+        delete obj2;
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 0 );
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 256 ); //not released yet
+
+        mo_mem_boot_arena_release();
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+    }
+
+    SECTION("Pending release after deinitialization") {
+        auto obj = new Managed();
+        mo_mem_boot_arena_freeze();
+
+        //the region outlives the release call until its last object is freed
+        mo_mem_boot_arena_release();
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 256 );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 1 );
+
+        delete obj;
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 0 );
+    }
+
+    SECTION("Reopen while the previous arena is in use") {
+        auto obj = new Managed();
+        mo_mem_boot_arena_freeze();
+        mo_mem_boot_arena_release();
+        size_t used = mo_mem_get_boot_arena_used();
+
+        //warns and keeps the old region. The objects of the new run go to the heap
+        mo_mem_set_boot_arena_size(512);
+        mo_mem_boot_arena_open();
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 256 );
+
+        auto obj2 = new Managed();
+        REQUIRE( mo_mem_get_boot_arena_used() == used );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 1 );
+        delete obj2;
+
+        delete obj;
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+    }
+
+    SECTION("Transient objects bypass the arena") {
+        auto obj = new Transient();
+        REQUIRE( mo_mem_get_boot_arena_used() == 0 );
+        REQUIRE( mo_mem_get_boot_arena_blocks() == 0 );
+        delete obj;
+
+        //e.g. the files which the loaders open during mocpp_initialize()
+        auto filesystem = makeMemoryFilesystemAdapter();
+        size_t used = mo_mem_get_boot_arena_used();
+        auto file = filesystem->open(MO_FILENAME_PREFIX "arena.jsn", "w");
+        REQUIRE( file );
+        REQUIRE( file->write("{}", 2) == 2 );
+        file.reset();
+        file = filesystem->open(MO_FILENAME_PREFIX "arena.jsn", "r");
+        REQUIRE( file );
+        REQUIRE( mo_mem_get_boot_arena_used() == used );
+        file.reset();
+        filesystem.reset();
+
+        mo_mem_boot_arena_release();
+    }
+
+    mo_mem_set_boot_arena_size(MO_BOOT_ARENA_SIZE);
+
+    SECTION("Lifecycle with mocpp_initialize") {
+        mo_mem_boot_arena_release();
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+
+        LoopbackConnection loopback;
+        mocpp_initialize(loopback, ChargerCredentials());
+
+        //the long-lived objects of the initialization are in the arena
+        REQUIRE( mo_mem_get_boot_arena_capacity() == MO_BOOT_ARENA_SIZE );
+        REQUIRE( mo_mem_get_boot_arena_blocks() > 0 );
+        size_t used = mo_mem_get_boot_arena_used();
+
+        mocpp_set_timer(custom_timer_cb);
+        loop();
+        REQUIRE( mo_mem_get_boot_arena_used() == used ); //frozen
+
+        mocpp_deinitialize();
+        REQUIRE( mo_mem_get_boot_arena_capacity() == 0 );
+    }
+}
+
+#endif //MO_ENABLE_BOOT_ARENA
@@ -1082,5 +1082,180 @@ TEST_CASE( "Charging sessions" ) {
         REQUIRE( checkProcessedStopTx );
     }
 
+    SECTION("Retry backoff") {
+
+        auto& retryPolicy = getOcppContext()->getModel().getRetryPolicy();
+
+        //CALLERROR classification
+        REQUIRE( classifyCallError("InternalError") == RetryDecision::Retry );
+        REQUIRE( classifyCallError("GenericError") == RetryDecision::Retry );
+        REQUIRE( classifyCallError("FormationViolation") == RetryDecision::GiveUp );
+        REQUIRE( classifyCallError("NotSupported") == RetryDecision::GiveUp );
+
+        //exponential backoff, capped at MO_RETRY_BACKOFF_MAX
+        retryPolicy.setJitter(0);
+        REQUIRE( retryPolicy.getRetryDelay(1, 60000, 0) == 60000 );
+        REQUIRE( retryPolicy.getRetryDelay(2, 60000, 0) == 120000 );
+        REQUIRE( retryPolicy.getRetryDelay(3, 60000, 0) == 240000 );
+        REQUIRE( retryPolicy.getRetryDelay(30, 60000, 0) == MO_RETRY_BACKOFF_MAX * 1000UL );
+
+        //jitter shortens the delay by up to MO_RETRY_JITTER percent. It is stable per message and differs between messages
+        retryPolicy.setJitter(MO_RETRY_JITTER);
+        bool spread = false;
+        for (uint32_t salt = 0; salt < 16; salt++) {
+            auto delay = retryPolicy.getRetryDelay(2, 60000, salt);
+            REQUIRE( delay <= 120000 );
+            REQUIRE( delay >= 120000 - 120000 / 100 * MO_RETRY_JITTER );
+            REQUIRE( delay == retryPolicy.getRetryDelay(2, 60000, salt) );
+            spread |= delay != retryPolicy.getRetryDelay(2, 60000, 0);
+        }
+        REQUIRE( spread );
+
+        declareConfiguration<int>("TransactionMessageAttempts", 0)->setInt(3);
+        declareConfiguration<int>("TransactionMessageRetryInterval", 0)->setInt(60);
+
+        unsigned int startTxAttempts = 0;
+        const char *startTxError = nullptr;
+        int retryAfter = -1;
+        unsigned int txId = 1000;
+
+        getOcppContext()->getOperationRegistry().registerOperation("StartTransaction", [&startTxAttempts, &startTxError, &retryAfter, &txId] () {
+            return new Ocpp16::CustomOperation("StartTransaction",
+                [&startTxAttempts] (JsonObject) {
+                    //receive req
+                    startTxAttempts++;
+                },
+                [&txId] () {
+                    //create conf
+                    auto doc = makeJsonDoc("UnitTests", JSON_OBJECT_SIZE(1) + JSON_OBJECT_SIZE(2));
+                    JsonObject payload = doc->to<JsonObject>();
+
+                    JsonObject idTagInfo = payload.createNestedObject("idTagInfo");
+                    idTagInfo["status"] = "Accepted";
+                    payload["transactionId"] = txId++;
+                    return doc;
+                },
+                [&startTxError] () {
+                    //ErrorCode for CALLERROR
+                    return startTxError;
+                },
+                nullptr,
+                [&retryAfter] () {
+                    //ErrorDetails for CALLERROR
+                    auto doc = makeJsonDoc("UnitTests", JSON_OBJECT_SIZE(1));
+                    JsonObject details = doc->to<JsonObject>();
+                    if (retryAfter > 0) {
+                        details["retryAfter"] = retryAfter;
+                    }
+                    return doc;
+                });});
+
+        /*
+         * - server rejects StartTx permanently: no retries
+         */
+        startTxError = "FormationViolation";
+
+        beginTransaction_authorized("mIdTag");
+        loop();
+        REQUIRE( startTxAttempts == 1 );
+
+        mtime += 3600 * 1000;
+        loop();
+        REQUIRE( startTxAttempts == 1 );
+        REQUIRE( !ocppPermitsCharge() );
+
+        endTransaction();
+        loop();
+
+        /*
+         * - transient server error with hinted backoff: retry after the hint instead of TransactionMessageRetryInterval
+         */
+        startTxAttempts = 0;
+        startTxError = "InternalError";
+        retryAfter = 3600;
+
+        beginTransaction_authorized("mIdTag");
+        loop();
+        REQUIRE( startTxAttempts == 1 );
+        REQUIRE( ocppPermitsCharge() );
+
+        mtime += 120 * 1000;
+        loop();
+        REQUIRE( startTxAttempts == 1 );
+
+        startTxError = nullptr;
+
+        mtime += 3600 * 1000;
+        loop();
+        REQUIRE( startTxAttempts == 2 );
+        REQUIRE( ocppPermitsCharge() );
+
+        /*
+         * - transient server error for StopTx: retry instead of discarding the StopTx
+         */
+        unsigned int stopTxAttempts = 0;
+
+        getOcppContext()->getOperationRegistry().registerOperation("StopTransaction", [&stopTxAttempts] () {
+            return new Ocpp16::CustomOperation("StopTransaction",
+                [&stopTxAttempts] (JsonObject) {
+                    //receive req
+                    stopTxAttempts++;
+                },
+                [] () {
+                    //create conf
+                    return createEmptyDocument();
+                },
+                [&stopTxAttempts] () {
+                    //ErrorCode for CALLERROR
+                    return stopTxAttempts <= 1 ? "InternalError" : (const char*)nullptr;
+                });});
+
+        endTransaction();
+        loop();
+        REQUIRE( stopTxAttempts == 1 );
+
+        mtime += 60 * 1000;
+        loop();
+        REQUIRE( stopTxAttempts == 2 );
+
+        mtime += 3600 * 1000;
+        loop();
+        REQUIRE( stopTxAttempts == 2 );
+    }
+
+    SECTION("Heap usage of a full charging session") {
+
+        MO_MEM_RESET();
+
+        setEnergyMeterInput([] () {return 1000;});
+        setConnectorPluggedInput([] () {return true;});
+        loop();
+
+        beginTransaction("mIdTag");
+        loop();
+        REQUIRE( ocppPermitsCharge() );
+
+        for (int i = 0; i < 60; i++) {
+            mtime += 60 * 1000; //charge for 1h
+            loop();
+        }
+
+        endTransaction();
+        setConnectorPluggedInput([] () {return false;});
+        loop();
+        REQUIRE( !ocppPermitsCharge() );
+
+        MO_MEM_PRINT_STATS();
+
+#if MO_OVERRIDE_ALLOCATION && MO_ENABLE_HEAP_PROFILER
+        //peaks measured on the 64 bit host when running the whole test case (see docs/benchmarks.md) plus a margin of 25 %
+        REQUIRE( mo_mem_get_total_max() <= 41372 * 5 / 4 );
+        REQUIRE( mo_mem_get_maximum_heap_by_tag("Request.") <= 3920 * 5 / 4 );
+        REQUIRE( mo_mem_get_maximum_heap_by_tag("v16.Transactions.") <= 3844 * 5 / 4 );
+        REQUIRE( mo_mem_get_maximum_heap_by_tag("v16.Metering.") <= 4624 * 5 / 4 );
+        REQUIRE( mo_mem_get_maximum_heap_by_tag("v16.Authorization.") <= 176 * 5 / 4 );
+#endif
+    }
+
     mocpp_deinitialize();
 }
@@ -0,0 +1,85 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <catch2/catch.hpp>
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace MicroOcpp;
+
+/*
+ * Common behavior of the FilesystemAdapters. Runs against the adapter of the build configuration, i.e. the
+ * in-memory filesystem by default and the POSIX adapter with the CMake flag MO_BUILD_UNIT_POSIX_FS
+ */
+TEST_CASE( "Filesystem adapter" ) {
+    printf("\nRun %s\n",  "Filesystem adapter");
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    REQUIRE( filesystem );
+
+    //other tests may have left files in the root folder. Start without the files of this test
+    filesystem->remove(MO_FILENAME_PREFIX "fs-test-a.jsn");
+    filesystem->remove(MO_FILENAME_PREFIX "fs-test-b.jsn");
+
+    size_t size = 0;
+    REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "fs-test-a.jsn", &size) != 0 );
+    REQUIRE( filesystem->open(MO_FILENAME_PREFIX "fs-test-a.jsn", "r") == nullptr );
+
+    auto file = filesystem->open(MO_FILENAME_PREFIX "fs-test-a.jsn", "w");
+    REQUIRE( file );
+    REQUIRE( file->write("hello", 5) == 5 );
+    file.reset();
+
+    file = filesystem->open(MO_FILENAME_PREFIX "fs-test-a.jsn", "a");
+    REQUIRE( file );
+    REQUIRE( file->write(" world", 6) == 6 );
+    file.reset();
+
+    REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "fs-test-a.jsn", &size) == 0 );
+    REQUIRE( size == 11 );
+
+    char buf [16] = {'\0'};
+    file = filesystem->open(MO_FILENAME_PREFIX "fs-test-a.jsn", "r");
+    REQUIRE( file );
+    REQUIRE( file->read(buf, sizeof(buf)) == 11 );
+    REQUIRE( !strcmp(buf, "hello world") );
+    REQUIRE( file->read() == -1 );
+    REQUIRE( file->seek(6) == 0 );
+    REQUIRE( file->read() == 'w' );
+    file.reset();
+
+    //rewrite truncates
+    file = filesystem->open(MO_FILENAME_PREFIX "fs-test-a.jsn", "w");
+    REQUIRE( file->write("abc", 3) == 3 );
+    file.reset();
+    REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "fs-test-a.jsn", &size) == 0 );
+    REQUIRE( size == 3 );
+
+    file = filesystem->open(MO_FILENAME_PREFIX "fs-test-b.jsn", "w");
+    REQUIRE( file->write("{}", 2) == 2 );
+    file.reset();
+
+    std::vector<std::string> fnames;
+    REQUIRE( filesystem->ftw_root([&fnames] (const char *fname) {
+        fnames.push_back(fname);
+        return 0;
+    }) == 0 );
+    REQUIRE( std::count(fnames.begin(), fnames.end(), "fs-test-a.jsn") == 1 );
+    REQUIRE( std::count(fnames.begin(), fnames.end(), "fs-test-b.jsn") == 1 );
+
+    //remove during enumeration
+    REQUIRE( filesystem->ftw_root([&filesystem] (const char *fname) {
+        if (!strncmp(fname, "fs-test-", strlen("fs-test-"))) {
+            return filesystem->remove((std::string(MO_FILENAME_PREFIX) + fname).c_str()) ? 0 : -1;
+        }
+        return 0;
+    }) == 0 );
+    REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "fs-test-a.jsn", &size) != 0 );
+    REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "fs-test-b.jsn", &size) != 0 );
+    REQUIRE( !filesystem->remove(MO_FILENAME_PREFIX "fs-test-a.jsn") );
+}
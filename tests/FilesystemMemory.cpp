@@ -0,0 +1,148 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <catch2/catch.hpp>
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace MicroOcpp;
+
+TEST_CASE( "FilesystemMemory" ) {
+    printf("\nRun %s\n",  "FilesystemMemory");
+
+    auto writeFile = [] (FilesystemAdapter& filesystem, const char *path, size_t size) {
+        std::vector<char> content (size, 'x');
+        auto file = filesystem.open(path, "w");
+        REQUIRE( file );
+        return file->write(content.data(), content.size());
+    };
+
+    SECTION("File operations") {
+        auto filesystem = makeMemoryFilesystemAdapter();
+
+        size_t size = 0;
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "a.jsn", &size) != 0 );
+        REQUIRE( filesystem->open(MO_FILENAME_PREFIX "a.jsn", "r") == nullptr );
+
+        auto file = filesystem->open(MO_FILENAME_PREFIX "a.jsn", "w");
+        REQUIRE( file );
+        REQUIRE( file->write("hello", 5) == 5 );
+        file.reset();
+
+        file = filesystem->open(MO_FILENAME_PREFIX "a.jsn", "a");
+        REQUIRE( file->write(" world", 6) == 6 );
+        file.reset();
+
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "a.jsn", &size) == 0 );
+        REQUIRE( size == 11 );
+
+        char buf [16] = {'\0'};
+        file = filesystem->open(MO_FILENAME_PREFIX "a.jsn", "r");
+        REQUIRE( file->read(buf, sizeof(buf)) == 11 );
+        REQUIRE( !strcmp(buf, "hello world") );
+        REQUIRE( file->read() == -1 );
+        REQUIRE( file->seek(6) == 0 );
+        REQUIRE( file->read() == 'w' );
+
+        //rewriting doesn't affect the open reader
+        writeFile(*filesystem, MO_FILENAME_PREFIX "a.jsn", 3);
+        REQUIRE( file->read() == 'o' );
+        file.reset();
+
+        writeFile(*filesystem, MO_FILENAME_PREFIX "b.jsn", 3);
+        writeFile(*filesystem, MO_FILENAME_PREFIX "sub/c.jsn", 3); //not in the root folder
+
+        std::vector<std::string> fnames;
+        REQUIRE( filesystem->ftw_root([&fnames] (const char *fname) {
+            fnames.push_back(fname);
+            return 0;
+        }) == 0 );
+        REQUIRE( fnames == std::vector<std::string>({"a.jsn", "b.jsn"}) );
+
+        //remove during enumeration
+        REQUIRE( filesystem->ftw_root([&filesystem] (const char *fname) {
+            return filesystem->remove((std::string(MO_FILENAME_PREFIX) + fname).c_str()) ? 0 : -1;
+        }) == 0 );
+        REQUIRE( filesystem->stat(MO_FILENAME_PREFIX "a.jsn", &size) != 0 );
+        REQUIRE( !filesystem->remove(MO_FILENAME_PREFIX "a.jsn") );
+    }
+
+    SECTION("LittleFS model") {
+        auto model = FlashModel::littlefs();
+        auto filesystem = makeMemoryFilesystemAdapter(model);
+
+        //inline file: only a metadata commit
+        writeFile(*filesystem, MO_FILENAME_PREFIX "small.jsn", 100);
+        auto stats = filesystem->getStats();
+        REQUIRE( stats.bytesWritten == 100 );
+        REQUIRE( stats.bytesProgrammed == model.commitSize + 112 ); //padded to progSize
+        REQUIRE( stats.blocksErased == 0 );
+        REQUIRE( stats.fileWrites == 1 );
+        REQUIRE( filesystem->getUsed() == 0 );
+
+        //file in own blocks: erase before program
+        filesystem->resetStats();
+        writeFile(*filesystem, MO_FILENAME_PREFIX "large.bin", 5000);
+        stats = filesystem->getStats();
+        REQUIRE( stats.blocksErased == 2 );
+        REQUIRE( stats.bytesProgrammed == 5008 + model.commitSize );
+        REQUIRE( filesystem->getUsed() == 2 * model.blockSize );
+        REQUIRE( stats.simulatedUs == 2 * model.blockEraseUs + (20 + 1) * model.pageProgramUs );
+
+        //frequent rewrites of a small file fill the metadata block, which is compacted regularly
+        filesystem->resetStats();
+        for (int i = 0; i < 100; i++) {
+            writeFile(*filesystem, MO_FILENAME_PREFIX "small.jsn", 100);
+        }
+        stats = filesystem->getStats();
+        REQUIRE( stats.blocksErased >= 100 * (model.commitSize + 112) / model.blockSize );
+        REQUIRE( stats.getWriteAmplification() > 1. );
+        REQUIRE( filesystem->getFileStats().at("small.jsn").fileWrites == 100 );
+
+        //reads
+        filesystem->resetStats();
+        char buf [600];
+        auto file = filesystem->open(MO_FILENAME_PREFIX "large.bin", "r");
+        REQUIRE( file->read(buf, sizeof(buf)) == sizeof(buf) );
+        file.reset();
+        stats = filesystem->getStats();
+        REQUIRE( stats.bytesRead == sizeof(buf) );
+        REQUIRE( stats.simulatedUs == 3 * model.pageReadUs );
+        REQUIRE( stats.bytesProgrammed == 0 );
+    }
+
+    SECTION("SPIFFS model") {
+        auto model = FlashModel::spiffs();
+        auto filesystem = makeMemoryFilesystemAdapter(model);
+
+        writeFile(*filesystem, MO_FILENAME_PREFIX "a.jsn", 100);
+        auto stats = filesystem->getStats();
+        REQUIRE( stats.bytesProgrammed == 2 * model.pageSize ); //data page and index header page
+        REQUIRE( stats.blocksErased == 0 );
+
+        //garbage collection erases one block per blockSize / pageSize programmed pages
+        for (int i = 0; i < 7; i++) {
+            writeFile(*filesystem, MO_FILENAME_PREFIX "a.jsn", 100);
+        }
+        stats = filesystem->getStats();
+        REQUIRE( stats.pagesProgrammed == 16 );
+        REQUIRE( stats.blocksErased == 1 );
+    }
+
+    SECTION("Capacity") {
+        auto model = FlashModel::littlefs();
+        model.capacity = 2 * model.blockSize;
+        auto filesystem = makeMemoryFilesystemAdapter(model);
+
+        REQUIRE( writeFile(*filesystem, MO_FILENAME_PREFIX "a.bin", model.blockSize) == model.blockSize );
+        REQUIRE( writeFile(*filesystem, MO_FILENAME_PREFIX "b.bin", model.blockSize + 1) == 0 );
+        REQUIRE( writeFile(*filesystem, MO_FILENAME_PREFIX "b.bin", model.blockSize) == model.blockSize );
+
+        REQUIRE( filesystem->remove(MO_FILENAME_PREFIX "a.bin") );
+        REQUIRE( filesystem->getUsed() == model.blockSize );
+    }
+}
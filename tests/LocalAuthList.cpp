@@ -514,6 +514,88 @@ TEST_CASE( "LocalAuth" ) {
         REQUIRE( checkStartTx );
     }
 
+    SECTION("Speculative authorization") {
+
+        localAuthorizeOffline->setBool(false);
+        localPreAuthorize->setBool(false);
+        declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SpeculativeAuthorize", false)->setBool(true);
+
+        //set local list
+        StaticJsonDocument<256> localAuthList;
+        localAuthList[0]["idTag"] = "mIdTag";
+        localAuthList[0]["idTagInfo"]["status"] = "Accepted";
+        authService->updateLocalList(localAuthList.as<JsonArray>(), 1, false);
+
+        //count StartTransaction and StopTransaction
+        unsigned int nStartTx = 0, nStopTx = 0;
+        bool checkStopDeAuthorized = false;
+        getOcppContext()->getOperationRegistry().setOnRequest("StartTransaction", [&nStartTx] (JsonObject) {nStartTx++;});
+        getOcppContext()->getOperationRegistry().setOnRequest("StopTransaction", [&nStopTx, &checkStopDeAuthorized] (JsonObject payload) {
+            nStopTx++;
+            checkStopDeAuthorized = !strcmp(payload["reason"] | "_Undefined", "DeAuthorized") &&
+                    payload.containsKey("meterStop");
+        });
+
+        //begin transaction and delay Authorize request - tx should start immediately, but without StartTx
+        loopback.setOnline(false);
+
+        beginTransaction("mIdTag");
+        loop();
+
+        REQUIRE( connector->getStatus() == ChargePointStatus_Charging );
+        REQUIRE( ocppPermitsCharge() );
+
+        //Authorize accepted - send StartTx
+        loopback.setOnline(true);
+        loop();
+
+        REQUIRE( connector->getStatus() == ChargePointStatus_Charging );
+        REQUIRE( nStartTx == 1 );
+
+        endTransaction();
+        loop();
+        REQUIRE( nStopTx == 1 );
+
+        //patch Authorize so it will reject all idTags
+        getOcppContext()->getOperationRegistry().registerOperation("Authorize", [] () {
+            return new Ocpp16::CustomOperation("Authorize",
+                [] (JsonObject) {}, //ignore req
+                [] () {
+                    //create conf
+                    auto doc = makeJsonDoc("UnitTests", 2 * JSON_OBJECT_SIZE(1));
+                    auto payload = doc->to<JsonObject>();
+                    payload["idTagInfo"]["status"] = "Blocked";
+                    return doc;
+                });});
+
+        bool checkTxRejected = false;
+        setTxNotificationOutput([&checkTxRejected] (Transaction*, TxNotification txNotification) {
+            if (txNotification == TxNotification::AuthorizationRejected) {
+                checkTxRejected = true;
+            }
+        });
+
+        loopback.setOnline(false);
+
+        beginTransaction("mIdTag");
+        loop();
+
+        REQUIRE( connector->getStatus() == ChargePointStatus_Charging );
+
+        //Authorize rejected within the speculation window - stop tx and report the delivered energy with StartTx and StopTx
+        loopback.setOnline(true);
+        loop();
+
+        REQUIRE( !ocppPermitsCharge() );
+        REQUIRE( connector->getStatus() == ChargePointStatus_Available );
+        REQUIRE( checkTxRejected );
+        REQUIRE( nStartTx == 2 );
+        REQUIRE( nStopTx == 2 );
+        REQUIRE( checkStopDeAuthorized );
+
+        declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SpeculativeAuthorize", false)->setBool(false);
+    }
+
     SECTION("Update local list") {
 
         REQUIRE( authService->getLocalListSize() == 0 ); //idle, empty local list
@@ -638,6 +720,64 @@ TEST_CASE( "LocalAuth" ) {
         REQUIRE( auth1->getAuthorizationStatus() == AuthorizationStatus::Blocked );
     }
 
+    SECTION("Deferred update in steps") {
+
+        auto& taskQueue = getOcppContext()->getTaskQueue();
+        size_t listSize = (size_t) declareConfiguration<int>("LocalAuthListMaxLength", -1)->getInt();
+        REQUIRE( listSize > 2 * MO_LOCALAUTH_STEP_SIZE );
+
+        auto localAuthList = makeJsonDoc("UnitTests", 8192);
+
+        //Full update: the merge is a swap, the write is split
+        generateAuthList(localAuthList->to<JsonArray>(), listSize, false);
+        REQUIRE( authService->updateLocalListDeferred(localAuthList->as<JsonArray>(), 1, false) );
+        REQUIRE( authService->isStorePending() );
+
+        unsigned int steps = 0;
+        while (taskQueue.stepNext()) {
+            steps++;
+        }
+        REQUIRE( steps > listSize / MO_LOCALAUTH_STEP_SIZE );
+        REQUIRE( !authService->isStorePending() );
+        REQUIRE( !authService->isStoreFailed() );
+        REQUIRE( authService->getLocalListVersion() == 1 );
+        REQUIRE( authService->getLocalListSize() == listSize );
+
+        //Differential update which blocks all entries: the merge is split too
+        generateAuthList(localAuthList->to<JsonArray>(), listSize, false);
+        for (JsonObject entry : localAuthList->as<JsonArray>()) {
+            entry["idTagInfo"]["status"] = "Blocked";
+        }
+        REQUIRE( authService->updateLocalListDeferred(localAuthList->as<JsonArray>(), 2, true) );
+        localAuthList.reset(); //the payload is released after processReq
+
+        char lastIdTag [IDTAG_LEN_MAX + 1];
+        sprintf(lastIdTag, "mIdTag%zu", listSize - 1);
+
+        REQUIRE( taskQueue.stepNext() );
+        REQUIRE( authService->getLocalListVersion() == 1 ); //merge not complete yet
+        REQUIRE( authService->getLocalAuthorization("mIdTag0")->getAuthorizationStatus() == AuthorizationStatus::Blocked );
+        REQUIRE( authService->getLocalAuthorization(lastIdTag)->getAuthorizationStatus() == AuthorizationStatus::Accepted );
+
+        steps = 1;
+        while (taskQueue.stepNext()) {
+            steps++;
+        }
+        REQUIRE( steps > 2 * (listSize / MO_LOCALAUTH_STEP_SIZE) ); //merge and write
+        REQUIRE( !authService->isStoreFailed() );
+        REQUIRE( authService->getLocalListVersion() == 2 );
+        REQUIRE( authService->getLocalListSize() == listSize );
+
+        mocpp_deinitialize();
+
+        mocpp_initialize(loopback, ChargerCredentials("test-runner1234"));
+        authService = getOcppContext()->getModel().getAuthorizationService();
+
+        REQUIRE( authService->getLocalListVersion() == 2 );
+        REQUIRE( authService->getLocalListSize() == listSize );
+        REQUIRE( authService->getLocalAuthorization(lastIdTag)->getAuthorizationStatus() == AuthorizationStatus::Blocked );
+    }
+
     SECTION("SendLocalList") {
 
         int listVersion = 42;
@@ -687,6 +687,168 @@ TEST_CASE("Metering") {
         REQUIRE(attemptNr == 3);
     }
 
+    SECTION("High-rate aggregation") {
+
+        //1000W with a spike of 20000W for 300ms
+        unsigned long spikeBegin = 0;
+        addMeterValueInput([&spikeBegin] () -> float {
+            return spikeBegin && mtime - spikeBegin < 300 ? 20000.f : 1000.f;
+        }, "Power.Active.Import", "W");
+
+        auto MeterValuesSampledDataString = declareConfiguration<const char*>("MeterValuesSampledData","", CONFIGURATION_FN);
+        MeterValuesSampledDataString->setString("Power.Active.Import,Energy.Active.Import.Interval");
+
+        auto MeterValueSampleIntervalInt = declareConfiguration<int>("MeterValueSampleInterval",0, CONFIGURATION_FN);
+        MeterValueSampleIntervalInt->setInt(10);
+
+        auto aggregationRateInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "MeterAggregationRate", 0);
+        aggregationRateInt->setInt(10);
+        declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "MeterAggregationStatistic", "Mean")->setString("Max");
+
+        float reportedPower = -1.f, reportedEnergy = -1.f;
+
+        setOnReceiveRequest("MeterValues", [&reportedPower, &reportedEnergy] (JsonObject payload) {
+            for (JsonObject sv : payload["meterValue"][0]["sampledValue"].as<JsonArray>()) {
+                if (!strcmp(sv["measurand"] | "", "Power.Active.Import")) {
+                    reportedPower = atof(sv["value"] | "-1");
+                } else if (!strcmp(sv["measurand"] | "", "Energy.Active.Import.Interval")) {
+                    REQUIRE( !strcmp(sv["unit"] | "", "Wh") );
+                    reportedEnergy = atof(sv["value"] | "-1");
+                }
+            }
+        });
+
+        loop();
+
+        beginTransaction_authorized("mIdTag");
+
+        loop();
+
+        spikeBegin = mtime + 2000;
+
+        for (unsigned int i = 0; i < 3; i++) {
+            loop();
+        }
+
+        //the spike is between two samples, but the MeterValue reports its maximum
+        REQUIRE( reportedPower == Approx(20000.f) );
+
+        //1000W for 10s and the spike: 2.78Wh + 1.58Wh
+        REQUIRE( reportedEnergy == Approx(4.36f).margin(0.5f) );
+
+        endTransaction();
+        loop();
+
+        aggregationRateInt->setInt(0);
+        declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "MeterAggregationStatistic", "Mean")->setString("Mean");
+    }
+
+    SECTION("Aggregation only for sampled contexts") {
+
+        //1000W with a spike of 20000W for 300ms
+        unsigned long spikeBegin = 0;
+        addMeterValueInput([&spikeBegin] () -> float {
+            return spikeBegin && mtime - spikeBegin < 300 ? 20000.f : 1000.f;
+        }, "Power.Active.Import", "W");
+
+        declareConfiguration<const char*>("MeterValuesSampledData","", CONFIGURATION_FN)->setString("Power.Active.Import");
+        declareConfiguration<int>("MeterValueSampleInterval",0, CONFIGURATION_FN)->setInt(10);
+
+        auto aggregationRateInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "MeterAggregationRate", 0);
+        aggregationRateInt->setInt(10);
+        declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "MeterAggregationStatistic", "Mean")->setString("Max");
+
+        float periodicPower = -1.f, triggeredPower = -1.f;
+
+        setOnReceiveRequest("MeterValues", [&periodicPower, &triggeredPower] (JsonObject payload) {
+            if ((payload["connectorId"] | -1) != 1) {
+                return;
+            }
+            for (JsonObject sv : payload["meterValue"][0]["sampledValue"].as<JsonArray>()) {
+                if (!strcmp(sv["context"] | "Sample.Periodic", "Trigger")) {
+                    triggeredPower = atof(sv["value"] | "-1");
+                } else if (!strcmp(sv["context"] | "Sample.Periodic", "Sample.Periodic")) {
+                    periodicPower = atof(sv["value"] | "-1");
+                }
+            }
+        });
+
+        loop();
+
+        beginTransaction_authorized("mIdTag");
+
+        loop();
+
+        spikeBegin = mtime + 1000;
+        loop();
+
+        //the spike is over. A triggered MeterValue reports the instantaneous reading
+        loopback.sendTXT(TRIGGER_METERVALUES, sizeof(TRIGGER_METERVALUES) - 1);
+        loop();
+        REQUIRE( triggeredPower == Approx(1000.f) );
+
+        //the trigger doesn't start a new window for the periodic MeterValues
+        loop();
+        REQUIRE( periodicPower == Approx(20000.f) );
+
+        endTransaction();
+        loop();
+
+        aggregationRateInt->setInt(0);
+        declareConfiguration<const char*>(MO_CONFIG_EXT_PREFIX "MeterAggregationStatistic", "Mean")->setString("Mean");
+    }
+
+    SECTION("Energy interval only with aggregation") {
+
+        addMeterValueInput([] () -> float {
+            return 1000.f;
+        }, "Power.Active.Import", "W");
+
+        declareConfiguration<const char*>("MeterValuesSampledData","", CONFIGURATION_FN)->setString("Power.Active.Import,Energy.Active.Import.Interval");
+        declareConfiguration<int>("MeterValueSampleInterval",0, CONFIGURATION_FN)->setInt(10);
+
+        auto aggregationRateInt = declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "MeterAggregationRate", 0);
+        REQUIRE( aggregationRateInt->getInt() == 0 );
+
+        bool checkPower = false, checkEnergyInterval = false;
+
+        setOnReceiveRequest("MeterValues", [&checkPower, &checkEnergyInterval] (JsonObject payload) {
+            for (JsonObject sv : payload["meterValue"][0]["sampledValue"].as<JsonArray>()) {
+                if (!strcmp(sv["measurand"] | "", "Power.Active.Import")) {
+                    checkPower = true;
+                } else if (!strcmp(sv["measurand"] | "", "Energy.Active.Import.Interval")) {
+                    checkEnergyInterval = true;
+                }
+            }
+        });
+
+        loop();
+
+        beginTransaction_authorized("mIdTag");
+
+        for (unsigned int i = 0; i < 4; i++) {
+            loop();
+        }
+
+        //without aggregation, the measurand doesn't exist
+        REQUIRE( checkPower );
+        REQUIRE( !checkEnergyInterval );
+
+        //enabling the aggregation adds it
+        aggregationRateInt->setInt(10);
+
+        for (unsigned int i = 0; i < 4; i++) {
+            loop();
+        }
+
+        REQUIRE( checkEnergyInterval );
+
+        endTransaction();
+        loop();
+
+        aggregationRateInt->setInt(0);
+    }
+
     SECTION("TriggerMessage") {
         
         addMeterValueInput([] () {
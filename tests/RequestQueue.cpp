@@ -0,0 +1,600 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/Request.h>
+#include <MicroOcpp/Core/RequestQueue.h>
+#include <MicroOcpp/Core/JsonPool.h>
+#include <MicroOcpp/Core/OperationRegistry.h>
+#include <MicroOcpp/Operations/CustomOperation.h>
+#include <MicroOcpp_c.h>
+#include <catch2/catch.hpp>
+#include "./helpers/testHelper.h"
+
+#include <string>
+#include <vector>
+#include <algorithm>
+
+using namespace MicroOcpp;
+
+TEST_CASE( "Request queue" ) {
+    printf("\nRun %s\n",  "Request queue");
+
+    //initialize Context with dummy socket
+    LoopbackConnection loopback;
+    mocpp_initialize(loopback);
+
+    mocpp_set_timer(custom_timer_cb);
+
+    loop();
+
+    SECTION("JSON memory budget") {
+
+        auto& jsonPool = getOcppContext()->getRequestQueue().getJsonPool();
+
+        //BootNotification has been measured
+        REQUIRE( jsonPool.getPeak("BootNotification") > 0 );
+        REQUIRE( jsonPool.getEstimate("BootNotification") == jsonPool.getPeak("BootNotification") );
+        REQUIRE( jsonPool.getEstimate("DataTransfer") == MO_JSON_POOL_INITIAL_ESTIMATE );
+        REQUIRE( jsonPool.getUsage() == 0 );
+
+        bool checkProcessedReq = false;
+        bool checkProcessedConf = false;
+
+        getOcppContext()->getOperationRegistry().registerOperation("DataTransfer", [&checkProcessedReq] () {
+            return new Ocpp16::CustomOperation("DataTransfer",
+                [&checkProcessedReq] (JsonObject) {
+                    checkProcessedReq = true; //process req
+                },
+                [] () {
+                    //create conf
+                    auto conf = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                    (*conf)["status"] = "Accepted";
+                    return conf;
+                });
+        });
+
+        //occupy the budget, e.g. by a TX buffer of the Connection
+        const size_t occupied = 1000;
+        jsonPool.setBudget(occupied + MO_JSON_POOL_INITIAL_ESTIMATE / 2);
+        REQUIRE( jsonPool.reserve(occupied) );
+
+        getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation("DataTransfer",
+            [] () {
+                //create req
+                auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                (*req)["vendorId"] = "MicroOcpp";
+                return req;
+            },
+            [&checkProcessedConf] (JsonObject) {
+                checkProcessedConf = true; //process conf
+            })));
+
+        loop();
+
+        //request is deferred, not dropped
+        REQUIRE( !checkProcessedReq );
+        REQUIRE( jsonPool.getUsage() == occupied );
+
+        jsonPool.release(occupied);
+
+        loop();
+
+        REQUIRE( checkProcessedReq );
+        REQUIRE( checkProcessedConf );
+        REQUIRE( jsonPool.getUsage() == 0 );
+        REQUIRE( jsonPool.getPeak("DataTransfer") > 0 );
+        REQUIRE( jsonPool.getMaxUsage() >= occupied );
+
+        //a single message always passes, even if it exceeds the budget
+        jsonPool.setBudget(1);
+
+        checkProcessedReq = false;
+        getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation("DataTransfer",
+            [] () {
+                return makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+            },
+            [] (JsonObject) { })));
+
+        loop();
+
+        REQUIRE( checkProcessedReq );
+    }
+
+    SECTION("JSON budget of concurrent messages") {
+
+        auto& jsonPool = getOcppContext()->getRequestQueue().getJsonPool();
+        jsonPool.setBudget(MO_JSON_POOL_INITIAL_ESTIMATE + MO_JSON_POOL_INITIAL_ESTIMATE / 2);
+
+        bool confCreated = false;
+        getOcppContext()->getOperationRegistry().registerOperation("DataTransfer", [&confCreated] () {
+            return new Ocpp16::CustomOperation("DataTransfer",
+                [] (JsonObject) { }, //process req
+                [&confCreated] () {
+                    //create conf
+                    confCreated = true;
+                    auto conf = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                    (*conf)["status"] = "Accepted";
+                    return conf;
+                });
+        });
+
+        //first request is in flight and doesn't get a response
+        bool timedOut = false;
+        loopback.setLoss(100);
+        auto request = makeRequest(new Ocpp16::CustomOperation("DataTransfer",
+            [] () {
+                //create req
+                auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                (*req)["vendorId"] = "MicroOcpp";
+                return req;
+            },
+            [] (JsonObject) { }));
+        request->setTimeout(10000);
+        request->setOnTimeoutListener([&timedOut] () {
+            timedOut = true;
+        });
+        getOcppContext()->initiateRequest(std::move(request));
+
+        loop();
+        loopback.setLoss(0);
+
+        //the in-flight request keeps its reservation
+        REQUIRE( jsonPool.getUsage() == MO_JSON_POOL_INITIAL_ESTIMATE );
+
+        //second message: the conf to a request of the server would exceed the budget, so it's deferred
+        const char *call = "[2, \"msg-01\", \"DataTransfer\", {\"vendorId\":\"CSMS\"}]";
+        loopback.sendTXT(call, strlen(call));
+        loop();
+
+        REQUIRE( !confCreated );
+        REQUIRE( !timedOut );
+        REQUIRE( jsonPool.getUsage() == MO_JSON_POOL_INITIAL_ESTIMATE );
+
+        //the timeout releases the reservation of the first request, then the conf is sent
+        for (unsigned int i = 0; i < 3; i++) {
+            loop();
+        }
+
+        REQUIRE( timedOut );
+        REQUIRE( confCreated );
+        REQUIRE( jsonPool.getUsage() == 0 );
+    }
+
+    SECTION("Zero-copy operations") {
+
+        struct RawExchange {
+            std::string req, conf; //payloads as received by the callbacks
+            const char *reqSlice = nullptr;
+            size_t minWriterSize = (size_t)-1;
+            bool failConf = false;
+            bool aborted = false;
+        } exchange;
+
+        ocpp_setRequestHandlerRaw("DataTransfer",
+            [] (const char *payload, size_t len, void *user_data) {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                exchange->reqSlice = payload;
+                exchange->req.assign(payload, len);
+            },
+            [] (char *buf, size_t size, void *user_data) -> int {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                if (size < exchange->minWriterSize) {
+                    exchange->minWriterSize = size;
+                }
+                if (exchange->failConf) {
+                    return -1;
+                }
+                return snprintf(buf, size, "{\"status\":\"Accepted\",\"data\":\"%s\"}", "conf-data");
+            }, &exchange);
+
+        //the raw slice of the received frame is passed to the handler, including escaped brackets and quotes
+        const char *call = "[2, \"msg-01\", \"DataTransfer\", {\"vendorId\":\"MicroOcpp\",\"data\":\"a]}\\\"\"} ]";
+        loopback.sendTXT(call, strlen(call));
+        loop();
+
+        REQUIRE( exchange.req == "{\"vendorId\":\"MicroOcpp\",\"data\":\"a]}\\\"\"}" );
+        REQUIRE( exchange.reqSlice == strstr(call, "{") );
+        REQUIRE( exchange.minWriterSize > 0 ); //writer is never probed with an empty buffer
+
+        //round trip via the loopback: request and response are both written and read without JSON documents
+        exchange.req.clear();
+
+        ocpp_sendRequestRaw("DataTransfer",
+            [] (char *buf, size_t size, void *) -> int {
+                return snprintf(buf, size, "{\"vendorId\":\"MicroOcpp\",\"data\":\"%s\"}", "req-data");
+            },
+            [] (const char *payload, size_t len, void *user_data) {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                exchange->conf.assign(payload, len);
+            },
+            [] (void *user_data) {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                exchange->aborted = true;
+            }, &exchange);
+
+        loop();
+
+        REQUIRE( exchange.req == "{\"vendorId\":\"MicroOcpp\",\"data\":\"req-data\"}" );
+        REQUIRE( exchange.conf == "{\"status\":\"Accepted\",\"data\":\"conf-data\"}" );
+        REQUIRE( !exchange.aborted );
+
+        //payload larger than the initial buffer: writer is called again with the returned size
+        struct LargeWriter {
+            std::string data = std::string(1500, 'x');
+            unsigned int calls = 0;
+            size_t lastSize = 0;
+        } largeWriter;
+        exchange.req.clear();
+        exchange.conf.clear();
+
+        ocpp_sendRequestRaw("DataTransfer",
+            [] (char *buf, size_t size, void *user_data) -> int {
+                auto largeWriter = static_cast<LargeWriter*>(user_data);
+                largeWriter->calls++;
+                largeWriter->lastSize = size;
+                return snprintf(buf, size, "{\"vendorId\":\"MicroOcpp\",\"data\":\"%s\"}", largeWriter->data.c_str());
+            },
+            nullptr, nullptr, &largeWriter);
+
+        loop();
+
+        REQUIRE( largeWriter.calls == 2 );
+        REQUIRE( largeWriter.lastSize > largeWriter.data.length() );
+        REQUIRE( exchange.req == "{\"vendorId\":\"MicroOcpp\",\"data\":\"" + largeWriter.data + "\"}" );
+
+        //failing writer results in a CallError
+        exchange.failConf = true;
+        exchange.conf.clear();
+
+        ocpp_sendRequestRaw("DataTransfer",
+            [] (char *buf, size_t size, void *) -> int {
+                return snprintf(buf, size, "{\"vendorId\":\"MicroOcpp\"}");
+            },
+            [] (const char *payload, size_t len, void *user_data) {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                exchange->conf.assign(payload, len);
+            },
+            [] (void *user_data) {
+                auto exchange = static_cast<RawExchange*>(user_data);
+                exchange->aborted = true;
+            }, &exchange);
+
+        loop();
+
+        REQUIRE( exchange.conf.empty() );
+        REQUIRE( exchange.aborted );
+    }
+
+    SECTION("Priority classes") {
+
+        auto& scheduler = getOcppContext()->getRequestQueue().getScheduler();
+
+        REQUIRE( scheduler.getPriorityClass("Authorize") == PriorityClass::Interactive );
+        REQUIRE( scheduler.getPriorityClass("StartTransaction") == PriorityClass::Transactional );
+        REQUIRE( scheduler.getPriorityClass("MeterValues") == PriorityClass::Telemetry );
+        REQUIRE( scheduler.getPriorityClass("SecurityEventNotification") == PriorityClass::Bulk );
+        REQUIRE( scheduler.getPriorityClass("DataTransfer") == PriorityClass::Transactional ); //default
+
+        std::vector<std::string> sent;
+
+        auto sendCustom = [&sent] (const char *operationType) {
+            getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation(operationType,
+                [&sent, operationType] () {
+                    //create req
+                    sent.push_back(operationType);
+                    auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(0));
+                    req->to<JsonObject>();
+                    return req;
+                },
+                [] (JsonObject) { })));
+        };
+
+        //backlog from an offline period
+        loopback.setConnected(false);
+
+        sendCustom("Heartbeat");
+        sendCustom("SecurityEventNotification");
+        sendCustom("DataTransfer");
+        sendCustom("Heartbeat");
+        sendCustom("Authorize");
+
+        loopback.setConnected(true);
+        loop();
+
+        std::vector<std::string> expected = {"Authorize", "DataTransfer", "Heartbeat", "Heartbeat", "SecurityEventNotification"};
+        REQUIRE( sent == expected );
+
+        //starvation protection: Bulk request gets through even if Authorize requests keep arriving
+        sent.clear();
+        scheduler.setDeadline(PriorityClass::Bulk, 0); //disable deadline
+
+        loopback.setConnected(false);
+        sendCustom("SecurityEventNotification");
+        loopback.setConnected(true);
+
+        for (unsigned int i = 0; i < 40; i++) {
+            sendCustom("Authorize");
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( std::find(sent.begin(), sent.end(), "SecurityEventNotification") == sent.end() );
+
+        scheduler.setDeadline(PriorityClass::Bulk, 1000);
+
+        for (unsigned int i = 0; i < 4; i++) {
+            sendCustom("Authorize");
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( std::find(sent.begin(), sent.end(), "SecurityEventNotification") != sent.end() );
+
+        //configurable classes
+        scheduler.setPriorityClass("DataTransfer", PriorityClass::Interactive);
+        REQUIRE( scheduler.getPriorityClass("DataTransfer") == PriorityClass::Interactive );
+    }
+
+    SECTION("Telemetry backlog") {
+
+        setEnergyMeterInput([] () {return 1000;}); //creates the MeteringService, so register the server mocks afterwards
+        declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "MeterValuesInTxOnly", true)->setBool(false);
+
+        std::vector<std::string> received;
+
+        auto registerServer = [&received] (const char *operationType) {
+            getOcppContext()->getOperationRegistry().registerOperation(operationType, [&received, operationType] () {
+                return new Ocpp16::CustomOperation(operationType,
+                    [&received, operationType] (JsonObject) {
+                        //process req
+                        received.push_back(operationType);
+                    },
+                    [] () {
+                        //create conf
+                        auto conf = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(0));
+                        conf->to<JsonObject>();
+                        return conf;
+                    });
+            });
+        };
+        registerServer("MeterValues");
+        registerServer("Authorize");
+
+        declareConfiguration<int>("MeterValueSampleInterval", 0)->setInt(10);
+
+        //MeterValues pile up during an outage
+        loopback.setConnected(false);
+        for (unsigned int i = 0; i < 1200; i++) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        //slow link: each MeterValues takes 10 s, so the backlog is sent for longer than the Telemetry deadline
+        loopback.setLatency(5000);
+        loopback.setConnected(true);
+        for (unsigned int i = 0; i < 700; i++) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( received.size() >= 5 );
+        REQUIRE( std::find(received.begin(), received.end(), "Authorize") == received.end() );
+
+        //the MeterValues are older than the Telemetry deadline, but the Authorize goes first
+        declareConfiguration<int>("MeterValueSampleInterval", 0)->setInt(0);
+        received.clear();
+
+        getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation("Authorize",
+            [] () {
+                //create req
+                auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                (*req)["idTag"] = "mIdTag";
+                return req;
+            },
+            [] (JsonObject) { })));
+
+        for (unsigned int i = 0; i < 300; i++) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( !received.empty() );
+        auto authorize = std::find(received.begin(), received.end(), "Authorize");
+        REQUIRE( authorize != received.end() );
+        REQUIRE( authorize - received.begin() <= 1 ); //at most the MeterValues which was already in flight
+
+        declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "MeterValuesInTxOnly", true)->setBool(true);
+        loopback.setLatency(0);
+        loop();
+    }
+
+    SECTION("Fan-out") {
+
+        const unsigned int NUM_CONNECTORS = 24; //e.g. a cabinet with 24 connectors
+
+        auto& requestQueue = getOcppContext()->getRequestQueue();
+
+        std::vector<unsigned int> sentConnectorIds;
+        unsigned int produced = 0;
+        unsigned int otherSent = 0;
+
+        bool accepted = requestQueue.sendFanoutPreBoot("StatusNotification", NUM_CONNECTORS, [&sentConnectorIds, &produced] (unsigned int connectorId) {
+            produced++;
+            return makeRequest(new Ocpp16::CustomOperation("StatusNotification",
+                [&sentConnectorIds, connectorId] () {
+                    //create req
+                    sentConnectorIds.push_back(connectorId);
+                    auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(3));
+                    (*req)["connectorId"] = connectorId;
+                    (*req)["errorCode"] = "NoError";
+                    (*req)["status"] = "Available";
+                    return req;
+                },
+                [] (JsonObject) { }));
+        });
+
+        REQUIRE( accepted );
+
+        //requests are created lazily and leave room for other messages
+        REQUIRE( produced <= MO_REQUEST_CACHE_MAXSIZE / 2 );
+
+        for (unsigned int i = 0; i < MO_REQUEST_CACHE_MAXSIZE / 2; i++) {
+            requestQueue.sendRequestPreBoot(makeRequest(new Ocpp16::CustomOperation("DataTransfer",
+                [&otherSent] () {
+                    //create req
+                    otherSent++;
+                    auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                    (*req)["vendorId"] = "MicroOcpp";
+                    return req;
+                },
+                [] (JsonObject) { })));
+        }
+
+        loop();
+        loop();
+
+        //no message has been dropped and the connectors have been served in order
+        REQUIRE( produced == NUM_CONNECTORS );
+        REQUIRE( sentConnectorIds.size() == NUM_CONNECTORS );
+        for (unsigned int i = 0; i < NUM_CONNECTORS; i++) {
+            REQUIRE( sentConnectorIds[i] == i );
+        }
+        REQUIRE( otherSent == MO_REQUEST_CACHE_MAXSIZE / 2 );
+
+        //TriggerMessage without connectorId uses the fan-out
+        unsigned int triggeredCount = 0;
+        getOcppContext()->getOperationRegistry().setOnRequest("StatusNotification", [&triggeredCount] (JsonObject) {
+            triggeredCount++;
+        });
+
+        const char *triggerMessage = "[2,\"msg-01\",\"TriggerMessage\",{\"requestedMessage\":\"StatusNotification\"}]";
+        loopback.sendTXT(triggerMessage, strlen(triggerMessage));
+        loop();
+
+        REQUIRE( triggeredCount == getOcppContext()->getModel().getNumConnectors() );
+    }
+
+    SECTION("Link monitor") {
+
+        auto& linkMonitor = getOcppContext()->getRequestQueue().getLinkMonitor();
+
+        getOcppContext()->getOperationRegistry().registerOperation("DataTransfer", [] () {
+            return new Ocpp16::CustomOperation("DataTransfer",
+                [] (JsonObject) { }, //process req
+                [] () {
+                    //create conf
+                    auto conf = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                    (*conf)["status"] = "Accepted";
+                    return conf;
+                });
+        });
+
+        //the BootNotification has been answered without delay
+        REQUIRE( linkMonitor.hasEstimate() );
+        REQUIRE( !linkMonitor.isOffline(mocpp_tick_ms()) );
+
+        //weak cellular link: 500 ms one-way latency
+        loopback.setLatency(500);
+
+        for (unsigned int i = 0; i < 3; i++) {
+            getOcppContext()->initiateRequest(makeRequest(new Ocpp16::CustomOperation("DataTransfer",
+                [] () {
+                    //create req
+                    auto req = makeJsonDoc(UNIT_MEM_TAG, JSON_OBJECT_SIZE(1));
+                    (*req)["vendorId"] = "MicroOcpp";
+                    return req;
+                },
+                [] (JsonObject) { })));
+            loop();
+        }
+
+        REQUIRE( linkMonitor.getStats().lastRtt >= 1000 );
+        REQUIRE( linkMonitor.getStats().lastRtt <= 1200 );
+        REQUIRE( linkMonitor.getStats().losses == 0 );
+        REQUIRE( linkMonitor.getRto() >= MO_LINK_RTO_MIN );
+        REQUIRE( linkMonitor.getRto() < 20000 );
+
+        //messages don't get through anymore, but the socket still reports a connection
+        loopback.setLoss(100);
+        declareConfiguration<int>(MO_CONFIG_EXT_PREFIX "AuthorizationTimeout", 20)->setInt(20);
+        declareConfiguration<bool>("AllowOfflineTxForUnknownId", false)->setBool(true);
+
+        //the Authorize times out after the RTO instead of the AuthorizationTimeout
+        unsigned long t_before = mocpp_tick_ms();
+        beginTransaction("mIdTag");
+        while (!ocppPermitsCharge() && mocpp_tick_ms() - t_before < 30000) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( ocppPermitsCharge() );
+        REQUIRE( mocpp_tick_ms() - t_before >= MO_LINK_AUTHORIZE_TIMEOUT_MIN );
+        REQUIRE( mocpp_tick_ms() - t_before < 20000 );
+        REQUIRE( linkMonitor.getStats().losses >= 1 );
+
+        //the next request in flight becomes overdue, then the link is considered offline
+        t_before = mocpp_tick_ms();
+        while (!linkMonitor.isOffline(mocpp_tick_ms()) && mocpp_tick_ms() - t_before < MO_LINK_RTO_MAX) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( linkMonitor.isOffline(mocpp_tick_ms()) );
+
+        endTransaction();
+        loop();
+        REQUIRE( !ocppPermitsCharge() );
+
+        //the verdict expires after the RTO. The requests which are still lost then renew it
+        t_before = mocpp_tick_ms();
+        while (!linkMonitor.isOffline(mocpp_tick_ms()) && mocpp_tick_ms() - t_before < MO_LINK_RTO_MAX) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( linkMonitor.isOffline(mocpp_tick_ms()) );
+
+        //fast offline verdict: the next swipe only waits for a short probe
+        REQUIRE( linkMonitor.getAdaptiveTimeout(20000, mocpp_tick_ms()) == linkMonitor.getStats().srtt + MO_LINK_PROBE_MARGIN );
+        t_before = mocpp_tick_ms();
+        beginTransaction("mIdTag2");
+        while (!ocppPermitsCharge() && mocpp_tick_ms() - t_before < 30000) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( ocppPermitsCharge() );
+        REQUIRE( mocpp_tick_ms() - t_before < MO_LINK_AUTHORIZE_TIMEOUT_MIN );
+
+        endTransaction();
+
+        //recovery: timeouts during the verdict don't extend it. The socket reconnects (e.g. after a missed ping) and the
+        //request in flight is sent again, e.g. the StatusNotification which has no timeout. Then the pending requests get through
+        auto lossesOffline = linkMonitor.getStats().losses;
+        loopback.setLoss(0);
+        loopback.setLatency(0);
+        loopback.setConnected(false);
+        loop();
+        loopback.setConnected(true);
+
+        t_before = mocpp_tick_ms();
+        while ((linkMonitor.isOffline(mocpp_tick_ms()) || linkMonitor.getStats().consecutiveLosses > 0) &&
+                mocpp_tick_ms() - t_before < 2 * MO_LINK_RTO_MAX) {
+            mtime += 100;
+            mocpp_loop();
+        }
+
+        REQUIRE( !linkMonitor.isOffline(mocpp_tick_ms()) );
+        REQUIRE( linkMonitor.getStats().consecutiveLosses == 0 );
+        REQUIRE( linkMonitor.getStats().losses <= lossesOffline + 1 ); //at most the request which was in flight when the verdict expired
+        REQUIRE( linkMonitor.getAdaptiveTimeout(20000, mocpp_tick_ms()) >= MO_LINK_AUTHORIZE_TIMEOUT_MIN );
+        loop();
+    }
+
+    mocpp_deinitialize();
+}
@@ -0,0 +1,151 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/StaticVector.h>
+#include <MicroOcpp/Model/SmartCharging/SmartChargingModel.h>
+#include <catch2/catch.hpp>
+
+#include <memory>
+
+using namespace MicroOcpp;
+
+namespace {
+
+//counts the live instances to check that each element is destroyed exactly once
+struct Element {
+    static int instances;
+    int value;
+    Element(int value) : value(value) {instances++;}
+    Element(const Element& other) : value(other.value) {instances++;}
+    Element(Element&& other) : value(other.value) {other.value = -1; instances++;}
+    Element& operator=(const Element& other) = default;
+    Element& operator=(Element&& other) {value = other.value; other.value = -1; return *this;}
+    ~Element() {instances--;}
+};
+
+int Element::instances = 0;
+
+} //namespace
+
+TEST_CASE( "StaticVector" ) {
+    printf("\nRun %s\n",  "StaticVector");
+
+    Element::instances = 0;
+
+    SECTION("Capacity") {
+        StaticVector<Element, 3> vec;
+        REQUIRE( vec.empty() );
+        REQUIRE( vec.capacity() == 3 );
+
+        REQUIRE( vec.emplace_back(1) );
+        REQUIRE( vec.push_back(Element(2)) );
+        Element el3 {3};
+        REQUIRE( vec.push_back(el3) );
+        REQUIRE( vec.full() );
+        REQUIRE( Element::instances == 4 );
+
+        //full: rejected without side effects
+        REQUIRE( !vec.emplace_back(4) );
+        REQUIRE( !vec.push_back(el3) );
+        REQUIRE( vec.size() == 3 );
+        REQUIRE( vec.back().value == 3 );
+        REQUIRE( el3.value == 3 );
+        REQUIRE( Element::instances == 4 );
+
+        //a rejected emplace_back(new X()) leaves the ownership with the caller
+        StaticVector<std::unique_ptr<Element>, 1> owners;
+        REQUIRE( owners.emplace_back(new Element(5)) );
+        auto rejected = new Element(6);
+        REQUIRE( !owners.emplace_back(rejected) );
+        REQUIRE( Element::instances == 6 );
+        delete rejected;
+    }
+
+    SECTION("Order of insertions and removals") {
+        StaticVector<Element, 8> vec;
+        for (int i = 0; i < 6; i++) {
+            REQUIRE( vec.emplace_back(i) );
+        }
+
+        //erase keeps the order of the remaining elements
+        auto it = vec.erase(vec.begin() + 1);
+        REQUIRE( it == vec.begin() + 1 );
+        REQUIRE( it->value == 2 );
+        it = vec.erase(vec.begin() + 2, vec.begin() + 4);
+        REQUIRE( it->value == 5 );
+        REQUIRE( vec.size() == 3 );
+        REQUIRE( vec[0].value == 0 );
+        REQUIRE( vec[1].value == 2 );
+        REQUIRE( vec[2].value == 5 );
+        REQUIRE( Element::instances == 3 );
+
+        REQUIRE( vec.erase(vec.begin(), vec.begin()) == vec.begin() );
+        it = vec.erase(vec.end() - 1);
+        REQUIRE( it == vec.end() );
+        REQUIRE( vec.size() == 2 );
+
+        //appended behind the remaining elements. The freed slots are reused
+        REQUIRE( vec.emplace_back(6) );
+        REQUIRE( vec.emplace_back(7) );
+        int expected [] = {0, 2, 6, 7};
+        size_t i = 0;
+        for (auto& el : vec) {
+            REQUIRE( el.value == expected[i++] );
+        }
+        REQUIRE( i == 4 );
+        REQUIRE( Element::instances == 4 );
+
+        vec.pop_back();
+        REQUIRE( vec.back().value == 6 );
+        REQUIRE( Element::instances == 3 );
+    }
+
+    SECTION("Element destruction") {
+        {
+            StaticVector<Element, 4> vec;
+            vec.emplace_back(1);
+            vec.emplace_back(2);
+
+            StaticVector<Element, 4> copy {vec};
+            REQUIRE( copy.size() == 2 );
+            REQUIRE( Element::instances == 4 );
+
+            StaticVector<Element, 4> moved {std::move(copy)};
+            REQUIRE( copy.empty() );
+            REQUIRE( moved[1].value == 2 );
+            REQUIRE( Element::instances == 4 );
+
+            moved = vec;
+            REQUIRE( Element::instances == 4 );
+            moved = std::move(vec);
+            REQUIRE( vec.empty() );
+            REQUIRE( Element::instances == 2 );
+
+            moved.clear();
+            REQUIRE( Element::instances == 0 );
+
+            moved.emplace_back(3);
+            REQUIRE( Element::instances == 1 );
+        } //destructor
+        REQUIRE( Element::instances == 0 );
+
+        {
+            StaticVector<std::unique_ptr<Element>, 4> owners;
+            owners.emplace_back(new Element(1));
+            owners.emplace_back(new Element(2));
+            owners.emplace_back(new Element(3));
+            owners.erase(owners.begin());
+            REQUIRE( owners.front()->value == 2 );
+            REQUIRE( Element::instances == 2 );
+        }
+        REQUIRE( Element::instances == 0 );
+    }
+
+    SECTION("Footprint") {
+        //inline storage for N elements and the length, without further heap blocks
+        REQUIRE( sizeof(StaticVector<ChargingSchedulePeriod, MO_ChargingScheduleMaxPeriods>) <=
+                MO_ChargingScheduleMaxPeriods * sizeof(ChargingSchedulePeriod) + 2 * sizeof(size_t) );
+        REQUIRE( sizeof(StaticVector<std::unique_ptr<Element>, 4>) == 4 * sizeof(void*) + sizeof(size_t) );
+    }
+}
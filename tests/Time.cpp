@@ -0,0 +1,277 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Time.h>
+#include <MicroOcpp/Platform.h>
+#include <catch2/catch.hpp>
+#include "./helpers/testHelper.h"
+
+#include <string.h>
+#include <memory>
+
+#define BASE_TIME "2023-01-01T00:00:00.000Z"
+
+using namespace MicroOcpp;
+
+TEST_CASE( "Time" ) {
+    printf("\nRun %s\n",  "Time");
+
+    mocpp_set_timer(custom_timer_cb);
+
+    SECTION("Timestamp arithmetic") {
+
+        Timestamp t1, t2;
+        REQUIRE( t1.setTime("2024-02-28T23:59:59Z") );
+        REQUIRE( t2.setTime("2024-03-01T00:00:00Z") );
+        REQUIRE( t2 - t1 == 24 * 3600 + 1 ); //leap day
+
+        t1 += 24 * 3600 + 1;
+        REQUIRE( t1 == t2 );
+
+        REQUIRE( t1.setTime("1999-12-31T23:59:59Z") );
+        REQUIRE( t2.setTime("2037-01-01T00:00:00Z") );
+        t1 += t2 - t1;
+        REQUIRE( t1 == t2 );
+        t1 -= 3600;
+        char buf [JSONDATE_LENGTH + 1];
+        REQUIRE( t1.toJsonString(buf, sizeof(buf)) );
+        REQUIRE( !strncmp(buf, "2036-12-31T23:00:00", 19) );
+
+        REQUIRE( !t1.setTime("2023-02-29T00:00:00Z") );
+        REQUIRE( !t1.setTime("2023-01-01T00:00") );
+        REQUIRE( !t1.setTime("2023-01-01 00:00:00Z") );
+        REQUIRE( !t1.setTime("2023-01-01T00:00:00.Z") );
+        REQUIRE( t1.setTime("2023-01-01T00:00:00.5Z") );
+    }
+
+    SECTION("Timestamp fractions") {
+
+        Timestamp t;
+
+        //1, 2 and 3 digits are tenths, hundredths and thousandths of a second. Further digits are ignored
+#if MO_ENABLE_TIMESTAMP_MILLISECONDS
+        REQUIRE( t.setTime("2023-01-01T00:00:00.5Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 500) );
+        REQUIRE( t.setTime("2023-01-01T00:00:00.05Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 50) );
+        REQUIRE( t.setTime("2023-01-01T00:00:00.25Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 250) );
+        REQUIRE( t.setTime("2023-01-01T00:00:00.005Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 5) );
+        REQUIRE( t.setTime("2023-01-01T00:00:00.9999Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 999) );
+        REQUIRE( t.setTime("2023-01-01T00:00:00Z") );
+        REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0, 0) );
+
+        char buf [JSONDATE_LENGTH + 1];
+        REQUIRE( t.setTime("2023-01-01T00:00:00.5Z") );
+        REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+        REQUIRE( !strcmp(buf, "2023-01-01T00:00:00.500Z") );
+        REQUIRE( t.setTime("2023-01-01T00:00:00.07Z") );
+        REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+        REQUIRE( !strcmp(buf, "2023-01-01T00:00:00.070Z") );
+#else
+        //without millisecond resolution, the fraction is validated and dropped
+        const char *fractions [] = {
+            "2023-01-01T00:00:00.5Z",
+            "2023-01-01T00:00:00.05Z",
+            "2023-01-01T00:00:00.005Z",
+            "2023-01-01T00:00:00.9999Z"};
+        for (auto date : fractions) {
+            REQUIRE( t.setTime(date) );
+            REQUIRE( t == Timestamp(2023, 0, 0, 0, 0, 0) );
+        }
+#endif //MO_ENABLE_TIMESTAMP_MILLISECONDS
+
+        REQUIRE( !t.setTime("2023-01-01T00:00:00.") );
+        REQUIRE( !t.setTime("2023-01-01T00:00:00.x") );
+    }
+
+    SECTION("Timestamp truncated input") {
+
+        Timestamp t;
+        REQUIRE( t.setTime("2023-06-15T12:30:45Z") );
+        Timestamp expected = t;
+
+        //each prefix of a date is rejected. The buffers have the exact size of the prefix, so that the
+        //memory checkers report any read behind the terminating zero
+        const char *date = "2023-12-31T23:59:59.123Z";
+        for (size_t len = 0; len < 19; len++) {
+            std::unique_ptr<char[]> buf {new char[len + 1]};
+            memcpy(buf.get(), date, len);
+            buf[len] = '\0';
+            REQUIRE( !t.setTime(buf.get()) );
+            REQUIRE( t == expected ); //unchanged
+        }
+
+        //the zone designator and the fraction are optional, so the string may end after the seconds or within the fraction
+        for (size_t len : {19, 21, 22, 23}) {
+            std::unique_ptr<char[]> buf {new char[len + 1]};
+            memcpy(buf.get(), date, len);
+            buf[len] = '\0';
+            REQUIRE( t.setTime(buf.get()) );
+            REQUIRE( t - Timestamp(2023, 11, 30, 23, 59, 59) == 0 );
+        }
+
+        //the date is not terminated directly, but followed by further data, e.g. within a JSON message
+        REQUIRE( t.setTime("2023-06-15T12:30:45Z\",\"status\":\"Accepted\"}") );
+        REQUIRE( t == expected );
+    }
+
+    SECTION("Timestamp serialization round-trip") {
+
+        Timestamp t, t2;
+        char buf [JSONDATE_LENGTH + 1];
+
+        REQUIRE( !t.toJsonString(buf, JSONDATE_LENGTH) ); //no space for the terminating zero
+
+        //the last second before and the first second after day, month and year boundaries
+        const char *boundaries [][2] = {
+            {"1970-01-01T23:59:59", "1970-01-02T00:00:00"},
+            {"2023-01-31T23:59:59", "2023-02-01T00:00:00"},
+            {"2023-02-28T23:59:59", "2023-03-01T00:00:00"},
+            {"2024-02-28T23:59:59", "2024-02-29T00:00:00"},
+            {"2024-02-29T23:59:59", "2024-03-01T00:00:00"},
+            {"2023-04-30T23:59:59", "2023-05-01T00:00:00"},
+            {"2023-12-31T23:59:59", "2024-01-01T00:00:00"},
+            {"2036-12-31T23:59:59", "2037-01-01T00:00:00"}};
+
+        for (auto& boundary : boundaries) {
+            REQUIRE( t.setTime(boundary[0]) );
+            REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+            REQUIRE( !strncmp(buf, boundary[0], 19) );
+            REQUIRE( t2.setTime(buf) );
+            REQUIRE( t2 == t );
+
+            t += 1;
+            REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+            REQUIRE( !strncmp(buf, boundary[1], 19) );
+            REQUIRE( t2.setTime(buf) );
+            REQUIRE( t2 == t );
+
+            t -= 1;
+            REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+            REQUIRE( !strncmp(buf, boundary[0], 19) );
+        }
+
+#if MO_ENABLE_TIMESTAMP_MILLISECONDS
+        REQUIRE( t.setTime("2023-12-31T23:59:59.999Z") );
+        t.addMilliseconds(1);
+        REQUIRE( t.toJsonString(buf, sizeof(buf)) );
+        REQUIRE( !strcmp(buf, "2024-01-01T00:00:00.000Z") );
+        REQUIRE( t2.setTime(buf) );
+        REQUIRE( t2 == t );
+#endif //MO_ENABLE_TIMESTAMP_MILLISECONDS
+    }
+
+    SECTION("Clock drift compensation") {
+
+        Clock clock;
+        REQUIRE( clock.setTime(BASE_TIME) );
+
+        Timestamp serverTime;
+        serverTime.setTime(BASE_TIME);
+
+        const double localRate = 1. - 35e-6; //simulated crystal runs slow by 3s per day
+        const unsigned long localMsPerHour = (unsigned long) (3600. * 1000. * localRate);
+
+        REQUIRE( clock.getResidualDriftPpm() == -1 ); //not learned yet
+
+        //time sync every hour for three days, e.g. by Heartbeat
+        for (int i = 0; i < 3 * 24; i++) {
+            mtime += localMsPerHour;
+            serverTime += 3600;
+
+            char buf [JSONDATE_LENGTH + 1];
+            serverTime.toJsonString(buf, sizeof(buf));
+            REQUIRE( clock.setTime(buf) );
+        }
+
+        REQUIRE( clock.getDriftPpm() >= 30 );
+        REQUIRE( clock.getDriftPpm() <= 40 );
+
+        //the samples agree with the estimate. Only a small drift remains after the compensation
+        REQUIRE( clock.getResidualDriftPpm() >= 1 );
+        REQUIRE( clock.getResidualDriftPpm() <= 5 );
+
+        //one day without time sync
+        for (int i = 0; i < 24; i++) {
+            mtime += localMsPerHour;
+            serverTime += 3600;
+            clock.now();
+        }
+
+        int deviation = clock.now() - serverTime;
+        REQUIRE( deviation >= -1 );
+        REQUIRE( deviation <= 1 );
+
+        //without compensation, the Clock would be 3s behind
+        clock.setDriftPpm(0);
+        deviation = clock.now() - serverTime;
+        REQUIRE( deviation <= -2 );
+        REQUIRE( clock.getResidualDriftPpm() == -1 ); //restored value, residual unknown
+    }
+
+    SECTION("Clock time jumps are not learned as drift") {
+
+        Clock clock;
+        REQUIRE( clock.setTime(BASE_TIME) );
+
+        mtime += 7 * 3600 * 1000;
+        REQUIRE( clock.setTime("2023-01-02T07:00:00.000Z") ); //jump by one day
+        REQUIRE( clock.getDriftPpm() == 0 );
+
+        mtime += 7 * 3600 * 1000;
+        REQUIRE( clock.setTime("2023-01-02T14:00:00.000Z") );
+        REQUIRE( clock.getDriftPpm() == 0 );
+
+        Timestamp expected;
+        expected.setTime("2023-01-02T14:00:00.000Z");
+        REQUIRE( clock.now() == expected );
+    }
+
+    SECTION("Clock jitter is not learned as drift") {
+
+        Clock clock;
+        REQUIRE( clock.setTime(BASE_TIME) );
+
+        Timestamp serverTime;
+        serverTime.setTime(BASE_TIME);
+
+        const unsigned long mtimeBase = mtime;
+        const int jitterS [] = {0, 1, -1, 1, 0, -1, 1};  //1s resolution of the server timestamps
+        const int jitterMs [] = {300, -450, 0, 500, -200, 150}; //transmission delay
+
+        //time sync every hour for two weeks with a precise crystal
+        for (int i = 1; i <= 14 * 24; i++) {
+            mtime = mtimeBase + (unsigned long) i * 3600UL * 1000UL + jitterMs[i % 6];
+
+            Timestamp t = serverTime;
+            t += i * 3600 + jitterS[i % 7];
+            char buf [JSONDATE_LENGTH + 1];
+            t.toJsonString(buf, sizeof(buf));
+            REQUIRE( clock.setTime(buf) );
+
+            REQUIRE( clock.getDriftPpm() == 0 );
+        }
+    }
+
+    SECTION("Clock monotonic time base") {
+
+        Clock clock;
+        auto t0 = clock.getMonotonicMs();
+        mtime += 1000;
+        REQUIRE( clock.getMonotonicMs() - t0 == 1000 );
+
+        REQUIRE( clock.setTime(BASE_TIME) );
+        const Timestamp *cached = &clock.now();
+        Timestamp t1 = *cached;
+        REQUIRE( clock.now() == t1 );
+
+        mtime += 1500;
+        Timestamp expected;
+        expected.setTime("2023-01-01T00:00:01.000Z");
+        REQUIRE( clock.now() - expected == 0 );
+    }
+}
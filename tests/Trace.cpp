@@ -0,0 +1,182 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Trace.h>
+
+#if MO_ENABLE_TRACE
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemAdapter.h>
+#include <MicroOcpp/Core/FilesystemUtils.h>
+#include <catch2/catch.hpp>
+#include "./helpers/testHelper.h"
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+using namespace MicroOcpp;
+
+TEST_CASE( "Trace" ) {
+    printf("\nRun %s\n",  "Trace");
+
+    //clean state
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+
+    //initialize Context with dummy socket
+    LoopbackConnection loopback;
+
+    mocpp_set_timer(custom_timer_cb);
+
+    mocpp_initialize(loopback, ChargerCredentials("test-runner1234"));
+
+    auto traceFn = [] (uint16_t bootNr) {
+        char path [MO_MAX_PATH_SIZE];
+        snprintf(path, sizeof(path), MO_FILENAME_PREFIX MO_TRACE_FN_PREFIX "%u.bin", (unsigned int)(bootNr % MO_TRACE_FILES));
+        return std::string(path);
+    };
+
+    //disabled by default
+    size_t size;
+    REQUIRE( filesystem->stat(traceFn(getOcppContext()->getModel().getBootNr()).c_str(), &size) != 0 );
+
+    //enable for the next boot
+    declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "TraceCapture", false)->setBool(true);
+    configuration_save();
+    mocpp_deinitialize();
+
+    mocpp_initialize(loopback, ChargerCredentials("test-runner1234"));
+    auto bootNr = getOcppContext()->getModel().getBootNr();
+    auto t_begin = mtime;
+
+    bool plugged = false;
+    setConnectorPluggedInput([&plugged] () {return plugged;});
+    setEnergyMeterInput([] () {return 1000;});
+
+    SECTION("Capture") {
+
+        loop();
+        plugged = true;
+        beginTransaction("mIdTag");
+        loop();
+        endTransaction();
+        plugged = false;
+        loop();
+
+        auto t_end = mtime;
+
+        mocpp_deinitialize(); //flush trace
+
+        auto path = traceFn(bootNr);
+        REQUIRE( filesystem->stat(path.c_str(), &size) == 0 );
+        REQUIRE( size <= MO_TRACE_MAXSIZE );
+
+        std::vector<unsigned char> buf (size);
+        auto file = filesystem->open(path.c_str(), "r");
+        REQUIRE( file );
+        REQUIRE( file->read((char*)buf.data(), size) == size );
+        file.reset();
+
+        TraceReader reader {buf.data(), buf.size()};
+        TraceHeader header;
+        REQUIRE( reader.readHeader(header) );
+        REQUIRE( header.bootNr == bootNr );
+        REQUIRE( header.versionMajor == 1 );
+        REQUIRE( header.versionMinor == 6 );
+        REQUIRE( header.t_begin == t_begin );
+
+        unsigned long t = header.t_begin;
+        unsigned long nLoops = 0;
+        int pluggedId = -1, energyId = -1;
+        std::vector<bool> pluggedValues;
+        int32_t energy = -1;
+        bool checkBootNotification = false, checkStartTx = false, checkBeginTx = false, checkEndTx = false;
+        size_t nFramesOut = 0, nFramesIn = 0;
+
+        TraceRecord record;
+        while (reader.next(record)) {
+            switch (record.type) {
+                case TraceRecordType::Tick:
+                    t += record.dt * record.repeat;
+                    nLoops += record.repeat;
+                    break;
+                case TraceRecordType::InputDecl:
+                    REQUIRE( record.nStr >= 1 );
+                    if (!strcmp(record.str[0], "ConnectorPlugged")) {
+                        REQUIRE( record.valueType == TraceValueType::Bool );
+                        REQUIRE( record.connectorId == 1 );
+                        pluggedId = (int)record.inputId;
+                    } else if (!strcmp(record.str[0], "EnergyMeter")) {
+                        REQUIRE( record.valueType == TraceValueType::Int );
+                        energyId = (int)record.inputId;
+                    }
+                    break;
+                case TraceRecordType::InputValue:
+                    if ((int)record.inputId == pluggedId) {
+                        pluggedValues.push_back(record.boolValue);
+                    } else if ((int)record.inputId == energyId) {
+                        energy = record.intValue;
+                    }
+                    break;
+                case TraceRecordType::FrameOut: {
+                    std::string frame (record.data, record.len);
+                    REQUIRE( record.accepted );
+                    if (frame.find("\"BootNotification\"") != std::string::npos) {
+                        checkBootNotification = true;
+                    }
+                    if (frame.find("\"StartTransaction\"") != std::string::npos) {
+                        checkStartTx = true;
+                    }
+                    nFramesOut++;
+                    break;
+                }
+                case TraceRecordType::FrameIn:
+                    nFramesIn++;
+                    break;
+                case TraceRecordType::Call:
+                    REQUIRE( record.nStr >= 2 );
+                    if (!strcmp(record.str[0], "beginTransaction")) {
+                        REQUIRE( !strcmp(record.str[1], "mIdTag") );
+                        REQUIRE( record.connectorId == 1 );
+                        checkBeginTx = true;
+                    } else if (!strcmp(record.str[0], "endTransaction")) {
+                        REQUIRE( record.str[1] == nullptr );
+                        checkEndTx = true;
+                    }
+                    break;
+                case TraceRecordType::Truncated:
+                    FAIL( "trace truncated" );
+                    break;
+            }
+        }
+
+        REQUIRE( !reader.isMalformed() );
+        REQUIRE( t == t_end );
+        REQUIRE( nLoops == 90 );
+        REQUIRE( pluggedValues == std::vector<bool>({false, true, false}) );
+        REQUIRE( energy == 1000 );
+        REQUIRE( checkBootNotification );
+        REQUIRE( checkStartTx );
+        REQUIRE( checkBeginTx );
+        REQUIRE( checkEndTx );
+        REQUIRE( nFramesOut > 0 );
+        REQUIRE( nFramesIn == nFramesOut ); //loopback delivers each sent frame
+
+        //runs of loop calls with the same time delta are packed into one record
+        REQUIRE( size < 90 * 3 + (size_t)nFramesOut * 512 );
+
+        mocpp_initialize(loopback, ChargerCredentials("test-runner1234"));
+    }
+
+    declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "TraceCapture", false)->setBool(false);
+    configuration_save();
+
+    mocpp_deinitialize();
+}
+
+#endif //MO_ENABLE_TRACE
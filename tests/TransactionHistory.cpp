@@ -0,0 +1,187 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Transactions/TransactionHistory.h>
+
+#if MO_ENABLE_TX_HISTORY
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Model/Transactions/TransactionStore.h>
+#include <catch2/catch.hpp>
+#include "./helpers/testHelper.h"
+
+#include <string.h>
+
+using namespace MicroOcpp;
+
+TEST_CASE( "Transaction history" ) {
+    printf("\nRun %s\n",  "Transaction history");
+
+    auto filesystem = makeMemoryFilesystemAdapter();
+    std::unique_ptr<TransactionStore> txStore {new TransactionStore(3, filesystem)};
+
+    //fabricate a finished session and commit it like the Connector does
+    auto addSession = [&txStore] (unsigned int connectorId, unsigned int txNr, const char *idTag, int startSecs, int meterStart, int meterStop) {
+        auto tx = txStore->createTransaction(connectorId, txNr);
+        REQUIRE( tx );
+        tx->setIdTag(idTag);
+        tx->setStartTimestamp(MIN_TIME + startSecs);
+        tx->setMeterStart(meterStart);
+        tx->getStartSync().setRequested();
+        REQUIRE( tx->commit() );
+        tx->setStopTimestamp(MIN_TIME + startSecs + 3600);
+        tx->setMeterStop(meterStop);
+        tx->getStopSync().setRequested();
+        REQUIRE( tx->commit() );
+        REQUIRE( tx->commit() ); //repeated commits don't add duplicates
+        tx.reset();
+        REQUIRE( txStore->remove(connectorId, txNr) );
+    };
+
+    SECTION("Queries") {
+        auto history = txStore->getHistory();
+        REQUIRE( history );
+        REQUIRE( history->size() == 0 );
+
+        //running tx isn't recorded
+        auto tx = txStore->createTransaction(1, 10);
+        REQUIRE( tx );
+        tx->getStartSync().setRequested();
+        REQUIRE( tx->commit() );
+        REQUIRE( history->size() == 0 );
+        tx.reset();
+        REQUIRE( txStore->remove(1, 10) );
+
+        addSession(1, 0, "mIdTag", 0, 1000, 2000);
+        addSession(2, 0, "mIdTag2", 1800, 0, 500);
+        addSession(1, 1, "MIDTAG", 7200, 2000, 4000);
+        REQUIRE( history->size() == 3 );
+
+        TxSummary out [4];
+
+        //idTag lookup: case-insensitive, newest first
+        REQUIRE( history->findByIdTag("mIdTag", out, 4) == 2 );
+        REQUIRE( out[0].connectorId == 1 );
+        REQUIRE( out[0].txNr == 1 );
+        REQUIRE( out[0].start == MIN_TIME + 7200 );
+        REQUIRE( out[0].stop == MIN_TIME + 7200 + 3600 );
+        REQUIRE( out[0].getEnergy() == 2000 );
+        REQUIRE( out[1].txNr == 0 );
+        REQUIRE( history->findByIdTag("mIdTag", out, 1) == 1 );
+        REQUIRE( history->findByIdTag("unknown", out, 4) == 0 );
+
+        //time range: sessions which overlap with [from, to)
+        REQUIRE( history->findByTime(MIN_TIME + 3000, MIN_TIME + 5000, out, 4) == 2 );
+        REQUIRE( out[0].connectorId == 2 );
+        REQUIRE( out[1].connectorId == 1 );
+        REQUIRE( out[1].txNr == 0 );
+        REQUIRE( history->findByTime(MIN_TIME + 20000, MIN_TIME + 30000, out, 4) == 0 );
+
+        //energy of the sessions which stopped within [from, to)
+        REQUIRE( history->getEnergy(MIN_TIME, MIN_TIME + 20000) == 3500 );
+        REQUIRE( history->getEnergy(MIN_TIME, MIN_TIME + 20000, 1) == 3000 );
+        REQUIRE( history->getEnergy(MIN_TIME, MIN_TIME + 6000) == 1500 );
+    }
+
+    SECTION("Persistence and rotation") {
+        const unsigned int nSessions = MO_TX_HISTORY_SIZE + 10;
+        for (unsigned int i = 0; i < nSessions; i++) {
+            addSession(1 + i % 2, i / 2, i % 3 ? "mIdTag" : "mIdTag2", (int) i * 3600, 0, 100);
+        }
+
+        //the oldest half has been dropped when the index was full
+        size_t expectedSize = MO_TX_HISTORY_SIZE / 2 + 10;
+        REQUIRE( txStore->getHistory()->size() == expectedSize );
+
+        //reboot
+        txStore.reset(new TransactionStore(3, filesystem));
+        auto history = txStore->getHistory();
+        REQUIRE( history->size() == expectedSize );
+
+        unsigned int i = nSessions;
+        history->forEach([&i] (const TxSummary& summary) {
+            i--;
+            REQUIRE( summary.connectorId == 1 + i % 2 );
+            REQUIRE( summary.txNr == i / 2 );
+            REQUIRE( summary.start == MIN_TIME + (int) i * 3600 );
+            return true;
+        });
+        REQUIRE( i == nSessions - expectedSize );
+
+        //commit of an already recorded session after the reboot
+        auto tx = txStore->createTransaction(2, (nSessions - 1) / 2);
+        REQUIRE( tx );
+        tx->getStartSync().setRequested();
+        tx->getStopSync().setRequested();
+        REQUIRE( tx->commit() );
+        REQUIRE( history->size() == expectedSize );
+    }
+
+    SECTION("Removed index") {
+        addSession(1, 0, "mIdTag", 0, 1000, 2000);
+        REQUIRE( txStore->getHistory()->size() == 1 );
+
+        //e.g. a factory reset
+        REQUIRE( filesystem->remove(MO_FILENAME_PREFIX MO_TX_HISTORY_FN_PREFIX "0.bin") );
+        REQUIRE( txStore->getHistory()->size() == 0 );
+
+        //new index, the txNr of the removed session can be recorded again
+        addSession(1, 0, "mIdTag2", 3600, 0, 100);
+        REQUIRE( txStore->getHistory()->size() == 1 );
+
+        //reboot
+        txStore.reset(new TransactionStore(3, filesystem));
+        TxSummary summary;
+        REQUIRE( txStore->getHistory()->size() == 1 );
+        REQUIRE( txStore->getHistory()->findByIdTag("mIdTag2", &summary, 1) == 1 );
+        REQUIRE( summary.getEnergy() == 100 );
+    }
+
+    SECTION("Charging session") {
+        txStore.reset();
+
+        LoopbackConnection loopback;
+        mocpp_initialize(loopback, ChargerCredentials(), filesystem);
+        mocpp_set_timer(custom_timer_cb);
+        loop();
+
+        auto history = getOcppContext()->getModel().getTransactionStore()->getHistory();
+        REQUIRE( history );
+        auto sizeBefore = history->size();
+
+        setEnergyMeterInput([] () {return 1000;});
+        beginTransaction_authorized("mIdTag");
+        loop();
+        REQUIRE( history->size() == sizeBefore );
+        auto txNr = getTransaction()->getTxNr();
+        endTransaction();
+        loop();
+
+        REQUIRE( history->size() == sizeBefore + 1 );
+        TxSummary summary;
+        REQUIRE( history->findByIdTag("mIdTag", &summary, 1) == 1 );
+        REQUIRE( summary.connectorId == 1 );
+        REQUIRE( summary.txNr == txNr );
+        REQUIRE( summary.meterStart == 1000 );
+        REQUIRE( summary.getEnergy() == 0 );
+        REQUIRE( (summary.flags & TxSummary_Authorized) );
+
+        //ClearCache and the recovery of the persistent storage delete the tx records, but not the index
+        const char *clearCache = "[2,\"msg-01\",\"ClearCache\",{}]";
+        loopback.sendTXT(clearCache, strlen(clearCache));
+        loop();
+
+        REQUIRE( history->size() == sizeBefore + 1 );
+        REQUIRE( history->findByIdTag("mIdTag", &summary, 1) == 1 );
+        REQUIRE( summary.txNr == txNr );
+
+        mocpp_deinitialize();
+    }
+}
+
+#endif //MO_ENABLE_TX_HISTORY
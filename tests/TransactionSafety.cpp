@@ -6,7 +6,9 @@
 #include <MicroOcpp/Core/Connection.h>
 #include <MicroOcpp/Core/Context.h>
 #include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Model/Transactions/TransactionStore.h>
 #include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
 #include <MicroOcpp/Operations/BootNotification.h>
 #include <MicroOcpp/Operations/StatusNotification.h>
 #include <MicroOcpp/Debug.h>
@@ -96,4 +98,74 @@ TEST_CASE( "Transaction safety" ) {
         mocpp_deinitialize();
     }
 
+    SECTION("Transaction cache") {
+        mocpp_deinitialize();
+
+        auto filesystem = makeMemoryFilesystemAdapter();
+        std::unique_ptr<TransactionStore> txStore {new TransactionStore(2, filesystem)};
+        const unsigned int txNr = 0;
+
+        //closed files which have been read from the record of the first tx
+        auto txReads = [&filesystem] () -> size_t {
+            auto stats = filesystem->getFileStats().find("tx-1-0.jsn");
+            return stats != filesystem->getFileStats().end() ? stats->second.fileReads : 0;
+        };
+
+        auto tx = txStore->createTransaction(1, txNr);
+        REQUIRE( tx );
+        tx->setIdTag("mIdTag");
+        REQUIRE( tx->commit() );
+        auto txRaw = tx.get();
+        tx.reset();
+
+        //released tx stays parsed
+        size_t reads = txReads();
+        tx = txStore->getTransaction(1, txNr);
+        REQUIRE( tx.get() == txRaw );
+        REQUIRE( !strcmp(tx->getIdTag(), "mIdTag") );
+        REQUIRE( txReads() == reads );
+
+        //uncommitted modification is discarded like before, i.e. the tx is loaded from flash again
+        tx->setIdTag("mIdTag2");
+        tx.reset();
+        tx = txStore->getTransaction(1, txNr);
+        REQUIRE( tx );
+        REQUIRE( !strcmp(tx->getIdTag(), "mIdTag") );
+        REQUIRE( txReads() == reads + 1 );
+
+        //the setters, including those of the send status, mark the tx as modified until the next commit
+        REQUIRE( !tx->isDirty() );
+        tx->getStartSync().setRequested();
+        REQUIRE( tx->isDirty() );
+        REQUIRE( tx->commit() );
+        REQUIRE( !tx->isDirty() );
+
+        tx->getStopSync().setRequested();
+        tx.reset();
+        tx = txStore->getTransaction(1, txNr);
+        REQUIRE( tx->getStartSync().isRequested() );
+        REQUIRE( !tx->getStopSync().isRequested() );
+        REQUIRE( txReads() == reads + 2 );
+        tx.reset();
+
+        //LRU: after using two other txs, the first one is evicted
+        txStore->setCacheSize(2);
+        reads = txReads();
+        REQUIRE( txStore->getTransaction(1, txNr) );
+        REQUIRE( txStore->createTransaction(1, txNr + 1) );
+        REQUIRE( txStore->getTransaction(1, txNr) );
+        REQUIRE( txReads() == reads ); //still cached
+        REQUIRE( txStore->createTransaction(1, txNr + 2) );
+        REQUIRE( txStore->createTransaction(1, txNr + 3) );
+        tx = txStore->getTransaction(1, txNr);
+        REQUIRE( tx );
+        REQUIRE( !strcmp(tx->getIdTag(), "mIdTag") );
+        REQUIRE( txReads() == reads + 1 ); //evicted, parsed from flash again
+        tx.reset();
+
+        for (unsigned int i = 0; i < 4; i++) {
+            REQUIRE( txStore->remove(1, txNr + i) );
+        }
+        REQUIRE( txStore->getTransaction(1, txNr) == nullptr );
+    }
 }
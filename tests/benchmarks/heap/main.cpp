@@ -0,0 +1,182 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+/*
+ * Heap usage of scripted OCPP scenarios. Each scenario runs against the loopback connection, i.e. the
+ * library answers its own requests like a CSMS would and server-initiated operations are injected as
+ * raw OCPP-J messages. After each scenario, the heap profiler statistics (maximum usage in total and
+ * per memory tag) are written to stdout as JSON. See tests/benchmarks/scripts/footprint_report.py
+ */
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Core/Memory.h>
+
+#include <stdio.h>
+#include <string.h>
+
+using namespace MicroOcpp;
+
+namespace {
+
+unsigned long mtime = 10000;
+unsigned long custom_timer_cb() {
+    return mtime;
+}
+
+void loop(unsigned int iterations = 30) {
+    for (unsigned int i = 0; i < iterations; i++) {
+        mtime += 100;
+        mocpp_loop();
+    }
+}
+
+void serverCall(LoopbackConnection& loopback, const char *msg) {
+    loopback.sendTXT(msg, strlen(msg));
+    loop();
+}
+
+void bootNotification(LoopbackConnection&) {
+    loop();
+}
+
+void configuration(LoopbackConnection& loopback) {
+    loop();
+    serverCall(loopback, "[2,\"msg-01\",\"ChangeConfiguration\",{\"key\":\"HeartbeatInterval\",\"value\":\"120\"}]");
+    serverCall(loopback, "[2,\"msg-02\",\"GetConfiguration\",{\"key\":[]}]");
+}
+
+void localAuthList(LoopbackConnection& loopback) {
+    declareConfiguration<bool>("LocalAuthListEnabled", true)->setBool(true);
+    loop();
+    serverCall(loopback, "[2,\"msg-01\",\"SendLocalList\",{\"listVersion\":1,\"updateType\":\"Full\",\"localAuthorizationList\":["
+            "{\"idTag\":\"mIdTag-0\",\"idTagInfo\":{\"status\":\"Accepted\"}},"
+            "{\"idTag\":\"mIdTag-1\",\"idTagInfo\":{\"status\":\"Accepted\",\"expiryDate\":\"2030-01-01T00:00:00.000Z\"}},"
+            "{\"idTag\":\"mIdTag-2\",\"idTagInfo\":{\"status\":\"Blocked\",\"parentIdTag\":\"mParentIdTag\"}},"
+            "{\"idTag\":\"mIdTag-3\",\"idTagInfo\":{\"status\":\"Accepted\"}}]}]");
+    serverCall(loopback, "[2,\"msg-02\",\"GetLocalListVersion\",{}]");
+}
+
+void chargingSession(LoopbackConnection&) {
+    setEnergyMeterInput([] () {return (int) (mtime / 1000);});
+    setPowerMeterInput([] () {return 11000.f;});
+    declareConfiguration<int>("MeterValueSampleInterval", 0)->setInt(1);
+    loop();
+
+    beginTransaction("mIdTag");
+    loop(100);
+    endTransaction();
+    loop();
+}
+
+void remoteStartStop(LoopbackConnection& loopback) {
+    loop();
+    serverCall(loopback, "[2,\"msg-01\",\"RemoteStartTransaction\",{\"idTag\":\"mIdTag\",\"connectorId\":1}]");
+
+    int transactionId = getTransaction() ? getTransaction()->getTransactionId() : -1;
+
+    char msg [128];
+    snprintf(msg, sizeof(msg), "[2,\"msg-02\",\"RemoteStopTransaction\",{\"transactionId\":%i}]", transactionId);
+    serverCall(loopback, msg);
+}
+
+void smartCharging(LoopbackConnection& loopback) {
+    loop();
+    serverCall(loopback, "[2,\"msg-01\",\"SetChargingProfile\",{\"connectorId\":1,\"csChargingProfiles\":{\"chargingProfileId\":1,\"stackLevel\":0,"
+            "\"chargingProfilePurpose\":\"TxDefaultProfile\",\"chargingProfileKind\":\"Recurring\",\"recurrencyKind\":\"Daily\","
+            "\"chargingSchedule\":{\"duration\":86400,\"startSchedule\":\"2023-01-01T00:00:00.000Z\",\"chargingRateUnit\":\"A\","
+            "\"chargingSchedulePeriod\":[{\"startPeriod\":0,\"limit\":16,\"numberPhases\":3},{\"startPeriod\":18000,\"limit\":32,\"numberPhases\":3}]}}}]");
+    serverCall(loopback, "[2,\"msg-02\",\"GetCompositeSchedule\",{\"connectorId\":1,\"duration\":86400,\"chargingRateUnit\":\"A\"}]");
+    serverCall(loopback, "[2,\"msg-03\",\"ClearChargingProfile\",{\"id\":1}]");
+}
+
+void triggerMessage(LoopbackConnection& loopback) {
+    loop();
+    serverCall(loopback, "[2,\"msg-01\",\"TriggerMessage\",{\"requestedMessage\":\"StatusNotification\",\"connectorId\":1}]");
+    serverCall(loopback, "[2,\"msg-02\",\"TriggerMessage\",{\"requestedMessage\":\"MeterValues\",\"connectorId\":1}]");
+    serverCall(loopback, "[2,\"msg-03\",\"DataTransfer\",{\"vendorId\":\"MicroOcpp\",\"data\":\"Benchmark\"}]");
+}
+
+#if MO_ENABLE_V201
+void transactionV201(LoopbackConnection&) {
+    loop();
+    beginTransaction_authorized("mIdToken");
+    loop(100);
+    endTransaction_authorized("mIdToken");
+    loop();
+}
+#endif //MO_ENABLE_V201
+
+struct Scenario {
+    const char *name;
+    ProtocolVersion version;
+    void (*run)(LoopbackConnection& loopback);
+};
+
+const Scenario scenarios [] = {
+    {"v16_BootNotification", ProtocolVersion(1,6), bootNotification},
+    {"v16_Configuration", ProtocolVersion(1,6), configuration},
+    {"v16_LocalAuthList", ProtocolVersion(1,6), localAuthList},
+    {"v16_ChargingSession", ProtocolVersion(1,6), chargingSession},
+    {"v16_RemoteStartStop", ProtocolVersion(1,6), remoteStartStop},
+    {"v16_SmartCharging", ProtocolVersion(1,6), smartCharging},
+    {"v16_TriggerMessage", ProtocolVersion(1,6), triggerMessage},
+#if MO_ENABLE_V201
+    {"v201_BootNotification", ProtocolVersion(2,0,1), bootNotification},
+    {"v201_Transaction", ProtocolVersion(2,0,1), transactionV201},
+#endif //MO_ENABLE_V201
+};
+
+char statsBuf [64000];
+
+} //namespace
+
+int main() {
+
+    mocpp_set_timer(custom_timer_cb);
+
+    printf("{\"scenarios\":[");
+
+    for (size_t i = 0; i < sizeof(scenarios) / sizeof(scenarios[0]); i++) {
+        const auto& scenario = scenarios[i];
+
+        //clean state
+        auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+        FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+
+        LoopbackConnection loopback;
+
+        MO_MEM_RESET();
+
+        #if MO_ENABLE_V201
+        if (scenario.version.major == 2) {
+            mocpp_initialize(loopback, ChargerCredentials::v201("Benchmark model", "Benchmark vendor"), filesystem, false, scenario.version);
+        } else
+        #endif //MO_ENABLE_V201
+        {
+            mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"), filesystem, false, scenario.version);
+        }
+
+        scenario.run(loopback);
+
+        int ret = mo_mem_write_stats_json(statsBuf, sizeof(statsBuf));
+
+        mocpp_deinitialize();
+
+        if (ret < 0 || (size_t)ret >= sizeof(statsBuf)) {
+            fprintf(stderr, "heap stats exceed buffer (%s)\n", scenario.name);
+            return 1;
+        }
+
+        printf("%s{\"name\":\"%s\",\"heap\":%s}", i == 0 ? "" : ",", scenario.name, statsBuf);
+    }
+
+    printf("]}\n");
+
+    MO_MEM_DEINIT();
+    return 0;
+}
@@ -0,0 +1,205 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Request.h>
+#include <MicroOcpp/Operations/CustomOperation.h>
+#include <MicroOcpp/Platform.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <algorithm>
+#include <iterator>
+#include <map>
+#include <unordered_map>
+#include <vector>
+
+#define HEAP_SIZE (1024 * 1024)
+#define HEAP_ALIGN 16
+#define HEAP_BLOCK_OVERHEAD 16 //header of a typical embedded heap allocator, e.g. umm_malloc or the ESP-IDF heap
+
+#define DAYS 7
+#define SESSIONS_PER_DAY 6
+#define STEP_MS 150
+
+using namespace MicroOcpp;
+
+/*
+ * Fragmentation of the heap over a simulated week of operation, once with the objects of
+ * mocpp_initialize() interleaved with the other allocations on the heap and once with the boot arena
+ * (build flag MO_ENABLE_BOOT_ARENA). The simulated heap is a first-fit allocator with coalescing like
+ * on most MCUs. At the end of the week, it reports the largest free block and the number of free
+ * fragments within the address range which the library has occupied at its peak, i.e. in a heap
+ * which is just large enough for the run
+ */
+namespace {
+
+struct SimHeap {
+    std::vector<unsigned char> buf = std::vector<unsigned char>(HEAP_SIZE);
+    std::map<size_t, size_t> freeBlocks {{0, HEAP_SIZE}}; //offset -> size, coalesced
+    std::unordered_map<size_t, size_t> usedBlocks;
+    size_t used = 0;
+    size_t peakTop = 0;
+
+    bool contains(void *ptr) {
+        return (unsigned char*)ptr >= buf.data() && (unsigned char*)ptr < buf.data() + buf.size();
+    }
+
+    void *allocate(size_t size) {
+        size_t blockSize = (size + HEAP_BLOCK_OVERHEAD + HEAP_ALIGN - 1) / HEAP_ALIGN * HEAP_ALIGN;
+        for (auto block = freeBlocks.begin(); block != freeBlocks.end(); ++block) {
+            if (block->second < blockSize) {
+                continue;
+            }
+            size_t offset = block->first;
+            size_t remaining = block->second - blockSize;
+            freeBlocks.erase(block);
+            if (remaining > 0) {
+                freeBlocks.emplace(offset + blockSize, remaining);
+            }
+            usedBlocks.emplace(offset, blockSize);
+            used += blockSize;
+            peakTop = std::max(peakTop, offset + blockSize);
+            return buf.data() + offset;
+        }
+        return nullptr;
+    }
+
+    void release(void *ptr) {
+        size_t offset = (unsigned char*)ptr - buf.data();
+        auto usedBlock = usedBlocks.find(offset);
+        if (usedBlock == usedBlocks.end()) {
+            return;
+        }
+        size_t size = usedBlock->second;
+        usedBlocks.erase(usedBlock);
+        used -= size;
+
+        auto next = freeBlocks.lower_bound(offset);
+        if (next != freeBlocks.end() && offset + size == next->first) {
+            size += next->second;
+            next = freeBlocks.erase(next);
+        }
+        if (next != freeBlocks.begin()) {
+            auto prev = std::prev(next);
+            if (prev->first + prev->second == offset) {
+                prev->second += size;
+                return;
+            }
+        }
+        freeBlocks.emplace(offset, size);
+    }
+
+    void getFragmentation(size_t& largestFree, size_t& fragments) {
+        largestFree = 0;
+        fragments = 0;
+        for (auto& block : freeBlocks) {
+            if (block.first >= peakTop) {
+                break;
+            }
+            size_t size = std::min(block.first + block.second, peakTop) - block.first;
+            largestFree = std::max(largestFree, size);
+            fragments++;
+        }
+    }
+};
+
+SimHeap simHeaps [2];
+SimHeap *currentHeap = nullptr;
+
+void *sim_malloc(size_t size) {
+    return currentHeap->allocate(size);
+}
+
+void sim_free(void *ptr) {
+    //blocks of an earlier run stay in their simulated heap
+    for (auto& heap : simHeaps) {
+        if (heap.contains(ptr)) {
+            heap.release(ptr);
+            return;
+        }
+    }
+    free(ptr);
+}
+
+void loopFor(unsigned long duration) {
+    auto t_start = mocpp_tick_ms();
+    while (mocpp_tick_ms() - t_start < duration) {
+        mocpp_loop();
+    }
+}
+
+void runWeek(SimHeap& heap, size_t arenaSize) {
+
+    currentHeap = &heap;
+    mo_mem_set_malloc_free(sim_malloc, sim_free);
+    mo_mem_set_boot_arena_size(arenaSize);
+
+    LoopbackConnection loopback;
+    mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"),
+            makeDefaultFilesystemAdapter(FilesystemOpt::Deactivate));
+
+    size_t arenaUsed = mo_mem_get_boot_arena_used();
+
+    bool plugged = false;
+    int32_t energy = 0;
+    setConnectorPluggedInput([&plugged] () {return plugged;});
+    setEnergyMeterInput([&energy] () {return energy;});
+    loopFor(STEP_MS); //BootNotification
+
+    for (unsigned int day = 0; day < DAYS; day++) {
+        for (unsigned int i = 0; i < SESSIONS_PER_DAY; i++) {
+            char idTag [21];
+            snprintf(idTag, sizeof(idTag), "mIdTag-%u", day * SESSIONS_PER_DAY * 37 + i * 1009); //varying lengths
+            plugged = true;
+            beginTransaction(idTag);
+            loopFor(STEP_MS);
+            REQUIRE( ocppPermitsCharge() );
+            energy += 1000 + 100 * (int32_t) i;
+            endTransaction();
+            plugged = false;
+            loopFor(STEP_MS);
+        }
+
+        //daily message of a varying size, e.g. a vendor-specific report
+        size_t dataSize = 64 + 256 * (day % 4);
+        getOcppContext()->initiateRequest(makeRequest(
+            new Ocpp16::CustomOperation("DataTransfer",
+                [dataSize] () {
+                    auto doc = makeJsonDoc("Benchmark", JSON_OBJECT_SIZE(2) + dataSize + 1);
+                    auto payload = doc->to<JsonObject>();
+                    payload["vendorId"] = "Benchmark vendor";
+                    payload["data"] = std::string(dataSize - 32, 'x');
+                    return doc;
+                },
+                [] (JsonObject) { })));
+        loopFor(STEP_MS);
+    }
+
+    size_t largestFree, fragments;
+    heap.getFragmentation(largestFree, fragments);
+
+    printf("%-12zu %10zu %10zu %10zu %14zu %10zu\n",
+            arenaSize, arenaUsed, heap.peakTop, heap.used, largestFree, fragments);
+
+    mocpp_deinitialize();
+
+    mo_mem_set_boot_arena_size(MO_BOOT_ARENA_SIZE);
+}
+
+} //namespace
+
+TEST_CASE( "Boot arena" ) {
+
+    printf("\nHeap fragmentation after a simulated week\n");
+    printf("%-12s %10s %10s %10s %14s %10s\n", "arena size", "arena used", "peak", "in use", "largest free", "fragments");
+
+    runWeek(simHeaps[0], 0);
+    runWeek(simHeaps[1], MO_BOOT_ARENA_SIZE);
+
+    mo_mem_set_malloc_free(nullptr, sim_free); //blocks which outlive the runs remain in the simulated heaps
+}
@@ -0,0 +1,123 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Model/Transactions/TransactionStore.h>
+#include <MicroOcpp/Model/Metering/MeteringService.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <string>
+#include <sys/stat.h>
+
+#define BASE_TIME "2023-01-01T00:00:00.000Z"
+
+using namespace MicroOcpp;
+
+/*
+ * Processing time of Model::loop() depending on the number of connectors, like on a cabinet with 24 AC
+ * connectors. Each connector has the usual hardware inputs: plug detection, EV and EVSE readiness and
+ * an error code input. Every other connector has a vehicle plugged in, so the status derivation runs
+ * through the Preparing branch. Only the connectors are set up, so the loop time is dominated by the
+ * connector status derivation and the status reporting pass over the ConnectorTable
+ */
+TEST_CASE( "Connector scaling" ) {
+
+    mkdir(MO_FILENAME_PREFIX, 0777);
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    REQUIRE( filesystem );
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+
+    printf("\nsizeof(Connector) = %zuB\n", sizeof(Connector));
+
+    const unsigned int numConnectorsList [] = {4, 8, 16, 24, 48};
+
+    for (auto numConnectors : numConnectorsList) {
+
+        configuration_init(filesystem);
+
+        {
+            LoopbackConnection loopback;
+            Context context {loopback, filesystem, 1, ProtocolVersion(1,6)};
+            auto& model = context.getModel();
+
+            model.setTransactionStore(std::unique_ptr<TransactionStore>(
+                new TransactionStore(numConnectors, filesystem)));
+
+            auto connectors = makeVector<std::unique_ptr<Connector>>("v16.ConnectorBase.Connector");
+            for (unsigned int connectorId = 0; connectorId < numConnectors; connectorId++) {
+                connectors.emplace_back(new Connector(context, filesystem, connectorId));
+                if (connectorId == 0) {
+                    continue;
+                }
+                bool plugged = connectorId % 2 == 0;
+                connectors.back()->setConnectorPluggedInput([plugged] () {return plugged;});
+                connectors.back()->setEvReadyInput([] () {return true;});
+                connectors.back()->setEvseReadyInput([] () {return true;});
+                connectors.back()->addErrorCodeInput([] () {return (const char*)nullptr;});
+            }
+            model.setConnectors(std::move(connectors));
+
+            model.getClock().setTime(BASE_TIME);
+            model.activateTasks();
+            model.loop(); //initial StatusNotifications
+
+            REQUIRE( model.getConnectorTable().size() == numConnectors );
+            REQUIRE( model.getConnector(2)->getStatus() == ChargePointStatus_Preparing ); //plugged
+
+            BENCHMARK(std::string("Model::loop() with ") + std::to_string(numConnectors) + " connectors") {
+                model.loop();
+            };
+        }
+
+        configuration_deinit();
+    }
+
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+}
+
+/*
+ * Initialization of 24 connectors with their MeteringConnectors, like in mocpp_initialize(). The global
+ * configurations are declared once per Context and the connectors share the handles, so the init time
+ * mostly consists of the per-connector keys, the transaction range scans and the allocations
+ */
+TEST_CASE( "Connector initialization" ) {
+
+    mkdir(MO_FILENAME_PREFIX, 0777);
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    REQUIRE( filesystem );
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+
+    configuration_init(filesystem);
+
+    const unsigned int numConnectors = 24;
+
+    BENCHMARK("Initialize 24 connectors") {
+        LoopbackConnection loopback;
+        Context context {loopback, filesystem, 1, ProtocolVersion(1,6)};
+        auto& model = context.getModel();
+
+        model.setTransactionStore(std::unique_ptr<TransactionStore>(
+            new TransactionStore(numConnectors, filesystem)));
+        auto connectors = makeVector<std::unique_ptr<Connector>>("v16.ConnectorBase.Connector");
+        for (unsigned int connectorId = 0; connectorId < numConnectors; connectorId++) {
+            connectors.emplace_back(new Connector(context, filesystem, connectorId));
+        }
+        model.setConnectors(std::move(connectors));
+        model.setMeteringSerivce(std::unique_ptr<MeteringService>(
+            new MeteringService(context, numConnectors, filesystem)));
+
+        return model.getNumConnectors();
+    };
+
+    configuration_deinit();
+
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+}
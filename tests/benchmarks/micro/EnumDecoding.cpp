@@ -0,0 +1,90 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Metering/ReadingContext.h>
+#include <catch2/catch.hpp>
+
+#include <string.h>
+
+using namespace MicroOcpp;
+
+namespace {
+
+//decoder before the perfect-hash tables, for comparison
+ReadingContext deserializeReadingContextStrcmp(const char *context) {
+    if (!strcmp(context, "Sample.Periodic")) {
+        return ReadingContext_SamplePeriodic;
+    } else if (!strcmp(context, "Sample.Clock")) {
+        return ReadingContext_SampleClock;
+    } else if (!strcmp(context, "Transaction.Begin")) {
+        return ReadingContext_TransactionBegin;
+    } else if (!strcmp(context, "Transaction.End")) {
+        return ReadingContext_TransactionEnd;
+    } else if (!strcmp(context, "Other")) {
+        return ReadingContext_Other;
+    } else if (!strcmp(context, "Interruption.Begin")) {
+        return ReadingContext_InterruptionBegin;
+    } else if (!strcmp(context, "Interruption.End")) {
+        return ReadingContext_InterruptionEnd;
+    } else if (!strcmp(context, "Trigger")) {
+        return ReadingContext_Trigger;
+    }
+    return ReadingContext_UNDEFINED;
+}
+
+} //end namespace
+
+/*
+ * Decoding cost of an OCPP enum string. The strcmp chain compares the input against the names one by one,
+ * so the later names and the unknown strings are the expensive cases. The perfect-hash table takes one
+ * hash pass over the input and one strcmp for any input
+ */
+TEST_CASE( "Enum decoding" ) {
+
+    //in enum order, i.e. from the front to the back of the strcmp chain
+    const char *readingContexts [] = {
+        "Sample.Periodic",
+        "Sample.Clock",
+        "Transaction.Begin",
+        "Transaction.End",
+        "Other",
+        "Interruption.Begin",
+        "Interruption.End",
+        "Trigger"
+    };
+    const size_t readingContextsSize = sizeof(readingContexts) / sizeof(readingContexts[0]);
+
+    for (size_t i = 0; i < readingContextsSize; i++) {
+        REQUIRE( deserializeReadingContext(readingContexts[i]) == deserializeReadingContextStrcmp(readingContexts[i]) );
+        REQUIRE( !strcmp(serializeReadingContext(deserializeReadingContext(readingContexts[i])), readingContexts[i]) );
+    }
+    REQUIRE( deserializeReadingContext("Sample.Periodik") == ReadingContext_UNDEFINED );
+    REQUIRE( deserializeReadingContext("") == ReadingContext_UNDEFINED );
+
+    size_t i = 0;
+
+    BENCHMARK("ReadingContext strcmp chain (all names)") {
+        return deserializeReadingContextStrcmp(readingContexts[i++ % readingContextsSize]);
+    };
+
+    BENCHMARK("ReadingContext perfect hash (all names)") {
+        return deserializeReadingContext(readingContexts[i++ % readingContextsSize]);
+    };
+
+    BENCHMARK("ReadingContext strcmp chain (last name)") {
+        return deserializeReadingContextStrcmp("Trigger");
+    };
+
+    BENCHMARK("ReadingContext perfect hash (last name)") {
+        return deserializeReadingContext("Trigger");
+    };
+
+    BENCHMARK("ReadingContext strcmp chain (unknown)") {
+        return deserializeReadingContextStrcmp("Interruption.Bgn");
+    };
+
+    BENCHMARK("ReadingContext perfect hash (unknown)") {
+        return deserializeReadingContext("Interruption.Bgn"); //the benchmark build doesn't print the error
+    };
+}
@@ -0,0 +1,116 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <MicroOcpp/Platform.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+
+using namespace MicroOcpp;
+
+/*
+ * Flash wear and flash time of typical scenarios on the in-memory filesystem with the cost models of
+ * LittleFS and SPIFFS: the first boot with an empty store, a reboot, a configuration change and a
+ * charging session. For each scenario, it prints the bytes which MO writes, the bytes which the
+ * filesystem programs including metadata, the erased blocks and the simulated flash time. Finally, it
+ * lists the files which the charging session writes on LittleFS
+ */
+namespace {
+
+void loopFor(unsigned long duration) {
+    auto t_start = mocpp_tick_ms();
+    while (mocpp_tick_ms() - t_start < duration) {
+        mocpp_loop();
+    }
+}
+
+void printStats(const char *scenario, const FlashStats& stats) {
+    printf("%-22s %7zu B %7zu B %5.2f %4zu %6zu %9.1f ms\n",
+            scenario,
+            stats.bytesWritten,
+            stats.bytesProgrammed,
+            stats.getWriteAmplification(),
+            stats.fileWrites,
+            stats.blocksErased,
+            stats.getSimulatedMs());
+}
+
+} //namespace
+
+TEST_CASE( "Flash wear" ) {
+
+    struct {
+        const char *name;
+        FlashModel model;
+    } models [] = {
+        {"LittleFS", FlashModel::littlefs()},
+        {"SPIFFS", FlashModel::spiffs()},
+    };
+
+    for (auto& model : models) {
+
+        auto filesystem = makeMemoryFilesystemAdapter(model.model);
+
+        LoopbackConnection loopback;
+
+        bool plugged = false;
+
+        printf("\nFlash wear on %s\n", model.name);
+        printf("%-22s %9s %9s %5s %4s %6s %12s\n", "scenario", "written", "programd", "WA", "files", "erases", "flash time");
+
+        mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"), filesystem);
+        setConnectorPluggedInput([&plugged] () {return plugged;});
+        setEnergyMeterInput([] () {return 1000;});
+        loopFor(500); //BootNotification
+        printStats("first boot", filesystem->getStats());
+
+        filesystem->resetStats();
+        mocpp_deinitialize();
+        mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"), filesystem);
+        setConnectorPluggedInput([&plugged] () {return plugged;});
+        setEnergyMeterInput([] () {return 1000;});
+        loopFor(500);
+        printStats("reboot", filesystem->getStats());
+
+        filesystem->resetStats();
+        declareConfiguration<int>("MeterValueSampleInterval", 60)->setInt(30);
+        configuration_save();
+        printStats("configuration change", filesystem->getStats());
+
+        filesystem->resetStats();
+        plugged = true;
+        beginTransaction("mIdTag");
+        loopFor(500);
+        endTransaction();
+        plugged = false;
+        loopFor(500);
+        auto session = filesystem->getStats();
+        printStats("charging session", session);
+
+        REQUIRE( session.bytesWritten > 0 );
+        REQUIRE( session.bytesProgrammed >= session.bytesWritten );
+        REQUIRE( session.simulatedUs > 0 );
+
+        if (model.model.copyOnWrite) {
+            printf("\n%-22s %9s %9s %5s %6s\n", "file (session)", "written", "programd", "files", "erases");
+            for (auto& file : filesystem->getFileStats()) {
+                if (file.second.fileWrites == 0) {
+                    continue;
+                }
+                printf("%-22s %7zu B %7zu B %5zu %6zu\n",
+                        file.first.c_str(),
+                        file.second.bytesWritten,
+                        file.second.bytesProgrammed,
+                        file.second.fileWrites,
+                        file.second.blocksErased);
+            }
+        }
+
+        mocpp_deinitialize();
+    }
+}
@@ -0,0 +1,124 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Heartbeat/HeartbeatService.h>
+#include <MicroOcpp/Core/LinkMonitor.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#define DAY_MS (24UL * 3600UL * 1000UL)
+#define STEP_MS 1000UL
+#define HEARTBEAT_INTERVAL_MS (300UL * 1000UL) //HeartbeatInterval of a fleet on a metered data plan
+#define METER_VALUE_SAMPLE_INTERVAL_MS (60UL * 1000UL)
+
+/*
+ * Bytes on the wire per Heartbeat exchange over a TLS connection: CALL [2,"<GUID>","Heartbeat",{}] (57 B),
+ * CALLRESULT [3,"<GUID>",{"currentTime":"2024-01-01T00:00:00Z"}] (81 B), WebSocket frame headers (masked
+ * client frame 6 B, server frame 2 B), TLS records with AES-GCM (29 B each) and TCP/IP headers of both
+ * segments and their ACKs (4 x 40 B)
+ */
+#define HEARTBEAT_WIRE_BYTES (57 + 81 + 6 + 2 + 2 * 29 + 4 * 40)
+
+using namespace MicroOcpp;
+
+/*
+ * Simulation of one day of Heartbeats with a HeartbeatInterval of 5 minutes. During charging sessions,
+ * the charger sends MeterValues every minute. The server answers each request after one step. The time
+ * is synced at boot (BootNotification) and with each Heartbeat.conf. The traffic-aware schedule only
+ * sends a Heartbeat if the link has been silent for the HeartbeatInterval or if the expected clock error
+ * exceeds MO_HEARTBEAT_RESYNC_MAX_ERROR
+ */
+namespace {
+
+struct Scenario {
+    const char *name;
+    unsigned long meteringBegin; //in ms of the day
+    unsigned long meteringEnd;
+};
+
+struct Result {
+    unsigned int heartbeats = 0;
+    unsigned long maxSyncAge = 0; //longest time without time sync in ms
+};
+
+Result simulate(const Scenario& scenario, bool deferOnTraffic) {
+    Result result;
+
+    LinkMonitor linkMonitor;
+    HeartbeatSchedule schedule {0};
+    unsigned long lastSync = 0; //BootNotification at t = 0
+
+    std::vector<bool> pendingResponses; //answered in the next step. True for Heartbeats
+
+    for (unsigned long t = 0; t < DAY_MS; t += STEP_MS) {
+
+        for (bool heartbeat : pendingResponses) {
+            linkMonitor.onResponse(t);
+            if (heartbeat) {
+                lastSync = t;
+            }
+        }
+        pendingResponses.clear();
+
+        if (t - lastSync > result.maxSyncAge) {
+            result.maxSyncAge = t - lastSync;
+        }
+
+        if (t >= scenario.meteringBegin && t < scenario.meteringEnd &&
+                (t - scenario.meteringBegin) % METER_VALUE_SAMPLE_INTERVAL_MS == 0) {
+            linkMonitor.onRequestSent(t);
+            pendingResponses.push_back(false);
+        }
+
+        if (schedule.isDue(t, HEARTBEAT_INTERVAL_MS, deferOnTraffic, linkMonitor, t - lastSync)) {
+            schedule.onHeartbeat(t);
+            linkMonitor.onRequestSent(t);
+            pendingResponses.push_back(true);
+            result.heartbeats++;
+        }
+    }
+
+    return result;
+}
+
+} //namespace
+
+TEST_CASE( "Heartbeat traffic" ) {
+
+    const Scenario scenarios [] = {
+        {"idle",              0,                 0},
+        {"8 h charging",      8UL * 3600000UL,  16UL * 3600000UL},
+        {"24 h charging",     0,                 DAY_MS},
+    };
+
+    printf("\nHeartbeats per day with HeartbeatInterval = %lu s, %u B per Heartbeat\n",
+            HEARTBEAT_INTERVAL_MS / 1000UL, HEARTBEAT_WIRE_BYTES);
+
+    for (auto& scenario : scenarios) {
+        auto fixed = simulate(scenario, false);
+        auto deferred = simulate(scenario, true);
+
+        REQUIRE( deferred.heartbeats <= fixed.heartbeats );
+        REQUIRE( !HeartbeatSchedule::isResyncDue(deferred.maxSyncAge - HEARTBEAT_INTERVAL_MS) );
+
+        printf("%-15s fixed: %4u, deferred on traffic: %4u, saved %6u B per day, max. time without sync %5lu s\n",
+                scenario.name,
+                fixed.heartbeats,
+                deferred.heartbeats,
+                (fixed.heartbeats - deferred.heartbeats) * HEARTBEAT_WIRE_BYTES,
+                deferred.maxSyncAge / 1000UL);
+    }
+
+    LinkMonitor linkMonitor;
+    linkMonitor.onRequestReceived(HEARTBEAT_INTERVAL_MS);
+    HeartbeatSchedule schedule {0};
+    unsigned long t = HEARTBEAT_INTERVAL_MS;
+
+    BENCHMARK("HeartbeatSchedule::isDue") {
+        return schedule.isDue(t++, HEARTBEAT_INTERVAL_MS, true, linkMonitor, 60000);
+    };
+}
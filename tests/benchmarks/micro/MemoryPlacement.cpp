@@ -0,0 +1,172 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Request.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Operations/CustomOperation.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unordered_map>
+
+#define LOCAL_LIST_SIZE 40
+
+using namespace MicroOcpp;
+
+/*
+ * Simulated heaps. The external heap is a static arena, so it has a different address range than the
+ * host heap like the PSRAM of an ESP32-WROVER. Both heaps count their current and maximum usage
+ */
+namespace {
+
+struct HeapUsage {
+    size_t current = 0;
+    size_t max = 0;
+
+    void add(size_t size) {
+        current += size;
+        if (current > max) {
+            max = current;
+        }
+    }
+};
+
+HeapUsage internalHeap;
+HeapUsage externalHeap;
+
+std::unordered_map<void*, size_t> internalBlocks;
+
+bool externalRamAvailable = true;
+
+alignas(max_align_t) unsigned char externalArena [4 * 1024 * 1024];
+size_t externalArenaPos = 0;
+size_t externalArenaBlocks = 0;
+
+void *internal_malloc(size_t size) {
+    void *ptr = malloc(size);
+    if (ptr) {
+        internalBlocks[ptr] = size;
+        internalHeap.add(size);
+    }
+    return ptr;
+}
+
+void internal_free(void *ptr) {
+    auto block = internalBlocks.find(ptr);
+    if (block != internalBlocks.end()) {
+        internalHeap.current -= block->second;
+        internalBlocks.erase(block);
+    }
+    free(ptr);
+}
+
+void *external_malloc(size_t size) {
+    //bump allocator with a size header which is reset when all blocks are freed. Sufficient for the benchmark scenario
+    size_t blockSize = (size + 2 * sizeof(max_align_t) - 1) / sizeof(max_align_t) * sizeof(max_align_t);
+    if (!externalRamAvailable || externalArenaPos + blockSize > sizeof(externalArena)) {
+        return nullptr;
+    }
+    unsigned char *block = externalArena + externalArenaPos;
+    externalArenaPos += blockSize;
+    externalArenaBlocks++;
+    *reinterpret_cast<size_t*>(block) = size;
+    externalHeap.add(size);
+    return block + sizeof(max_align_t);
+}
+
+void external_free(void *ptr) {
+    if (!ptr) {
+        return;
+    }
+    unsigned char *block = static_cast<unsigned char*>(ptr) - sizeof(max_align_t);
+    externalHeap.current -= *reinterpret_cast<size_t*>(block);
+    externalArenaBlocks--;
+    if (externalArenaBlocks == 0) {
+        externalArenaPos = 0;
+    }
+}
+
+void runScenario() {
+
+    internalHeap.max = internalHeap.current;
+    externalHeap.max = externalHeap.current;
+
+    LoopbackConnection loopback;
+    mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"),
+            makeDefaultFilesystemAdapter(FilesystemOpt::Deactivate));
+
+    declareConfiguration<bool>("LocalAuthListEnabled", true)->setBool(true);
+
+    for (unsigned int i = 0; i < 10; i++) {
+        mocpp_loop();
+    }
+
+    //cold data: local auth list
+    getOcppContext()->initiateRequest(makeRequest(
+        new Ocpp16::CustomOperation("SendLocalList",
+            [] () {
+                auto doc = makeJsonDoc("Benchmark", 8192);
+                auto payload = doc->to<JsonObject>();
+                payload["listVersion"] = 1;
+                payload["updateType"] = "Full";
+                auto list = payload.createNestedArray("localAuthorizationList");
+                for (unsigned int i = 0; i < LOCAL_LIST_SIZE; i++) {
+                    char idTag [21];
+                    snprintf(idTag, sizeof(idTag), "mIdTag-%u", i);
+                    auto entry = list.createNestedObject();
+                    entry["idTag"] = idTag;
+                    entry["idTagInfo"]["status"] = "Accepted";
+                }
+                return doc;
+            },
+            [] (JsonObject) { })));
+
+    for (unsigned int i = 0; i < 10; i++) {
+        mocpp_loop();
+    }
+
+    //hot data: charging session
+    beginTransaction_authorized("mIdTag-0");
+
+    for (unsigned int i = 0; i < 10; i++) {
+        mocpp_loop();
+    }
+
+    BENCHMARK("mocpp_loop") {
+        mocpp_loop();
+    };
+
+    printf("internal heap: current %zu B, max %zu B; external heap: current %zu B, max %zu B\n",
+            internalHeap.current, internalHeap.max, externalHeap.current, externalHeap.max);
+
+    endTransaction();
+    mocpp_deinitialize();
+}
+
+} //namespace
+
+TEST_CASE( "Memory placement" ) {
+
+    mo_mem_set_malloc_free(internal_malloc, internal_free);
+    mo_mem_set_malloc_free_ext(external_malloc, external_free);
+
+    SECTION("Internal RAM only") {
+        printf("\nInternal RAM only\n");
+        externalRamAvailable = false;
+        runScenario();
+    }
+
+    SECTION("External RAM with placement policy") {
+        printf("\nExternal RAM with placement policy\n");
+        externalRamAvailable = true;
+        runScenario();
+    }
+
+    mo_mem_set_malloc_free(nullptr, nullptr);
+    mo_mem_set_malloc_free_ext(nullptr, nullptr);
+}
@@ -0,0 +1,82 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Model/Metering/MeterAggregator.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <string>
+#include <vector>
+#include <memory>
+
+using namespace MicroOcpp;
+
+/*
+ * CPU cost of one high-rate sample of the MeterAggregator. The inputs are like a three-phase charger:
+ * voltage, current and power per phase plus the total power (10 channels with MO_METER_AGGREGATION_CHANNELS
+ * set accordingly, otherwise the first 8). MeterAggregator::update() only updates the accumulators of all
+ * channels. MeterAggregator::sample() also reads the inputs through their SampledValueSamplers, like the
+ * MeteringConnector does at every Cst_MeterAggregationRate tick
+ */
+TEST_CASE( "Meter aggregation" ) {
+
+    const char *measurands [] = {
+        "Voltage", "Voltage", "Voltage",
+        "Current.Import", "Current.Import", "Current.Import",
+        "Power.Active.Import", "Power.Active.Import", "Power.Active.Import",
+        "Power.Active.Import"
+    };
+    const char *phases [] = {"L1", "L2", "L3", "L1", "L2", "L3", "L1", "L2", "L3", nullptr};
+
+    std::vector<std::unique_ptr<SampledValueSampler>> inputs;
+    float reading = 230.f;
+
+    MeterAggregator aggregator {nullptr};
+
+    for (size_t i = 0; i < sizeof(measurands) / sizeof(measurands[0]); i++) {
+        SampledValueProperties properties;
+        properties.setMeasurand(measurands[i]);
+        if (phases[i]) {
+            properties.setPhase(phases[i]);
+        }
+        inputs.emplace_back(new SampledValueSamplerConcrete<float, SampledValueDeSerializer<float>>(
+                properties,
+                [&reading, i] (ReadingContext) {return reading + (float) i;}));
+        aggregator.addChannel(inputs.back().get());
+    }
+
+    auto nChannels = aggregator.getChannelCount();
+    REQUIRE( nChannels > 0 );
+
+    float values [MO_METER_AGGREGATION_CHANNELS];
+    for (size_t i = 0; i < nChannels; i++) {
+        values[i] = 230.f + (float) i;
+    }
+
+    unsigned long t = 0;
+
+    aggregator.reset(t);
+    for (unsigned int i = 0; i < 10; i++) {
+        aggregator.update(values, t += 100);
+    }
+    REQUIRE( aggregator.getCount() == 10 );
+    REQUIRE( aggregator.getValue(0, AggregationStatistic::Mean) == Approx(230.f) );
+    REQUIRE( aggregator.getValue(0, AggregationStatistic::Max) == Approx(230.f) );
+
+    printf("\nsizeof(MeterAggregator) = %zuB, %zu channels\n", sizeof(MeterAggregator), nChannels);
+
+    BENCHMARK(std::string("MeterAggregator::update() with ") + std::to_string(nChannels) + " channels") {
+        values[0] += 0.001f;
+        aggregator.update(values, t += 100);
+    };
+
+    BENCHMARK(std::string("MeterAggregator::sample() with ") + std::to_string(nChannels) + " channels") {
+        reading += 0.001f;
+        aggregator.sample(t += 100);
+    };
+
+    BENCHMARK("MeterAggregator::getValue(Mean)") {
+        return aggregator.getValue(0, AggregationStatistic::Mean);
+    };
+}
@@ -0,0 +1,273 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/RequestScheduler.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+
+#define RTT_MS 300 //send request and receive confirmation
+#define QUEUE_CAPACITY 10 //MO_REQUEST_CACHE_MAXSIZE
+
+using namespace MicroOcpp;
+
+/*
+ * Simulation of the send queues of the RequestQueue with the RequestScheduler. Only one request is in
+ * flight at a time and each request occupies the connection for one round trip. The connection comes up
+ * at t = 0 and the wait time of a request is counted from when it has become the front of its queue, like
+ * in the RequestQueue. The legacy policy
+ * assigns all requests to the same class without deadlines, then the scheduler falls back to the
+ * lowest OpNr like the RequestQueue did before the priority classes
+ */
+namespace {
+
+struct SimRequest {
+    const char *operationType;
+    unsigned long queuedAt;
+    unsigned int opNr;
+};
+
+struct SimQueue {
+    std::deque<SimRequest> requests;
+    unsigned long frontSince = 0;
+    PriorityClass priorityClass;
+    bool sequenced; //transaction-related messages with OpNr
+};
+
+struct Stats {
+    unsigned long authorizeLatency = 0;
+    unsigned long startTxLatency = 0;
+    unsigned long maxWait [MO_NUM_PRIORITY_CLASSES] = {0};
+    unsigned long maxFrontWait [MO_NUM_PRIORITY_CLASSES] = {0}; //at the front of the queue
+    unsigned long drained = 0;
+};
+
+class Simulation {
+public:
+    RequestScheduler scheduler;
+    bool legacy = false;
+
+    SimQueue defaultQueues [MO_NUM_PRIORITY_CLASSES];
+    SimQueue txQueues [2]; //StartTx / StopTx per connector
+    SimQueue meteringQueues [2]; //MeterValues per connector
+
+    unsigned int nextOpNr = RequestScheduler::SequencedOpNr;
+    unsigned long now = 0;
+
+    Stats stats;
+
+    Simulation(bool legacy) : legacy(legacy) {
+        for (size_t i = 0; i < MO_NUM_PRIORITY_CLASSES; i++) {
+            defaultQueues[i].priorityClass = (PriorityClass)i;
+            defaultQueues[i].sequenced = false;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            txQueues[i].priorityClass = PriorityClass::Transactional;
+            txQueues[i].sequenced = true;
+            meteringQueues[i].priorityClass = PriorityClass::Telemetry;
+            meteringQueues[i].sequenced = true;
+        }
+        if (legacy) {
+            for (size_t i = 0; i < MO_NUM_PRIORITY_CLASSES; i++) {
+                scheduler.setDeadline((PriorityClass)i, 0);
+            }
+        }
+    }
+
+    PriorityClass classOf(const SimQueue& queue) {
+        return legacy ? PriorityClass::Transactional : queue.priorityClass;
+    }
+
+    void sendRequest(const char *operationType) {
+        auto priorityClass = legacy ? PriorityClass::Transactional : scheduler.getPriorityClass(operationType);
+        auto& queue = defaultQueues[(size_t)priorityClass];
+        if (queue.requests.size() >= QUEUE_CAPACITY) {
+            queue.requests.pop_front(); //drop oldest like VolatileRequestQueue
+            queue.frontSince = now;
+        }
+        push(queue, {operationType, now, 0});
+    }
+
+    void sendSequenced(SimQueue& queue, const char *operationType) {
+        push(queue, {operationType, now, nextOpNr++});
+    }
+
+    void push(SimQueue& queue, SimRequest request) {
+        if (queue.requests.empty()) {
+            queue.frontSince = now;
+        }
+        queue.requests.push_back(request);
+    }
+
+    //returns the request which is sent next
+    SimRequest fetchNext(bool& success) {
+        SimQueue *queues [MO_NUM_PRIORITY_CLASSES + 4];
+        size_t n = 0;
+        for (auto& queue : defaultQueues) {
+            queues[n++] = &queue;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            queues[n++] = &txQueues[i];
+            queues[n++] = &meteringQueues[i];
+        }
+
+        RequestScheduler::Candidate candidates [MO_NUM_PRIORITY_CLASSES + 4];
+        size_t order [MO_NUM_PRIORITY_CLASSES + 4];
+        for (size_t i = 0; i < n; i++) {
+            auto& queue = *queues[i];
+            if (queue.requests.empty()) {
+                candidates[i].opNr = RequestScheduler::NoOperation;
+                continue;
+            }
+            candidates[i].opNr = queue.sequenced ? queue.requests.front().opNr : 1;
+            candidates[i].priorityClass = classOf(queue);
+            candidates[i].waitTime = now - queue.frontSince;
+        }
+
+        success = scheduler.rank(candidates, n, order) > 0;
+        if (!success) {
+            return SimRequest();
+        }
+
+        auto& queue = *queues[order[0]];
+        auto request = queue.requests.front();
+        queue.requests.pop_front();
+
+        auto priorityClass = (size_t)scheduler.getPriorityClass(request.operationType);
+        stats.maxWait[priorityClass] = std::max(stats.maxWait[priorityClass], now - request.queuedAt);
+        stats.maxFrontWait[priorityClass] = std::max(stats.maxFrontWait[priorityClass], now - queue.frontSince);
+        queue.frontSince = now;
+        return request;
+    }
+
+    bool empty() {
+        for (auto& queue : defaultQueues) {
+            if (!queue.requests.empty()) return false;
+        }
+        for (size_t i = 0; i < 2; i++) {
+            if (!txQueues[i].requests.empty() || !meteringQueues[i].requests.empty()) return false;
+        }
+        return true;
+    }
+};
+
+/*
+ * Reconnect after an outage of one hour. Connector 1 has an ongoing transaction, so its StartTransaction
+ * and the last MeterValues are still queued, connector 2 has clock-aligned MeterValues. One second
+ * after the reconnect, a driver presents an idTag at connector 2. After the Authorize is accepted, the
+ * charger sends the StartTransaction
+ */
+Stats runBacklog(bool legacy, unsigned long dataTransferLoad) {
+    Simulation sim {legacy};
+
+    const char *backlog [] = {"SecurityEventNotification", "StatusNotification", "SecurityEventNotification", "StatusNotification",
+            "DiagnosticsStatusNotification", "StatusNotification", "FirmwareStatusNotification", "StatusNotification",
+            "Heartbeat", "SecurityEventNotification"};
+    for (auto operationType : backlog) {
+        sim.sendRequest(operationType);
+    }
+    sim.sendSequenced(sim.txQueues[0], "StartTransaction");
+    for (unsigned int i = 0; i < QUEUE_CAPACITY; i++) {
+        sim.sendSequenced(sim.meteringQueues[0], "MeterValues");
+        sim.sendSequenced(sim.meteringQueues[1], "MeterValues");
+    }
+
+    const unsigned long driverArrives = 1000;
+    bool authorizeQueued = false;
+    unsigned long startTxQueuedAt = 0;
+    unsigned long nextDataTransfer = dataTransferLoad;
+
+    while (sim.now < 3600UL * 1000UL) {
+
+        if (!authorizeQueued && sim.now >= driverArrives) {
+            sim.sendRequest("Authorize");
+            authorizeQueued = true;
+        }
+
+        if (dataTransferLoad && sim.now >= nextDataTransfer) {
+            //vendor-specific traffic which saturates the connection
+            sim.sendRequest("DataTransfer");
+            nextDataTransfer += dataTransferLoad;
+        }
+
+        bool success = false;
+        auto request = sim.fetchNext(success);
+        if (!success) {
+            if (authorizeQueued && !dataTransferLoad && sim.empty()) {
+                break;
+            }
+            sim.now += 10;
+            continue;
+        }
+
+        sim.now += RTT_MS;
+
+        if (!strcmp(request.operationType, "Authorize")) {
+            sim.stats.authorizeLatency = sim.now - request.queuedAt;
+            sim.sendSequenced(sim.txQueues[1], "StartTransaction");
+            startTxQueuedAt = sim.now;
+            sim.sendRequest("StatusNotification");
+        }
+        if (!strcmp(request.operationType, "StartTransaction") && request.queuedAt == startTxQueuedAt) {
+            sim.stats.startTxLatency = sim.now - request.queuedAt;
+        }
+    }
+
+    sim.stats.drained = sim.now;
+    return sim.stats;
+}
+
+void printStats(const char *policy, const Stats& stats) {
+    char startTx [16];
+    if (stats.startTxLatency) {
+        snprintf(startTx, sizeof(startTx), "%6lu ms", stats.startTxLatency);
+    } else {
+        snprintf(startTx, sizeof(startTx), "not sent"); //starved within the simulated hour
+    }
+    printf("%-24s Authorize %6lu ms   StartTx %s   max wait: Interactive %6lu ms, Transactional %6lu ms, Telemetry %6lu ms, Bulk %7lu ms\n",
+            policy, stats.authorizeLatency, startTx,
+            stats.maxWait[(size_t)PriorityClass::Interactive], stats.maxWait[(size_t)PriorityClass::Transactional],
+            stats.maxWait[(size_t)PriorityClass::Telemetry], stats.maxWait[(size_t)PriorityClass::Bulk]);
+}
+
+} //namespace
+
+TEST_CASE( "Request scheduling" ) {
+
+    printf("\nBacklog after reconnect, RTT %u ms\n", RTT_MS);
+    auto legacy = runBacklog(true, 0);
+    auto priority = runBacklog(false, 0);
+    printStats("Lowest OpNr (legacy)", legacy);
+    printStats("Priority classes", priority);
+
+    REQUIRE( priority.authorizeLatency <= legacy.authorizeLatency );
+
+    printf("\nBacklog with saturating DataTransfer load, RTT %u ms\n", RTT_MS);
+    auto legacyLoad = runBacklog(true, RTT_MS);
+    auto priorityLoad = runBacklog(false, RTT_MS);
+    printStats("Lowest OpNr (legacy)", legacyLoad);
+    printStats("Priority classes", priorityLoad);
+
+    //starvation protection: each Bulk request gets through within its deadline at the front of the queue plus the
+    //time to send the other overdue requests
+    REQUIRE( priorityLoad.maxFrontWait[(size_t)PriorityClass::Bulk] < 2 * MO_PRIORITY_DEADLINE_BULK );
+
+    //cost of one scheduling decision with all send queues occupied
+    RequestScheduler scheduler;
+    RequestScheduler::Candidate candidates [16];
+    for (size_t i = 0; i < 16; i++) {
+        candidates[i].priorityClass = (PriorityClass)(i % MO_NUM_PRIORITY_CLASSES);
+        candidates[i].opNr = i < MO_NUM_PRIORITY_CLASSES ? 1 : RequestScheduler::SequencedOpNr + 16 - i;
+        candidates[i].waitTime = i * 5000;
+    }
+
+    BENCHMARK("RequestScheduler::rank (16 queues)") {
+        size_t order [16];
+        return scheduler.rank(candidates, 16, order);
+    };
+}
@@ -0,0 +1,172 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/RetryPolicy.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <stdint.h>
+#include <vector>
+
+#define FLEET_SIZE 1000
+#define RETRY_INTERVAL_MS 60000 //TransactionMessageRetryInterval
+#define OUTAGE_MS (30UL * 60UL * 1000UL)
+#define CSMS_CAPACITY 20 //requests per second which the CSMS processes after the outage
+#define SIM_DURATION_MS (6UL * 3600UL * 1000UL)
+
+using namespace MicroOcpp;
+
+/*
+ * Simulation of a fleet of chargers which retry a StopTransaction after a CSMS outage. The CSMS fails
+ * at t = 0 and every charger loses its StopTransaction within the first 5 seconds. During the outage, the
+ * CSMS answers all requests with InternalError. After the outage, it processes CSMS_CAPACITY requests per
+ * second and answers the excess with InternalError (overload). Optionally, it tells the rejected chargers
+ * to retry after its backlog has been worked off (server-hinted backoff). The chargers retry without limit
+ * (TransactionMessageAttempts) and the simulation runs in 1 s steps
+ */
+namespace {
+
+enum class Policy {
+    Legacy,     //TransactionMessageRetryInterval * attemptNr, without jitter
+    Backoff,    //RetryPolicy: exponential backoff with jitter
+    ServerHint  //RetryPolicy with server-hinted backoff
+};
+
+struct Charger {
+    RetryPolicy retryPolicy;
+    unsigned int attemptNr = 1;
+    unsigned long attemptTime = 0;
+    unsigned long holdOffUntil = 0;
+    bool delivered = false;
+};
+
+struct Stats {
+    unsigned long peakAfterOutage = 0; //maximum of requests arriving at the CSMS in one second
+    unsigned long requestsAfterOutage = 0;
+    unsigned long rejectedAfterOutage = 0;
+    unsigned long drainTime = 0; //time after the outage until all StopTransactions are delivered
+    unsigned long delivered = 0;
+};
+
+uint32_t lcg(uint32_t& state) {
+    state = state * 1664525U + 1013904223U;
+    return state >> 8;
+}
+
+Stats runFleet(Policy policy) {
+
+    std::vector<Charger> fleet (FLEET_SIZE);
+
+    uint32_t rand = 12345;
+
+    for (size_t i = 0; i < fleet.size(); i++) {
+        char serial [16];
+        auto len = snprintf(serial, sizeof(serial), "CP-%04zu", i);
+        fleet[i].retryPolicy.addEntropy(serial, (size_t)len);
+        fleet[i].attemptTime = lcg(rand) % 5000; //first attempt failed during the first 5 s
+    }
+
+    Stats stats;
+    size_t pending = fleet.size();
+
+    std::vector<size_t> arrivals;
+
+    for (unsigned long now = 0; now < SIM_DURATION_MS && pending > 0; now += 1000) {
+
+        arrivals.clear();
+        for (size_t i = 0; i < fleet.size(); i++) {
+            auto& charger = fleet[i];
+            if (charger.delivered || now < charger.holdOffUntil) {
+                continue;
+            }
+            unsigned long delay;
+            if (policy == Policy::Legacy) {
+                delay = charger.attemptNr * (unsigned long)RETRY_INTERVAL_MS;
+            } else {
+                delay = charger.retryPolicy.getRetryDelay(charger.attemptNr, RETRY_INTERVAL_MS, 0);
+            }
+            if (now - charger.attemptTime >= delay) {
+                arrivals.push_back(i);
+            }
+        }
+
+        //the CSMS serves the arrivals of this second in random order
+        for (size_t i = arrivals.size(); i > 1; i--) {
+            std::swap(arrivals[i - 1], arrivals[lcg(rand) % i]);
+        }
+
+        size_t accepted = 0;
+        if (now >= OUTAGE_MS) {
+            accepted = arrivals.size() < CSMS_CAPACITY ? arrivals.size() : CSMS_CAPACITY;
+
+            stats.requestsAfterOutage += arrivals.size();
+            stats.rejectedAfterOutage += arrivals.size() - accepted;
+            if (arrivals.size() > stats.peakAfterOutage) {
+                stats.peakAfterOutage = arrivals.size();
+            }
+        }
+
+        for (size_t k = 0; k < arrivals.size(); k++) {
+            auto& charger = fleet[arrivals[k]];
+            if (k < accepted) {
+                charger.delivered = true;
+                pending--;
+                if (pending == 0) {
+                    stats.drainTime = now - OUTAGE_MS;
+                }
+                continue;
+            }
+            charger.attemptNr++;
+            charger.attemptTime = now;
+            if (policy == Policy::ServerHint && now >= OUTAGE_MS) {
+                //hint: retry when the CSMS has processed the current backlog
+                unsigned long backlog = arrivals.size() - accepted;
+                charger.holdOffUntil = now + (backlog / CSMS_CAPACITY + 1) * 1000UL;
+            }
+        }
+    }
+
+    stats.delivered = fleet.size() - pending;
+    return stats;
+}
+
+void printStats(const char *policy, const Stats& stats) {
+    printf("%-36s peak %4lu req/s   requests %6lu   rejected %6lu   ",
+            policy, stats.peakAfterOutage, stats.requestsAfterOutage, stats.rejectedAfterOutage);
+    if (stats.delivered == FLEET_SIZE) {
+        printf("drained after %5lu s\n", stats.drainTime / 1000UL);
+    } else {
+        printf("%lu of %u delivered within %lu h\n", stats.delivered, FLEET_SIZE, SIM_DURATION_MS / 3600000UL);
+    }
+}
+
+} //namespace
+
+TEST_CASE( "Retry backoff" ) {
+
+    printf("\nFleet of %u chargers after a %lu min CSMS outage, CSMS capacity %u req/s\n",
+            FLEET_SIZE, OUTAGE_MS / 60000UL, CSMS_CAPACITY);
+
+    auto legacy = runFleet(Policy::Legacy);
+    auto backoff = runFleet(Policy::Backoff);
+    auto serverHint = runFleet(Policy::ServerHint);
+
+    printStats("Linear, no jitter (legacy)", legacy);
+    printStats("Exponential backoff with jitter", backoff);
+    printStats("Backoff with server hint", serverHint);
+
+    //thundering herd: the retries don't arrive in lockstep
+    REQUIRE( backoff.peakAfterOutage < legacy.peakAfterOutage );
+    REQUIRE( serverHint.peakAfterOutage < legacy.peakAfterOutage );
+
+    RetryPolicy retryPolicy;
+
+    BENCHMARK("RetryPolicy::getRetryDelay") {
+        unsigned long sum = 0;
+        for (unsigned int attemptNr = 1; attemptNr <= 10; attemptNr++) {
+            sum += retryPolicy.getRetryDelay(attemptNr, RETRY_INTERVAL_MS, attemptNr);
+        }
+        return sum;
+    };
+}
@@ -0,0 +1,145 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/Configuration.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <MicroOcpp/Operations/CustomOperation.h>
+#include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Model/Authorization/AuthorizationService.h>
+#include <MicroOcpp/Platform.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#define LATENCY_MS 150 //one-way delay of the loopback connection, i.e. 300 ms round-trip time
+#define ENERGIZE_MAX_MS 10000
+
+using namespace MicroOcpp;
+
+/*
+ * Time-to-energize of a charging session with an idTag on the local authorization list: the time from
+ * beginTransaction() until ocppPermitsCharge() becomes true. The simulation runs on the real clock with a
+ * loopback connection which delays each message by 150 ms. By default, the charger waits for the
+ * Authorize.conf. With LocalPreAuthorize, it starts right away and never asks the server. With the
+ * speculative authorization, it starts right away too, but sends the Authorize in parallel and holds
+ * the StartTransaction back until the server has confirmed or rejected the idTag
+ */
+namespace {
+
+void loopFor(unsigned long duration) {
+    auto t_start = mocpp_tick_ms();
+    while (mocpp_tick_ms() - t_start < duration) {
+        mocpp_loop();
+    }
+}
+
+unsigned long measureTimeToEnergize() {
+    auto t_begin = mocpp_tick_ms();
+    beginTransaction("mIdTag");
+    while (!ocppPermitsCharge() && mocpp_tick_ms() - t_begin < ENERGIZE_MAX_MS) {
+        mocpp_loop();
+    }
+    return mocpp_tick_ms() - t_begin;
+}
+
+} //namespace
+
+TEST_CASE( "Speculative authorization" ) {
+
+    LoopbackConnection loopback;
+    loopback.setLatency(LATENCY_MS);
+
+    mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"),
+            makeMemoryFilesystemAdapter()); //the local list needs a filesystem
+
+    declareConfiguration<bool>("LocalAuthListEnabled", true)->setBool(true);
+    auto localPreAuthorize = declareConfiguration<bool>("LocalPreAuthorize", false);
+    auto speculativeAuthorize = declareConfiguration<bool>(MO_CONFIG_EXT_PREFIX "SpeculativeAuthorize", false);
+
+    StaticJsonDocument<256> localAuthList;
+    localAuthList[0]["idTag"] = "mIdTag";
+    localAuthList[0]["idTagInfo"]["status"] = "Accepted";
+    REQUIRE( getOcppContext()->getModel().getAuthorizationService()->updateLocalList(localAuthList.as<JsonArray>(), 1, false) );
+
+    unsigned int nStartTx = 0, nStopTx = 0;
+    bool stopDeAuthorized = false;
+    getOcppContext()->getOperationRegistry().setOnRequest("StartTransaction", [&nStartTx] (JsonObject) {nStartTx++;});
+    getOcppContext()->getOperationRegistry().setOnRequest("StopTransaction", [&nStopTx, &stopDeAuthorized] (JsonObject payload) {
+        nStopTx++;
+        stopDeAuthorized = !strcmp(payload["reason"] | "_Undefined", "DeAuthorized");
+    });
+
+    loopFor(2000); //BootNotification
+
+    struct {
+        const char *name;
+        bool localPreAuthorize;
+        bool speculativeAuthorize;
+    } modes [] = {
+        {"Authorize.conf", false, false},
+        {"LocalPreAuthorize", true, false},
+        {"speculative", false, true},
+    };
+
+    printf("\nTime-to-energize with %u ms round-trip time\n", 2 * LATENCY_MS);
+
+    for (auto& mode : modes) {
+        localPreAuthorize->setBool(mode.localPreAuthorize);
+        speculativeAuthorize->setBool(mode.speculativeAuthorize);
+
+        auto timeToEnergize = measureTimeToEnergize();
+        REQUIRE( ocppPermitsCharge() );
+
+        loopFor(2000); //Authorize and StartTransaction
+        endTransaction();
+        loopFor(2000);
+
+        printf("%-20s %5lu ms\n", mode.name, timeToEnergize);
+    }
+
+    REQUIRE( nStartTx == sizeof(modes) / sizeof(modes[0]) );
+
+    //server rejects the idTag: the speculative tx is stopped and reported with StartTx and StopTx
+    getOcppContext()->getOperationRegistry().registerOperation("Authorize", [] () {
+        return new Ocpp16::CustomOperation("Authorize",
+            [] (JsonObject) {}, //ignore req
+            [] () {
+                //create conf
+                auto doc = makeJsonDoc("Benchmark", 2 * JSON_OBJECT_SIZE(1));
+                auto payload = doc->to<JsonObject>();
+                payload["idTagInfo"]["status"] = "Blocked";
+                return doc;
+            });});
+
+    localPreAuthorize->setBool(false);
+    speculativeAuthorize->setBool(true);
+
+    nStartTx = 0;
+    nStopTx = 0;
+    auto timeToEnergize = measureTimeToEnergize();
+    REQUIRE( ocppPermitsCharge() );
+
+    auto t_energized = mocpp_tick_ms();
+    while (ocppPermitsCharge() && mocpp_tick_ms() - t_energized < ENERGIZE_MAX_MS) {
+        mocpp_loop();
+    }
+    auto timeToWithdraw = mocpp_tick_ms() - t_energized;
+    REQUIRE( !ocppPermitsCharge() );
+
+    loopFor(2000);
+    REQUIRE( nStartTx == 1 );
+    REQUIRE( nStopTx == 1 );
+    REQUIRE( stopDeAuthorized );
+
+    printf("%-20s %5lu ms, stopped after %lu ms with StopTransaction (DeAuthorized)\n", "speculative, Blocked", timeToEnergize, timeToWithdraw);
+
+    localPreAuthorize->setBool(false);
+    speculativeAuthorize->setBool(false);
+
+    mocpp_deinitialize();
+}
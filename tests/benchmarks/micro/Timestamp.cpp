@@ -0,0 +1,52 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/Time.h>
+#include <catch2/catch.hpp>
+
+using namespace MicroOcpp;
+
+TEST_CASE( "Timestamp kernels" ) {
+
+    const char *jsonDates [] = {
+        "2023-01-01T00:00:00Z",
+        "2024-02-29T23:59:59.123Z",
+        "1999-12-31T12:34:56Z",
+        "2037-06-15T07:08:09.5Z"
+    };
+    const size_t jsonDatesSize = sizeof(jsonDates) / sizeof(jsonDates[0]);
+
+    Timestamp t1, t2;
+    REQUIRE( t1.setTime(jsonDates[0]) );
+    REQUIRE( t2.setTime(jsonDates[1]) );
+
+    size_t i = 0;
+
+    BENCHMARK("setTime") {
+        Timestamp t;
+        return t.setTime(jsonDates[i++ % jsonDatesSize]);
+    };
+
+    BENCHMARK("toJsonString") {
+        char buf [JSONDATE_LENGTH + 1];
+        t1.toJsonString(buf, sizeof(buf));
+        return buf[JSONDATE_LENGTH - 1];
+    };
+
+    BENCHMARK("operator-") {
+        return t2 - t1;
+    };
+
+    BENCHMARK("operator+= (seconds)") {
+        Timestamp t = t1;
+        t += 59;
+        return t;
+    };
+
+    BENCHMARK("operator+= (years)") {
+        Timestamp t = t1;
+        t += 14 * 365 * 24 * 3600;
+        return t;
+    };
+}
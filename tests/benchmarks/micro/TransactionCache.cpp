@@ -0,0 +1,99 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/FilesystemMemory.h>
+#include <MicroOcpp/Model/Model.h>
+#include <MicroOcpp/Model/Transactions/TransactionStore.h>
+#include <MicroOcpp/Platform.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <string.h>
+
+#define NUM_SESSIONS 5
+
+using namespace MicroOcpp;
+
+/*
+ * Reads of transaction records per charging session with and without the strong LRU cache of the
+ * ConnectorTransactionStore (build flag MO_TXSTORE_CACHE_SIZE). Without the cache, each tx is parsed
+ * from flash again whenever its last user has released it, e.g. when the Connector walks the tx
+ * history to allocate the next tx or to find the front request. The filesystem is the in-memory
+ * LittleFS model, so the reads are counted per file
+ */
+namespace {
+
+void loopFor(unsigned long duration) {
+    auto t_start = mocpp_tick_ms();
+    while (mocpp_tick_ms() - t_start < duration) {
+        mocpp_loop();
+    }
+}
+
+FlashStats getTxFileStats(MemoryFilesystemAdapter& filesystem) {
+    FlashStats stats;
+    for (auto& file : filesystem.getFileStats()) {
+        if (!strncmp(file.first.c_str(), "tx-", strlen("tx-"))) {
+            stats.add(file.second);
+        }
+    }
+    return stats;
+}
+
+} //namespace
+
+TEST_CASE( "Transaction cache" ) {
+
+    size_t cacheSizes [] = {0, MO_TXSTORE_CACHE_SIZE};
+
+    printf("\nTransaction record reads per charging session\n");
+    printf("%-12s %10s %10s\n", "cache size", "tx reads", "bytes");
+
+    for (auto cacheSize : cacheSizes) {
+
+        auto filesystem = makeMemoryFilesystemAdapter();
+
+        LoopbackConnection loopback;
+
+        bool plugged = false;
+
+        mocpp_initialize(loopback, ChargerCredentials("Benchmark model", "Benchmark vendor"), filesystem);
+        getOcppContext()->getModel().getTransactionStore()->setCacheSize(cacheSize);
+        setConnectorPluggedInput([&plugged] () {return plugged;});
+        setEnergyMeterInput([] () {return 1000;});
+        loopFor(500); //BootNotification
+
+        filesystem->resetStats();
+
+        for (unsigned int i = 0; i < NUM_SESSIONS; i++) {
+            plugged = true;
+            beginTransaction("mIdTag");
+            loopFor(200);
+            REQUIRE( ocppPermitsCharge() );
+            endTransaction();
+            plugged = false;
+            loopFor(200);
+        }
+
+        auto stats = getTxFileStats(*filesystem);
+        printf("%-12zu %10.1f %8.0f B\n",
+                cacheSize,
+                (double) stats.fileReads / NUM_SESSIONS,
+                (double) stats.bytesRead / NUM_SESSIONS);
+
+        mocpp_deinitialize();
+    }
+
+    //cache hit of a released tx. The cache discards the tx if its previous users have left uncommitted modifications
+    auto filesystem = makeMemoryFilesystemAdapter();
+    TransactionStore txStore {2, filesystem};
+    REQUIRE( txStore.createTransaction(1, 0) );
+
+    BENCHMARK("Cache hit of a released tx") {
+        return txStore.getTransaction(1, 0) != nullptr;
+    };
+}
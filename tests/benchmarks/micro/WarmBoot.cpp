@@ -0,0 +1,228 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+#include <MicroOcpp/Core/FilesystemSnapshot.h>
+#include <MicroOcpp/Core/FilesystemUtils.h>
+#include <catch2/catch.hpp>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+
+using namespace MicroOcpp;
+
+/*
+ * Boot-time file accesses of the OCPP 1.6 loaders with a populated store of 3 connectors: bootstats,
+ * configurations, the local authorization list, Smart Charging profiles, the transaction records and
+ * the meter data of a running transaction. The loaders probe every Smart Charging stack level, so
+ * most of the lookups target files which don't exist. The benchmark runs the same access pattern on
+ * the individual files and on the snapshot, and counts the calls which reach the filesystem
+ */
+namespace {
+
+struct StoreFile {
+    const char *fname;
+    size_t size;
+};
+
+const StoreFile store [] = {
+    {"bootstats.jsn",     90},
+    {"ocpp-config.jsn", 2800},
+    {"client-state.jsn", 350},
+    {"localauth.jsn",   1900},
+    {"sc-cm-0.jsn",      300},
+    {"sc-td-0-0.jsn",    300},
+    {"tx-1-0.jsn",       420},
+    {"tx-1-1.jsn",       420},
+    {"tx-1-2.jsn",       420},
+    {"tx-1-3.jsn",       420},
+    {"tx-2-0.jsn",       420},
+    {"tx-2-1.jsn",       420},
+    {"sd-1-3-0.jsn",     600},
+};
+
+#define NUM_CONNECTORS 3
+#define SC_STACK_LEVELS 8 //MO_ChargeProfileMaxStackLevel
+
+class CountingFilesystemAdapter : public FilesystemAdapter {
+private:
+    std::shared_ptr<FilesystemAdapter> filesystem;
+public:
+    size_t nCalls = 0; //stat, open, remove and ftw_root
+    size_t nBytesRead = 0;
+
+    class CountingFileAdapter : public FileAdapter {
+    private:
+        std::unique_ptr<FileAdapter> file;
+        size_t& nBytesRead;
+    public:
+        CountingFileAdapter(std::unique_ptr<FileAdapter> file, size_t& nBytesRead) : file(std::move(file)), nBytesRead(nBytesRead) { }
+        size_t read(char *buf, size_t len) override {
+            auto ret = file->read(buf, len);
+            nBytesRead += ret;
+            return ret;
+        }
+        size_t write(const char *buf, size_t len) override {return file->write(buf, len);}
+        size_t seek(size_t offset) override {return file->seek(offset);}
+        int read() override {
+            auto c = file->read();
+            nBytesRead += c >= 0 ? 1 : 0;
+            return c;
+        }
+    };
+
+    CountingFilesystemAdapter(std::shared_ptr<FilesystemAdapter> filesystem) : filesystem(filesystem) { }
+
+    int stat(const char *path, size_t *size) override {
+        nCalls++;
+        return filesystem->stat(path, size);
+    }
+    std::unique_ptr<FileAdapter> open(const char *fn, const char *mode) override {
+        nCalls++;
+        auto file = filesystem->open(fn, mode);
+        if (!file) {
+            return nullptr;
+        }
+        return std::unique_ptr<FileAdapter>(new CountingFileAdapter(std::move(file), nBytesRead));
+    }
+    bool remove(const char *fn) override {
+        nCalls++;
+        return filesystem->remove(fn);
+    }
+    int ftw_root(std::function<int(const char *fpath)> fn) override {
+        nCalls++;
+        return filesystem->ftw_root(fn);
+    }
+};
+
+void populateStore(std::shared_ptr<FilesystemAdapter> filesystem) {
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+
+    const char pattern [] = "{\"key\":\"value\",\"number\":1234,\"flag\":true},";
+    for (auto& entry : store) {
+        char path [MO_MAX_PATH_SIZE];
+        snprintf(path, sizeof(path), MO_FILENAME_PREFIX "%s", entry.fname);
+        auto file = filesystem->open(path, "w");
+        REQUIRE( file );
+        for (size_t i = 0; i < entry.size; i++) {
+            file->write(&pattern[i % (sizeof(pattern) - 1)], 1);
+        }
+    }
+}
+
+size_t loadFile(FilesystemAdapter& filesystem, const char *path) {
+    size_t size = 0;
+    if (filesystem.stat(path, &size) != 0) {
+        return 0;
+    }
+    auto file = filesystem.open(path, "r");
+    if (!file) {
+        return 0;
+    }
+    char buf [128];
+    size_t read = 0;
+    while (auto ret = file->read(buf, sizeof(buf))) {
+        read += ret;
+    }
+    return read;
+}
+
+//the file accesses of mocpp_initialize()
+size_t bootLoaders(FilesystemAdapter& filesystem) {
+    size_t read = 0;
+    char path [MO_MAX_PATH_SIZE];
+
+    read += loadFile(filesystem, MO_FILENAME_PREFIX "bootstats.jsn");
+    read += loadFile(filesystem, MO_FILENAME_PREFIX "ocpp-config.jsn");
+    read += loadFile(filesystem, MO_FILENAME_PREFIX "client-state.jsn");
+
+    for (unsigned int cId = 0; cId < NUM_CONNECTORS; cId++) {
+        //tx range scan and the most recent tx
+        char prefix [16];
+        snprintf(prefix, sizeof(prefix), "tx-%u-", cId);
+        unsigned int txNrLatest = 0;
+        bool found = false;
+        filesystem.ftw_root([&prefix, &txNrLatest, &found] (const char *fname) -> int {
+            if (!strncmp(fname, prefix, strlen(prefix))) {
+                unsigned int txNr = (unsigned int)atoi(fname + strlen(prefix));
+                txNrLatest = found && txNrLatest > txNr ? txNrLatest : txNr;
+                found = true;
+            }
+            return 0;
+        });
+        if (found) {
+            snprintf(path, sizeof(path), MO_FILENAME_PREFIX "tx-%u-%u.jsn", cId, txNrLatest);
+            read += loadFile(filesystem, path);
+        }
+    }
+
+    read += loadFile(filesystem, MO_FILENAME_PREFIX "localauth.jsn");
+    read += loadFile(filesystem, MO_FILENAME_PREFIX "reservations.jsn");
+
+    for (unsigned int iLevel = 0; iLevel < SC_STACK_LEVELS; iLevel++) {
+        snprintf(path, sizeof(path), MO_FILENAME_PREFIX "sc-cm-%u.jsn", iLevel);
+        read += loadFile(filesystem, path);
+    }
+    for (unsigned int cId = 0; cId < NUM_CONNECTORS; cId++) {
+        for (unsigned int iLevel = 0; iLevel < SC_STACK_LEVELS; iLevel++) {
+            snprintf(path, sizeof(path), MO_FILENAME_PREFIX "sc-td-%u-%u.jsn", cId, iLevel);
+            read += loadFile(filesystem, path);
+            snprintf(path, sizeof(path), MO_FILENAME_PREFIX "sc-tx-%u-%u.jsn", cId, iLevel);
+            read += loadFile(filesystem, path);
+        }
+    }
+
+    //meter data of the running tx
+    for (unsigned int i = 0; i < 4; i++) {
+        snprintf(path, sizeof(path), MO_FILENAME_PREFIX "sd-1-3-%u.jsn", i);
+        read += loadFile(filesystem, path);
+    }
+
+    return read;
+}
+
+} //namespace
+
+TEST_CASE( "Warm boot" ) {
+
+    mkdir(MO_FILENAME_PREFIX, 0777);
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    REQUIRE( filesystem );
+    populateStore(filesystem);
+
+    //per-file path
+    auto cold = std::make_shared<CountingFilesystemAdapter>(filesystem);
+    auto coldRead = bootLoaders(*cold);
+
+    //create snapshot
+    auto snapshot = decorateSnapshot(filesystem);
+    REQUIRE( snapshot->storeSnapshot() );
+    snapshot.reset();
+
+    //snapshot path
+    auto warm = std::make_shared<CountingFilesystemAdapter>(filesystem);
+    auto warmSnapshot = decorateSnapshot(warm);
+    REQUIRE( warmSnapshot->isImageLoaded() );
+    auto warmRead = bootLoaders(*warmSnapshot);
+
+    printf("\nBoot-time file accesses, %zu files with %zuB\n", sizeof(store) / sizeof(store[0]), coldRead);
+    printf("%-20s %4zu filesystem calls   %6zu bytes read\n", "Individual files", cold->nCalls, cold->nBytesRead);
+    printf("%-20s %4zu filesystem calls   %6zu bytes read\n", "Snapshot", warm->nCalls, warm->nBytesRead);
+
+    REQUIRE( warmRead == coldRead ); //the loaders see the same contents
+    REQUIRE( warm->nCalls < cold->nCalls );
+
+    BENCHMARK("Boot loaders (individual files)") {
+        return bootLoaders(*filesystem);
+    };
+
+    BENCHMARK("Boot loaders (snapshot)") {
+        auto fsSnapshot = decorateSnapshot(filesystem);
+        return bootLoaders(*fsSnapshot);
+    };
+
+    FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+}
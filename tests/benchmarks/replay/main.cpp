@@ -0,0 +1,520 @@
+// matth-x/MicroOcpp
+// Copyright Matthias Akstaller 2019 - 2024
+// MIT License
+
+/*
+ * Deterministic replay of a trace which a charger has captured with MO_ENABLE_TRACE and Cst_TraceCapture.
+ *
+ *     mo_trace_replay <trace file> [--keep-store] [--summary]
+ *
+ * The replay runs MO with virtual time at maximum speed. It sets mocpp_tick_ms() to the recorded value before
+ * each mocpp_loop() call, registers the recorded Inputs and plays back their values, repeats the transaction
+ * calls of the application and delivers the recorded server frames. The messageIds of the charger are random,
+ * so the server responses are redirected to the messageIds of the replayed requests. Each frame which the
+ * replay sends is compared with the recorded frame; the first mismatch is reported as divergence.
+ *
+ * Per OCPP message, the replay reports the host processing time and the heap peak (all MO allocations). An
+ * incoming message is accounted with the time spent in the receive callback. An outgoing message is accounted
+ * with the time since the previous message of the same loop call, i.e. including its creation.
+ *
+ * The replay starts with a clean ./mo_store folder. For an exact replay, copy the files of the charger into
+ * ./mo_store and pass --keep-store. Build the replay with the same build flags (like MO_NUMCONNECTORS) as the
+ * firmware. Output is JSON on stdout
+ */
+
+#include <MicroOcpp.h>
+#include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
+#include <MicroOcpp/Core/FilesystemUtils.h>
+#include <MicroOcpp/Core/Memory.h>
+#include <MicroOcpp/Core/Trace.h>
+
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace MicroOcpp;
+
+namespace {
+
+unsigned long mtime = 0;
+unsigned long custom_timer_cb() {
+    return mtime;
+}
+
+struct ReplayInput {
+    TraceValueType type = TraceValueType::Bool;
+    bool boolValue = false;
+    int32_t intValue = 0;
+    float floatValue = 0.f;
+    std::string strValue;
+    bool strNull = true;
+};
+
+struct MessageStats {
+    unsigned long t; //virtual time relative to the trace begin
+    const char *dir;
+    std::string op;
+    const char *kind;
+    size_t size;
+    unsigned long us;
+    size_t heap;
+};
+
+struct OperationStats {
+    unsigned long count = 0;
+    unsigned long usSum = 0;
+    unsigned long usMax = 0;
+    size_t heapMax = 0;
+};
+
+//[<MessageTypeId>,"<messageId>",... Returns false if the frame doesn't have this format
+bool parseFrame(const char *frame, size_t len, int& type, size_t& idBegin, size_t& idEnd) {
+    if (len < 5 || frame[0] != '[' || frame[1] < '2' || frame[1] > '4' || frame[2] != ',' || frame[3] != '"') {
+        return false;
+    }
+    type = frame[1] - '0';
+    idBegin = 4;
+    for (idEnd = idBegin; idEnd < len && frame[idEnd] != '"'; idEnd++);
+    return idEnd < len;
+}
+
+//action of a CALL, i.e. the string after the messageId
+std::string parseAction(const char *frame, size_t len, size_t idEnd) {
+    size_t begin = idEnd + 1;
+    while (begin < len && frame[begin] != '"') {
+        begin++;
+    }
+    size_t end = begin + 1;
+    while (end < len && frame[end] != '"') {
+        end++;
+    }
+    return end < len ? std::string(frame + begin + 1, end - begin - 1) : std::string();
+}
+
+class ReplayConnection : public Connection {
+private:
+    ReceiveTXTcallback receiveTXT;
+
+    struct Frame {
+        std::string data;
+        bool accepted;
+    };
+    std::deque<std::string> inbound; //delivered in the next loop call
+    std::deque<Frame> expected; //recorded outgoing frames of the current loop call
+
+    std::map<std::string, std::string> messageIds; //recorded messageId -> messageId of the replay
+    std::map<std::string, std::string> actionsOut; //messageId of the replay's requests -> action
+    std::map<std::string, std::string> actionsIn; //messageId of the server's requests -> action
+
+    std::chrono::steady_clock::time_point t_mark;
+public:
+    std::shared_ptr<ReplayInput> connected;
+
+    std::vector<MessageStats> messages;
+    unsigned long t_begin = 0;
+
+    unsigned long nOut = 0;
+    unsigned long diverged = 0;
+    long firstDivergence = -1; //index of the outgoing frame
+
+    void mark() {
+        mo_mem_reset();
+        t_mark = std::chrono::steady_clock::now();
+    }
+
+    void account(const char *dir, const char *frame, size_t len, std::map<std::string, std::string>& requests, std::map<std::string, std::string>& responses) {
+        auto us = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - t_mark).count();
+
+        int type;
+        size_t idBegin, idEnd;
+        std::string op = "unknown";
+        const char *kind = "unknown";
+        if (parseFrame(frame, len, type, idBegin, idEnd)) {
+            std::string messageId (frame + idBegin, idEnd - idBegin);
+            if (type == 2) {
+                op = parseAction(frame, len, idEnd);
+                kind = "req";
+                requests[messageId] = op;
+            } else {
+                auto action = responses.find(messageId);
+                if (action != responses.end()) {
+                    op = action->second;
+                    responses.erase(action);
+                }
+                kind = type == 3 ? "conf" : "error";
+            }
+        }
+
+        messages.push_back(MessageStats {mtime - t_begin, dir, op, kind, len, (unsigned long)us, mo_mem_get_total_max()});
+    }
+
+    void deliver(const char *frame, size_t len) {
+        inbound.emplace_back(frame, len);
+    }
+
+    void expect(const char *frame, size_t len, bool accepted) {
+        expected.push_back(Frame {std::string(frame, len), accepted});
+    }
+
+    void clearExpected() {
+        //recorded frames which the replay hasn't sent
+        if (!expected.empty()) {
+            if (firstDivergence < 0) {
+                firstDivergence = (long)nOut;
+            }
+            diverged += expected.size();
+            expected.clear();
+        }
+    }
+
+    void loop() override {
+        while (!inbound.empty()) {
+            auto frame = std::move(inbound.front());
+            inbound.pop_front();
+
+            //responses refer to the messageIds of the replay
+            int type;
+            size_t idBegin, idEnd;
+            if (parseFrame(frame.c_str(), frame.length(), type, idBegin, idEnd) && type != 2) {
+                auto messageId = messageIds.find(frame.substr(idBegin, idEnd - idBegin));
+                if (messageId != messageIds.end()) {
+                    frame.replace(idBegin, idEnd - idBegin, messageId->second);
+                    messageIds.erase(messageId);
+                }
+            }
+
+            mark();
+            if (receiveTXT) {
+                receiveTXT(frame.c_str(), frame.length());
+            }
+            account("in", frame.c_str(), frame.length(), actionsIn, actionsOut);
+            mark();
+        }
+    }
+
+    bool sendTXT(const char *msg, size_t length) override {
+        account("out", msg, length, actionsOut, actionsIn);
+
+        bool accepted = true;
+        bool match = false;
+
+        if (!expected.empty()) {
+            auto& recorded = expected.front();
+            accepted = recorded.accepted;
+
+            int type, typeRecorded;
+            size_t idBegin, idEnd, idBeginRecorded, idEndRecorded;
+            if (parseFrame(msg, length, type, idBegin, idEnd) &&
+                    parseFrame(recorded.data.c_str(), recorded.data.length(), typeRecorded, idBeginRecorded, idEndRecorded)) {
+                //compare without the messageIds
+                match = type == typeRecorded &&
+                        length - idEnd == recorded.data.length() - idEndRecorded &&
+                        !memcmp(msg + idEnd, recorded.data.c_str() + idEndRecorded, length - idEnd);
+                if (type == 2) {
+                    messageIds[recorded.data.substr(idBeginRecorded, idEndRecorded - idBeginRecorded)] = std::string(msg + idBegin, idEnd - idBegin);
+                }
+            } else {
+                match = length == recorded.data.length() && !memcmp(msg, recorded.data.c_str(), length);
+            }
+            expected.pop_front();
+        }
+
+        if (!match) {
+            if (firstDivergence < 0) {
+                firstDivergence = (long)nOut;
+            }
+            diverged++;
+        }
+        nOut++;
+
+        mark();
+        return accepted;
+    }
+
+    void setReceiveTXTcallback(ReceiveTXTcallback &receiveTXT) override {
+        this->receiveTXT = receiveTXT;
+    }
+
+    unsigned long getLastConnected() override {
+        return 0;
+    }
+
+    bool isConnected() override {
+        return connected ? connected->boolValue : true;
+    }
+};
+
+void declareInput(const TraceRecord& record, std::shared_ptr<ReplayInput> input, ReplayConnection& connection) {
+    const char *name = record.str[0] ? record.str[0] : "";
+    unsigned int connectorId = record.connectorId;
+
+    if (!strcmp(name, "Connected")) {
+        connection.connected = input;
+    } else if (!strcmp(name, "ConnectorPlugged")) {
+        setConnectorPluggedInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "EvReady")) {
+        setEvReadyInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "EvseReady")) {
+        setEvseReadyInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "Occupied")) {
+        setOccupiedInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "StartTxReady")) {
+        setStartTxReadyInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "StopTxReady")) {
+        setStopTxReadyInput([input] () {return input->boolValue;}, connectorId);
+    } else if (!strcmp(name, "EnergyMeter")) {
+        setEnergyMeterInput([input] () {return (int)input->intValue;}, connectorId);
+    } else if (!strcmp(name, "PowerMeter")) {
+        setPowerMeterInput([input] () {return input->floatValue;}, connectorId);
+    } else if (!strcmp(name, "MeterValue")) {
+        addMeterValueInput([input] () {return input->floatValue;}, record.str[1], record.str[2], record.str[3], record.str[4], connectorId);
+    } else if (!strcmp(name, "ErrorCode")) {
+        addErrorCodeInput([input] () {return input->strNull ? (const char*)nullptr : input->strValue.c_str();}, connectorId);
+    } else {
+        fprintf(stderr, "unknown Input %s\n", name);
+    }
+}
+
+void updateInput(const TraceRecord& record, ReplayInput& input) {
+    input.boolValue = record.boolValue;
+    input.intValue = record.intValue;
+    input.floatValue = record.floatValue;
+    input.strNull = record.strValue == nullptr;
+    input.strValue = record.strValue ? record.strValue : "";
+}
+
+void call(const TraceRecord& record) {
+    const char *name = record.str[0] ? record.str[0] : "";
+    if (!strcmp(name, "beginTransaction")) {
+        beginTransaction(record.str[1] ? record.str[1] : "", record.connectorId);
+    } else if (!strcmp(name, "beginTransaction_authorized")) {
+        beginTransaction_authorized(record.str[1] ? record.str[1] : "", record.str[2], record.connectorId);
+    } else if (!strcmp(name, "endTransaction")) {
+        endTransaction(record.str[1], record.str[2], record.connectorId);
+    } else if (!strcmp(name, "endTransaction_authorized")) {
+        endTransaction_authorized(record.str[1], record.str[2], record.connectorId);
+    } else {
+        fprintf(stderr, "unknown call %s\n", name);
+    }
+}
+
+//payload of the first BootNotification of the trace, used as ChargerCredentials of the replay
+std::string findCredentials(const std::vector<unsigned char>& trace) {
+    TraceReader reader {trace.data(), trace.size()};
+    TraceHeader header;
+    TraceRecord record;
+    if (!reader.readHeader(header)) {
+        return std::string();
+    }
+    while (reader.next(record)) {
+        int type;
+        size_t idBegin, idEnd;
+        if (record.type == TraceRecordType::FrameOut &&
+                parseFrame(record.data, record.len, type, idBegin, idEnd) && type == 2 &&
+                parseAction(record.data, record.len, idEnd) == "BootNotification") {
+            DynamicJsonDocument doc {2 * record.len + JSON_ARRAY_SIZE(4)};
+            if (deserializeJson(doc, record.data, record.len)) {
+                return std::string();
+            }
+            JsonObject payload = header.versionMajor == 2 ?
+                    doc[3]["chargingStation"] : //v201 credentials without the BootNotification reason
+                    doc[3];
+            std::string credentials;
+            serializeJson(payload, credentials);
+            return credentials;
+        }
+    }
+    return std::string();
+}
+
+} //namespace
+
+int main(int argc, char **argv) {
+
+    const char *fn = nullptr;
+    bool keepStore = false;
+    bool summary = false;
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--keep-store")) {
+            keepStore = true;
+        } else if (!strcmp(argv[i], "--summary")) {
+            summary = true;
+        } else {
+            fn = argv[i];
+        }
+    }
+
+    if (!fn) {
+        fprintf(stderr, "usage: %s <trace file> [--keep-store] [--summary]\n", argv[0]);
+        return 1;
+    }
+
+    std::vector<unsigned char> trace;
+    if (FILE *f = fopen(fn, "rb")) {
+        unsigned char buf [4096];
+        size_t len;
+        while ((len = fread(buf, 1, sizeof(buf), f)) > 0) {
+            trace.insert(trace.end(), buf, buf + len);
+        }
+        fclose(f);
+    } else {
+        fprintf(stderr, "could not open %s\n", fn);
+        return 1;
+    }
+
+    TraceReader reader {trace.data(), trace.size()};
+    TraceHeader header;
+    if (!reader.readHeader(header)) {
+        fprintf(stderr, "%s is not a trace of this MO version\n", fn);
+        return 1;
+    }
+
+    auto credentials = findCredentials(trace);
+    if (credentials.empty()) {
+        credentials = header.versionMajor == 2 ?
+                ChargerCredentials::v201("Replay model", "Replay vendor") :
+                ChargerCredentials("Replay model", "Replay vendor");
+    }
+
+    auto filesystem = makeDefaultFilesystemAdapter(FilesystemOpt::Use_Mount_FormatOnFail);
+    if (!keepStore) {
+        FilesystemUtils::remove_if(filesystem, [] (const char*) {return true;});
+    }
+
+    mtime = header.t_begin;
+    mocpp_set_timer(custom_timer_cb);
+
+    ReplayConnection connection;
+    connection.t_begin = header.t_begin;
+
+    MO_MEM_RESET();
+
+    mocpp_initialize(connection, credentials.c_str(), filesystem, false, ProtocolVersion(header.versionMajor, header.versionMinor, header.versionPatch));
+
+    std::vector<std::shared_ptr<ReplayInput>> inputs;
+
+    //records which belong to the current loop call. Inputs and frames are applied before the loop call, the
+    //transaction calls of the application after it
+    std::vector<TraceRecord> pending;
+    bool loopPending = false;
+    unsigned long nLoops = 0;
+    bool truncated = false;
+
+    auto apply = [&] (const TraceRecord& record) {
+        switch (record.type) {
+            case TraceRecordType::InputDecl:
+                inputs.emplace_back(new ReplayInput());
+                inputs.back()->type = record.valueType;
+                declareInput(record, inputs.back(), connection);
+                break;
+            case TraceRecordType::InputValue:
+                if (record.inputId < inputs.size()) {
+                    updateInput(record, *inputs[record.inputId]);
+                }
+                break;
+            case TraceRecordType::FrameIn:
+                connection.deliver(record.data, record.len);
+                break;
+            case TraceRecordType::FrameOut:
+                connection.expect(record.data, record.len, record.accepted);
+                break;
+            case TraceRecordType::Call:
+                call(record);
+                break;
+            default:
+                break;
+        }
+    };
+
+    auto runLoop = [&] () {
+        for (const auto& record : pending) {
+            if (record.type != TraceRecordType::Call) {
+                apply(record);
+            }
+        }
+        connection.mark();
+        mocpp_loop();
+        connection.clearExpected();
+        for (const auto& record : pending) {
+            if (record.type == TraceRecordType::Call) {
+                apply(record);
+            }
+        }
+        pending.clear();
+        nLoops++;
+    };
+
+    auto t_replay = std::chrono::steady_clock::now();
+
+    TraceRecord record;
+    while (reader.next(record)) {
+        if (record.type == TraceRecordType::Tick) {
+            if (loopPending) {
+                runLoop();
+            }
+            for (unsigned long i = 0; i + 1 < record.repeat; i++) {
+                mtime += record.dt;
+                runLoop();
+            }
+            mtime += record.dt;
+            loopPending = record.repeat > 0;
+        } else if (record.type == TraceRecordType::Truncated) {
+            truncated = true;
+        } else if (loopPending) {
+            pending.push_back(record);
+        } else {
+            apply(record); //before the first loop call, e.g. the Input declarations
+        }
+    }
+    if (loopPending) {
+        runLoop();
+    }
+
+    auto replayMs = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t_replay).count();
+
+    mocpp_deinitialize();
+
+    std::map<std::string, OperationStats> operations;
+    for (const auto& msg : connection.messages) {
+        auto& stats = operations[std::string(msg.dir) + " " + msg.op + " " + msg.kind];
+        stats.count++;
+        stats.usSum += msg.us;
+        stats.usMax = std::max(stats.usMax, msg.us);
+        stats.heapMax = std::max(stats.heapMax, msg.heap);
+    }
+
+    printf("{\"trace\":{\"bootNr\":%u,\"version\":\"%i.%i.%i\",\"loops\":%lu,\"duration_ms\":%lu,\"truncated\":%s,\"malformed\":%s},",
+            (unsigned int)header.bootNr, header.versionMajor, header.versionMinor, header.versionPatch,
+            nLoops, mtime - header.t_begin, truncated ? "true" : "false", reader.isMalformed() ? "true" : "false");
+    printf("\"replay_ms\":%lu,\"sent\":%lu,\"diverged\":%lu,\"first_divergence\":%li,",
+            (unsigned long)replayMs, connection.nOut, connection.diverged, connection.firstDivergence);
+
+    if (!summary) {
+        printf("\"messages\":[");
+        for (size_t i = 0; i < connection.messages.size(); i++) {
+            const auto& msg = connection.messages[i];
+            printf("%s{\"t\":%lu,\"dir\":\"%s\",\"op\":\"%s\",\"kind\":\"%s\",\"size\":%zu,\"us\":%lu,\"heap\":%zu}",
+                    i == 0 ? "" : ",", msg.t, msg.dir, msg.op.c_str(), msg.kind, msg.size, msg.us, msg.heap);
+        }
+        printf("],");
+    }
+
+    printf("\"operations\":[");
+    bool first = true;
+    for (const auto& op : operations) {
+        printf("%s{\"message\":\"%s\",\"count\":%lu,\"us_mean\":%lu,\"us_max\":%lu,\"heap_max\":%zu}",
+                first ? "" : ",", op.first.c_str(), op.second.count, op.second.usSum / op.second.count, op.second.usMax, op.second.heapMax);
+        first = false;
+    }
+    printf("]}\n");
+
+    MO_MEM_DEINIT();
+    return connection.diverged > 0 ? 2 : 0;
+}
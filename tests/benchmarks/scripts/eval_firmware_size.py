@@ -79,9 +79,21 @@ def categorize_table(df):
     df.at['Core/FilesystemUtils.cpp', 'v16'] = TICK
     df.at['Core/FilesystemUtils.cpp', 'v201'] = TICK
     df.at['Core/FilesystemUtils.cpp', 'Module'] = MODULE_GENERAL
+    df.at['Core/FilesystemSnapshot.cpp', 'v16'] = TICK
+    df.at['Core/FilesystemSnapshot.cpp', 'v201'] = TICK
+    df.at['Core/FilesystemSnapshot.cpp', 'Module'] = MODULE_GENERAL
+    df.at['Core/FilesystemMemory.cpp', 'v16'] = TICK
+    df.at['Core/FilesystemMemory.cpp', 'v201'] = TICK
+    df.at['Core/FilesystemMemory.cpp', 'Module'] = MODULE_HAL
     df.at['Core/FtpMbedTLS.cpp', 'v16'] = TICK
     df.at['Core/FtpMbedTLS.cpp', 'v201'] = TICK
     df.at['Core/FtpMbedTLS.cpp', 'Module'] = MODULE_GENERAL
+    df.at['Core/JsonPool.cpp', 'v16'] = TICK
+    df.at['Core/JsonPool.cpp', 'v201'] = TICK
+    df.at['Core/JsonPool.cpp', 'Module'] = MODULE_RPC
+    df.at['Core/LinkMonitor.cpp', 'v16'] = TICK
+    df.at['Core/LinkMonitor.cpp', 'v201'] = TICK
+    df.at['Core/LinkMonitor.cpp', 'Module'] = MODULE_RPC
     df.at['Core/Memory.cpp', 'v16'] = TICK
     df.at['Core/Memory.cpp', 'v201'] = TICK
     df.at['Core/Memory.cpp', 'Module'] = MODULE_GENERAL
@@ -97,6 +109,18 @@ def categorize_table(df):
     df.at['Core/RequestQueue.cpp', 'v16'] = TICK
     df.at['Core/RequestQueue.cpp', 'v201'] = TICK
     df.at['Core/RequestQueue.cpp', 'Module'] = MODULE_RPC
+    df.at['Core/RequestScheduler.cpp', 'v16'] = TICK
+    df.at['Core/RequestScheduler.cpp', 'v201'] = TICK
+    df.at['Core/RequestScheduler.cpp', 'Module'] = MODULE_RPC
+    df.at['Core/TaskQueue.cpp', 'v16'] = TICK
+    df.at['Core/TaskQueue.cpp', 'v201'] = TICK
+    df.at['Core/TaskQueue.cpp', 'Module'] = MODULE_GENERAL
+    df.at['Core/Trace.cpp', 'v16'] = TICK
+    df.at['Core/Trace.cpp', 'v201'] = TICK
+    df.at['Core/Trace.cpp', 'Module'] = MODULE_GENERAL
+    df.at['Core/RetryPolicy.cpp', 'v16'] = TICK
+    df.at['Core/RetryPolicy.cpp', 'v201'] = TICK
+    df.at['Core/RetryPolicy.cpp', 'Module'] = MODULE_RPC
     df.at['Core/Time.cpp', 'v16'] = TICK
     df.at['Core/Time.cpp', 'v201'] = TICK
     df.at['Core/Time.cpp', 'Module'] = MODULE_GENERAL
@@ -135,6 +159,8 @@ def categorize_table(df):
     df.at['Model/Certificates/CertificateService.cpp', 'Module'] = MODULE_CERTS
     df.at['Model/ConnectorBase/Connector.cpp', 'v16'] = TICK
     df.at['Model/ConnectorBase/Connector.cpp', 'Module'] = MODULE_CORE
+    df.at['Model/ConnectorBase/ConnectorTable.cpp', 'v16'] = TICK
+    df.at['Model/ConnectorBase/ConnectorTable.cpp', 'Module'] = MODULE_CORE
     df.at['Model/ConnectorBase/ConnectorsCommon.cpp', 'v16'] = TICK
     df.at['Model/ConnectorBase/ConnectorsCommon.cpp', 'Module'] = MODULE_CORE
     if 'Model/ConnectorBase/Notification.cpp' in df.index:
@@ -147,6 +173,8 @@ def categorize_table(df):
     df.at['Model/Heartbeat/HeartbeatService.cpp', 'v16'] = TICK
     df.at['Model/Heartbeat/HeartbeatService.cpp', 'v201'] = TICK
     df.at['Model/Heartbeat/HeartbeatService.cpp', 'Module'] = MODULE_AVAILABILITY
+    df.at['Model/Metering/MeterAggregator.cpp', 'v16'] = TICK
+    df.at['Model/Metering/MeterAggregator.cpp', 'Module'] = MODULE_METERVALUES
     df.at['Model/Metering/MeteringConnector.cpp', 'v16'] = TICK
     df.at['Model/Metering/MeteringConnector.cpp', 'Module'] = MODULE_METERVALUES
     df.at['Model/Metering/MeteringService.cpp', 'v16'] = TICK
@@ -185,6 +213,9 @@ def categorize_table(df):
     df.at['Model/Transactions/Transaction.cpp', 'Module'] = MODULE_TX
     df.at['Model/Transactions/TransactionDeserialize.cpp', 'v16'] = TICK
     df.at['Model/Transactions/TransactionDeserialize.cpp', 'Module'] = MODULE_TX
+    if 'Model/Transactions/TransactionHistory.cpp' in df.index:
+        df.at['Model/Transactions/TransactionHistory.cpp', 'v16'] = TICK
+        df.at['Model/Transactions/TransactionHistory.cpp', 'Module'] = MODULE_TX
     if 'Model/Transactions/TransactionService.cpp' in df.index:
         df.at['Model/Transactions/TransactionService.cpp', 'v201'] = TICK
         df.at['Model/Transactions/TransactionService.cpp', 'Module'] = MODULE_TX
@@ -255,6 +286,9 @@ def categorize_table(df):
     if 'Operations/NotifyReport.cpp' in df.index:
         df.at['Operations/NotifyReport.cpp', 'v201'] = TICK
         df.at['Operations/NotifyReport.cpp', 'Module'] = MODULE_PROVISIONING_VARS
+    df.at['Operations/RawOperation.cpp', 'v16'] = TICK
+    df.at['Operations/RawOperation.cpp', 'v201'] = TICK
+    df.at['Operations/RawOperation.cpp', 'Module'] = MODULE_RPC
     df.at['Operations/RemoteStartTransaction.cpp', 'v16'] = TICK
     df.at['Operations/RemoteStartTransaction.cpp', 'Module'] = MODULE_TX
     df.at['Operations/RemoteStopTransaction.cpp', 'v16'] = TICK
@@ -0,0 +1,116 @@
+# matth-x/MicroOcpp
+# Copyright Matthias Akstaller 2019 - 2024
+# MIT License
+
+# Host-side footprint report. Collects the static size (.text/.data/.bss) of each compilation unit of
+# the v16 and v201 feature configurations and the heap usage of the scripted scenarios. Runs offline,
+# see CMake target mo_footprint_report
+
+import argparse
+import glob
+import json
+import os
+import subprocess
+import sys
+
+CONFIGS = ['v16', 'v201']
+
+def unit_name(obj_path, obj_dir):
+    # e.g. <obj_dir>/src/MicroOcpp/Core/Time.cpp.o -> Core/Time.cpp
+    rel = os.path.relpath(obj_path, obj_dir).replace(os.sep, '/')
+    if rel.endswith('.o'):
+        rel = rel[:-len('.o')]
+    for prefix in ['src/MicroOcpp/', 'src/']:
+        if rel.startswith(prefix):
+            return rel[len(prefix):]
+    return rel
+
+def measure_sizes(build_dir, config, size_tool):
+    obj_dir = os.path.join(build_dir, 'CMakeFiles', 'mo_footprint_' + config + '.dir')
+    objs = sorted(glob.glob(os.path.join(obj_dir, '**', '*.o'), recursive=True))
+    if not objs:
+        sys.exit('no object files found in ' + obj_dir + '. Build target mo_footprint_' + config + ' first')
+
+    # Berkeley format: text data bss dec hex filename
+    out = subprocess.run([size_tool] + objs, capture_output=True, text=True, check=True).stdout
+
+    units = {}
+    total = {'text': 0, 'data': 0, 'bss': 0}
+    for line in out.splitlines()[1:]:
+        cols = line.split()
+        if len(cols) < 6:
+            continue
+        entry = {'text': int(cols[0]), 'data': int(cols[1]), 'bss': int(cols[2])}
+        units[unit_name(' '.join(cols[5:]), obj_dir)] = entry
+        for key in total:
+            total[key] += entry[key]
+
+    return {'total': total, 'units': units}
+
+def measure_heap(build_dir):
+    exe = os.path.join(build_dir, 'mo_footprint_heap')
+    os.makedirs(os.path.join(build_dir, 'mo_store'), exist_ok=True)
+    out = subprocess.run([exe], capture_output=True, text=True, check=True, cwd=build_dir).stdout
+    raw = json.loads(out)
+
+    scenarios = {}
+    for scenario in raw['scenarios']:
+        heap = scenario['heap']
+        scenarios[scenario['name']] = {
+            'total_max': heap['total_max'],
+            # tags which were not used during this scenario keep a maximum of 0
+            'by_tag': {tag['tag']: tag['max'] for tag in heap['by_tag'] if tag['max'] > 0}
+        }
+    return scenarios
+
+def print_delta(label, old, new):
+    if old != new:
+        change = '{:+d}'.format(new - old)
+        rel = ' ({:+.1f} %)'.format(100. * (new - old) / old) if old else ''
+        print('{:<60} {:>9} -> {:>9} {}{}'.format(label, old, new, change, rel))
+
+def compare(baseline, report):
+    print('Changes against baseline:')
+    for config in CONFIGS:
+        old = baseline['size'].get(config, {}).get('units', {})
+        new = report['size'][config]['units']
+        for unit in sorted(set(old) | set(new)):
+            for section in ['text', 'data', 'bss']:
+                print_delta('size ' + config + ' ' + unit + ' .' + section,
+                            old.get(unit, {}).get(section, 0), new.get(unit, {}).get(section, 0))
+    for name, scenario in report['heap'].items():
+        old = baseline['heap'].get(name, {})
+        print_delta('heap ' + name + ' total_max', old.get('total_max', 0), scenario['total_max'])
+        old_tags = old.get('by_tag', {})
+        for tag in sorted(set(old_tags) | set(scenario['by_tag'])):
+            print_delta('heap ' + name + ' ' + tag, old_tags.get(tag, 0), scenario['by_tag'].get(tag, 0))
+
+def main():
+    parser = argparse.ArgumentParser(description='Host-side footprint report')
+    parser.add_argument('--build-dir', default='.', help='CMake build directory')
+    parser.add_argument('--output', default='footprint_report.json', help='path of the JSON report')
+    parser.add_argument('--baseline', help='previous report to compare against')
+    parser.add_argument('--size-tool', default='size', help='binutils size executable')
+    args = parser.parse_args()
+
+    report = {
+        'size': {config: measure_sizes(args.build_dir, config, args.size_tool) for config in CONFIGS},
+        'heap': measure_heap(args.build_dir)
+    }
+
+    with open(args.output, 'w') as f:
+        json.dump(report, f, indent=2, sort_keys=True)
+
+    for config in CONFIGS:
+        total = report['size'][config]['total']
+        print('size {}: .text {} B, .data {} B, .bss {} B'.format(config, total['text'], total['data'], total['bss']))
+    for name, scenario in report['heap'].items():
+        print('heap {}: {} B'.format(name, scenario['total_max']))
+    print('Report written to ' + args.output)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            compare(json.load(f), report)
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,67 @@
+# matth-x/MicroOcpp
+# Copyright Matthias Akstaller 2019 - 2024
+# MIT License
+
+# Generator for the perfect-hash tables of the OCPP enums (see src/MicroOcpp/Core/EnumTable.h). For each
+# enum, it searches the smallest power-of-2 slot table and a seed for which the seeded FNV-1a hashes of the
+# names don't collide and prints the constexpr table. Paste the output into the .cpp file of the enum. The
+# tables are checked at compile time, so a renamed or added enum value fails the build until the table is
+# regenerated
+
+# name of the table -> enum value names in the order of the enum. None for values without a string
+# representation (like UNDEFINED)
+ENUMS = {
+    'readingContextTable': [None, 'Interruption.Begin', 'Interruption.End', 'Other', 'Sample.Clock',
+                            'Sample.Periodic', 'Transaction.Begin', 'Transaction.End', 'Trigger'],
+    'authorizationStatusTable': ['Accepted', 'Blocked', 'Expired', 'Invalid', 'ConcurrentTx', None],
+    'registrationStatusTable': ['Accepted', 'Pending', 'Rejected', None],
+    'tConfigTable': ['int', 'bool', 'string'],
+    'chargingProfilePurposeTable': ['ChargePointMaxProfile', 'TxDefaultProfile', 'TxProfile'],
+    'chargingProfileKindTable': ['Absolute', 'Recurring', 'Relative'],
+    'recurrencyKindTable': [None, 'Daily', 'Weekly'],
+    'aggregationStatisticTable': ['Mean', 'Min', 'Max', 'Last', None],
+}
+
+SLOT_EMPTY = 0xFF
+MAX_SEED = 1 << 16
+
+def enum_hash(name, seed):
+    h = seed
+    for c in name.encode('ascii'):
+        h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+    return h ^ (h >> 16) # fold the high bits in, the low bits of FNV-1a only depend on the low bits of the input
+
+def find_table(names):
+    m = 1
+    while m < len(names):
+        m *= 2
+    while True:
+        for seed in range(MAX_SEED):
+            slots = [SLOT_EMPTY] * m
+            perfect = True
+            for value, name in enumerate(names):
+                if name is None:
+                    continue
+                slot = enum_hash(name, seed) & (m - 1)
+                if slots[slot] != SLOT_EMPTY:
+                    perfect = False
+                    break
+                slots[slot] = value
+            if perfect:
+                return seed, slots
+        m *= 2
+
+def main():
+    for table, names in ENUMS.items():
+        seed, slots = find_table(names)
+        names_str = ', '.join('"' + n + '"' if n is not None else 'nullptr' for n in names)
+        slots_str = ', '.join('0xFF' if s == SLOT_EMPTY else str(s) for s in slots)
+        print('constexpr EnumTable<%i,%i> %s {' % (len(names), len(slots), table))
+        print('    {%s},' % names_str)
+        print('    {%s},' % slots_str)
+        print('    %iU};' % seed)
+        print('static_assert(%s.isPerfect(), "regenerate with gen_enum_tables.py");' % table)
+        print()
+
+if __name__ == '__main__':
+    main()
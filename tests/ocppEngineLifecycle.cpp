@@ -4,6 +4,7 @@
 
 #include <MicroOcpp.h>
 #include <MicroOcpp/Core/Connection.h>
+#include <MicroOcpp/Core/Context.h>
 #include <catch2/catch.hpp>
 #include "./helpers/testHelper.h"
 
@@ -24,3 +25,77 @@ TEST_CASE( "Context lifecycle" ) {
         REQUIRE( !( getOcppContext() ) );
     }
 }
+
+TEST_CASE( "Time-sliced tasks" ) {
+    printf("\nRun %s\n",  "Time-sliced tasks");
+
+    //initialize Context with dummy socket
+    MicroOcpp::LoopbackConnection loopback;
+    mocpp_initialize(loopback);
+
+    mocpp_set_timer(custom_timer_cb);
+
+    auto context = getOcppContext();
+    auto& taskQueue = context->getTaskQueue();
+
+    SECTION("Resume tasks within the loop budget") {
+
+        unsigned int steps = 0;
+        taskQueue.addTask(MicroOcpp::makeTask([&steps] () {
+            mtime += 2; //simulate 2 ms of work per step
+            steps++;
+            return steps < 10 ? MicroOcpp::TaskStatus::Pending : MicroOcpp::TaskStatus::Done;
+        }));
+
+        context->resetMaxLoopTime();
+        mocpp_loop();
+
+        REQUIRE( steps == (MO_LOOP_BUDGET_MS + 1) / 2 ); //the step which exceeds the budget is the last one
+        REQUIRE( taskQueue.size() == 1 );
+        REQUIRE( context->getMaxLoopTime() >= MO_LOOP_BUDGET_MS );
+        REQUIRE( context->getMaxLoopTime() < MO_LOOP_BUDGET_MS + 2 );
+
+        for (unsigned int i = 0; i < 10 && taskQueue.size() > 0; i++) {
+            mocpp_loop();
+        }
+
+        REQUIRE( steps == 10 );
+        REQUIRE( taskQueue.size() == 0 );
+    }
+
+    SECTION("Round robin and progress guarantee") {
+
+        unsigned int stepsA = 0, stepsB = 0;
+        taskQueue.addTask(MicroOcpp::makeTask([&stepsA] () {
+            mtime += MO_LOOP_BUDGET_MS + 1; //each step exceeds the budget
+            stepsA++;
+            return stepsA < 5 ? MicroOcpp::TaskStatus::Pending : MicroOcpp::TaskStatus::Done;
+        }));
+        taskQueue.addTask(MicroOcpp::makeTask([&stepsB] () {
+            mtime += MO_LOOP_BUDGET_MS + 1;
+            stepsB++;
+            return stepsB < 2 ? MicroOcpp::TaskStatus::Pending : MicroOcpp::TaskStatus::Done;
+        }));
+
+        mocpp_loop();
+        REQUIRE( stepsA == 1 );
+        REQUIRE( stepsB == 0 );
+
+        mocpp_loop();
+        REQUIRE( stepsA == 1 );
+        REQUIRE( stepsB == 1 );
+
+        mocpp_loop();
+        mocpp_loop();
+        REQUIRE( stepsA == 2 );
+        REQUIRE( stepsB == 2 );
+        REQUIRE( taskQueue.size() == 1 );
+
+        taskQueue.flush(); //run to completion, like before deinitialization
+
+        REQUIRE( stepsA == 5 );
+        REQUIRE( taskQueue.size() == 0 );
+    }
+
+    mocpp_deinitialize();
+}